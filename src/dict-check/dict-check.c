@@ -5,161 +5,694 @@
 
 /** @file
     Główny plik modułu dict-check
+
+    Wejście czytane jest jako bajty w UTF-8: zwykły plik mapowany jest do
+    pamięci, inne wejście (potok, terminal) wczytywane dużymi porcjami.
+    Porcje dzielone są na kawałki z całych wierszy, sprawdzane w jednym lub
+    kilku wątkach. Tekst między znakami do dopisania (#) przepisywany jest
+    na wyjście prosto z wejścia, bez dekodowania i kopiowania.
     @ingroup dict-check
   */
 
 #include "trie.h"
 
 #include "dictionary.h"
+#include "watki.h"
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/** Liczba słów, dla których pamiętane są podpowiedzi; w tekście te same
+    błędy (nazwy, słownictwo dziedzinowe, częste literówki) się powtarzają.
+  */
+#define POJEMNOSC_PODPOWIEDZI 4096
+
+/** Rozmiar kawałka wejścia sprawdzanego w całości przez jeden wątek,
+    w bajtach; kawałek kończy się na końcu wiersza.
+  */
+#define KAWALEK (1024 * 1024)
+
+/** Liczba kawałków na wątek w jednej porcji wejścia; wątek, który skończył
+    swoje, bierze kolejny kawałek, więc wolniejsze kawałki nie zatrzymują
+    pozostałych wątków.
+  */
+#define KAWALKI_NA_WATEK 4
+
+/** Liczba znaków z tablicy małych liter: wszystkie kodowane w UTF-8 na
+    jednym lub dwóch bajtach, w tym polskie litery.
+  */
+#define ZNAKI_TABLICY 0x800
+
+/** Małe litery znaków z tablicy albo 0 dla znaków niebędących literami,
+    według lokalizacji (iswalpha(), towlower()).
+  */
+static wchar_t male[ZNAKI_TABLICY];
+
+/** Czy literami ASCII są dokładnie a-z i A-Z, co zakłada wektorowe
+    pomijanie znaków między słowami.
+  */
+static bool literyAscii;
+
+/**
+  Bufor bajtów do wypisania.
+  */
+struct bufor
+{
+  /** Bajty. */
+  char * dane;
+
+  /** Liczba bajtów. */
+  size_t dlugosc;
+
+  /** Rozmiar bufora. */
+  size_t rozmiar;
+};
+
+/**
+  Kawałek wejścia złożony z całych wierszy, z wynikami jego sprawdzenia.
+  */
+struct kawalek
+{
+  /** Pierwszy bajt kawałka. */
+  const unsigned char * poczatek;
+
+  /** Długość kawałka w bajtach. */
+  size_t dlugosc;
+
+  /** Numer pierwszego wiersza kawałka. */
+  int wiersz;
+
+  /** Przesunięcia słów spoza słownika względem początku kawałka. */
+  size_t * krzyzyki;
+
+  /** Liczba słów spoza słownika. */
+  int liczbaKrzyzykow;
+
+  /** Rozmiar tablicy przesunięć. */
+  int rozmiarKrzyzykow;
+
+  /** Podpowiedzi dla standardowego wyjścia błędów. */
+  struct bufor bledy;
+};
+
+/**
+  Stan wątku sprawdzającego.
+  */
+struct sprawdzajacy
+{
+  /** Czytelnik słownika wątku. */
+  struct dictionary_reader * czytelnik;
+
+  /** Lista na podpowiedzi. */
+  struct word_list lista;
+
+  /** Słowo małymi literami. */
+  wchar_t * slowo;
+
+  /** Liczba liter, na które jest miejsce w słowie. */
+  size_t rozmiar;
+};
+
+/**
+  Zlecenie sprawdzania porcji wejścia.
+  */
+struct sprawdzanie
+{
+  /** Kawałki porcji. */
+  struct kawalek * kawalki;
+
+  /** Stany wątków. */
+  struct sprawdzajacy * watki;
+
+  /** Czy wypisywać podpowiedzi. */
+  bool czyPodpowiedzi;
+};
+
+/**
+  Miejsce w kawałku z numerem wiersza i znaku w wierszu, wyznaczane
+  dopiero dla słów, do których wypisywane są podpowiedzi.
+  */
+struct pozycja
+{
+  /** Miejsce. */
+  const unsigned char * miejsce;
+
+  /** Numer wiersza. */
+  int wiersz;
+
+  /** Numer znaku w wierszu. */
+  int kolumna;
+};
 
-/** Maksymalna długość nazwy pliku.
-    Maksymalna długość nazwy pliku bez kończącego znaku '\0'
+/**
+  Wejście programu.
   */
-#define MAX_WORD_LENGTH 100
+struct wejscie
+{
+  /** Bajty wejścia: zmapowany plik albo bufor. */
+  unsigned char * dane;
+
+  /** Liczba bajtów w buforze (całego pliku przy mapowaniu). */
+  size_t dlugosc;
+
+  /** Pierwszy jeszcze niesprawdzony bajt. */
+  size_t pozycja;
+
+  /** Rozmiar bufora. */
+  size_t rozmiar;
+
+  /** Czy plik jest zmapowany. */
+  bool mapa;
+
+  /** Czy w buforze jest już koniec wejścia. */
+  bool koniec;
+};
 
-/** Funkcja tworząca słowo zawierające tylko małe litery.
- * 
- * @param[in] word Zmieniane słowo.
- * @param[in] dlugosc Długość słowa.
- * 
- * @return Słowo posiadające tylko małe litery.
+/** Funkcja budująca tablicę małych liter.
  */
-static wchar_t * make_lowercase(wchar_t *word, int dlugosc)
+static void zbudujTablice(void)
 {
-  wchar_t * new = malloc(sizeof(wchar_t) * (dlugosc +1));
-  for (int i = 0; i < dlugosc; i++)
+  literyAscii = true;
+  for (wchar_t znak = 0; znak < ZNAKI_TABLICY; znak++)
   {
-    if (!iswalpha(word[i]))
-      return NULL;
-    new[i] = towlower(word[i]);
+    male[znak] = iswalpha(znak) ? towlower(znak) : 0;
+    if (znak < 0x80)
+    {
+      bool litera = (znak | 0x20) >= 'a' && (znak | 0x20) <= 'z';
+      if ((male[znak] != 0) != litera)
+        literyAscii = false;
+    }
   }
-  new[dlugosc] = '\0';
-  return new;
 }
 
-/** Funkcja wczytująca słowo z pliku.
- * 
- * @param[in] stream Wejściowy strumień.
- * @return Wczytane słowo.
+/** Funkcja zwracająca małą literę znaku.
+ * @param[in] znak Znak.
+ * @return Mała litera albo 0, jeśli znak nie jest literą.
+ */
+static inline wchar_t mala(wchar_t znak)
+{
+  if (znak < ZNAKI_TABLICY)
+    return male[znak];
+  return iswalpha(znak) ? towlower(znak) : 0;
+}
+
+/** Funkcja dekodująca znak UTF-8. Błędny bajt jest osobnym znakiem
+ * niebędącym literą, który przepisuje się bez zmian.
+ * @param[out] znak Znak.
+ * @param[in] p Pierwszy bajt znaku.
+ * @param[in] koniec Koniec kawałka.
+ * @return Długość kodowania znaku w bajtach.
  */
-static wchar_t * wezSlowo(FILE * stream)
+static size_t dekoduj(wchar_t * znak, const unsigned char * p,
+  const unsigned char * koniec)
 {
-  int rozmiar = 0;
-  wchar_t word[MAX_WORD_LENGTH];
-  wchar_t buff;
-  while ((buff = fgetwc(stream)) != EOF)
+  int dlugosc;
+  wchar_t wynik, najmniejszy;
+  if (p[0] < 0x80)
   {
-    if (!(iswalpha(buff))){
-      ungetwc(buff, stream);
-      break;
+    *znak = p[0];
+    return 1;
+  }
+  if (p[0] >= 0xC2 && p[0] < 0xE0)
+  {
+    dlugosc = 2;
+    wynik = p[0] & 0x1F;
+    najmniejszy = 0x80;
+  }
+  else if (p[0] >= 0xE0 && p[0] < 0xF0)
+  {
+    dlugosc = 3;
+    wynik = p[0] & 0x0F;
+    najmniejszy = 0x800;
+  }
+  else if (p[0] >= 0xF0 && p[0] < 0xF5)
+  {
+    dlugosc = 4;
+    wynik = p[0] & 0x07;
+    najmniejszy = 0x10000;
+  }
+  else
+    dlugosc = 0;
+  if (dlugosc == 0 || koniec - p < dlugosc)
+  {
+    *znak = 0xFFFD;
+    return 1;
+  }
+  for (int i = 1; i < dlugosc; i++)
+  {
+    if ((p[i] & 0xC0) != 0x80)
+    {
+      *znak = 0xFFFD;
+      return 1;
     }
-    word[rozmiar] = buff;
-    rozmiar++;
-  } 
-  wchar_t * prawdziwy = malloc(sizeof(wchar_t) * (rozmiar + 1));
-  for (int i = 0; i < rozmiar; i++)
+    wynik = (wynik << 6) | (p[i] & 0x3F);
+  }
+  if (wynik < najmniejszy || wynik > 0x10FFFF ||
+      (wynik >= 0xD800 && wynik < 0xE000))
   {
-    prawdziwy[i] = word[i];
+    *znak = 0xFFFD;
+    return 1;
   }
-  prawdziwy[rozmiar] = L'\0';
-  return prawdziwy;
+  *znak = wynik;
+  return dlugosc;
 }
 
-/** Główna funkcja wykonująca
- * 
- * @param[in] pfile Strumień z pliku.
- * @param[in] czyPodpowiedzi Decyduje czy wypisywać podpowiedzi.
+/** Funkcja pomijająca znaki ASCII niebędące literami.
+ * @param[in] p Pierwszy bajt.
+ * @param[in] koniec Koniec kawałka.
+ * @return Pierwsza litera ASCII, pierwszy bajt spoza ASCII albo koniec.
+ */
+static const unsigned char * pominOdstepy(const unsigned char * p,
+  const unsigned char * koniec)
+{
+#ifdef __SSE2__
+  if (literyAscii)
+  {
+    /* Po ustawieniu bitu 0x20 i przesunięciu litery a-z stają się
+       najmniejszymi liczbami ze znakiem, od -128 do -103. */
+    const __m128i maleLitery = _mm_set1_epi8(0x20);
+    const __m128i przesuniecie = _mm_set1_epi8((char) (0x80 - 'a'));
+    const __m128i granica = _mm_set1_epi8(-128 + 26);
+    for (; koniec - p >= 16; p += 16)
+    {
+      __m128i bajty = _mm_loadu_si128((const __m128i *) p);
+      __m128i litery = _mm_cmplt_epi8(
+        _mm_add_epi8(_mm_or_si128(bajty, maleLitery), przesuniecie), granica);
+      int maska = _mm_movemask_epi8(_mm_or_si128(litery, bajty));
+      if (maska != 0)
+        return p + __builtin_ctz(maska);
+    }
+  }
+#endif
+  while (p < koniec && *p < 0x80 && male[*p] == 0)
+    p++;
+  return p;
+}
+
+/** Funkcja przesuwająca pozycję dalej w kawałku, licząc wiersze i znaki.
+ * @param[in,out] poz Pozycja.
+ * @param[in] cel Nowe miejsce, na granicy znaków.
+ */
+static void przesun(struct pozycja * poz, const unsigned char * cel)
+{
+  const unsigned char * p = poz->miejsce, * wiersz;
+  while ((wiersz = memchr(p, '\n', cel - p)) != NULL)
+  {
+    poz->wiersz++;
+    poz->kolumna = 1;
+    p = wiersz + 1;
+  }
+  while (p < cel)
+  {
+    wchar_t znak;
+    p += dekoduj(&znak, p, cel);
+    poz->kolumna++;
+  }
+  poz->miejsce = cel;
+}
+
+/** Funkcja dopisująca bajty do bufora.
+ * @param[in,out] b Bufor.
+ * @param[in] dane Bajty.
+ * @param[in] dlugosc Liczba bajtów.
  */
-void wykonaj(FILE * pfile, bool czyPodpowiedzi)
+static void dopisz(struct bufor * b, const char * dane, size_t dlugosc)
 {
-  struct dictionary * dict = NULL;
-  dict = dictionary_load(pfile); 
-  
-  wchar_t buff;
-  int wiersz = 1, kolumna = 1;
-  while ((buff = fgetwc(stdin)) != EOF)
+  if (b->dlugosc + dlugosc > b->rozmiar)
   {
-    if(iswalpha(buff))
+    b->rozmiar = 2 * (b->dlugosc + dlugosc);
+    b->dane = realloc(b->dane, b->rozmiar);
+  }
+  memcpy(b->dane + b->dlugosc, dane, dlugosc);
+  b->dlugosc += dlugosc;
+}
+
+/** Funkcja dopisująca do bufora napis zakodowany według lokalizacji.
+ * @param[in,out] b Bufor.
+ * @param[in] napis Napis.
+ */
+static void dopiszSzerokie(struct bufor * b, const wchar_t * napis)
+{
+  char znak[MB_LEN_MAX];
+  mbstate_t stan;
+  memset(&stan, 0, sizeof(stan));
+  for (; *napis; napis++)
+  {
+    size_t n = wcrtomb(znak, *napis, &stan);
+    if (n != (size_t) -1)
+      dopisz(b, znak, n);
+  }
+}
+
+/** Funkcja zapamiętująca słowo spoza słownika i dopisująca jego
+ * podpowiedzi.
+ * @param[in] s Zlecenie.
+ * @param[in,out] k Kawałek.
+ * @param[in,out] w Stan wątku ze sprawdzonym słowem.
+ * @param[in,out] poz Pozycja przed słowem.
+ * @param[in] slowo Pierwszy bajt słowa.
+ * @param[in] koniecSlowa Bajt za słowem.
+ */
+static void zglosSlowo(const struct sprawdzanie * s, struct kawalek * k,
+  struct sprawdzajacy * w, struct pozycja * poz, const unsigned char * slowo,
+  const unsigned char * koniecSlowa)
+{
+  if (k->liczbaKrzyzykow == k->rozmiarKrzyzykow)
+  {
+    k->rozmiarKrzyzykow = k->rozmiarKrzyzykow ? 2 * k->rozmiarKrzyzykow : 64;
+    k->krzyzyki = realloc(k->krzyzyki, sizeof(size_t) * k->rozmiarKrzyzykow);
+  }
+  k->krzyzyki[k->liczbaKrzyzykow++] = slowo - k->poczatek;
+  if (!s->czyPodpowiedzi)
+    return;
+  przesun(poz, slowo);
+  char pozycja[32];
+  dopisz(&k->bledy, pozycja,
+    snprintf(pozycja, sizeof(pozycja), "%d,%d ", poz->wiersz, poz->kolumna));
+  dopisz(&k->bledy, (const char *) slowo, koniecSlowa - slowo);
+  dopisz(&k->bledy, ": ", 2);
+  dictionary_reader_hints(w->czytelnik, w->slowo, &w->lista);
+  wchar_t * const *a = word_list_get(&w->lista);
+  for (size_t i = 0; i < word_list_size(&w->lista); i++)
+  {
+    if (i > 0)
+      dopisz(&k->bledy, " ", 1);
+    dopiszSzerokie(&k->bledy, a[i]);
+  }
+  dopisz(&k->bledy, "\n", 1);
+}
+
+/** Funkcja sprawdzająca jeden kawałek wejścia, zadanie puli wątków.
+ * Litery ASCII zamieniane są na małe bez dekodowania, pozostałe znaki
+ * dekodowane prosto do bufora słowa wątku.
+ * @param[in] zadanie Numer kawałka.
+ * @param[in] watek Numer wątku.
+ * @param[in,out] dane Zlecenie (struct sprawdzanie).
+ */
+static void sprawdzKawalek(int zadanie, int watek, void * dane)
+{
+  struct sprawdzanie * s = dane;
+  struct kawalek * k = &s->kawalki[zadanie];
+  struct sprawdzajacy * w = &s->watki[watek];
+  const unsigned char * p = k->poczatek;
+  const unsigned char * koniec = p + k->dlugosc;
+  struct pozycja poz = { p, k->wiersz, 1 };
+  k->liczbaKrzyzykow = 0;
+  k->bledy.dlugosc = 0;
+  while ((p = pominOdstepy(p, koniec)) < koniec)
+  {
+    wchar_t znak;
+    size_t n = dekoduj(&znak, p, koniec);
+    if (mala(znak) == 0)
+    {
+      p += n;
+      continue;
+    }
+    const unsigned char * slowo = p;
+    size_t dlugosc = 0;
+    while (p < koniec)
     {
-      ungetwc(buff, stdin);     
-      wchar_t * pom = wezSlowo(stdin);      
-      int dlugosc = wcslen(pom);
-      wchar_t * toFind = make_lowercase(pom, dlugosc);
-      if (!dictionary_find(dict, toFind))
+      wchar_t litera;
+      if (*p < 0x80)
       {
-        wprintf(L"#");
-        
-        if (czyPodpowiedzi)
-        {
-          fwprintf(stderr, L"%d,%d %ls: ", wiersz, kolumna, pom);
-          struct word_list list;
-          dictionary_hints(dict, toFind, &list);
-          int rozmiar = word_list_size(&list);    
-          if (rozmiar > 0)
-          {        
-            wchar_t * const *a = word_list_get(&list);
-            for (size_t i = 0; i < rozmiar; ++i)
-            {
-                fwprintf(stderr, L"%ls", a[i]);
-                if (i != rozmiar - 1)
-                  fwprintf(stderr, L" ");
-            }
-          } 
-          fwprintf(stderr, L"\n");         
-          word_list_done(&list);
-        }
+        litera = male[*p];
+        n = 1;
       }
-      wprintf(L"%ls", pom);
-      kolumna += dlugosc;
-      free(toFind);
-      free(pom);
+      else
+      {
+        n = dekoduj(&znak, p, koniec);
+        litera = mala(znak);
+      }
+      if (litera == 0)
+        break;
+      if (dlugosc + 1 >= w->rozmiar)
+      {
+        w->rozmiar = 2 * (dlugosc + 1);
+        w->slowo = realloc(w->slowo, sizeof(wchar_t) * w->rozmiar);
+      }
+      w->slowo[dlugosc++] = litera;
+      p += n;
     }
-    else
-    {
-      wprintf(L"%lc", buff);
-      kolumna++;
-    } 
-    if (buff == '\n')
+    w->slowo[dlugosc] = L'\0';
+    if (!dictionary_reader_find(w->czytelnik, w->slowo))
+      zglosSlowo(s, k, w, &poz, slowo, p);
+  }
+}
+
+/** Funkcja wypisująca wynik kawałka: podpowiedzi i tekst wejścia
+ * z dopisanymi znakami #.
+ * @param[in] k Kawałek.
+ */
+static void wypiszKawalek(const struct kawalek * k)
+{
+  if (k->bledy.dlugosc > 0)
+    fwrite(k->bledy.dane, 1, k->bledy.dlugosc, stderr);
+  size_t od = 0;
+  for (int i = 0; i < k->liczbaKrzyzykow; i++)
+  {
+    fwrite(k->poczatek + od, 1, k->krzyzyki[i] - od, stdout);
+    putchar('#');
+    od = k->krzyzyki[i];
+  }
+  if (k->dlugosc > od)
+    fwrite(k->poczatek + od, 1, k->dlugosc - od, stdout);
+}
+
+/** Funkcja wyznaczająca koniec kawałka zaczynającego się w danym miejscu
+ * wejścia: ostatni koniec wiersza w pierwszych KAWALEK bajtach albo, jeśli
+ * wiersz jest dłuższy, najbliższy dalszy.
+ * @param[in] we Wejście.
+ * @param[in] poczatek Początek kawałka.
+ * @return Koniec kawałka albo `poczatek`, jeśli reszta bufora nie zawiera
+ * całego wiersza i trzeba ją sprawdzić razem z następną porcją.
+ */
+static size_t koniecKawalka(const struct wejscie * we, size_t poczatek)
+{
+  size_t granica = we->dlugosc - poczatek > KAWALEK ?
+    poczatek + KAWALEK : we->dlugosc;
+  for (size_t i = granica; i > poczatek; i--)
+    if (we->dane[i - 1] == '\n')
+      return i;
+  const unsigned char * wiersz =
+    memchr(we->dane + granica, '\n', we->dlugosc - granica);
+  if (wiersz != NULL)
+    return wiersz - we->dane + 1;
+  return we->koniec ? we->dlugosc : poczatek;
+}
+
+/** Funkcja licząca końce wierszy.
+ * @param[in] tekst Tekst.
+ * @param[in] dlugosc Długość tekstu w bajtach.
+ * @return Liczba końców wierszy.
+ */
+static int policzWiersze(const unsigned char * tekst, size_t dlugosc)
+{
+  int liczba = 0;
+  const unsigned char * koniec = tekst + dlugosc;
+  while ((tekst = memchr(tekst, '\n', koniec - tekst)) != NULL)
+  {
+    liczba++;
+    tekst++;
+  }
+  return liczba;
+}
+
+/** Funkcja otwierająca wejście: mapująca standardowe wejście, jeśli jest
+ * zwykłym plikiem.
+ * @param[out] we Wejście.
+ */
+static void otworzWejscie(struct wejscie * we)
+{
+  struct stat opis;
+  we->dane = NULL;
+  we->dlugosc = 0;
+  we->pozycja = 0;
+  we->rozmiar = 0;
+  we->mapa = false;
+  we->koniec = false;
+  if (fstat(fileno(stdin), &opis) == 0 && S_ISREG(opis.st_mode) &&
+      opis.st_size > 0)
+  {
+    off_t poczatek = lseek(fileno(stdin), 0, SEEK_CUR);
+    if (poczatek < 0 || poczatek >= opis.st_size)
+      return;
+    void * mapa = mmap(NULL, opis.st_size, PROT_READ, MAP_PRIVATE,
+      fileno(stdin), 0);
+    if (mapa == MAP_FAILED)
+      return;
+    madvise(mapa, opis.st_size, MADV_SEQUENTIAL);
+    we->dane = mapa;
+    we->dlugosc = opis.st_size;
+    we->pozycja = poczatek;
+    we->mapa = true;
+    we->koniec = true;
+  }
+}
+
+/** Funkcja wczytująca następną porcję niezmapowanego wejścia za resztą
+ * poprzedniej, przeniesioną na początek bufora.
+ * @param[in,out] we Wejście.
+ * @param[in] porcja Rozmiar porcji w bajtach.
+ */
+static void doczytaj(struct wejscie * we, size_t porcja)
+{
+  if (we->mapa || we->koniec)
+    return;
+  /* Przy pierwszym wywołaniu dane są jeszcze NULL. */
+  if (we->pozycja > 0 && we->dlugosc > we->pozycja)
+    memmove(we->dane, we->dane + we->pozycja, we->dlugosc - we->pozycja);
+  we->dlugosc -= we->pozycja;
+  we->pozycja = 0;
+  if (we->rozmiar < we->dlugosc + porcja)
+  {
+    we->rozmiar = we->dlugosc + porcja;
+    we->dane = realloc(we->dane, we->rozmiar);
+  }
+  size_t wczytane = fread(we->dane + we->dlugosc, 1, porcja, stdin);
+  we->dlugosc += wczytane;
+  we->koniec = wczytane < porcja;
+}
+
+/** Funkcja zamykająca wejście.
+ * @param[in,out] we Wejście.
+ */
+static void zamknijWejscie(struct wejscie * we)
+{
+  if (we->mapa)
+    munmap(we->dane, we->dlugosc);
+  else
+    free(we->dane);
+}
+
+/** Główna funkcja wykonująca.
+ * Wejście dzielone jest na kawałki z całych wierszy, sprawdzane
+ * współbieżnie przez pulę wątków; wyniki kawałków wypisywane są
+ * w kolejności wejścia, więc wyjście nie zależy od liczby wątków.
+ *
+ * @param[in] dict Słownik.
+ * @param[in] czyPodpowiedzi Decyduje czy wypisywać podpowiedzi.
+ * @param[in] liczbaWatkow Liczba wątków.
+ */
+void wykonaj(struct dictionary * dict, bool czyPodpowiedzi, int liczbaWatkow)
+{
+  dictionary_freeze(dict);
+  zbudujTablice();
+  struct watki * pula = liczbaWatkow > 1 ? watki_nowe(liczbaWatkow) : NULL;
+  liczbaWatkow = pula != NULL ? pula->liczba : 1;
+  struct sprawdzanie s;
+  s.czyPodpowiedzi = czyPodpowiedzi;
+  s.kawalki = NULL;
+  s.watki = calloc(liczbaWatkow, sizeof(struct sprawdzajacy));
+  for (int i = 0; i < liczbaWatkow; i++)
+  {
+    s.watki[i].czytelnik = dictionary_reader_new(dict,
+      czyPodpowiedzi ? POJEMNOSC_PODPOWIEDZI : 0);
+    word_list_init(&s.watki[i].lista);
+  }
+
+  int najwiecejKawalkow = KAWALKI_NA_WATEK * liczbaWatkow;
+  size_t porcja = (size_t) KAWALEK * najwiecejKawalkow;
+  struct wejscie we;
+  otworzWejscie(&we);
+  int rozmiarKawalkow = 0, wiersz = 1;
+  for (;;)
+  {
+    doczytaj(&we, porcja);
+    int liczbaKawalkow = 0;
+    size_t koniec;
+    while (liczbaKawalkow < najwiecejKawalkow && we.pozycja < we.dlugosc &&
+           (koniec = koniecKawalka(&we, we.pozycja)) > we.pozycja)
     {
-      wiersz++;
-      kolumna = 1;
+      if (liczbaKawalkow == rozmiarKawalkow)
+      {
+        int nowy = rozmiarKawalkow ? 2 * rozmiarKawalkow : 16;
+        s.kawalki = realloc(s.kawalki, sizeof(struct kawalek) * nowy);
+        memset(s.kawalki + rozmiarKawalkow, 0,
+          sizeof(struct kawalek) * (nowy - rozmiarKawalkow));
+        rozmiarKawalkow = nowy;
+      }
+      struct kawalek * k = &s.kawalki[liczbaKawalkow++];
+      k->poczatek = we.dane + we.pozycja;
+      k->dlugosc = koniec - we.pozycja;
+      k->wiersz = wiersz;
+      if (czyPodpowiedzi)
+        wiersz += policzWiersze(k->poczatek, k->dlugosc);
+      we.pozycja = koniec;
     }
+    if (liczbaKawalkow == 0 && we.koniec)
+      break;
+    if (pula != NULL)
+      watki_wykonaj(pula, liczbaKawalkow, sprawdzKawalek, &s);
+    else
+      for (int i = 0; i < liczbaKawalkow; i++)
+        sprawdzKawalek(i, 0, &s);
+    for (int i = 0; i < liczbaKawalkow; i++)
+      wypiszKawalek(&s.kawalki[i]);
   }
+  zamknijWejscie(&we);
+
+  for (int i = 0; i < rozmiarKawalkow; i++)
+  {
+    free(s.kawalki[i].krzyzyki);
+    free(s.kawalki[i].bledy.dane);
+  }
+  free(s.kawalki);
+  for (int i = 0; i < liczbaWatkow; i++)
+  {
+    dictionary_reader_done(s.watki[i].czytelnik);
+    word_list_done(&s.watki[i].lista);
+    free(s.watki[i].slowo);
+  }
+  free(s.watki);
+  watki_done(pula);
   dictionary_done(dict);
 }
 
-/** Funkcja main.  
- * @param[in] argv Pomocnicze parametry, decydują o 
- * rodzaju słownika ora zwyświetlaniu podpowiedzi.
+/** Funkcja main.
+ * @param[in] argv Pomocnicze parametry, decydują o
+ * rodzaju słownika ora zwyświetlaniu podpowiedzi (`-v`) i liczbie
+ * wątków sprawdzających (`-j N`).
  * @param[in] argc Liczba argumentów.
  */
 int main(int argc, const char* argv[])
 {
   setlocale(LC_ALL, "pl_PL.UTF-8");
   bool czyPodpowiedzi = 0;
-  FILE * pfile;
-  if (argc == 3 && !strcmp(argv[1],"-v"))
-  {
-    pfile = fopen(argv[2], "r");
-    czyPodpowiedzi = 1;
-  }
-  else if (argc == 2)
+  int liczbaWatkow = 1;
+  bool poprawne = argc >= 2;
+  for (int i = 1; poprawne && i < argc - 1; i++)
   {
-    pfile = fopen(argv[1], "r");
+    if (!strcmp(argv[i], "-v"))
+      czyPodpowiedzi = 1;
+    else if (!strcmp(argv[i], "-j") && i + 1 < argc - 1)
+    {
+      char * koniec;
+      long liczba = strtol(argv[++i], &koniec, 10);
+      poprawne = *koniec == '\0' && liczba >= 1 && liczba <= 1024;
+      liczbaWatkow = liczba;
+    }
+    else
+      poprawne = false;
   }
-  else
+  if (!poprawne)
   {
     wprintf(L"Błędne argumenty\n");
     return 0;
   }
-  if (pfile == NULL)
+  const char * nazwaPliku = argv[argc - 1];
+  /* Słownik binarny jest mapowany do pamięci, tekstowy wczytywany. */
+  struct dictionary * dict = dictionary_load_file(nazwaPliku);
+  if (dict == NULL)
   {
     wprintf(L"Brak pliku o podanej nazwie\n");
     return 0;
   }
-  wykonaj(pfile, czyPodpowiedzi);
-  fclose(pfile); 
+  wykonaj(dict, czyPodpowiedzi, liczbaWatkow);
   return 0;
 }
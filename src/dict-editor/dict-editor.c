@@ -24,6 +24,9 @@
 /** Makro służące do otrzymania stałej w formie napisu */
 #define xstr(x)         str(x)
 
+/** Lista na podpowiedzi, wspólna dla wszystkich poleceń hints. */
+static struct word_list hints;
+
 
 /** Dostępne polecenia.
     Odpowiadające komendy w tablicy @ref commands
@@ -148,17 +151,15 @@ static int dict_command(struct dictionary **dict, enum Command c)
             break;
         case HINTS:
             {
-                struct word_list list;
-                dictionary_hints(*dict, word, &list);
-                wchar_t * const *a = word_list_get(&list);                
-                for (size_t i = 0; i < word_list_size(&list); ++i)
+                dictionary_hints_into(*dict, word, &hints);
+                wchar_t * const *a = word_list_get(&hints);
+                for (size_t i = 0; i < word_list_size(&hints); ++i)
                 {
                     if (i)
                         printf(" ");
                     printf("%ls", a[i]);
                 }
                 printf("\n");
-                word_list_done(&list);
                 break;
             }
         default:
@@ -273,8 +274,10 @@ int main(void)
 {
     setlocale(LC_ALL, "pl_PL.UTF-8");
     struct dictionary *dict = dictionary_new();
+    word_list_init(&hints);
     
     do {} while (try_process_command(&dict));
+    word_list_done(&hints);
     dictionary_done(dict);
 
     return 0;
@@ -0,0 +1,140 @@
+/** @file
+  Implementacja puli pamięci (areny).
+
+  @ingroup dictionary
+ */
+
+#include "arena.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Rozmiar pierwszego bloku. */
+#define PIERWSZY_BLOK (16 * 1024)
+
+/** Największy rozmiar bloku, bloki rosną dwukrotnie aż do tej wartości. */
+#define MAX_BLOK (1024 * 1024)
+
+/** Nagłówek bloku pamięci areny. */
+struct arena_blok
+{
+  /** Następny blok. */
+  struct arena_blok * nastepny;
+
+  /** Wyrównanie danych następujących po nagłówku. */
+  size_t wyrownanie;
+};
+
+/** Nagłówek dużego przydziału. */
+struct arena_duzy
+{
+  /** Poprzedni duży przydział. */
+  struct arena_duzy * poprzedni;
+
+  /** Następny duży przydział. */
+  struct arena_duzy * nastepny;
+};
+
+/** Funkcja zaokrąglająca rozmiar do wielokrotności ziarna.
+ * @param[in] rozmiar Rozmiar w bajtach.
+ * @return Zaokrąglony rozmiar.
+ */
+static size_t zaokraglij(size_t rozmiar)
+{
+  return (rozmiar + ARENA_ZIARNO - 1) & ~(size_t) (ARENA_ZIARNO - 1);
+}
+
+void arena_init(struct arena * a)
+{
+  a->wolne = NULL;
+  a->zostalo = 0;
+  a->rozmiarBloku = PIERWSZY_BLOK;
+  a->bloki = NULL;
+  memset(a->listyWolnych, 0, sizeof(a->listyWolnych));
+  a->duze = NULL;
+  a->zajete = 0;
+}
+
+void arena_done(struct arena * a)
+{
+  struct arena_blok * blok = a->bloki;
+  while (blok != NULL)
+  {
+    struct arena_blok * nastepny = blok->nastepny;
+    free(blok);
+    blok = nastepny;
+  }
+  struct arena_duzy * duzy = a->duze;
+  while (duzy != NULL)
+  {
+    struct arena_duzy * nastepny = duzy->nastepny;
+    free(duzy);
+    duzy = nastepny;
+  }
+  arena_init(a);
+}
+
+void * arena_alloc(struct arena * a, size_t rozmiar)
+{
+  rozmiar = zaokraglij(rozmiar);
+  if (rozmiar > ARENA_MAX_KAWALEK)
+  {
+    struct arena_duzy * duzy = malloc(sizeof(struct arena_duzy) + rozmiar);
+    duzy->poprzedni = NULL;
+    duzy->nastepny = a->duze;
+    if (a->duze != NULL)
+      a->duze->poprzedni = duzy;
+    a->duze = duzy;
+    a->zajete += rozmiar;
+    return duzy + 1;
+  }
+
+  void ** lista = &a->listyWolnych[rozmiar / ARENA_ZIARNO];
+  if (*lista != NULL)
+  {
+    void * p = *lista;
+    *lista = *(void **) p;
+    return p;
+  }
+
+  if (a->zostalo < rozmiar)
+  {
+    /* Resztkę bieżącego bloku oddajemy na listę wolnych kawałków. */
+    if (a->zostalo >= ARENA_ZIARNO)
+      arena_free(a, a->wolne, a->zostalo);
+    struct arena_blok * blok = malloc(sizeof(struct arena_blok) + a->rozmiarBloku);
+    blok->nastepny = a->bloki;
+    a->bloki = blok;
+    a->wolne = (char *) (blok + 1);
+    a->zostalo = a->rozmiarBloku;
+    a->zajete += a->rozmiarBloku;
+    if (a->rozmiarBloku < MAX_BLOK)
+      a->rozmiarBloku *= 2;
+  }
+  void * p = a->wolne;
+  a->wolne += rozmiar;
+  a->zostalo -= rozmiar;
+  return p;
+}
+
+void arena_free(struct arena * a, void * p, size_t rozmiar)
+{
+  if (p == NULL)
+    return;
+  rozmiar = zaokraglij(rozmiar);
+  if (rozmiar > ARENA_MAX_KAWALEK)
+  {
+    struct arena_duzy * duzy = (struct arena_duzy *) p - 1;
+    if (duzy->poprzedni != NULL)
+      duzy->poprzedni->nastepny = duzy->nastepny;
+    else
+      a->duze = duzy->nastepny;
+    if (duzy->nastepny != NULL)
+      duzy->nastepny->poprzedni = duzy->poprzedni;
+    a->zajete -= rozmiar;
+    free(duzy);
+    return;
+  }
+  void ** lista = &a->listyWolnych[rozmiar / ARENA_ZIARNO];
+  *(void **) p = *lista;
+  *lista = p;
+}
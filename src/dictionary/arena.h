@@ -0,0 +1,83 @@
+/** @file
+    Interfejs puli pamięci (areny) dla wierzchołków drzewa TRIE.
+
+    Pamięć przydzielana jest z dużych bloków (slabów). Zwolnione kawałki
+    trafiają na listy wolnych kawałków według rozmiaru i są ponownie
+    wykorzystywane. Cała pula zwalniana jest naraz przez arena_done().
+
+    @ingroup dictionary
+ */
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+/** Ziarnistość przydziału w bajtach. */
+#define ARENA_ZIARNO 8
+
+/** Największy kawałek obsługiwany przez listy wolnych kawałków. Większe
+    przydziały realizowane są bezpośrednio przez malloc(). */
+#define ARENA_MAX_KAWALEK 4096
+
+/** Liczba klas rozmiarów. */
+#define ARENA_KLASY (ARENA_MAX_KAWALEK / ARENA_ZIARNO + 1)
+
+/** Nagłówek bloku pamięci areny. */
+struct arena_blok;
+
+/** Nagłówek dużego przydziału. */
+struct arena_duzy;
+
+/**
+  Pula pamięci.
+  */
+struct arena
+{
+  /** Początek wolnego miejsca w bieżącym bloku. */
+  char * wolne;
+
+  /** Liczba wolnych bajtów w bieżącym bloku. */
+  size_t zostalo;
+
+  /** Rozmiar następnego przydzielanego bloku. */
+  size_t rozmiarBloku;
+
+  /** Lista bloków. */
+  struct arena_blok * bloki;
+
+  /** Listy wolnych kawałków, indeksowane klasą rozmiaru. */
+  void * listyWolnych[ARENA_KLASY];
+
+  /** Lista dużych przydziałów. */
+  struct arena_duzy * duze;
+
+  /** Łączna liczba bajtów pobranych z systemu. */
+  size_t zajete;
+};
+
+/** Inicjalizacja puli.
+ * @param[out] a Pula.
+ */
+void arena_init(struct arena * a);
+
+/** Zwolnienie całej pamięci puli.
+ * @param[in,out] a Pula.
+ */
+void arena_done(struct arena * a);
+
+/** Przydział pamięci z puli.
+ * @param[in,out] a Pula.
+ * @param[in] rozmiar Rozmiar w bajtach (dodatni).
+ * @return Wskaźnik na przydzieloną pamięć.
+ */
+void * arena_alloc(struct arena * a, size_t rozmiar);
+
+/** Zwrot kawałka pamięci do puli.
+ * @param[in,out] a Pula.
+ * @param[in] p Zwalniany kawałek (może być NULL).
+ * @param[in] rozmiar Rozmiar, z jakim kawałek został przydzielony.
+ */
+void arena_free(struct arena * a, void * p, size_t rozmiar);
+
+#endif /* __ARENA_H__ */
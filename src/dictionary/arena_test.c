@@ -0,0 +1,75 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+#include "arena.h"
+
+static void arena_init_test(void** state) {
+    struct arena a;
+    arena_init(&a);
+    assert_int_equal(a.zajete, 0);
+    arena_done(&a);
+}
+
+static void arena_alloc_test(void** state) {
+    struct arena a;
+    arena_init(&a);
+    char * p = arena_alloc(&a, 10);
+    char * q = arena_alloc(&a, 10);
+    assert_non_null(p);
+    assert_non_null(q);
+    assert_true(p != q);
+    memset(p, 1, 10);
+    memset(q, 2, 10);
+    assert_int_equal(p[9], 1);
+    arena_done(&a);
+}
+
+static void arena_reuse_test(void** state) {
+    struct arena a;
+    arena_init(&a);
+    void * p = arena_alloc(&a, 24);
+    arena_free(&a, p, 24);
+    assert_ptr_equal(arena_alloc(&a, 24), p);
+    void * r = arena_alloc(&a, 40);
+    assert_true(r != p);
+    arena_done(&a);
+}
+
+static void arena_big_test(void** state) {
+    struct arena a;
+    arena_init(&a);
+    char * p = arena_alloc(&a, ARENA_MAX_KAWALEK * 3);
+    memset(p, 0, ARENA_MAX_KAWALEK * 3);
+    char * q = arena_alloc(&a, ARENA_MAX_KAWALEK * 2);
+    arena_free(&a, p, ARENA_MAX_KAWALEK * 3);
+    memset(q, 0, ARENA_MAX_KAWALEK * 2);
+    arena_done(&a);
+}
+
+static void arena_many_test(void** state) {
+    struct arena a;
+    arena_init(&a);
+    for (int i = 0; i < 100000; i++)
+    {
+        int * p = arena_alloc(&a, sizeof(int) * (1 + i % 7));
+        p[i % 7] = i;
+    }
+    assert_true(a.zajete >= 100000 * sizeof(int));
+    arena_done(&a);
+    assert_int_equal(a.zajete, 0);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(arena_init_test),
+        cmocka_unit_test(arena_alloc_test),
+        cmocka_unit_test(arena_reuse_test),
+        cmocka_unit_test(arena_big_test),
+        cmocka_unit_test(arena_many_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,109 @@
+/** @file
+  Implementacja blokowego filtru Blooma.
+
+  @ingroup dictionary
+ */
+
+#include "bloom.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Liczba bitów bloku. */
+#define BITY_BLOKU (64 * BLOOM_BLOK)
+
+/** Funkcja mieszająca bity skrótu (końcowy krok MurmurHash3).
+ * @param[in] h Skrót.
+ * @return Wymieszany skrót.
+ */
+static inline uint64_t wymieszaj(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+void bloom_init(struct bloom * filtr, size_t pojemnosc)
+{
+  size_t liczbaBlokow = (pojemnosc * BLOOM_BITY_NA_SLOWO + BITY_BLOKU - 1) / BITY_BLOKU;
+  if (liczbaBlokow == 0)
+    liczbaBlokow = 1;
+  void * bloki = NULL;
+  if (posix_memalign(&bloki, sizeof(filtr->bloki[0]), liczbaBlokow * sizeof(filtr->bloki[0])))
+    bloki = NULL;
+  if (bloki != NULL)
+    memset(bloki, 0, liczbaBlokow * sizeof(filtr->bloki[0]));
+  else
+    liczbaBlokow = 0;
+  filtr->bloki = bloki;
+  filtr->liczbaBlokow = liczbaBlokow;
+  filtr->pojemnosc = liczbaBlokow * BITY_BLOKU / BLOOM_BITY_NA_SLOWO;
+  filtr->liczbaSlow = 0;
+}
+
+void bloom_done(struct bloom * filtr)
+{
+  free(filtr->bloki);
+  filtr->bloki = NULL;
+  filtr->liczbaBlokow = 0;
+  filtr->pojemnosc = 0;
+  filtr->liczbaSlow = 0;
+}
+
+uint64_t bloom_skrot(const wchar_t * slowo, size_t dlugosc)
+{
+  /* Litery mieszane są parami, po jednym mnożeniu na dwie litery. */
+  uint64_t h = 0x9e3779b97f4a7c15ULL ^ dlugosc;
+  size_t i = 0;
+  for (; i + 2 <= dlugosc; i += 2)
+  {
+    h ^= (uint32_t) slowo[i] | (uint64_t) (uint32_t) slowo[i + 1] << 32;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 32;
+  }
+  if (i < dlugosc)
+  {
+    h ^= (uint32_t) slowo[i];
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 32;
+  }
+  return wymieszaj(h);
+}
+
+/** Funkcja zwracająca blok filtru wybrany przez skrót.
+ * @param[in] filtr Niepusty filtr.
+ * @param[in] h Skrót słowa.
+ * @return Blok.
+ */
+static inline uint64_t * blok(const struct bloom * filtr, uint64_t h)
+{
+  return filtr->bloki[((h >> 32) * filtr->liczbaBlokow) >> 32];
+}
+
+void bloom_dodaj(struct bloom * filtr, const wchar_t * slowo, size_t dlugosc)
+{
+  filtr->liczbaSlow++;
+  if (filtr->liczbaBlokow == 0)
+    return;
+  uint64_t h = bloom_skrot(slowo, dlugosc);
+  uint64_t * b = blok(filtr, h);
+  /* Kolejne bity wybierane są z 9-bitowych kawałków drugiego skrótu. */
+  uint64_t bity = h * 0x9e3779b97f4a7c15ULL;
+  for (int i = 0; i < BLOOM_BITY_SLOWA; i++, bity >>= 9)
+    b[(bity & (BITY_BLOKU - 1)) / 64] |= (uint64_t) 1 << (bity % 64);
+}
+
+bool bloom_moze_byc(const struct bloom * filtr, const wchar_t * slowo, size_t dlugosc)
+{
+  if (filtr->liczbaBlokow == 0)
+    return true;
+  uint64_t h = bloom_skrot(slowo, dlugosc);
+  const uint64_t * b = blok(filtr, h);
+  uint64_t bity = h * 0x9e3779b97f4a7c15ULL;
+  for (int i = 0; i < BLOOM_BITY_SLOWA; i++, bity >>= 9)
+    if (!(b[(bity & (BITY_BLOKU - 1)) / 64] & ((uint64_t) 1 << (bity % 64))))
+      return false;
+  return true;
+}
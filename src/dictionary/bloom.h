@@ -0,0 +1,99 @@
+/** @file
+    Interfejs filtru Blooma odrzucającego słowa spoza słownika.
+
+    Filtr jest blokowy: wszystkie bity jednego słowa leżą w jednym bloku
+    wielkości linii pamięci podręcznej, więc sprawdzenie słowa, którego na
+    pewno nie ma, kosztuje jedno odwołanie do pamięci zamiast przejścia po
+    drzewie. Filtr może się mylić tylko w jedną stronę: przepuszcza część
+    słów spoza słownika, ale nigdy nie odrzuca słowa ze słownika.
+
+    @ingroup dictionary
+ */
+
+#ifndef __BLOOM_H__
+#define __BLOOM_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <wchar.h>
+
+/** Liczba bitów filtru przypadająca na jedno słowo. */
+#define BLOOM_BITY_NA_SLOWO 10
+
+/** Liczba bitów ustawianych przez jedno słowo. */
+#define BLOOM_BITY_SLOWA 7
+
+/** Rozmiar bloku filtru w słowach 64-bitowych (64 bajty). */
+#define BLOOM_BLOK 8
+
+/**
+  Filtr Blooma.
+  */
+struct bloom
+{
+  /** Bloki filtru. */
+  uint64_t (* bloki)[BLOOM_BLOK];
+
+  /** Liczba bloków. */
+  size_t liczbaBlokow;
+
+  /** Liczba słów, dla której filtr zachowuje zakładany odsetek pomyłek. */
+  size_t pojemnosc;
+
+  /** Liczba słów dodanych do filtru. */
+  size_t liczbaSlow;
+};
+
+/** Inicjalizacja pustego filtru.
+ * @param[out] filtr Filtr.
+ * @param[in] pojemnosc Przewidywana liczba słów.
+ */
+void bloom_init(struct bloom * filtr, size_t pojemnosc);
+
+/** Zwolnienie pamięci filtru.
+ * @param[in,out] filtr Filtr.
+ */
+void bloom_done(struct bloom * filtr);
+
+/** Oblicza skrót słowa, z którego filtr wybiera blok i bity.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @return Skrót.
+ */
+uint64_t bloom_skrot(const wchar_t * slowo, size_t dlugosc);
+
+/** Dodanie słowa do filtru.
+ * @param[in,out] filtr Filtr.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ */
+void bloom_dodaj(struct bloom * filtr, const wchar_t * slowo, size_t dlugosc);
+
+/** Sprawdzenie, czy słowo może być w filtrze.
+ * @param[in] filtr Filtr.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @return False jeśli słowa na pewno nie dodano do filtru, true wpp.
+ */
+bool bloom_moze_byc(const struct bloom * filtr, const wchar_t * slowo, size_t dlugosc);
+
+/** Czy filtr jest przepełniony i należy go zbudować od nowa, większy.
+ * @param[in] filtr Filtr.
+ * @return True jeśli dodano więcej słów niż wynosi pojemność filtru.
+ */
+static inline bool bloom_pelny(const struct bloom * filtr)
+{
+  return filtr->liczbaSlow > filtr->pojemnosc;
+}
+
+/** Rozmiar pamięci zajmowanej przez filtr.
+ * @param[in] filtr Filtr.
+ * @return Rozmiar w bajtach.
+ */
+static inline size_t bloom_rozmiar(const struct bloom * filtr)
+{
+  return filtr->liczbaBlokow * sizeof(filtr->bloki[0]);
+}
+
+#endif /* __BLOOM_H__ */
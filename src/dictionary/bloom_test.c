@@ -0,0 +1,75 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include "bloom.h"
+
+static void bloom_words(wchar_t (*words)[8], int ile, int od) {
+    for (int i = 0; i < ile; i++)
+        swprintf(words[i], 8, L"w%d", od + i);
+}
+
+static void bloom_empty_test(void** state) {
+    struct bloom f;
+    bloom_init(&f, 0);
+    assert_true(f.liczbaBlokow > 0);
+    assert_false(bloom_moze_byc(&f, L"kot", 3));
+    assert_false(bloom_pelny(&f));
+    bloom_done(&f);
+}
+
+static void bloom_no_false_negatives_test(void** state) {
+    enum { ILE = 5000 };
+    static wchar_t words[ILE][8];
+    bloom_words(words, ILE, 0);
+    struct bloom f;
+    bloom_init(&f, ILE);
+    for (int i = 0; i < ILE; i++)
+        bloom_dodaj(&f, words[i], wcslen(words[i]));
+    assert_false(bloom_pelny(&f));
+    for (int i = 0; i < ILE; i++)
+        assert_true(bloom_moze_byc(&f, words[i], wcslen(words[i])));
+    /* "w1" i "w10" różnią się długością, a prefiks nie jest słowem */
+    assert_false(bloom_moze_byc(&f, L"w", 1));
+    bloom_done(&f);
+}
+
+static void bloom_false_positive_rate_test(void** state) {
+    enum { ILE = 20000 };
+    static wchar_t words[ILE][8];
+    static wchar_t others[ILE][8];
+    bloom_words(words, ILE, 0);
+    bloom_words(others, ILE, ILE);
+    struct bloom f;
+    bloom_init(&f, ILE);
+    for (int i = 0; i < ILE; i++)
+        bloom_dodaj(&f, words[i], wcslen(words[i]));
+    int przepuszczone = 0;
+    for (int i = 0; i < ILE; i++)
+        przepuszczone += bloom_moze_byc(&f, others[i], wcslen(others[i]));
+    /* przy 10 bitach na słowo filtr myli się w około 1% przypadków */
+    assert_true(przepuszczone < ILE / 40);
+    bloom_done(&f);
+}
+
+static void bloom_full_test(void** state) {
+    struct bloom f;
+    bloom_init(&f, 10);
+    size_t pojemnosc = f.pojemnosc;
+    for (size_t i = 0; i <= pojemnosc; i++)
+        bloom_dodaj(&f, L"x", 1);
+    assert_true(bloom_pelny(&f));
+    bloom_done(&f);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(bloom_empty_test),
+        cmocka_unit_test(bloom_no_false_negatives_test),
+        cmocka_unit_test(bloom_false_positive_rate_test),
+        cmocka_unit_test(bloom_full_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -10,9 +10,22 @@
 
 #include "dictionary.h"
 #include "trie.h"
+#include "double_array.h"
+#include "bloom.h"
+#include "levenshtein.h"
+#include "podpowiedzi.h"
+#include "usuniecia.h"
+#include "podreczna.h"
+#include "watki.h"
 #include "conf.h"
 #include <assert.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
 #include <argz.h>
 #include <ctype.h>
 
@@ -21,20 +34,76 @@
 /** Pomocnicza zmienna do rozpoznawania "pustych" słów. */
 static wchar_t * puste = L"";
 
-/** Struktura przechowujaca tablicę reguł o ustalonym koszcie. */
-struct regula 
-{ 
-  /** Lewa strona reguły. */
-  const wchar_t * lewaStrona;
+/** Znacznik na początku binarnego pliku słownika. */
+static const char magiaPliku[8] = { 'S', 'L', 'O', 'W', 'N', 'I', 'K', '\0' };
 
-  /** Prawa strona reguły. */
-  const wchar_t * prawaStrona;
+/** Wersja formatu binarnego pliku słownika. */
+#define WERSJA_PLIKU 2
 
-  /** Reprezentuje flagę przypisaną regule. */
-  enum rule_flag flaga;
+/** Największa liczba wątków wyszukiwania podpowiedzi. */
+#define MAKS_WATKOW 64
 
-  /** Koszt podpowiedzi. */
-  int koszt;
+/** Wartość, po której rozpoznawany jest plik zapisany przy innej kolejności
+    bajtów. */
+#define KOLEJNOSC_BAJTOW 0x01020304
+
+/**
+  Nagłówek binarnego pliku słownika. Za nagłówkiem leżą kolejno: alfabet,
+  reguły, indeks podpowiedzi (usuniecia_zapisz(), jeśli jest włączony)
+  i podwójna tablica (double_array_zapisz()), każda część wyrównana
+  do 8 bajtów. Plik mapowany jest do pamięci i używany w miejscu.
+  */
+struct naglowek_pliku
+{
+  /** Znacznik magiaPliku. */
+  char magia[8];
+
+  /** Wersja formatu (WERSJA_PLIKU). */
+  uint32_t wersja;
+
+  /** KOLEJNOSC_BAJTOW w kolejności bajtów zapisującego. */
+  uint32_t kolejnoscBajtow;
+
+  /** Rozmiar wchar_t zapisującego. */
+  uint32_t rozmiarLitery;
+
+  /** Maksymalny koszt podpowiedzi. */
+  int32_t maksymalnyKoszt;
+
+  /** Liczba liter alfabetu. */
+  uint32_t liczbaLiter;
+
+  /** Liczba reguł. */
+  uint32_t liczbaRegul;
+
+  /** Przesunięcie pierwszej reguły od początku pliku. */
+  uint64_t poczatekRegul;
+
+  /** Przesunięcie indeksu podpowiedzi od początku pliku; indeks zajmuje
+      miejsce do początku podwójnej tablicy, w pliku bez indeksu puste. */
+  uint64_t poczatekIndeksu;
+
+  /** Przesunięcie podwójnej tablicy od początku pliku. */
+  uint64_t poczatekTablicy;
+};
+
+/**
+  Reguła w binarnym pliku słownika. Za strukturą leżą obie strony reguły,
+  zakończone znakiem '\0', wyrównane razem do 8 bajtów.
+  */
+struct regula_pliku
+{
+  /** Długość lewej strony. */
+  uint32_t dlugoscLewej;
+
+  /** Długość prawej strony. */
+  uint32_t dlugoscPrawej;
+
+  /** Koszt reguły. */
+  int32_t koszt;
+
+  /** Flaga reguły. */
+  int32_t flaga;
 };
 
 /** Strutktura przechowująca tablicę reguł danego kosztu. */
@@ -50,6 +119,60 @@ struct tablica_regul
   struct regula ** zbiorRegulKosztu;
 };
 
+/**
+  Podpowiedź wraz z kosztem. Pamięć podpowiedzi używana jest ponownie
+  w kolejnych wyszukiwaniach.
+  */
+struct podpowiedz
+{
+  /** Słowo; w tym samym bloku pamięci, za słowem, leży klucz. */
+  wchar_t * slowo;
+
+  /** Klucz porządku słownikowego (wcsxfrm()). */
+  wchar_t * klucz;
+
+  /** Liczba liter, na które jest miejsce w bloku słowa. */
+  size_t rozmiar;
+
+  /** Koszt (dla podpowiedzi bez reguł odległość edycyjna). */
+  int koszt;
+};
+
+/**
+  Zebrane podpowiedzi. Jeśli ich liczba jest ograniczona, tablica jest
+  kopcem, na którego szczycie leży najgorsza z najlepszych dotychczas
+  podpowiedzi (najdroższa, a przy równym koszcie ostatnia w kolejności
+  słownikowej). Bez ograniczenia słowa trafiają od razu do listy.
+  */
+struct podpowiedzi
+{
+  /** Podpowiedzi; miejsca od liczba do rozmiar - 1 są wolne, ale mogą
+      mieć pamięć z poprzednich wyszukiwań. */
+  struct podpowiedz * tablica;
+
+  /** Liczba podpowiedzi. */
+  int liczba;
+
+  /** Rozmiar tablicy. */
+  int rozmiar;
+
+  /** Największa liczba podpowiedzi (niedodatnia oznacza wszystkie). */
+  int limit;
+
+  /** Klucz porządku słownikowego sprawdzanego słowa. */
+  wchar_t * klucz;
+
+  /** Liczba liter, na które jest miejsce w kluczu. */
+  size_t rozmiarKlucza;
+
+  /** Lista, do której trafiają podpowiedzi bez ograniczenia liczby. */
+  struct word_list * lista;
+
+  /** Największy koszt potrzebnych podpowiedzi, wspólny dla wątków
+      równoległego wyszukiwania. */
+  int * granica;
+};
+
 /**
   Struktura przechowująca słownik.
   Implementacja z użyciem drzewa TRIE.
@@ -71,11 +194,107 @@ struct dictionary
   /** Maksymalny koszt podpowiedzi. */
   int maksymalnyKoszt;
 
-  /** Lista reguł do podpowiedzi */
+  /** Lista reguł do podpowiedzi, reguły o koszcie k są w tablicaRegul[k]. */
   struct tablica_regul ** tablicaRegul;
 
+  /** Liczba miejsc w tablicy reguł (największy koszt reguły + 1). */
+  int liczbaKosztow;
+
   /** Ogolna liczba reguł w słowniku. */
   int ogolnaLiczbaRegul;
+
+  /** Indeks reguł, budowany przy pierwszym szukaniu podpowiedzi po zmianie
+      reguł, NULL jeśli jeszcze go nie zbudowano. */
+  struct reguly * indeksRegul;
+
+  /** Podwójna tablica zamrożonego słownika, NULL jeśli słownik nie jest zamrożony. */
+  struct double_array * zamrozony;
+
+  /** Zmapowany plik binarny słownika, NULL jeśli słownik nie był z niego
+      wczytany. Zamrożona tablica może wskazywać do jego wnętrza. */
+  void * mapa;
+
+  /** Rozmiar zmapowanego pliku. */
+  size_t rozmiarMapy;
+
+  /** Filtr odrzucający słowa spoza słownika, NULL jeśli jest wyłączony. */
+  struct bloom * filtr;
+
+  /** Indeks podpowiedzi odległych o kilka edycji, NULL jeśli jest
+      wyłączony. */
+  struct usuniecia * indeksUsuniec;
+
+  /** Pamięć podręczna podpowiedzi, NULL jeśli jest wyłączona. */
+  struct podreczna * podreczna;
+
+  /** Pamięć dictionary_hints() na najlepsze podpowiedzi, zachowywana
+      między wywołaniami. */
+  struct podpowiedzi robocze;
+
+  /** Pula wątków wyszukiwania podpowiedzi, NULL jeśli podpowiedzi szukane
+      są w jednym wątku. */
+  struct watki * watki;
+
+  /** Pamięć podpowiedzi każdego wątku puli. */
+  struct podpowiedzi * roboczeWatkow;
+
+  /** Liczba zapytań dictionary_find(). */
+  unsigned long long zapytania;
+
+  /** Liczba zapytań o słowa spoza słownika. */
+  unsigned long long nieznalezione;
+
+  /** Liczba zapytań odrzuconych przez filtr. */
+  unsigned long long odrzucone;
+
+  /** Liczba zapytań o słowa spoza słownika przepuszczonych przez filtr. */
+  unsigned long long przepuszczone;
+
+  /** Liczba podpowiedzi wziętych z pamięci podręcznej. */
+  unsigned long long trafienia;
+
+  /** Liczba podpowiedzi wyszukanych przy włączonej pamięci podręcznej. */
+  unsigned long long chybienia;
+};
+
+/** Liczba liter z podstawowej płaszczyzny Unicode, zaznaczanych przy
+    budowie w mapie bitowej. */
+#define LITERY_MAPY 0x10000
+
+/**
+  Budowa słownika z posortowanych słów.
+ */
+struct dictionary_builder
+{
+  /** Budowa drzewa. */
+  struct trie_budowa budowa;
+
+  /** Mapa bitowa użytych liter o kodach mniejszych niż LITERY_MAPY. */
+  uint64_t litery[LITERY_MAPY / 64];
+
+  /** Pozostałe użyte litery, posortowane. */
+  wchar_t * inne;
+
+  /** Liczba pozostałych liter. */
+  int liczbaInnych;
+
+  /** Rozmiar tablicy pozostałych liter. */
+  int rozmiarInnych;
+};
+
+/**
+  Czytelnik słownika.
+  */
+struct dictionary_reader
+{
+  /** Słownik. */
+  const struct dictionary * slownik;
+
+  /** Pamięć podpowiedzi czytelnika. */
+  struct podpowiedzi robocze;
+
+  /** Pamięć podręczna podpowiedzi czytelnika albo NULL. */
+  struct podreczna * podreczna;
 };
 
 /** @name Funkcje pomocnicze
@@ -179,13 +398,173 @@ static char ** poprawTablice2(char ** tablica, int * rozmiar, char * doWlozenia,
   return nowaTablica;
 }
 
+/**
+  Zwolnienie pamięci podpowiedzi.
+  @param[in,out] p podpowiedzi
+ */
+static void zwolnijPodpowiedzi(struct podpowiedzi * p)
+{
+  for (int i = 0; i < p->rozmiar; i++)
+    free(p->tablica[i].slowo);
+  free(p->tablica);
+  free(p->klucz);
+}
+
+/**
+  Zatrzymanie wątków wyszukiwania podpowiedzi i zwolnienie ich pamięci.
+  @param[in,out] dict słownik
+ */
+static void zatrzymajWatki(struct dictionary *dict)
+{
+  if (dict->watki == NULL)
+    return;
+  for (int i = 0; i < dict->watki->liczba; i++)
+    zwolnijPodpowiedzi(&dict->roboczeWatkow[i]);
+  free(dict->roboczeWatkow);
+  dict->roboczeWatkow = NULL;
+  watki_done(dict->watki);
+  dict->watki = NULL;
+}
+
 /**
   Czyszczenie pamięci słownika
   @param[in,out] dict słownik
  */
 static void dictionary_free(struct dictionary *dict)
 {
+ dictionary_rule_clear(dict);
+ free(dict->tablicaRegul);
  clean(dict->drzewko);
+ double_array_done(dict->zamrozony);
+ if (dict->mapa != NULL)
+   munmap(dict->mapa, dict->rozmiarMapy);
+ if (dict->filtr != NULL)
+   bloom_done(dict->filtr);
+ free(dict->filtr);
+ usuniecia_done(dict->indeksUsuniec);
+ podreczna_done(dict->podreczna);
+ zwolnijPodpowiedzi(&dict->robocze);
+ zatrzymajWatki(dict);
+}
+
+/**
+  Czyszczenie pamięci podręcznej podpowiedzi po zmianie słownika.
+  @param[in,out] dict słownik
+ */
+static void uniewaznijPodpowiedzi(struct dictionary *dict)
+{
+  if (dict->podreczna != NULL)
+    podreczna_wyczysc(dict->podreczna);
+}
+
+/** Funkcja wywołująca daną funkcję dla każdego słowa słownika.
+ * @param[in] dict Słownik.
+ * @param[in] funkcja Funkcja wywoływana ze słowem, jego długością
+ * i wskaźnikiem dane.
+ * @param[in] dane Dodatkowy argument funkcji.
+ */
+static void dlaKazdegoSlowa(const struct dictionary *dict,
+  void (*funkcja)(const wchar_t * slowo, int dlugosc, void * dane), void * dane)
+{
+  if (dict->zamrozony != NULL)
+  {
+    double_array_slowa(dict->zamrozony, funkcja, dane);
+    return;
+  }
+  struct trie_kursor kursor;
+  trie_kursor_init(&kursor);
+  trie_kursor_ustaw(&kursor, dict->drzewko);
+  while (trie_kursor_nastepny(&kursor, true))
+    if (trie_kursor_wezel(&kursor)->czySlowo)
+      funkcja(trie_kursor_slowo(&kursor), trie_kursor_dlugosc(&kursor), dane);
+  trie_kursor_done(&kursor);
+}
+
+/** Funkcja zliczająca słowa, wywoływana przez dlaKazdegoSlowa().
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in,out] dane Wskaźnik na licznik słów.
+ */
+static void policzSlowo(const wchar_t * slowo, int dlugosc, void * dane)
+{
+  (*(size_t *) dane)++;
+}
+
+/** Funkcja dodająca słowo do filtru, wywoływana przez dlaKazdegoSlowa().
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in,out] dane Wskaźnik na filtr.
+ */
+static void dodajDoFiltru(const wchar_t * slowo, int dlugosc, void * dane)
+{
+  bloom_dodaj(dane, slowo, dlugosc);
+}
+
+/**
+  Buduje od nowa filtr słownika ze wszystkich jego słów, z zapasem na
+  ćwierć tylu nowych słów. Usunięte słowa znikają z filtru dopiero przy
+  takiej przebudowie.
+  @param[in,out] dict Słownik z włączonym filtrem.
+ */
+static void zbudujFiltr(struct dictionary *dict)
+{
+  size_t liczbaSlow = 0;
+  dlaKazdegoSlowa(dict, policzSlowo, &liczbaSlow);
+  bloom_done(dict->filtr);
+  bloom_init(dict->filtr, liczbaSlow + liczbaSlow / 4 + 64);
+  dlaKazdegoSlowa(dict, dodajDoFiltru, dict->filtr);
+}
+
+/**
+  Sprawdza, czy słowo jest w słowniku, bez zliczania zapytania.
+  @param[in] dict Słownik.
+  @param[in] word Szukane słowo.
+  @param[in] dlugosc Długość słowa.
+  @return Czy słowo jest w słowniku.
+ */
+static bool znajdz(const struct dictionary *dict, const wchar_t *word, int dlugosc)
+{
+  if (dict->zamrozony != NULL)
+    return double_array_find(dict->zamrozony, word, dlugosc);
+  return finder(word, dlugosc, 0, dict->drzewko);
+}
+
+/** Funkcja wstawiająca słowo do drzewa, wywoływana dla kolejnych słów
+ * zamrożonego słownika.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in,out] dane Wskaźnik na budowane drzewo.
+ */
+static void wstawDoDrzewa(const wchar_t * slowo, int dlugosc, void * dane)
+{
+  struct trie ** drzewko = dane;
+  *drzewko = insert(slowo, dlugosc, *drzewko, 1);
+}
+
+/** Funkcja odtwarzająca drzewo TRIE zamrożonego słownika.
+ * @param[in] dict Zamrożony słownik.
+ * @return Drzewo ze wszystkimi słowami słownika.
+ */
+static struct trie * odtworzDrzewo(const struct dictionary *dict)
+{
+  struct trie * drzewko = NULL;
+  double_array_slowa(dict->zamrozony, wstawDoDrzewa, &drzewko);
+  return drzewko;
+}
+
+/**
+  Odmrażanie słownika przed modyfikacją.
+  Zamrożony słownik nie trzyma drzewa TRIE, więc drzewo jest odtwarzane
+  z automatu, a podwójna tablica porzucana.
+  @param[in,out] dict słownik
+ */
+static void odmroz(struct dictionary *dict)
+{
+  if (dict->zamrozony == NULL)
+    return;
+  dict->drzewko = odtworzDrzewo(dict);
+  double_array_done(dict->zamrozony);
+  dict->zamrozony = NULL;
 }
 
 struct dictionary * dictionary_new()
@@ -197,7 +576,19 @@ struct dictionary * dictionary_new()
   dict->rozmiarAlfabetu = 0;
   dict->maksymalnyKoszt = 0;
   dict->tablicaRegul = NULL;
+  dict->liczbaKosztow = 0;
   dict->ogolnaLiczbaRegul = 0;
+  dict->indeksRegul = NULL;
+  dict->zamrozony = NULL;
+  dict->mapa = NULL;
+  dict->rozmiarMapy = 0;
+  dict->filtr = NULL;
+  dict->indeksUsuniec = NULL;
+  dict->podreczna = NULL;
+  dict->robocze = (struct podpowiedzi) { NULL, 0, 0, DICTIONARY_MAX_HINTS, NULL, 0, NULL, NULL };
+  dict->watki = NULL;
+  dict->roboczeWatkow = NULL;
+  dictionary_reset_stats(dict);
   return dict;
 }
 
@@ -210,9 +601,11 @@ void dictionary_done(struct dictionary *dict)
 
 int dictionary_insert(struct dictionary *dict, const wchar_t *word)
 {
-    if (dictionary_find(dict, word))
-      return 0;
     int dlugosc = wcslen(word);
+    if ((dict->filtr == NULL || bloom_moze_byc(dict->filtr, word, dlugosc)) &&
+      znajdz(dict, word, dlugosc))
+      return 0;
+    odmroz(dict);
 
     for (int i = 0; i < dlugosc; i++)
     {
@@ -233,22 +626,243 @@ int dictionary_insert(struct dictionary *dict, const wchar_t *word)
     }
 
     dict->drzewko = insert(word, dlugosc, dict->drzewko, 1);
+    if (dict->filtr != NULL)
+    {
+      bloom_dodaj(dict->filtr, word, dlugosc);
+      if (bloom_pelny(dict->filtr))
+        zbudujFiltr(dict);
+    }
+    if (dict->indeksUsuniec != NULL)
+      usuniecia_dodaj(dict->indeksUsuniec, word, dlugosc);
+    uniewaznijPodpowiedzi(dict);
     return 1;
 }
 
 int dictionary_delete(struct dictionary *dict, const wchar_t *word)
 {
-    if (dictionary_find(dict, word))
+    if (znajdz(dict, word, wcslen(word)))
     {
+      odmroz(dict);
       dict->drzewko = delete(word, wcslen(word), 0, dict->drzewko);
+      if (dict->indeksUsuniec != NULL)
+        usuniecia_usun(dict->indeksUsuniec, word, wcslen(word));
+      uniewaznijPodpowiedzi(dict);
       return 1;
     }
     return 0;
 }
 
+struct dictionary_builder * dictionary_builder_new(void)
+{
+  struct dictionary_builder *builder = malloc(sizeof(struct dictionary_builder));
+  trie_budowa_init(&builder->budowa);
+  memset(builder->litery, 0, sizeof(builder->litery));
+  builder->inne = NULL;
+  builder->liczbaInnych = 0;
+  builder->rozmiarInnych = 0;
+  return builder;
+}
+
+int dictionary_builder_add(struct dictionary_builder *builder, const wchar_t *word)
+{
+  int dlugosc = wcslen(word);
+  int wynik = trie_budowa_dodaj(&builder->budowa, word, dlugosc);
+  if (wynik <= 0)
+    return wynik;
+  for (int i = 0; i < dlugosc; i++)
+  {
+    unsigned litera = word[i];
+    if (litera < LITERY_MAPY)
+      builder->litery[litera / 64] |= (uint64_t) 1 << (litera % 64);
+    else if (!czyJest(builder->liczbaInnych, builder->inne, word[i]))
+    {
+      if (builder->inne == NULL)
+        builder->inne = malloc(sizeof(wchar_t));
+      builder->inne = poprawAlfabet(&builder->rozmiarInnych,
+        &builder->liczbaInnych, builder->inne, word[i]);
+    }
+  }
+  return 1;
+}
+
+struct dictionary * dictionary_builder_finish(struct dictionary_builder *builder)
+{
+  struct dictionary *dict = dictionary_new();
+  dict->drzewko = trie_budowa_koniec(&builder->budowa);
+  /* Alfabet powstaje raz, z mapy bitowej, już posortowany. */
+  int liczbaLiter = builder->liczbaInnych;
+  for (int i = 0; i < LITERY_MAPY / 64; i++)
+    liczbaLiter += __builtin_popcountll(builder->litery[i]);
+  if (liczbaLiter > 0)
+  {
+    dict->alfabet = malloc(sizeof(wchar_t) * (liczbaLiter + 1));
+    int ile = 0;
+    for (int i = 0; i < LITERY_MAPY / 64; i++)
+      for (uint64_t slowo = builder->litery[i]; slowo != 0; slowo &= slowo - 1)
+        dict->alfabet[ile++] = 64 * i + __builtin_ctzll(slowo);
+    wmemcpy(dict->alfabet + ile, builder->inne, builder->liczbaInnych);
+    dict->alfabet[liczbaLiter] = L'\0';
+    dict->liczbaLiter = dict->rozmiarAlfabetu = liczbaLiter;
+  }
+  free(builder->inne);
+  free(builder);
+  return dict;
+}
+
+struct dictionary * dictionary_build_sorted(const wchar_t **words, size_t n)
+{
+  struct dictionary_builder *builder = dictionary_builder_new();
+  for (size_t i = 0; i < n; i++)
+  {
+    if (dictionary_builder_add(builder, words[i]) < 0)
+    {
+      dictionary_done(dictionary_builder_finish(builder));
+      return NULL;
+    }
+  }
+  return dictionary_builder_finish(builder);
+}
+
 bool dictionary_find(const struct dictionary *dict, const wchar_t* word)
 {
-  return finder(word, wcslen(word), 0, dict->drzewko);
+  /* Liczniki nie są częścią zawartości słownika. */
+  struct dictionary *liczniki = (struct dictionary *) dict;
+  int dlugosc = wcslen(word);
+  liczniki->zapytania++;
+  /* Zamrożony słownik rozstrzyga brak słowa szybciej, niż trwa odwołanie
+     do filtru, więc filtr chroni tylko przed przechodzeniem drzewa. */
+  bool zFiltrem = dict->filtr != NULL && dict->zamrozony == NULL;
+  if (zFiltrem && !bloom_moze_byc(dict->filtr, word, dlugosc))
+  {
+    liczniki->nieznalezione++;
+    liczniki->odrzucone++;
+    return false;
+  }
+  bool wynik = znajdz(dict, word, dlugosc);
+  if (!wynik)
+  {
+    liczniki->nieznalezione++;
+    if (zFiltrem)
+      liczniki->przepuszczone++;
+  }
+  return wynik;
+}
+
+bool dictionary_filter(struct dictionary *dict, bool enable)
+{
+  bool bylWlaczony = dict->filtr != NULL;
+  if (enable && !bylWlaczony)
+  {
+    dict->filtr = malloc(sizeof(struct bloom));
+    bloom_init(dict->filtr, 0);
+    zbudujFiltr(dict);
+  }
+  else if (!enable && bylWlaczony)
+  {
+    bloom_done(dict->filtr);
+    free(dict->filtr);
+    dict->filtr = NULL;
+  }
+  return bylWlaczony;
+}
+
+/** Funkcja dodająca słowo do indeksu podpowiedzi.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in,out] dane Indeks (struct usuniecia).
+ */
+static void dodajDoIndeksu(const wchar_t * slowo, int dlugosc, void * dane)
+{
+  usuniecia_dodaj(dane, slowo, dlugosc);
+}
+
+int dictionary_hint_index(struct dictionary *dict, int distance)
+{
+  if (distance < 0 || distance > LEVENSHTEIN_MAKS_ODLEGLOSC)
+    return -1;
+  int byla = dict->indeksUsuniec != NULL ? dict->indeksUsuniec->odleglosc : 0;
+  if (distance == byla)
+    return byla;
+  usuniecia_done(dict->indeksUsuniec);
+  dict->indeksUsuniec = NULL;
+  if (distance > 0)
+  {
+    dict->indeksUsuniec = usuniecia_nowe(distance);
+    dlaKazdegoSlowa(dict, dodajDoIndeksu, dict->indeksUsuniec);
+  }
+  return byla;
+}
+
+int dictionary_hint_cache(struct dictionary *dict, int capacity)
+{
+  if (capacity < 0)
+    return -1;
+  int byla = dict->podreczna != NULL ? dict->podreczna->pojemnosc : 0;
+  if (capacity == byla)
+    return byla;
+  podreczna_done(dict->podreczna);
+  dict->podreczna = capacity > 0 ? podreczna_nowa(capacity) : NULL;
+  return byla;
+}
+
+int dictionary_hint_threads(struct dictionary *dict, int threads)
+{
+  if (threads < 0 || threads > MAKS_WATKOW)
+    return -1;
+  int byla = dict->watki != NULL ? dict->watki->liczba : 1;
+  if (threads <= 1)
+    threads = 1;
+  if (threads == byla)
+    return byla;
+  zatrzymajWatki(dict);
+  if (threads > 1)
+  {
+    dict->watki = watki_nowe(threads);
+    if (dict->watki == NULL)
+      return -1;
+    dict->roboczeWatkow = malloc(sizeof(struct podpowiedzi) * threads);
+    for (int i = 0; i < threads; i++)
+      dict->roboczeWatkow[i] = (struct podpowiedzi)
+        { NULL, 0, 0, DICTIONARY_MAX_HINTS, NULL, 0, NULL, NULL };
+  }
+  return byla;
+}
+
+void dictionary_get_stats(const struct dictionary *dict, struct dictionary_stats *stats)
+{
+  stats->lookups = dict->zapytania;
+  stats->misses = dict->nieznalezione;
+  stats->filter_rejects = dict->odrzucone;
+  stats->filter_false_positives = dict->przepuszczone;
+  stats->filter_bytes = dict->filtr != NULL ? bloom_rozmiar(dict->filtr) : 0;
+  stats->filter_words = dict->filtr != NULL ? dict->filtr->liczbaSlow : 0;
+  stats->hint_index_bytes = dict->indeksUsuniec != NULL ?
+    usuniecia_rozmiar(dict->indeksUsuniec) : 0;
+  stats->hint_cache_hits = dict->trafienia;
+  stats->hint_cache_misses = dict->chybienia;
+  stats->hint_cache_entries = dict->podreczna != NULL ? dict->podreczna->liczba : 0;
+}
+
+void dictionary_reset_stats(struct dictionary *dict)
+{
+  dict->zapytania = 0;
+  dict->nieznalezione = 0;
+  dict->odrzucone = 0;
+  dict->przepuszczone = 0;
+  dict->trafienia = 0;
+  dict->chybienia = 0;
+}
+
+void dictionary_freeze(struct dictionary *dict)
+{
+  if (dict->zamrozony != NULL)
+    return;
+  dict->zamrozony = double_array_build(dict->drzewko);
+  /* Alfabetu za dużego na podwójną tablicę nie da się zamrozić. */
+  if (dict->zamrozony == NULL)
+    return;
+  clean(dict->drzewko);
+  dict->drzewko = NULL;
 }
 
 int dictionary_save(const struct dictionary *dict, FILE* stream)
@@ -257,7 +871,7 @@ int dictionary_save(const struct dictionary *dict, FILE* stream)
   struct tablica_regul ** tablicaRegul = dict->tablicaRegul;
   fwprintf(stream, L"%d\n", dict->maksymalnyKoszt);
   fwprintf(stream, L"%d\n", dict->ogolnaLiczbaRegul);
-  for (int i = 0; i < dict->maksymalnyKoszt; i++)
+  for (int i = 0; i < dict->liczbaKosztow; i++)
   {
     if (tablicaRegul[i] != NULL)
     {
@@ -271,71 +885,321 @@ int dictionary_save(const struct dictionary *dict, FILE* stream)
       }
     }
   }
-  zapis(dict->drzewko, stream, -1);  
+  if (dict->zamrozony != NULL)
+  {
+    struct trie * drzewko = odtworzDrzewo(dict);
+    zapis(drzewko, stream, -1);
+    clean(drzewko);
+  }
+  else
+    zapis(dict->drzewko, stream, -1);  
 
   return 0;
 }
 
+/** Wczytuje stronę reguły zapisaną jako ciąg znaków o znanej długości.
+ * @param[in,out] czytnik Czytnik strumienia.
+ * @param[in] dlugosc Liczba znaków.
+ * @return Wczytana strona reguły.
+ */
+static wchar_t * wczytajStrone(struct utf8_czytnik * czytnik, int dlugosc)
+{
+  if (dlugosc <= 0)
+    return puste;
+  wchar_t * strona = malloc(sizeof(wchar_t) * (dlugosc + 1));
+  for (int i = 0; i < dlugosc; i++)
+    strona[i] = utf8_wez(czytnik);
+  strona[dlugosc] = L'\0';
+  return strona;
+}
+
 struct dictionary * dictionary_load(FILE* stream)
 {
   struct dictionary * new = dictionary_new();
-  int liczbaRegul, pom = 0;
-
-  fwscanf(stream, L"%d", &liczbaRegul);
-  if (!pom)
-    pom = dictionary_hints_max_cost(new, liczbaRegul);
-  fwscanf(stream, L"%d", &liczbaRegul);    
-  wchar_t buff = NULL;
+  struct utf8_czytnik czytnik;
+  utf8_czytnik_init(&czytnik, stream);
+  int maksymalnyKoszt = 0, liczbaRegul = 0;
+  utf8_liczba(&czytnik, &maksymalnyKoszt);
+  dictionary_hints_max_cost(new, maksymalnyKoszt);
+  utf8_liczba(&czytnik, &liczbaRegul);
+  utf8_wez(&czytnik);
+  /* Każda reguła zajmuje wiersz "dl. lewej|lewa|dl. prawej|prawa|koszt|flaga",
+     a po ostatnim wierszu zaczyna się zapis drzewa. */
   for (int j = 0; j < liczbaRegul; j++)
   {
-  
-    fwscanf(stream, L"%d", &pom);
-    buff = fgetwc(stream);
-    wchar_t * lewaStrona;    
-    if (!pom)
-      lewaStrona = L"";
-    else
+    int dlugosc = 0, koszt = 0, flaga = 0;
+    utf8_liczba(&czytnik, &dlugosc);
+    utf8_wez(&czytnik);
+    wchar_t * lewaStrona = wczytajStrone(&czytnik, dlugosc);
+    utf8_wez(&czytnik);
+    dlugosc = 0;
+    utf8_liczba(&czytnik, &dlugosc);
+    utf8_wez(&czytnik);
+    wchar_t * prawaStrona = wczytajStrone(&czytnik, dlugosc);
+    utf8_wez(&czytnik);
+    utf8_liczba(&czytnik, &koszt);
+    utf8_wez(&czytnik);
+    utf8_liczba(&czytnik, &flaga);
+    utf8_wez(&czytnik);
+    dictionary_rule_add(new, lewaStrona, prawaStrona, 0, koszt, flaga);
+    if (lewaStrona != puste)
+      free(lewaStrona);
+    if (prawaStrona != puste)
+      free(prawaStrona);
+  }
+
+  new->drzewko = wczyt(&czytnik, &(new->rozmiarAlfabetu), &(new->liczbaLiter),
+    &(new->alfabet));
+  utf8_czytnik_done(&czytnik);
+  return new;
+}
+
+/** Funkcja zaokrąglająca rozmiar w górę do wielokrotności 8 bajtów.
+ * @param[in] rozmiar Rozmiar w bajtach.
+ * @return Zaokrąglony rozmiar.
+ */
+static size_t wyrownaj(size_t rozmiar)
+{
+  return (rozmiar + 7) & ~(size_t) 7;
+}
+
+/** Funkcja dopisująca zera, tak żeby zapisane dane zajęły wielokrotność
+ * 8 bajtów.
+ * @param[in] stream Strumień (binarny).
+ * @param[in] rozmiar Rozmiar zapisanych danych w bajtach.
+ * @return True jeśli zapis się powiódł, false wpp.
+ */
+static bool dopelnij(FILE * stream, size_t rozmiar)
+{
+  static const char zera[8];
+  size_t uzupelnienie = wyrownaj(rozmiar) - rozmiar;
+  return fwrite(zera, 1, uzupelnienie, stream) == uzupelnienie;
+}
+
+/** Funkcja obliczająca rozmiar reguły w binarnym pliku słownika.
+ * @param[in] reg Reguła.
+ * @return Rozmiar w bajtach.
+ */
+static size_t rozmiarReguly(const struct regula * reg)
+{
+  return sizeof(struct regula_pliku) + wyrownaj(sizeof(wchar_t) *
+    (wcslen(reg->lewaStrona) + wcslen(reg->prawaStrona) + 2));
+}
+
+/** Funkcja zapisująca słownik w formacie binarnym do otwartego pliku.
+ * @param[in] dict Słownik.
+ * @param[in,out] file Plik.
+ * @return Czy zapis się udał.
+ */
+static bool zapiszBinarnie(const struct dictionary *dict, FILE * file)
+{
+  struct double_array * tablica = dict->zamrozony;
+  if (tablica == NULL)
+    tablica = double_array_build(dict->drzewko);
+  if (tablica == NULL)
+    return false;
+
+  struct naglowek_pliku naglowek;
+  memset(&naglowek, 0, sizeof(naglowek));
+  memcpy(naglowek.magia, magiaPliku, sizeof(magiaPliku));
+  naglowek.wersja = WERSJA_PLIKU;
+  naglowek.kolejnoscBajtow = KOLEJNOSC_BAJTOW;
+  naglowek.rozmiarLitery = sizeof(wchar_t);
+  naglowek.maksymalnyKoszt = dict->maksymalnyKoszt;
+  naglowek.liczbaLiter = dict->liczbaLiter;
+  naglowek.poczatekRegul = sizeof(naglowek) + wyrownaj(sizeof(wchar_t) * dict->liczbaLiter);
+  naglowek.poczatekIndeksu = naglowek.poczatekRegul;
+  for (int i = 0; i < dict->liczbaKosztow; i++)
+  {
+    if (dict->tablicaRegul[i] == NULL)
+      continue;
+    for (int j = 0; j < dict->tablicaRegul[i]->liczbaRegulKosztu; j++)
     {
-      lewaStrona = malloc(sizeof(wchar_t) * (pom + 1));
-      for (int i = 0; i < pom; i++)
-      {
-        buff = fgetwc(stream);
-        lewaStrona[i] = buff;
-      }
-      lewaStrona[pom] = L'\0';
+      naglowek.liczbaRegul++;
+      naglowek.poczatekIndeksu += rozmiarReguly(dict->tablicaRegul[i]->zbiorRegulKosztu[j]);
     }
-    buff = fgetwc(stream);
-    fwscanf(stream, L"%d", &pom);
-    buff = fgetwc(stream);
-    wchar_t * prawaStrona;
-    if (!pom)
-      prawaStrona = L"";
-    else
+  }
+  naglowek.poczatekTablicy = naglowek.poczatekIndeksu;
+  if (dict->indeksUsuniec != NULL)
+    naglowek.poczatekTablicy += usuniecia_rozmiar_zapisu(dict->indeksUsuniec);
+
+  size_t alfabet = sizeof(wchar_t) * dict->liczbaLiter;
+  bool udane = fwrite(&naglowek, sizeof(naglowek), 1, file) == 1 &&
+    fwrite(dict->alfabet, 1, alfabet, file) == alfabet && dopelnij(file, alfabet);
+  for (int i = 0; udane && i < dict->liczbaKosztow; i++)
+  {
+    if (dict->tablicaRegul[i] == NULL)
+      continue;
+    for (int j = 0; udane && j < dict->tablicaRegul[i]->liczbaRegulKosztu; j++)
     {
-      prawaStrona = malloc(sizeof(wchar_t) * (pom + 1));
-      for (int i = 0; i < pom; i++)
-      {
-        buff = fgetwc(stream);
-        prawaStrona[i] = buff;
-      }
-      prawaStrona[pom] = L'\0';
+      const struct regula * reg = dict->tablicaRegul[i]->zbiorRegulKosztu[j];
+      struct regula_pliku zapisana = { wcslen(reg->lewaStrona),
+        wcslen(reg->prawaStrona), reg->koszt, reg->flaga };
+      size_t lewa = sizeof(wchar_t) * (zapisana.dlugoscLewej + 1);
+      size_t prawa = sizeof(wchar_t) * (zapisana.dlugoscPrawej + 1);
+      udane = fwrite(&zapisana, sizeof(zapisana), 1, file) == 1 &&
+        fwrite(reg->lewaStrona, 1, lewa, file) == lewa &&
+        fwrite(reg->prawaStrona, 1, prawa, file) == prawa &&
+        dopelnij(file, lewa + prawa);
     }
-    buff = fgetwc(stream);
-    fwscanf(stream, L"%d", &pom);
-    int koszt = pom;
-    buff = fgetwc(stream);
-    fwscanf(stream, L"%d", &pom);
-    int flaga = pom;
-    dictionary_rule_add(new, lewaStrona, prawaStrona, 0, koszt, flaga);  
-    buff = fgetwc(stream);
-  }  
-  
-  if (!pom)
-    buff = fgetwc(stream);
+  }
+  if (dict->indeksUsuniec != NULL)
+    udane = udane && usuniecia_zapisz(dict->indeksUsuniec, file);
+  udane = udane && double_array_zapisz(tablica, file);
+  if (tablica != dict->zamrozony)
+    double_array_done(tablica);
+  return udane;
+}
 
-  new->drzewko = wczyt(stream, &(new->rozmiarAlfabetu), &(new->liczbaLiter), 
-    &(new->alfabet));
-  return new;
+int dictionary_save_file(const struct dictionary *dict, const char *filename)
+{
+  /* Słownik wczytany z pliku czyta z niego dalej podwójną tablicę
+     i indeks, więc plik zapisywany jest obok i podmieniany dopiero po
+     udanym zapisie; nieudany zapis nie niszczy też poprzedniego pliku. */
+  char * tymczasowy = malloc(strlen(filename) + 8);
+  sprintf(tymczasowy, "%s.XXXXXX", filename);
+  int fd = mkstemp(tymczasowy);
+  if (fd < 0)
+  {
+    free(tymczasowy);
+    return -1;
+  }
+  struct stat opis;
+  mode_t prawa;
+  if (stat(filename, &opis) == 0)
+    prawa = opis.st_mode & 07777;
+  else
+  {
+    mode_t maska = umask(0);
+    umask(maska);
+    prawa = 0666 & ~maska;
+  }
+  FILE * file = fdopen(fd, "wb");
+  bool udane = file != NULL && fchmod(fd, prawa) == 0 &&
+    zapiszBinarnie(dict, file) && fflush(file) == 0 && fsync(fd) == 0;
+  if (file != NULL ? fclose(file) != 0 : close(fd) != 0)
+    udane = false;
+  if (udane && rename(tymczasowy, filename) != 0)
+    udane = false;
+  if (!udane)
+    unlink(tymczasowy);
+  free(tymczasowy);
+  return udane ? 0 : -1;
+}
+
+/** Funkcja tworząca zamrożony słownik z zmapowanego pliku binarnego.
+ * Podwójna tablica, indeks podpowiedzi i strony reguł wskazują bezpośrednio
+ * do pliku.
+ * @param[in] mapa Zmapowany plik, zaczynający się znacznikiem magiaPliku.
+ * @param[in] rozmiar Rozmiar pliku.
+ * @return Słownik, który przejmuje mapowanie, albo NULL, jeśli plik jest
+ * niepoprawny (mapowanie zostaje wtedy u wywołującego).
+ */
+static struct dictionary * slownikZPliku(void * mapa, size_t rozmiar)
+{
+  const struct naglowek_pliku * naglowek = mapa;
+  if (naglowek->wersja != WERSJA_PLIKU ||
+    naglowek->kolejnoscBajtow != KOLEJNOSC_BAJTOW ||
+    naglowek->rozmiarLitery != sizeof(wchar_t) || naglowek->maksymalnyKoszt < 0 ||
+    naglowek->maksymalnyKoszt > MAX_HINTS_COST ||
+    naglowek->poczatekRegul != sizeof(*naglowek) +
+      wyrownaj(sizeof(wchar_t) * (uint64_t) naglowek->liczbaLiter) ||
+    naglowek->poczatekIndeksu < naglowek->poczatekRegul ||
+    naglowek->poczatekTablicy < naglowek->poczatekIndeksu ||
+    naglowek->poczatekTablicy > rozmiar)
+    return NULL;
+  const char * poczatek = mapa;
+  struct double_array * tablica = double_array_widok(poczatek + naglowek->poczatekTablicy,
+    rozmiar - naglowek->poczatekTablicy);
+  if (tablica == NULL)
+    return NULL;
+  struct usuniecia * indeks = NULL;
+  if (naglowek->poczatekTablicy > naglowek->poczatekIndeksu)
+  {
+    indeks = usuniecia_widok(poczatek + naglowek->poczatekIndeksu,
+      naglowek->poczatekTablicy - naglowek->poczatekIndeksu);
+    if (indeks == NULL)
+    {
+      double_array_done(tablica);
+      return NULL;
+    }
+  }
+
+  struct dictionary * dict = dictionary_new();
+  dict->zamrozony = tablica;
+  dict->indeksUsuniec = indeks;
+  if (naglowek->liczbaLiter > 0)
+  {
+    dict->alfabet = malloc(sizeof(wchar_t) * (naglowek->liczbaLiter + 1));
+    memcpy(dict->alfabet, poczatek + sizeof(*naglowek), sizeof(wchar_t) * naglowek->liczbaLiter);
+    dict->alfabet[naglowek->liczbaLiter] = L'\0';
+    dict->liczbaLiter = dict->rozmiarAlfabetu = naglowek->liczbaLiter;
+  }
+  dictionary_hints_max_cost(dict, naglowek->maksymalnyKoszt);
+  const char * regula = poczatek + naglowek->poczatekRegul;
+  const char * koniecRegul = poczatek + naglowek->poczatekIndeksu;
+  for (uint32_t i = 0; i < naglowek->liczbaRegul; i++)
+  {
+    const struct regula_pliku * zapisana = (const struct regula_pliku *) regula;
+    if ((size_t) (koniecRegul - regula) < sizeof(*zapisana) ||
+      (size_t) (koniecRegul - regula) - sizeof(*zapisana) < sizeof(wchar_t) *
+        ((uint64_t) zapisana->dlugoscLewej + zapisana->dlugoscPrawej + 2))
+    {
+      dictionary_done(dict);
+      return NULL;
+    }
+    const wchar_t * lewa = (const wchar_t *) (zapisana + 1);
+    const wchar_t * prawa = lewa + zapisana->dlugoscLewej + 1;
+    /* Każda zapisana reguła była poprawna, więc odrzucona oznacza
+       uszkodzony plik. */
+    if (lewa[zapisana->dlugoscLewej] != L'\0' || prawa[zapisana->dlugoscPrawej] != L'\0' ||
+      dictionary_rule_add(dict, lewa, prawa, 0, zapisana->koszt, zapisana->flaga) < 1)
+    {
+      dictionary_done(dict);
+      return NULL;
+    }
+    regula += sizeof(*zapisana) + wyrownaj(sizeof(wchar_t) *
+      (zapisana->dlugoscLewej + zapisana->dlugoscPrawej + 2));
+  }
+  dict->mapa = mapa;
+  dict->rozmiarMapy = rozmiar;
+  return dict;
+}
+
+struct dictionary * dictionary_load_file(const char *filename)
+{
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0)
+    return NULL;
+  struct stat informacje;
+  void * mapa = MAP_FAILED;
+  size_t rozmiar = 0;
+  if (fstat(fd, &informacje) == 0 &&
+    (size_t) informacje.st_size >= sizeof(struct naglowek_pliku))
+  {
+    rozmiar = informacje.st_size;
+    mapa = mmap(NULL, rozmiar, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (mapa != MAP_FAILED)
+  {
+    if (!memcmp(mapa, magiaPliku, sizeof(magiaPliku)))
+    {
+      struct dictionary * dict = slownikZPliku(mapa, rozmiar);
+      if (dict == NULL)
+        munmap(mapa, rozmiar);
+      return dict;
+    }
+    munmap(mapa, rozmiar);
+  }
+
+  /* Plik tekstowy (dictionary_save()). */
+  FILE * file = fopen(filename, "r");
+  if (file == NULL)
+    return NULL;
+  struct dictionary * dict = dictionary_load(file);
+  fclose(file);
+  return dict;
 }
 
 /** Pomocniczy komparator potrzebndy do sortowania word_listy. 
@@ -419,10 +1283,8 @@ int dictionary_save_lang(const struct dictionary *dict, const char *lang)
   int lang_len = strlen(lang);
   char buff [strlen(CONF_PATH) + lang_len + 2];
   sprintf(buff, "%s/%s", CONF_PATH, lang);
-  FILE * file = fopen(buff, "w");
-  if (file == NULL)
+  if (dictionary_save_file(dict, buff) < 0)
     return -1;
-  dictionary_save(dict, file);  
   char * langLista = NULL;
   size_t rozmiarLangListy;
   int powiodloSie = dictionary_lang_list(&langLista, &rozmiarLangListy);
@@ -437,7 +1299,6 @@ int dictionary_save_lang(const struct dictionary *dict, const char *lang)
       {
         free(langLista);
         free(str);
-        fclose(file);
         return 0;
       }
       i += strlen(str) + 1;      
@@ -450,13 +1311,9 @@ int dictionary_save_lang(const struct dictionary *dict, const char *lang)
   }
   if (langLista != NULL)
     free(langLista);
-  fclose(file);
-  file = fopen(CONF_PATH"/"DICT_LIST, "a");
+  FILE * file = fopen(CONF_PATH"/"DICT_LIST, "a");
   if (file == NULL)
-  {
-    fclose(file);
     return -1;
-  }
   fwprintf(file, L"%d%s\n", lang_len, lang);
   fclose(file);
   return 0;
@@ -468,172 +1325,702 @@ struct dictionary * dictionary_load_lang(const char *lang)
   int lang_len = strlen(lang);
   char buff [strlen(CONF_PATH) + lang_len + 2];
   sprintf(buff, "%s/%s", CONF_PATH, lang);
-  FILE * file = fopen(buff, "r");
-  if (file == NULL)
-    return NULL;
-  struct dictionary * hehe = dictionary_load(file);  
-  fclose(file);
-  return hehe;
+  return dictionary_load_file(buff);
 }
 
 int dictionary_hints_max_cost(struct dictionary *dict, int new_cost)
 {
+  if (new_cost < 0 || new_cost > MAX_HINTS_COST)
+    return -1;
   int pom = dict->maksymalnyKoszt;
   dict->maksymalnyKoszt = new_cost;
-  if (pom < new_cost)
-    dict->tablicaRegul = powiekszTabliceSpecjalnaRegul(dict->tablicaRegul, (new_cost +1));
-  for (int i = pom; i < new_cost;i++)
-    dict->tablicaRegul[i] = NULL;
+  if (new_cost != pom)
+    uniewaznijPodpowiedzi(dict);
   return pom;
 }
 
+/** Funkcja kopiująca stronę reguły.
+ * @param[in] strona Strona reguły.
+ * @return Kopia.
+ */
+static wchar_t * kopiujStrone(const wchar_t * strona)
+{
+  size_t dlugosc = wcslen(strona);
+  wchar_t * kopia = malloc(sizeof(wchar_t) * (dlugosc + 1));
+  wmemcpy(kopia, strona, dlugosc + 1);
+  return kopia;
+}
+
 struct regula * newRegula(const wchar_t * left, const wchar_t * right, 
   int cost, enum rule_flag flag)
 {
   struct regula * reg = malloc(sizeof(struct regula));
-  reg->lewaStrona = left;
-  reg->prawaStrona = right;
+  reg->lewaStrona = kopiujStrone(left);
+  reg->prawaStrona = kopiujStrone(right);
   reg->koszt = cost;
   reg->flaga = flag;
+  reg->program = NULL;
   return reg;
 }
 
-static bool czyZmiennych (const wchar_t * left, const wchar_t * right)
+/** Funkcja zwalniająca regułę razem z jej stronami.
+ * @param[in] reg Reguła.
+ */
+static void usunRegule(struct regula * reg)
 {
-  bool T[10];
-  int dlugosc1 = wcslen(left);
-  int dlugosc2 = wcslen(right);
-  for (int i = 0; i < 10; i++)
-    T[i] = false;
+  regula_done(reg);
+  free((wchar_t *) reg->lewaStrona);
+  free((wchar_t *) reg->prawaStrona);
+  free(reg);
+}
 
-  for (int i = 0; i < dlugosc1; i++)
+/** Funkcja dodająca regułę w jednym kierunku.
+ * @param[in,out] dict Słownik.
+ * @param[in] left Lewa strona reguły.
+ * @param[in] right Prawa strona reguły.
+ * @param[in] cost Koszt reguły (dodatni).
+ * @param[in] flag Flaga reguły.
+ * @return 1 jeśli reguła została dodana, 0 jeśli została odrzucona,
+ * -1 jeśli zabrakło pamięci.
+ */
+static int dodajRegule(struct dictionary *dict, const wchar_t *left,
+ const wchar_t *right, int cost, enum rule_flag flag)
+{
+  /* Kompilacja odrzuca reguły z więcej niż jedną zmienną prawej strony,
+     której nie ma po lewej. */
+  struct regula * reg = newRegula(left, right, cost, flag);
+  int skompilowana = regula_kompiluj(reg);
+  if (skompilowana <= 0)
   {
-    if (isdigit(left[i]))
-    {
-      int pom = left[i] - '0';
-      T[pom] = true;
-      fwprintf(stderr, L"%d asd \n", pom);
-    }
+    usunRegule(reg);
+    return skompilowana;
   }
-  bool zaDuzo = false;
-  for (int j = 0; j < dlugosc2; j++)
+  if (cost >= dict->liczbaKosztow)
   {
-    if (isdigit(right[j]))
+    struct tablica_regul ** tablica = powiekszTabliceSpecjalnaRegul
+      (dict->tablicaRegul, cost + 1);
+    if (tablica == NULL)
     {
-      int pom = right[j] - '0';
-      if (!T[pom])
-      {
-        if (zaDuzo)
-        {
-          return false;
-        }
-        zaDuzo = true;
-        T[pom] = true;
-      }
+      usunRegule(reg);
+      return -1;
     }
+    for (int i = dict->liczbaKosztow; i <= cost; i++)
+      tablica[i] = NULL;
+    dict->tablicaRegul = tablica;
+    dict->liczbaKosztow = cost + 1;
   }
-  return true;
+  struct tablica_regul ** tablicaRegul = dict->tablicaRegul;
+  if (tablicaRegul[cost] == NULL)
+    tablicaRegul[cost] = initalizeTablicaRegul(tablicaRegul[cost]);
+  tablicaRegul[cost]->zbiorRegulKosztu = poprawTabliceRegul
+    (&(tablicaRegul[cost]->liczbaRegulKosztu), tablicaRegul[cost]->zbiorRegulKosztu,
+     &(tablicaRegul[cost]->rozmiarRegulKosztu), reg);
+  if (tablicaRegul[cost]->zbiorRegulKosztu == NULL)
+  {
+    usunRegule(reg);
+    return -1;
+  }
+  dict->ogolnaLiczbaRegul++;
+  reguly_done(dict->indeksRegul);
+  dict->indeksRegul = NULL;
+  uniewaznijPodpowiedzi(dict);
+  return 1;
 }
 
 int dictionary_rule_add(struct dictionary *dict, const wchar_t *left,
  const wchar_t *right, bool bidirectional, int cost, enum rule_flag flag)
 {
-  if (!wcscoll(left, puste) && !wcscoll(left,right))
-    return -1;    
-  
-  int licznik = 0;
-  struct tablica_regul ** tablicaRegul = dict->tablicaRegul;  
-  struct regula * reg;
-  bool ho = czyZmiennych(left, right);
-  
-  if (ho)
+  /* Obie strony mogą być puste tylko w regule podziału, a koszt zerowy
+     pozwalałby stosować reguły bez końca. */
+  if ((left[0] == L'\0' && right[0] == L'\0' && flag != RULE_SPLIT) || cost < 1)
+    return 0;
+  int licznik = dodajRegule(dict, left, right, cost, flag);
+  if (licznik < 0)
+    return -1;
+  if (bidirectional && wcscmp(left, right))
   {
-    reg = newRegula(left, right, cost, flag);
-    
-    if (tablicaRegul[cost] == NULL)
-      tablicaRegul[cost] = initalizeTablicaRegul(tablicaRegul[cost]);
-    tablicaRegul[cost]->zbiorRegulKosztu = poprawTabliceRegul
-      (&(tablicaRegul[cost]->liczbaRegulKosztu), tablicaRegul[cost]->zbiorRegulKosztu,
-       &(tablicaRegul[cost]->rozmiarRegulKosztu), reg);
-    if (tablicaRegul[cost]->zbiorRegulKosztu == NULL)
-    {
-      free(reg);
+    int drugi = dodajRegule(dict, right, left, cost, flag);
+    if (drugi < 0)
       return -1;
-    }
-    licznik++; 
+    licznik += drugi;
   }
-  if (bidirectional)
-  {
-    ho = czyZmiennych(right, left);
-    if (ho)
-    {
-      reg = newRegula(right, left, cost, flag);
-      if (tablicaRegul[cost] == NULL)
-      tablicaRegul[cost] = initalizeTablicaRegul(tablicaRegul[cost]);
-      tablicaRegul[cost]->zbiorRegulKosztu = poprawTabliceRegul(&(tablicaRegul[cost]
-        ->liczbaRegulKosztu), tablicaRegul[cost]->zbiorRegulKosztu, &(tablicaRegul[cost]->
-          rozmiarRegulKosztu), reg);
-      if (tablicaRegul[cost]->zbiorRegulKosztu == NULL)
-      {
-        free(reg);
-        return -1;  
-      }
-      licznik++;
-    }
-  }
-  dict->ogolnaLiczbaRegul += licznik;
   return licznik;
 }
 
 void dictionary_rule_clear(struct dictionary *dict)
 {
   struct tablica_regul ** zbior = dict->tablicaRegul;
-  for (int i = 0; i < dict->maksymalnyKoszt; i++)
+  for (int i = 0; i < dict->liczbaKosztow; i++)
   {
     struct tablica_regul * pom = zbior[i];
-    if (pom != NULL)
-    {
-      for (int j = 0; j < pom->rozmiarRegulKosztu; j++)
-          free(pom->zbiorRegulKosztu[j]);
+    if (pom == NULL)
+      continue;
+    for (int j = 0; j < pom->liczbaRegulKosztu; j++)
+      usunRegule(pom->zbiorRegulKosztu[j]);
+    free(pom->zbiorRegulKosztu);
     free(pom);
+    zbior[i] = NULL;
+  }
+  dict->ogolnaLiczbaRegul = 0;
+  reguly_done(dict->indeksRegul);
+  dict->indeksRegul = NULL;
+  uniewaznijPodpowiedzi(dict);
+}
+
+/** Komparator podpowiedzi z kluczami: najpierw tańsze, przy równym koszcie
+ * w kolejności słownikowej (przy równych kluczach według samych słów, żeby
+ * porządek był zawsze ten sam).
+ * @param[in] a Pierwsza podpowiedź.
+ * @param[in] b Druga podpowiedź.
+ * @return Liczba ujemna, zero lub dodatnia.
+ */
+static int cmpKosztu(const void * a, const void * b)
+{
+  const struct podpowiedz * x = a;
+  const struct podpowiedz * y = b;
+  if (x->koszt != y->koszt)
+    return x->koszt < y->koszt ? -1 : 1;
+  int wynik = wcscmp(x->klucz, y->klucz);
+  return wynik != 0 ? wynik : wcscmp(x->slowo, y->slowo);
+}
+
+/** Przesunięcie podpowiedzi w górę kopca.
+ * @param[in,out] p Podpowiedzi.
+ * @param[in] i Miejsce podpowiedzi.
+ */
+static void wGore(struct podpowiedzi * p, int i)
+{
+  struct podpowiedz x = p->tablica[i];
+  while (i > 0 && cmpKosztu(&p->tablica[(i - 1) / 2], &x) < 0)
+  {
+    p->tablica[i] = p->tablica[(i - 1) / 2];
+    i = (i - 1) / 2;
+  }
+  p->tablica[i] = x;
+}
+
+/** Przesunięcie podpowiedzi ze szczytu w dół kopca.
+ * @param[in,out] p Podpowiedzi.
+ */
+static void wDol(struct podpowiedzi * p)
+{
+  struct podpowiedz x = p->tablica[0];
+  int i = 0;
+  while (2 * i + 1 < p->liczba)
+  {
+    int syn = 2 * i + 1;
+    if (syn + 1 < p->liczba && cmpKosztu(&p->tablica[syn + 1], &p->tablica[syn]) > 0)
+      syn++;
+    if (cmpKosztu(&p->tablica[syn], &x) <= 0)
+      break;
+    p->tablica[i] = p->tablica[syn];
+    i = syn;
+  }
+  p->tablica[i] = x;
+}
+
+/** Funkcja wyznaczająca klucz porządku słownikowego słowa w pamięci
+ * podpowiedzi.
+ * @param[in,out] p Podpowiedzi.
+ * @param[in] slowo Słowo.
+ * @return Długość klucza.
+ */
+static size_t kluczSlowa(struct podpowiedzi * p, const wchar_t * slowo)
+{
+  size_t dlugosc = wcsxfrm(p->klucz, slowo, p->rozmiarKlucza);
+  if (dlugosc >= p->rozmiarKlucza)
+  {
+    p->rozmiarKlucza = 2 * dlugosc + 2;
+    p->klucz = realloc(p->klucz, sizeof(wchar_t) * p->rozmiarKlucza);
+    wcsxfrm(p->klucz, slowo, p->rozmiarKlucza);
+  }
+  return dlugosc;
+}
+
+/** Funkcja zapisująca słowo i jego klucz w miejscu podpowiedzi, którego
+ * pamięć powiększana jest tylko dla dłuższych niż dotąd słów.
+ * @param[in,out] miejsce Miejsce podpowiedzi.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] klucz Klucz słowa.
+ * @param[in] dlugoscKlucza Długość klucza.
+ * @param[in] koszt Koszt słowa.
+ */
+static void zapiszPodpowiedz(struct podpowiedz * miejsce, const wchar_t * slowo,
+  int dlugosc, const wchar_t * klucz, size_t dlugoscKlucza, int koszt)
+{
+  size_t potrzebne = dlugosc + dlugoscKlucza + 2;
+  if (potrzebne > miejsce->rozmiar)
+  {
+    miejsce->rozmiar = potrzebne > 2 * miejsce->rozmiar ? potrzebne : 2 * miejsce->rozmiar;
+    miejsce->slowo = realloc(miejsce->slowo, sizeof(wchar_t) * miejsce->rozmiar);
+  }
+  wmemcpy(miejsce->slowo, slowo, dlugosc + 1);
+  miejsce->klucz = miejsce->slowo + dlugosc + 1;
+  wmemcpy(miejsce->klucz, klucz, dlugoscKlucza + 1);
+  miejsce->koszt = koszt;
+}
+
+/** Funkcja zapamiętująca znalezione słowo. Bez ograniczenia liczby
+ * podpowiedzi słowo kopiowane jest od razu do listy. Przy ograniczonej
+ * liczbie słowo, które nie mieści się wśród najlepszych, nie jest
+ * kopiowane, a droższe od najgorszego z nich przestają być potrzebne.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] koszt Koszt słowa.
+ * @param[in,out] dane Podpowiedzi (struct podpowiedzi).
+ * @return Największy koszt słów, które mogą jeszcze trafić do podpowiedzi.
+ */
+static int dodajPodpowiedz(const wchar_t * slowo, int dlugosc, int koszt,
+  void * dane)
+{
+  struct podpowiedzi * p = dane;
+  if (p->limit <= 0)
+  {
+    word_list_add(p->lista, slowo);
+    return INT_MAX;
+  }
+  bool pelne = p->liczba == p->limit;
+  if (pelne && koszt > p->tablica[0].koszt)
+    return p->tablica[0].koszt;
+  size_t dlugoscKlucza = kluczSlowa(p, slowo);
+  if (pelne && koszt == p->tablica[0].koszt)
+  {
+    int porownanie = wcscmp(p->klucz, p->tablica[0].klucz);
+    if (porownanie > 0 ||
+        (porownanie == 0 && wcscmp(slowo, p->tablica[0].slowo) >= 0))
+      return p->tablica[0].koszt;
+  }
+  int i = 0;
+  if (!pelne)
+  {
+    if (p->liczba == p->rozmiar)
+    {
+      int rozmiar = p->rozmiar ? 2 * p->rozmiar : 16;
+      p->tablica = realloc(p->tablica, sizeof(struct podpowiedz) * rozmiar);
+      for (int j = p->rozmiar; j < rozmiar; j++)
+        p->tablica[j] = (struct podpowiedz) { NULL, NULL, 0, 0 };
+      p->rozmiar = rozmiar;
     }
+    i = p->liczba++;
   }
-  free(zbior);
+  zapiszPodpowiedz(&p->tablica[i], slowo, dlugosc, p->klucz, dlugoscKlucza, koszt);
+  if (pelne)
+    wDol(p);
+  else
+    wGore(p, i);
+  return p->liczba == p->limit ? p->tablica[0].koszt : INT_MAX;
+}
+
+/** Funkcja zapamiętująca słowo znalezione w jednym z wątków równoległego
+ * wyszukiwania. Granica kosztu najlepszych podpowiedzi wątku jest też
+ * granicą dla całego wyszukiwania, więc wątki zmniejszają wspólną granicę
+ * i stosują najmniejszą.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] koszt Koszt słowa.
+ * @param[in,out] dane Podpowiedzi wątku (struct podpowiedzi).
+ * @return Największy koszt słów, które mogą jeszcze trafić do podpowiedzi.
+ */
+static int dodajPodpowiedzWatku(const wchar_t * slowo, int dlugosc, int koszt,
+  void * dane)
+{
+  struct podpowiedzi * p = dane;
+  int granica = dodajPodpowiedz(slowo, dlugosc, koszt, p);
+  int wspolna = __atomic_load_n(p->granica, __ATOMIC_RELAXED);
+  while (granica < wspolna &&
+         !__atomic_compare_exchange_n(p->granica, &wspolna, granica, true,
+           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    ;
+  return granica < wspolna ? granica : wspolna;
+}
+
+/** Komparator kluczy podpowiedzi.
+ * @param[in] a Pierwsza podpowiedź.
+ * @param[in] b Druga podpowiedź.
+ * @return Liczba ujemna, zero lub dodatnia.
+ */
+static int cmpKluczy(const void * a, const void * b)
+{
+  return wcscmp(((const struct podpowiedz *) a)->klucz,
+    ((const struct podpowiedz *) b)->klucz);
+}
+
+/** Funkcja kopiująca najlepsze podpowiedzi do listy, w kolejności
+ * słownikowej. Miejsca podpowiedzi zostają do następnego wyszukiwania.
+ * @param[in,out] p Zebrane podpowiedzi, każda występuje raz.
+ * @param[out] list Lista.
+ */
+static void wybierzPodpowiedzi(struct podpowiedzi * p, struct word_list * list)
+{
+  int ile = p->liczba;
+  if (ile > 1)
+    qsort(p->tablica, ile, sizeof(struct podpowiedz), cmpKluczy);
+  for (int i = 0; i < ile; i++)
+    word_list_add(list, p->tablica[i].slowo);
+  p->liczba = 0;
+}
+
+/** Wyszukiwanie słów odległych od danego o co najwyżej kilka edycji.
+ * @param[in] dict Słownik.
+ * @param[in] word Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] max_distance Odległość.
+ * @param[in] transpositions Czy przestawienie liter jest jedną edycją.
+ * @param[in,out] p Podpowiedzi.
+ */
+static void szukajPodobnych(const struct dictionary *dict, const wchar_t *word,
+  int dlugosc, int max_distance, bool transpositions, struct podpowiedzi * p)
+{
+  if (dict->indeksUsuniec != NULL && max_distance <= dict->indeksUsuniec->odleglosc)
+    usuniecia_szukaj(dict->indeksUsuniec, word, dlugosc, max_distance,
+      transpositions, dodajPodpowiedz, p);
+  else if (dict->zamrozony != NULL)
+    levenshtein_double_array(dict->zamrozony, word, dlugosc, max_distance,
+      transpositions, dodajPodpowiedz, p);
+  else
+    levenshtein_trie(dict->drzewko, word, dlugosc, max_distance,
+      transpositions, dodajPodpowiedz, p);
+}
+
+int dictionary_edit_hints(const struct dictionary *dict, const wchar_t *word,
+        int max_distance, bool transpositions, struct word_list *list)
+{
+  word_list_init(list);
+  if (max_distance < 0 || max_distance > LEVENSHTEIN_MAKS_ODLEGLOSC)
+    return -1;
+  struct podpowiedzi p = { NULL, 0, 0, 0, NULL, 0, list, NULL };
+  szukajPodobnych(dict, word, wcslen(word), max_distance, transpositions, &p);
+  if (word_list_size(list) > 1)
+    qsort(word_list_get(list), word_list_size(list), sizeof(wchar_t *), cmp);
+  return 0;
+}
+
+/** Funkcja zwracająca indeks reguł słownika, budowany od nowa po każdej
+ * zmianie reguł.
+ * @param[in] dict Słownik.
+ * @return Indeks reguł.
+ */
+static const struct reguly * indeksRegul(const struct dictionary *dict)
+{
+  if (dict->indeksRegul != NULL)
+    return dict->indeksRegul;
+  const struct regula ** reguly = malloc(sizeof(struct regula *) *
+    (dict->ogolnaLiczbaRegul + 1));
+  int ile = 0;
+  for (int i = 0; i < dict->liczbaKosztow; i++)
+  {
+    if (dict->tablicaRegul[i] == NULL)
+      continue;
+    for (int j = 0; j < dict->tablicaRegul[i]->liczbaRegulKosztu; j++)
+      reguly[ile++] = dict->tablicaRegul[i]->zbiorRegulKosztu[j];
+  }
+  /* Indeks, tak jak liczniki, nie jest częścią zawartości słownika. */
+  struct dictionary *pamiec = (struct dictionary *) dict;
+  pamiec->indeksRegul = reguly_zbuduj(reguly, ile);
+  free(reguly);
+  return dict->indeksRegul;
+}
+
+/**
+  Równoległe wyszukiwanie podpowiedzi: zadaniami są pierwsze litery
+  podpowiedzi, czyli poddrzewa korzenia słownika.
+  */
+struct rownolegle
+{
+  /** Słownik. */
+  const struct dictionary * dict;
+
+  /** Indeks reguł. */
+  const struct reguly * reguly;
+
+  /** Słowo. */
+  const wchar_t * slowo;
+
+  /** Długość słowa. */
+  int dlugosc;
+
+  /** Pierwsze litery podpowiedzi, po jednej na zadanie. */
+  const wchar_t * litery;
+
+  /** Największy koszt potrzebnych podpowiedzi. */
+  int granica;
+};
+
+/** Funkcja wypisująca litery, którymi zaczynają się słowa słownika.
+ * @param[in] dict Słownik.
+ * @param[out] litery Tablica na litery albo NULL, żeby je tylko policzyć.
+ * @return Liczba liter.
+ */
+static int literyKorzenia(const struct dictionary *dict, wchar_t * litery)
+{
+  int ile = 0;
+  if (dict->zamrozony != NULL)
+  {
+    unsigned kod = 0;
+    while (double_array_nastepny_syn(dict->zamrozony, 0, &kod) != DOUBLE_ARRAY_BRAK)
+    {
+      if (litery != NULL)
+        litery[ile] = dict->zamrozony->litery[kod - 1];
+      ile++;
+    }
+  }
+  else if (dict->drzewko != NULL)
+  {
+    for (int i = trie_nastepny_syn(dict->drzewko, -1); i >= 0;
+         i = trie_nastepny_syn(dict->drzewko, i))
+    {
+      if (litery != NULL)
+        litery[ile] = trie_syn(dict->drzewko, i)->litera;
+      ile++;
+    }
+  }
+  return ile;
+}
+
+/** Zadanie równoległego wyszukiwania: podpowiedzi o jednej pierwszej
+ * literze, zbierane w pamięci podpowiedzi wątku.
+ * @param[in] zadanie Numer litery.
+ * @param[in] watek Numer wątku.
+ * @param[in,out] dane Wyszukiwanie (struct rownolegle).
+ */
+static void szukajOdLitery(int zadanie, int watek, void * dane)
+{
+  struct rownolegle * r = dane;
+  podpowiedzi_szukaj(r->dict->drzewko, r->dict->zamrozony, r->reguly,
+    r->slowo, r->dlugosc, __atomic_load_n(&r->granica, __ATOMIC_RELAXED),
+    r->litery[zadanie], dodajPodpowiedzWatku, &r->dict->roboczeWatkow[watek]);
+}
+
+/** Wyszukiwanie podpowiedzi według reguł w wątkach puli. Każdy wątek
+ * zbiera najlepsze podpowiedzi ze swoich zadań; najlepsze z nich wszystkich
+ * są tymi samymi podpowiedziami, co przy wyszukiwaniu w jednym wątku.
+ * @param[in] dict Słownik z pulą wątków.
+ * @param[in] word Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[out] list Lista podpowiedzi.
+ */
+static void szukajRownolegle(const struct dictionary *dict, const wchar_t *word,
+  int dlugosc, struct word_list * list)
+{
+  wchar_t litery[literyKorzenia(dict, NULL) + 1];
+  struct rownolegle r = { dict, indeksRegul(dict), word, dlugosc, litery,
+    dict->maksymalnyKoszt };
+  int liczbaZadan = literyKorzenia(dict, litery);
+  for (int i = 0; i < dict->watki->liczba; i++)
+    dict->roboczeWatkow[i].granica = &r.granica;
+  watki_wykonaj(dict->watki, liczbaZadan, szukajOdLitery, &r);
+
+  int ile = 0;
+  for (int i = 0; i < dict->watki->liczba; i++)
+    ile += dict->roboczeWatkow[i].liczba;
+  struct podpowiedz wszystkie[ile + 1];
+  ile = 0;
+  for (int i = 0; i < dict->watki->liczba; i++)
+  {
+    struct podpowiedzi * p = &dict->roboczeWatkow[i];
+    for (int j = 0; j < p->liczba; j++)
+      wszystkie[ile++] = p->tablica[j];
+    p->liczba = 0;
+  }
+  if (ile > 1)
+    qsort(wszystkie, ile, sizeof(struct podpowiedz), cmpKosztu);
+  if (ile > DICTIONARY_MAX_HINTS)
+    ile = DICTIONARY_MAX_HINTS;
+  if (ile > 1)
+    qsort(wszystkie, ile, sizeof(struct podpowiedz), cmpKluczy);
+  for (int i = 0; i < ile; i++)
+    word_list_add(list, wszystkie[i].slowo);
 }
 
 void dictionary_hints(const struct dictionary *dict, const wchar_t* word,
         struct word_list *list)
 {
-  // int liczbaHintow = 0;
-  // wchar_t ** hinty = hints(dict->drzewko, word, dict->alfabet, dict->liczbaLiter,
-  //  &liczbaHintow);
-  // if (hinty == NULL)
-  // {
-  //   word_list_init(list);
-  //   list->size = 0;
-  //   list->buffer_size = 0;
-  //   free(list->array);
-  //   list->array = NULL;
-  //   return;
-  // }
   word_list_init(list);
-  dictionary_hints_max_cost((struct dictionary *) dict, 5);
-  dictionary_rule_add((struct dictionary *) dict, L"012", L"0123", 1, 1, 1);
-  fwprintf(stderr, L"liczba regul %d\n", dict->ogolnaLiczbaRegul);
-  // qsort(hinty, liczbaHintow, sizeof(wchar_t *), cmp);
-  // int i = 0;
-  // while (i < liczbaHintow)
-  // {
-  //   int j = i;
-  //   word_list_add(list, hinty[i++]);
-  //   while (i < liczbaHintow && !wcscoll(hinty[j],hinty[i]))
-  //   {
-  //     free(hinty[i++]);
-  //   }
-  // }
-  // free(hinty);
-  
-  // pokazStany((wchar_t *) word, dict->drzewko);
+  dictionary_hints_into(dict, word, list);
+}
+
+/** Funkcja kopiująca do listy podpowiedzi zapamiętane w pamięci podręcznej.
+ * @param[in,out] podreczna Pamięć podręczna.
+ * @param[in] word Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in,out] list Lista.
+ * @return Czy podpowiedzi słowa były zapamiętane.
+ */
+static bool zPodrecznej(struct podreczna * podreczna, const wchar_t *word,
+  int dlugosc, struct word_list *list)
+{
+  const struct podreczna_wpis * wpis = podreczna_szukaj(podreczna, word, dlugosc);
+  if (wpis == NULL)
+    return false;
+  const wchar_t * podpowiedz = wpis->podpowiedzi;
+  for (int i = 0; i < wpis->liczba; i++)
+  {
+    word_list_add(list, podpowiedz);
+    podpowiedz += wcslen(podpowiedz) + 1;
+  }
+  return true;
+}
+
+/** Wyszukiwanie najlepszych podpowiedzi w wywołującym wątku.
+ * @param[in] dict Słownik.
+ * @param[in] word Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in,out] p Pamięć podpowiedzi.
+ * @param[in,out] list Lista.
+ */
+static void szukajPodpowiedzi(const struct dictionary *dict, const wchar_t *word,
+  int dlugosc, struct podpowiedzi * p, struct word_list *list)
+{
+  /* Słownik bez reguł podpowiada słowa odległe o jedną edycję. */
+  if (dict->ogolnaLiczbaRegul == 0)
+    szukajPodobnych(dict, word, dlugosc, 1, false, p);
+  else
+    podpowiedzi_szukaj(dict->drzewko, dict->zamrozony, indeksRegul(dict),
+      word, dlugosc, dict->maksymalnyKoszt, L'\0', dodajPodpowiedz, p);
+  wybierzPodpowiedzi(p, list);
+}
+
+void dictionary_hints_into(const struct dictionary *dict, const wchar_t *word,
+        struct word_list *list)
+{
+  word_list_clear(list);
+  int dlugosc = wcslen(word);
+  /* Pamięć podręczna i pamięć podpowiedzi, tak jak liczniki, nie są częścią
+     zawartości słownika. */
+  struct dictionary *pamiec = (struct dictionary *) dict;
+  if (dict->podreczna != NULL)
+  {
+    if (zPodrecznej(dict->podreczna, word, dlugosc, list))
+    {
+      pamiec->trafienia++;
+      return;
+    }
+    pamiec->chybienia++;
+  }
+  if (dict->ogolnaLiczbaRegul > 0 && dict->watki != NULL)
+    szukajRownolegle(dict, word, dlugosc, list);
+  else
+    szukajPodpowiedzi(dict, word, dlugosc, &pamiec->robocze, list);
+  if (dict->podreczna != NULL)
+    podreczna_dodaj(dict->podreczna, word, dlugosc, word_list_get(list),
+      word_list_size(list));
+}
+
+struct dictionary_reader * dictionary_reader_new(const struct dictionary *dict,
+        int cache_capacity)
+{
+  struct dictionary_reader * reader = malloc(sizeof(struct dictionary_reader));
+  reader->slownik = dict;
+  reader->robocze = (struct podpowiedzi)
+    { NULL, 0, 0, DICTIONARY_MAX_HINTS, NULL, 0, NULL, NULL };
+  reader->podreczna = cache_capacity > 0 ? podreczna_nowa(cache_capacity) : NULL;
+  /* Indeks reguł budowany jest przy pierwszym użyciu, więc budujemy go
+     teraz, zanim czytelnicy zaczną pracę w różnych wątkach. */
+  if (dict->ogolnaLiczbaRegul > 0)
+    indeksRegul(dict);
+  return reader;
+}
+
+void dictionary_reader_done(struct dictionary_reader *reader)
+{
+  zwolnijPodpowiedzi(&reader->robocze);
+  podreczna_done(reader->podreczna);
+  free(reader);
+}
+
+bool dictionary_reader_find(const struct dictionary_reader *reader,
+        const wchar_t *word)
+{
+  const struct dictionary * dict = reader->slownik;
+  int dlugosc = wcslen(word);
+  if (dict->filtr != NULL && dict->zamrozony == NULL &&
+      !bloom_moze_byc(dict->filtr, word, dlugosc))
+    return false;
+  return znajdz(dict, word, dlugosc);
+}
+
+void dictionary_reader_hints(struct dictionary_reader *reader,
+        const wchar_t *word, struct word_list *list)
+{
+  word_list_clear(list);
+  int dlugosc = wcslen(word);
+  if (reader->podreczna != NULL &&
+      zPodrecznej(reader->podreczna, word, dlugosc, list))
+    return;
+  szukajPodpowiedzi(reader->slownik, word, dlugosc, &reader->robocze, list);
+  if (reader->podreczna != NULL)
+    podreczna_dodaj(reader->podreczna, word, dlugosc, word_list_get(list),
+      word_list_size(list));
+}
+
+/**
+  Odbiorca podpowiedzi dictionary_hints_foreach().
+  */
+struct strumien
+{
+  /** Funkcja wywołującego. */
+  dictionary_hint_callback funkcja;
+
+  /** Dane wywołującego. */
+  void * ctx;
+};
+
+/** Funkcja przekazująca znalezione słowo wywołującemu
+ * dictionary_hints_foreach().
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] koszt Koszt słowa.
+ * @param[in] dane Odbiorca (struct strumien).
+ * @return -1, jeśli wywołujący przerwał wyszukiwanie, wpp. INT_MAX.
+ */
+static int przekazPodpowiedz(const wchar_t * slowo, int dlugosc, int koszt,
+  void * dane)
+{
+  const struct strumien * s = dane;
+  return s->funkcja(slowo, koszt, s->ctx) ? INT_MAX : -1;
+}
+
+/** Funkcja przekazująca wywołującemu słowa odległe o jedną edycję.
+ * Samo szukane słowo zostało już przekazane.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] koszt Odległość słowa.
+ * @param[in] dane Odbiorca (struct strumien).
+ * @return -1, jeśli wywołujący przerwał wyszukiwanie, wpp. INT_MAX.
+ */
+static int przekazPodobne(const wchar_t * slowo, int dlugosc, int koszt,
+  void * dane)
+{
+  if (koszt == 0)
+    return INT_MAX;
+  return przekazPodpowiedz(slowo, dlugosc, koszt, dane);
+}
+
+void dictionary_hints_foreach(const struct dictionary *dict, const wchar_t *word,
+        dictionary_hint_callback callback, void *ctx)
+{
+  int dlugosc = wcslen(word);
+  struct strumien s = { callback, ctx };
+  if (dict->ogolnaLiczbaRegul > 0)
+  {
+    podpowiedzi_szukaj(dict->drzewko, dict->zamrozony, indeksRegul(dict),
+      word, dlugosc, dict->maksymalnyKoszt, L'\0', przekazPodpowiedz, &s);
+    return;
+  }
+  /* Wyszukiwanie odległych słów nie idzie w kolejności odległości, więc
+     słowo z zerową odległością przekazywane jest najpierw. */
+  if (znajdz(dict, word, dlugosc) && !callback(word, 0, ctx))
+    return;
+  if (dict->indeksUsuniec != NULL && dict->indeksUsuniec->odleglosc >= 1)
+    usuniecia_szukaj(dict->indeksUsuniec, word, dlugosc, 1, false,
+      przekazPodobne, &s);
+  else if (dict->zamrozony != NULL)
+    levenshtein_double_array(dict->zamrozony, word, dlugosc, 1, false,
+      przekazPodobne, &s);
+  else
+    levenshtein_trie(dict->drzewko, word, dlugosc, 1, false,
+      przekazPodobne, &s);
 }
 
 /**@}*/
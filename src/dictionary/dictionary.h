@@ -26,6 +26,8 @@
 #define DICT_LIST "dict.list"
 /** Makro opisujące maksymalną długosc nazwy słownika. **/
 #define MAX_LANG_LENGTH 1000
+/** Makro opisujące największy dopuszczalny maksymalny koszt podpowiedzi. **/
+#define MAX_HINTS_COST 65536
 
 
 
@@ -59,6 +61,52 @@ void dictionary_done(struct dictionary *dict);
 int dictionary_insert(struct dictionary *dict, const wchar_t* word);
 
 
+/**
+  Struktura budowy słownika z posortowanych słów.
+  */
+struct dictionary_builder;
+
+
+/**
+  Rozpoczyna budowę słownika z posortowanych słów.
+  Budowę należy zakończyć za pomocą dictionary_builder_finish().
+  @return Nowa budowa.
+  */
+struct dictionary_builder * dictionary_builder_new(void);
+
+
+/**
+  Dodaje kolejne słowo do budowanego słownika. Słowa muszą przychodzić
+  rosnąco w porządku wcscmp(), czyli według kodów znaków (np. lista
+  posortowana przez `LC_ALL=C sort`). Drzewo budowane jest w jednym
+  przejściu, bez przeszukiwania i przebudowy wierzchołków.
+  @param[in,out] builder Budowa.
+  @param[in] word Dodawane słowo.
+  @return 1 jeśli słowo dodano, 0 jeśli powtarza poprzednie lub jest puste,
+  <0 jeśli słowa nie są posortowane (słowo nie jest dodawane).
+  */
+int dictionary_builder_add(struct dictionary_builder *builder, const wchar_t *word);
+
+
+/**
+  Kończy budowę i niszczy ją.
+  Słownik ten należy zniszczyć za pomocą dictionary_done().
+  @param[in,out] builder Budowa.
+  @return Zbudowany słownik.
+  */
+struct dictionary * dictionary_builder_finish(struct dictionary_builder *builder);
+
+
+/**
+  Buduje słownik z tablicy posortowanych słów (patrz dictionary_builder_add()).
+  Słownik ten należy zniszczyć za pomocą dictionary_done().
+  @param[in] words Słowa posortowane rosnąco w porządku wcscmp().
+  @param[in] n Liczba słów.
+  @return Zbudowany słownik lub NULL, jeśli słowa nie są posortowane.
+  */
+struct dictionary * dictionary_build_sorted(const wchar_t **words, size_t n);
+
+
 /**
   Usuwa podane słowo ze słownika, jeśli istnieje.
   @param[in,out] dict Słownik.
@@ -77,6 +125,136 @@ int dictionary_delete(struct dictionary *dict, const wchar_t* word);
 bool dictionary_find(const struct dictionary *dict, const wchar_t* word);
 
 
+/**
+  Włącza lub wyłącza filtr słów spoza słownika.
+  Filtr (blokowy filtr Blooma, około 10 bitów na słowo) budowany jest ze
+  wszystkich słów słownika przy włączeniu i uzupełniany przy wstawianiu.
+  dictionary_find() pyta go przed przejściem drzewa, więc słowo, którego na
+  pewno nie ma, odrzucane jest jednym odwołaniem do pamięci. Zamrożony
+  słownik (dictionary_freeze()) rozstrzyga brak słowa szybciej niż filtr
+  i z niego nie korzysta. Słowniki wczytane z pliku mają filtr wyłączony.
+  @param[in,out] dict Słownik.
+  @param[in] enable Czy filtr ma być włączony.
+  @return Czy filtr był dotychczas włączony.
+  */
+bool dictionary_filter(struct dictionary *dict, bool enable);
+
+
+/**
+  Włącza lub wyłącza indeks podpowiedzi odległych o kilka edycji.
+  Indeks pamięta skróty wszystkich słów powstających ze słów słownika przez
+  usunięcie co najwyżej `distance` liter. dictionary_edit_hints() dla
+  odległości nie większej niż `distance` i dictionary_hints() słownika bez
+  reguł zamiast przechodzić słownik sprawdzają wtedy w indeksie warianty
+  szukanego słowa i liczą odległość tylko dla znalezionych tak słów.
+  Indeks zajmuje wielokrotnie więcej pamięci niż słownik. Jest uzupełniany
+  przy wstawianiu i usuwaniu słów i zapisywany przez dictionary_save_file(),
+  więc dictionary_load_file() go nie przebudowuje.
+  @param[in,out] dict Słownik.
+  @param[in] distance Największa odległość obsługiwana przez indeks, 1 albo 2,
+  lub 0, żeby indeks wyłączyć.
+  @return Dotychczasowa odległość indeksu (0 jeśli był wyłączony) albo <0,
+  jeśli `distance` jest spoza zakresu.
+  */
+int dictionary_hint_index(struct dictionary *dict, int distance);
+
+
+/**
+  Ustawia pojemność pamięci podręcznej podpowiedzi.
+  Pamięć podręczna pamięta wyniki dictionary_hints() dla `capacity` ostatnio
+  używanych słów, więc powtarzające się słowo spoza słownika nie jest
+  ponownie wyszukiwane. Słowa rozróżniane są dokładnie, z wielkością liter
+  (dict-check przed sprawdzeniem zamienia litery na małe). Pamięć jest
+  czyszczona przy każdej zmianie, która może zmienić podpowiedzi:
+  wstawieniu i usunięciu słowa, dodaniu i usunięciu reguł oraz zmianie
+  maksymalnego kosztu podpowiedzi.
+  @param[in,out] dict Słownik.
+  @param[in] capacity Największa liczba pamiętanych słów lub 0, żeby pamięć
+  wyłączyć.
+  @return Dotychczasowa pojemność (0 jeśli pamięć była wyłączona) albo <0,
+  jeśli `capacity` jest ujemna.
+  */
+int dictionary_hint_cache(struct dictionary *dict, int capacity);
+
+
+/**
+  Ustawia liczbę wątków wyszukiwania podpowiedzi według reguł.
+  Przy więcej niż jednym wątku dictionary_hints() słownika z regułami dzieli
+  wyszukiwanie według pierwszej litery podpowiedzi, czyli poddrzew korzenia
+  słownika, między wątki puli; wątek, który skończył, bierze kolejną
+  literę. Wyniki łączone są w te same najlepsze podpowiedzi, w tej samej
+  kolejności, co przy wyszukiwaniu w jednym wątku. Opłaca się to dla
+  długich słów i dużego maksymalnego kosztu; słownik bez reguł zawsze
+  szuka podpowiedzi w jednym wątku. Wywołania dictionary_hints() dla tego
+  samego słownika nie mogą być współbieżne.
+  @param[in,out] dict Słownik.
+  @param[in] threads Liczba wątków, łącznie z wywołującym, od 0 do 64
+  (0 i 1 oznaczają wyszukiwanie w wywołującym wątku).
+  @return Dotychczasowa liczba wątków (1 przy wyszukiwaniu w jednym wątku)
+  albo <0, jeśli `threads` jest spoza zakresu lub nie udało się uruchomić
+  wątków (podpowiedzi szukane są wtedy w jednym wątku).
+  */
+int dictionary_hint_threads(struct dictionary *dict, int threads);
+
+
+/**
+  Statystyki zapytań słownika.
+  */
+struct dictionary_stats
+{
+    /// Liczba zapytań dictionary_find().
+    unsigned long long lookups;
+    /// Liczba zapytań o słowa spoza słownika.
+    unsigned long long misses;
+    /// Zapytania odrzucone przez filtr, bez przechodzenia słownika.
+    unsigned long long filter_rejects;
+    /// Zapytania o słowa spoza słownika, które filtr przepuścił.
+    unsigned long long filter_false_positives;
+    /// Rozmiar filtru w bajtach (0 jeśli filtr jest wyłączony).
+    size_t filter_bytes;
+    /// Liczba słów dodanych do filtru od jego ostatniej przebudowy.
+    size_t filter_words;
+    /// Rozmiar indeksu podpowiedzi w bajtach (0 jeśli indeks jest wyłączony).
+    size_t hint_index_bytes;
+    /// Zapytania dictionary_hints() rozstrzygnięte przez pamięć podręczną.
+    unsigned long long hint_cache_hits;
+    /// Zapytania dictionary_hints() spoza pamięci podręcznej (przy włączonej
+    /// pamięci).
+    unsigned long long hint_cache_misses;
+    /// Liczba słów w pamięci podręcznej podpowiedzi.
+    size_t hint_cache_entries;
+};
+
+
+/**
+  Pobiera statystyki zapytań słownika.
+  Skuteczność filtru to `filter_rejects / misses`: taka część zapytań
+  o słowa spoza słownika nie przechodzi słownika.
+  @param[in] dict Słownik.
+  @param[out] stats Statystyki.
+  */
+void dictionary_get_stats(const struct dictionary *dict, struct dictionary_stats *stats);
+
+
+/**
+  Zeruje liczniki zapytań słownika.
+  @param[in,out] dict Słownik.
+  */
+void dictionary_reset_stats(struct dictionary *dict);
+
+
+/**
+  Zamraża słownik.
+  Minimalizuje drzewo TRIE do acyklicznego automatu (wspólne końcówki słów
+  trzymane są raz) zapisanego w podwójnej tablicy (BASE/CHECK), z której od
+  tej pory korzysta dictionary_find(), a drzewo zwalnia. dictionary_insert()
+  i dictionary_delete() odmrażają słownik, odtwarzając drzewo z automatu.
+  Słownik o więcej niż 65534 różnych literach zostaje niezamrożony.
+  @param[in,out] dict Słownik.
+  */
+void dictionary_freeze(struct dictionary *dict);
+
+
 /**
   Zapisuje słownik.
   @param[in] dict Słownik.
@@ -88,6 +266,8 @@ int dictionary_save(const struct dictionary *dict, FILE* stream);
 
 /**
   Inicjuje i wczytuje słownik.
+  Strumień czytany jest blokami i dekodowany jako UTF-8, niezależnie od
+  ustawionej lokalizacji.
   Słownik ten należy zniszczyć za pomocą dictionary_done().
   @param[in,out] stream Strumień, skąd ma być wczytany słownik.
   @return Wczytany słownik lub NULL, jeśli operacja się nie powiedzie.
@@ -95,11 +275,44 @@ int dictionary_save(const struct dictionary *dict, FILE* stream);
 struct dictionary * dictionary_load(FILE* stream);
 
 
+/**
+  Zapisuje słownik do pliku w formacie binarnym, razem z alfabetem
+  i regułami. Taki plik dictionary_load_file() mapuje do pamięci
+  i przeszukuje w miejscu, bez wczytywania. Słownik zapisywany jest do
+  pliku tymczasowego w tym samym katalogu, który zastępuje plik
+  `filename` dopiero po udanym zapisie, więc słownik można zapisać do
+  pliku, z którego go wczytano. Słownika o więcej niż 65534 różnych
+  literach nie da się zapisać w tym formacie.
+  @param[in] dict Słownik.
+  @param[in] filename Nazwa pliku.
+  @return <0 jeśli operacja się nie powiedzie, 0 w p.p.
+  */
+int dictionary_save_file(const struct dictionary *dict, const char *filename);
+
+
+/**
+  Inicjuje i wczytuje słownik z pliku.
+  Plik binarny (dictionary_save_file()) jest mapowany do pamięci, a słownik
+  jest zamrożony (patrz dictionary_freeze()). Plik tekstowy
+  (dictionary_save()) wczytywany jest przez dictionary_load().
+  Słownik ten należy zniszczyć za pomocą dictionary_done().
+  @param[in] filename Nazwa pliku.
+  @return Wczytany słownik lub NULL, jeśli operacja się nie powiedzie.
+  */
+struct dictionary * dictionary_load_file(const char *filename);
+
+
 /**
   Tworzy możliwe podpowiedzi dla zadanego słowa.
   Jeżeli pojedyncza podpowiedź składa się z kilku słów,
   wtedy powinien być to jeden łańcuch znaków,
   w którym słowa są pooddzielane pojedynczymi spacjami.
+  Podpowiedzi powstają przez stosowanie reguł słownika
+  (patrz dictionary_rule_add()) o łącznym koszcie nie większym niż
+  maksymalny (dictionary_hints_max_cost()). Zwracanych jest
+  DICTIONARY_MAX_HINTS najtańszych podpowiedzi, w kolejności słownikowej.
+  Słownik bez reguł podpowiada słowa odległe o jedną zamianę, wstawienie
+  lub usunięcie litery.
   @param[in] dict Słownik.
   @param[in] word Szukane słowo.
   @param[in,out] list Lista, w której zostaną umieszczone podpowiedzi.
@@ -108,6 +321,123 @@ void dictionary_hints(const struct dictionary *dict, const wchar_t* word,
                       struct word_list *list);
 
 
+/**
+  Tworzy podpowiedzi tak jak dictionary_hints(), ale w liście już
+  zainicjowanej (word_list_init()), z której najpierw usuwane są
+  poprzednie słowa. Lista zachowuje pamięć, więc jedna lista używana
+  w pętli po wielu słowach nie przydziela jej przy każdym słowie.
+  Listę należy na końcu zniszczyć przez word_list_done().
+  @param[in] dict Słownik.
+  @param[in] word Szukane słowo.
+  @param[in,out] list Zainicjowana lista, w której zostaną umieszczone
+  podpowiedzi.
+  */
+void dictionary_hints_into(const struct dictionary *dict, const wchar_t *word,
+                           struct word_list *list);
+
+
+/**
+  Czytelnik słownika, przez którego wątki sprawdzają słowa i szukają
+  podpowiedzi współbieżnie.
+  */
+struct dictionary_reader;
+
+
+/**
+  Tworzy czytelnika słownika. Czytelnik ma własną pamięć wyszukiwania
+  podpowiedzi i własną pamięć podręczną, a nie zmienia liczników słownika,
+  więc czytelnicy tego samego słownika mogą działać współbieżnie, każdy
+  w jednym wątku. Czytelnicy nie widzą zmian słownika: należy ich
+  zniszczyć przez dictionary_reader_done() przed zmianą lub zniszczeniem
+  słownika.
+  @param[in] dict Słownik.
+  @param[in] cache_capacity Liczba słów, dla których czytelnik pamięta
+  podpowiedzi (0 wyłącza pamięć podręczną).
+  @return Nowy czytelnik.
+  */
+struct dictionary_reader * dictionary_reader_new(const struct dictionary *dict,
+                                                 int cache_capacity);
+
+
+/**
+  Niszczy czytelnika słownika.
+  @param[in] reader Czytelnik.
+  */
+void dictionary_reader_done(struct dictionary_reader *reader);
+
+
+/**
+  Sprawdza, czy dane słowo znajduje się w słowniku czytelnika, tak jak
+  dictionary_find().
+  @param[in] reader Czytelnik.
+  @param[in] word Słowo, którego obecność jest sprawdzana.
+  @return Wynik sprawdzenia.
+  */
+bool dictionary_reader_find(const struct dictionary_reader *reader,
+                            const wchar_t *word);
+
+
+/**
+  Tworzy podpowiedzi tak jak dictionary_hints_into(), zawsze w wywołującym
+  wątku.
+  @param[in,out] reader Czytelnik.
+  @param[in] word Szukane słowo.
+  @param[in,out] list Zainicjowana lista, w której zostaną umieszczone
+  podpowiedzi.
+  */
+void dictionary_reader_hints(struct dictionary_reader *reader,
+                             const wchar_t *word, struct word_list *list);
+
+
+/**
+  Funkcja otrzymująca kolejne podpowiedzi dictionary_hints_foreach().
+  @param[in] hint Podpowiedź, ważna tylko do powrotu z funkcji.
+  @param[in] cost Koszt podpowiedzi (odległość dla słownika bez reguł).
+  @param[in,out] ctx Dane wywołującego.
+  @return Czy szukać dalszych podpowiedzi.
+  */
+typedef bool (*dictionary_hint_callback)(const wchar_t *hint, int cost,
+                                         void *ctx);
+
+
+/**
+  Przekazuje podpowiedzi dla zadanego słowa po jednej, od najtańszej;
+  podpowiedzi o równym koszcie przychodzą w dowolnej kolejności.
+  Podpowiedzi są te same co w dictionary_hints(), ale bez ograniczenia
+  do DICTIONARY_MAX_HINTS, więc wywołujący, któremu wystarczy kilka
+  pierwszych, przerywa wyszukiwanie, zwracając false, zanim zostaną
+  znalezione droższe. Nic nie jest zbierane w pamięci, a pierwsza
+  podpowiedź nie czeka na pozostałe. Wyszukiwanie idzie w wywołującym
+  wątku, z pominięciem pamięci podręcznej (dictionary_hint_cache()).
+  @param[in] dict Słownik.
+  @param[in] word Szukane słowo.
+  @param[in] callback Funkcja wywoływana dla każdej podpowiedzi.
+  @param[in,out] ctx Dane przekazywane funkcji.
+  */
+void dictionary_hints_foreach(const struct dictionary *dict, const wchar_t *word,
+                              dictionary_hint_callback callback, void *ctx);
+
+
+/**
+  Tworzy podpowiedzi będące słowami słownika odległymi od zadanego słowa
+  o co najwyżej max_distance wstawień, usunięć i zamian liter.
+  Słownik przechodzony jest raz, z pominięciem poddrzew, w których
+  odległość musi przekroczyć limit. Podpowiedzi są posortowane.
+  @param[in] dict Słownik.
+  @param[in] word Szukane słowo.
+  @param[in] max_distance Odległość, 1 albo 2 (0 daje samo słowo, jeśli
+  jest w słowniku).
+  @param[in] transpositions Czy zamiana miejscami dwóch sąsiednich liter
+  liczy się jako jedna edycja.
+  @param[out] list Lista, w której zostaną umieszczone podpowiedzi.
+  @return 0 jeśli się udało, <0 jeśli odległość jest spoza zakresu
+  (lista jest wtedy pusta).
+  */
+int dictionary_edit_hints(const struct dictionary *dict, const wchar_t *word,
+                          int max_distance, bool transpositions,
+                          struct word_list *list);
+
+
 /**
   Zwraca nazwy języków, dla których dostępne są słowniki.
   Powinny to być nazwy lokali bez kodowania. np.
@@ -130,6 +460,7 @@ int dictionary_lang_list(char **list, size_t *list_len);
 
 /**
   Inicjuje i wczytuje słownik dla zadanego języka.
+  Plik słownika wczytywany jest przez dictionary_load_file().
   Słownik ten należy zniszczyć za pomocą dictionary_done().
   @param[in] lang Nazwa języka, patrz dictionary_lang_list().
   @return Słownik dla danego języka lub NULL, jeśli operacja się nie powiedzie.
@@ -138,7 +469,8 @@ struct dictionary * dictionary_load_lang(const char *lang);
 
 
 /**
-  Zapisuje słownik jak słownik dla ustalonego języka.
+  Zapisuje słownik jak słownik dla ustalonego języka,
+  w formacie binarnym (patrz dictionary_save_file()).
   @param[in] dict Słownik.
   @param[in] lang Nazwa języka, patrz dictionary_lang_list().
   @return <0 jeśli operacja się nie powiedzie, 0 w p.p.
@@ -149,8 +481,9 @@ int dictionary_save_lang(const struct dictionary *dict, const char *lang);
 /**
   Ustawia maksymalny koszt z jakim jest generowana podpowiedź.
   @param[in,out] dict Słownik.
-  @param[in] new_cost Nowy maksymalny koszt.
-  @return Zwraca dotychczasowy maksymalny koszt jaki był pamiętany przy słowniku.
+  @param[in] new_cost Nowy maksymalny koszt, od 0 do MAX_HINTS_COST.
+  @return Zwraca dotychczasowy maksymalny koszt jaki był pamiętany przy słowniku
+  lub <0, jeśli nowy koszt jest spoza zakresu (koszt się wtedy nie zmienia).
   */
 int dictionary_hints_max_cost(struct dictionary *dict, int new_cost);
 
@@ -206,7 +539,8 @@ enum rule_flag
   
   Reguły, w których prawa strona ma więcej niż jedną zmienną,
   która nie występuje po prawej stronie są odrzucane.
-  Jeśli obie strony są puste, to musi się to wiązać z użyciem flagi `s`, w p.p. reguła jest odrzucana. Funkcja zwraca liczbę reguł dodanych (bez uwzględnienia reguł odrzuconych).
+  Jeśli obie strony są puste, to musi się to wiązać z użyciem flagi `s`, w p.p. reguła jest odrzucana.
+  Odrzucane są też reguły o koszcie mniejszym niż 1. Funkcja zwraca liczbę reguł dodanych (bez uwzględnienia reguł odrzuconych).
   @param[in,out] dict Słownik.
   @param[in] left Lewa strona reguły.
   @param[in] right Prawa strona reguły.
@@ -0,0 +1,736 @@
+/** @file
+    Program mierzący szybkość operacji na słowniku.
+
+    Buduje słownik ze sztucznie wygenerowanych słów (tematy z polskimi
+    końcówkami fleksyjnymi) i wypisuje czasy poszczególnych operacji.
+    Uruchomienie: `dictionary_bench [liczba_tematow] [find|walk|load|build|filter|hints|rules|cache|threads]`.
+
+    @ingroup dictionary
+ */
+
+#include "dictionary.h"
+#include "trie.h"
+#include "double_array.h"
+#include "levenshtein.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <locale.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <math.h>
+
+/** Domyślna liczba generowanych tematów. */
+#define DOMYSLNA_LICZBA_TEMATOW 40000
+
+/** Maksymalna długość generowanego słowa. */
+#define MAX_DLUGOSC 32
+
+/** Litery, z których składane są tematy. */
+static const wchar_t litery[] = L"aąbcćdeęfghijklłmnńoóprsśtuwyzźż";
+
+/** Końcówki doklejane do tematów. */
+static const wchar_t * koncowki[] =
+{
+  L"", L"a", L"u", L"owi", L"em", L"ie", L"y", L"ów", L"om", L"ami", L"ach"
+};
+
+/** Stan generatora liczb pseudolosowych. */
+static unsigned long long ziarno = 88172645463325252ULL;
+
+/** Generator liczb pseudolosowych (xorshift), żeby wyniki były powtarzalne.
+ * @return Kolejna liczba pseudolosowa.
+ */
+static unsigned losuj(void)
+{
+  ziarno ^= ziarno << 13;
+  ziarno ^= ziarno >> 7;
+  ziarno ^= ziarno << 17;
+  return (unsigned) (ziarno >> 11);
+}
+
+/** Funkcja zwracająca bieżący czas w sekundach.
+ * @return Czas w sekundach.
+ */
+static double teraz(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/** Funkcja zwracająca bieżące zużycie pamięci rezydentnej.
+ * @return Pamięć rezydentna w MB.
+ */
+static double pamiecMB(void)
+{
+  long strony = 0, rezydentne = 0;
+  FILE * f = fopen("/proc/self/statm", "r");
+  if (f == NULL)
+    return 0;
+  if (fscanf(f, "%ld %ld", &strony, &rezydentne) != 2)
+    rezydentne = 0;
+  fclose(f);
+  return rezydentne * (double) sysconf(_SC_PAGESIZE) / 1e6;
+}
+
+/** Funkcja generująca zestaw słów.
+ * @param[in] tematy Liczba tematów.
+ * @param[out] ile Liczba wygenerowanych słów.
+ * @return Tablica słów.
+ */
+static wchar_t ** generujSlowa(int tematy, int * ile)
+{
+  int liczbaKoncowek = sizeof(koncowki) / sizeof(koncowki[0]);
+  int liczbaLiter = wcslen(litery);
+  wchar_t ** slowa = malloc(sizeof(wchar_t *) * tematy * liczbaKoncowek);
+  int n = 0;
+  for (int i = 0; i < tematy; i++)
+  {
+    wchar_t temat[MAX_DLUGOSC];
+    int dlugosc = 3 + losuj() % 8;
+    for (int j = 0; j < dlugosc; j++)
+      temat[j] = litery[losuj() % liczbaLiter];
+    temat[dlugosc] = L'\0';
+    for (int k = 0; k < liczbaKoncowek; k++)
+    {
+      slowa[n] = malloc(sizeof(wchar_t) * MAX_DLUGOSC);
+      swprintf(slowa[n], MAX_DLUGOSC, L"%ls%ls", temat, koncowki[k]);
+      n++;
+    }
+  }
+  *ile = n;
+  return slowa;
+}
+
+/** Funkcja przygotowująca zapytania: połowa trafień, połowa słów z jedną
+    zmienioną literą (w większości nieobecnych w słowniku).
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ * @param[in] liczbaZapytan Liczba zapytań.
+ * @return Tablica zapytań.
+ */
+static wchar_t ** generujZapytania(wchar_t ** slowa, int ile, int liczbaZapytan)
+{
+  int liczbaLiter = wcslen(litery);
+  wchar_t ** zapytania = malloc(sizeof(wchar_t *) * liczbaZapytan);
+  for (int i = 0; i < liczbaZapytan; i++)
+  {
+    const wchar_t * zrodlo = slowa[losuj() % ile];
+    zapytania[i] = malloc(sizeof(wchar_t) * MAX_DLUGOSC);
+    wcscpy(zapytania[i], zrodlo);
+    if (i & 1)
+      zapytania[i][losuj() % wcslen(zrodlo)] = litery[losuj() % liczbaLiter];
+  }
+  return zapytania;
+}
+
+/** Pomiar wyszukiwania: rekurencyjne finder() kontra podwójna tablica.
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ */
+static void benchFind(wchar_t ** slowa, int ile)
+{
+  int liczbaZapytan = 2000000;
+  wchar_t ** zapytania = generujZapytania(slowa, ile, liczbaZapytan);
+  int * dlugosci = malloc(sizeof(int) * liczbaZapytan);
+  for (int i = 0; i < liczbaZapytan; i++)
+    dlugosci[i] = wcslen(zapytania[i]);
+
+  struct trie * t = NULL;
+  for (int i = 0; i < ile; i++)
+    t = insert(slowa[i], wcslen(slowa[i]), t, 1);
+
+  double start = teraz();
+  struct double_array * da = double_array_build(t);
+  double budowa = teraz() - start;
+
+  long trafienia1 = 0, trafienia2 = 0;
+  start = teraz();
+  for (int i = 0; i < liczbaZapytan; i++)
+    trafienia1 += finder(zapytania[i], dlugosci[i], 0, t);
+  double czasTrie = teraz() - start;
+
+  start = teraz();
+  for (int i = 0; i < liczbaZapytan; i++)
+    trafienia2 += double_array_find(da, zapytania[i], dlugosci[i]);
+  double czasDa = teraz() - start;
+
+  printf("find: %d zapytan, trafienia %ld/%ld\n", liczbaZapytan, trafienia1, trafienia2);
+  printf("  budowa podwojnej tablicy: %.3f s, %u stanow, %u komorek (%.1f MB)\n", budowa,
+    da->liczbaStanow, da->rozmiar, da->rozmiar * sizeof(struct double_array_komorka) / 1e6);
+  printf("  finder:            %.1f ns/zapytanie\n", czasTrie * 1e9 / liczbaZapytan);
+  printf("  double_array_find: %.1f ns/zapytanie (x%.2f)\n",
+    czasDa * 1e9 / liczbaZapytan, czasTrie / czasDa);
+
+  double_array_done(da);
+  clean(t);
+  for (int i = 0; i < liczbaZapytan; i++)
+    free(zapytania[i]);
+  free(zapytania);
+  free(dlugosci);
+}
+
+/** Pomiar przejść po drzewie: wstawianie, wyszukiwanie, przejście kursorem
+    i zapis.
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ */
+static void benchWalk(wchar_t ** slowa, int ile)
+{
+  int * dlugosci = malloc(sizeof(int) * ile);
+  for (int i = 0; i < ile; i++)
+    dlugosci[i] = wcslen(slowa[i]);
+
+  struct trie * t = NULL;
+  double start = teraz();
+  for (int i = 0; i < ile; i++)
+    t = insert(slowa[i], dlugosci[i], t, 1);
+  double czasWstawiania = teraz() - start;
+
+  long trafienia = 0;
+  start = teraz();
+  for (int powtorzenie = 0; powtorzenie < 5; powtorzenie++)
+    for (int i = 0; i < ile; i++)
+      trafienia += finder(slowa[i], dlugosci[i], 0, t);
+  double czasWyszukiwania = teraz() - start;
+
+  long wierzcholki = 0, koncowe = 0;
+  struct trie_kursor kursor;
+  trie_kursor_init(&kursor);
+  start = teraz();
+  trie_kursor_ustaw(&kursor, t);
+  while (trie_kursor_nastepny(&kursor, true))
+  {
+    wierzcholki++;
+    koncowe += trie_kursor_wezel(&kursor)->czySlowo;
+  }
+  double czasPrzejscia = teraz() - start;
+  trie_kursor_done(&kursor);
+
+  FILE * plik = tmpfile();
+  start = teraz();
+  zapis(t, plik, -1);
+  double czasZapisu = teraz() - start;
+  fclose(plik);
+
+  printf("walk: %ld wierzcholkow, %ld slow\n", wierzcholki, koncowe);
+  printf("  insert:  %.1f ns/slowo\n", czasWstawiania * 1e9 / ile);
+  printf("  finder:  %.1f ns/slowo (trafienia %ld)\n", czasWyszukiwania * 1e9 / (5.0 * ile), trafienia);
+  printf("  kursor:  %.1f ns/wierzcholek\n", czasPrzejscia * 1e9 / wierzcholki);
+  printf("  zapis:   %.3f s\n", czasZapisu);
+
+  clean(t);
+  free(dlugosci);
+}
+
+/** Pomiar budowy, wczytywania i niszczenia słownika.
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ */
+static void benchLoad(wchar_t ** slowa, int ile)
+{
+  double start = teraz();
+  struct dictionary * dict = dictionary_new();
+  for (int i = 0; i < ile; i++)
+    dictionary_insert(dict, slowa[i]);
+  double czasWstawiania = teraz() - start;
+
+  /* Słownik wczytujemy z nowo otwartego pliku, tak jak robią to programy,
+     a nie ze strumienia, do którego był przed chwilą zapisywany. */
+  char nazwa[] = "/tmp/dictionary_benchXXXXXX";
+  int fd = mkstemp(nazwa);
+  close(fd);
+  FILE * plik = fopen(nazwa, "w");
+  dictionary_save(dict, plik);
+  fclose(plik);
+  dictionary_done(dict);
+  plik = fopen(nazwa, "r");
+  /* Oddajemy systemowi pamięć zwolnioną po budowie, żeby pomiar
+     pamięci rezydentnej obejmował tylko wczytany słownik. */
+  malloc_trim(0);
+
+  double pamiecPrzed = pamiecMB();
+  start = teraz();
+  dict = dictionary_load(plik);
+  double czasWczytania = teraz() - start;
+  fclose(plik);
+  double pamiecPo = pamiecMB();
+
+  start = teraz();
+  dictionary_freeze(dict);
+  double czasZamrozenia = teraz() - start;
+  malloc_trim(0);
+  double pamiecZamrozonego = pamiecMB();
+
+  dictionary_save_file(dict, nazwa);
+
+  start = teraz();
+  dictionary_done(dict);
+  double czasNiszczenia = teraz() - start;
+
+  malloc_trim(0);
+  pamiecPrzed = pamiecMB();
+  start = teraz();
+  dict = dictionary_load_file(nazwa);
+  double czasMapowania = teraz() - start;
+  long trafienia = 0;
+  for (int i = 0; i < ile; i++)
+    trafienia += dictionary_find(dict, slowa[i]);
+  double pamiecMapy = pamiecMB();
+  dictionary_done(dict);
+  unlink(nazwa);
+
+  printf("load:\n");
+  printf("  dictionary_insert: %.3f s\n", czasWstawiania);
+  printf("  dictionary_load:   %.3f s, +%.1f MB pamieci rezydentnej\n",
+    czasWczytania, pamiecPo - pamiecPrzed);
+  printf("  dictionary_freeze: %.3f s, +%.1f MB pamieci rezydentnej po zamrozeniu\n",
+    czasZamrozenia, pamiecZamrozonego - pamiecPrzed);
+  printf("  dictionary_done:   %.3f s\n", czasNiszczenia);
+  printf("  dictionary_load_file (binarny): %.6f s, +%.1f MB pamieci rezydentnej"
+    " po wyszukaniu wszystkich slow (trafienia %ld)\n",
+    czasMapowania, pamiecMapy - pamiecPrzed, trafienia);
+}
+
+/** Komparator słów w porządku wcscmp().
+ * @param[in] a Wskaźnik na pierwsze słowo.
+ * @param[in] b Wskaźnik na drugie słowo.
+ * @return Wynik porównania.
+ */
+static int porownajSlowa(const void * a, const void * b)
+{
+  return wcscmp(*(wchar_t * const *) a, *(wchar_t * const *) b);
+}
+
+/** Pomiar budowy słownika z posortowanych słów w porównaniu ze
+ * wstawianiem ich pojedynczo.
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ */
+static void benchBuild(wchar_t ** slowa, int ile)
+{
+  const wchar_t ** posortowane = malloc(sizeof(wchar_t *) * ile);
+  memcpy(posortowane, slowa, sizeof(wchar_t *) * ile);
+  qsort(posortowane, ile, sizeof(wchar_t *), porownajSlowa);
+
+  malloc_trim(0);
+  double pamiecPrzed = pamiecMB();
+  double start = teraz();
+  struct dictionary * dict = dictionary_new();
+  for (int i = 0; i < ile; i++)
+    dictionary_insert(dict, posortowane[i]);
+  double czasWstawiania = teraz() - start;
+  double pamiecWstawiania = pamiecMB() - pamiecPrzed;
+  dictionary_done(dict);
+
+  malloc_trim(0);
+  pamiecPrzed = pamiecMB();
+  start = teraz();
+  dict = dictionary_build_sorted(posortowane, ile);
+  double czasBudowy = teraz() - start;
+  double pamiecBudowy = pamiecMB() - pamiecPrzed;
+  long trafienia = 0;
+  for (int i = 0; i < ile; i++)
+    trafienia += dictionary_find(dict, slowa[i]);
+  dictionary_done(dict);
+  free(posortowane);
+
+  printf("build:\n");
+  printf("  dictionary_insert (posortowane): %.3f s, +%.1f MB pamieci rezydentnej\n",
+    czasWstawiania, pamiecWstawiania);
+  printf("  dictionary_build_sorted:         %.3f s, +%.1f MB pamieci rezydentnej"
+    " (trafienia %ld)\n", czasBudowy, pamiecBudowy, trafienia);
+}
+
+/** Pomiar filtru słów spoza słownika na zapytaniach takich, jakie zadaje
+ * generowanie podpowiedzi: słowa ze słownika z jedną literą zamienioną na
+ * każdą inną.
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ */
+static void benchFilter(wchar_t ** slowa, int ile)
+{
+  struct dictionary * dict = dictionary_new();
+  for (int i = 0; i < ile; i++)
+    dictionary_insert(dict, slowa[i]);
+  int liczbaLiter = wcslen(litery);
+  int probki = ile < 20000 ? ile : 20000;
+
+  printf("filter:\n");
+  for (int zamrozony = 0; zamrozony < 2; zamrozony++)
+  {
+    if (zamrozony)
+      dictionary_freeze(dict);
+    double czasy[2];
+    struct dictionary_stats stats;
+    for (int filtr = 0; filtr < 2; filtr++)
+    {
+      dictionary_filter(dict, filtr);
+      dictionary_reset_stats(dict);
+      long trafienia = 0;
+      wchar_t kandydat[MAX_DLUGOSC + 1];
+      double start = teraz();
+      for (int i = 0; i < probki; i++)
+      {
+        const wchar_t * slowo = slowa[(long) i * ile / probki];
+        int dlugosc = wcslen(slowo);
+        wmemcpy(kandydat, slowo, dlugosc + 1);
+        for (int j = 0; j < dlugosc; j++)
+        {
+          for (int k = 0; k < liczbaLiter; k++)
+          {
+            kandydat[j] = litery[k];
+            trafienia += dictionary_find(dict, kandydat);
+          }
+          kandydat[j] = slowo[j];
+        }
+      }
+      czasy[filtr] = teraz() - start;
+      dictionary_get_stats(dict, &stats);
+    }
+    printf("  %s: %llu zapytan, %llu spoza slownika, bez filtru %.3f s,"
+      " z filtrem %.3f s (x%.2f)\n", zamrozony ? "zamrozony" : "drzewo",
+      stats.lookups, stats.misses, czasy[0], czasy[1], czasy[0] / czasy[1]);
+    printf("    filtr %.1f MB, odrzucil %.1f%% zapytan spoza slownika\n",
+      stats.filter_bytes / 1048576.0, 100.0 * stats.filter_rejects / stats.misses);
+  }
+  dictionary_done(dict);
+}
+
+/** Sprawdzenie osobnym wyszukiwaniem każdego kandydata odległego od słowa
+ * o jedną zamianę, usunięcie lub wstawienie litery, tak jak robiło to
+ * wcześniejsze generowanie podpowiedzi.
+ * @param[in] dict Słownik.
+ * @param[in] slowo Słowo.
+ * @return Liczba kandydatów w słowniku.
+ */
+static long kandydaci(const struct dictionary * dict, const wchar_t * slowo)
+{
+  int dlugosc = wcslen(slowo);
+  int liczbaLiter = wcslen(litery);
+  wchar_t kandydat[MAX_DLUGOSC + 2];
+  long trafienia = 0;
+  /* zamiany */
+  wmemcpy(kandydat, slowo, dlugosc + 1);
+  for (int j = 0; j < dlugosc; j++)
+  {
+    for (int k = 0; k < liczbaLiter; k++)
+    {
+      kandydat[j] = litery[k];
+      trafienia += dictionary_find(dict, kandydat);
+    }
+    kandydat[j] = slowo[j];
+  }
+  /* usunięcia */
+  for (int j = 0; j < dlugosc; j++)
+  {
+    wmemcpy(kandydat, slowo, j);
+    wmemcpy(kandydat + j, slowo + j + 1, dlugosc - j);
+    trafienia += dictionary_find(dict, kandydat);
+  }
+  /* wstawienia */
+  for (int j = 0; j <= dlugosc; j++)
+  {
+    wmemcpy(kandydat, slowo, j);
+    wmemcpy(kandydat + j + 1, slowo + j, dlugosc - j + 1);
+    for (int k = 0; k < liczbaLiter; k++)
+    {
+      kandydat[j] = litery[k];
+      trafienia += dictionary_find(dict, kandydat);
+    }
+  }
+  return trafienia;
+}
+
+/** Pomiar podpowiedzi: sprawdzanie każdego kandydata odległego o jedną
+ * edycję osobnym wyszukiwaniem oraz jedno przejście słownika z tablicą
+ * odległości, dla odległości 1 i 2, na końcu z indeksem podpowiedzi.
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ */
+static void benchHints(wchar_t ** slowa, int ile)
+{
+  struct dictionary * dict = dictionary_new();
+  for (int i = 0; i < ile; i++)
+    dictionary_insert(dict, slowa[i]);
+  int probki = ile < 5000 ? ile : 5000;
+  wchar_t zmienione[MAX_DLUGOSC + 1];
+
+  printf("hints (%d slow z jedna zmieniona litera):\n", probki);
+  /* Kolejno: drzewo, zamrożony słownik i zamrożony słownik z indeksem. */
+  for (int tryb = 0; tryb < 3; tryb++)
+  {
+    double czasIndeksu = 0;
+    if (tryb == 1)
+      dictionary_freeze(dict);
+    if (tryb == 2)
+    {
+      double start = teraz();
+      dictionary_hint_index(dict, LEVENSHTEIN_MAKS_ODLEGLOSC);
+      czasIndeksu = teraz() - start;
+    }
+    long trafienia = 0;
+    double start = teraz();
+    for (int i = 0; i < probki; i++)
+    {
+      const wchar_t * slowo = slowa[(long) i * ile / probki];
+      wcscpy(zmienione, slowo);
+      zmienione[i % wcslen(slowo)] = litery[i % wcslen(litery)];
+      trafienia += kandydaci(dict, zmienione);
+    }
+    double czasKandydatow = teraz() - start;
+    double czasy[LEVENSHTEIN_MAKS_ODLEGLOSC + 1];
+    long podpowiedzi[LEVENSHTEIN_MAKS_ODLEGLOSC + 1];
+    for (int odleglosc = 1; odleglosc <= LEVENSHTEIN_MAKS_ODLEGLOSC; odleglosc++)
+    {
+      podpowiedzi[odleglosc] = 0;
+      start = teraz();
+      for (int i = 0; i < probki; i++)
+      {
+        const wchar_t * slowo = slowa[(long) i * ile / probki];
+        wcscpy(zmienione, slowo);
+        zmienione[i % wcslen(slowo)] = litery[i % wcslen(litery)];
+        struct word_list lista;
+        dictionary_edit_hints(dict, zmienione, odleglosc, true, &lista);
+        podpowiedzi[odleglosc] += word_list_size(&lista);
+        word_list_done(&lista);
+      }
+      czasy[odleglosc] = teraz() - start;
+    }
+    printf("  %s: kandydaci %.1f us/slowo (%ld trafien), przejscie odl. 1"
+      " %.1f us/slowo (%ld podpowiedzi), odl. 2 %.1f us/slowo (%ld podpowiedzi)\n",
+      tryb == 0 ? "drzewo" : tryb == 1 ? "zamrozony" : "indeks", 1e6 * czasKandydatow / probki,
+      trafienia, 1e6 * czasy[1] / probki, podpowiedzi[1], 1e6 * czasy[2] / probki,
+      podpowiedzi[2]);
+    if (tryb == 2)
+    {
+      struct dictionary_stats stats;
+      dictionary_get_stats(dict, &stats);
+      printf("  indeks: budowa %.2f s, %.1f MB\n", czasIndeksu, stats.hint_index_bytes / 1e6);
+    }
+  }
+  dictionary_done(dict);
+}
+
+/** Funkcja dodająca reguły pomiarów: zamiany każdej litery na każdą inną
+ * (kilkaset reguł bez zmiennych) oraz reguły ze zmiennymi usuwające,
+ * wstawiające i przestawiające litery i rozdzielające słowo.
+ * @param[in,out] dict Słownik.
+ * @return Liczba dodanych reguł.
+ */
+static int dodajReguly(struct dictionary * dict)
+{
+  int liczbaLiter = wcslen(litery), liczbaRegul = 0;
+  for (int i = 0; i < liczbaLiter; i++)
+    for (int j = 0; j < liczbaLiter; j++)
+    {
+      wchar_t lewa[2] = { litery[i], L'\0' }, prawa[2] = { litery[j], L'\0' };
+      if (i != j)
+        liczbaRegul += dictionary_rule_add(dict, lewa, prawa, false, 1, RULE_NORMAL);
+    }
+  liczbaRegul += dictionary_rule_add(dict, L"01", L"10", false, 1, RULE_NORMAL);
+  liczbaRegul += dictionary_rule_add(dict, L"0", L"", true, 2, RULE_NORMAL);
+  liczbaRegul += dictionary_rule_add(dict, L"", L"", false, 2, RULE_SPLIT);
+  dictionary_hints_max_cost(dict, 2);
+  return liczbaRegul;
+}
+
+/** Pomiar podpowiedzi według reguł (patrz dodajReguly()).
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ */
+static void benchRules(wchar_t ** slowa, int ile)
+{
+  struct dictionary * dict = dictionary_new();
+  for (int i = 0; i < ile; i++)
+    dictionary_insert(dict, slowa[i]);
+  int liczbaLiter = wcslen(litery), liczbaRegul = dodajReguly(dict);
+  int probki = ile < 2000 ? ile : 2000;
+  wchar_t zmienione[MAX_DLUGOSC + 1];
+
+  printf("rules (%d regul, %d slow z jedna zmieniona litera):\n", liczbaRegul, probki);
+  for (int zamrozony = 0; zamrozony < 2; zamrozony++)
+  {
+    if (zamrozony)
+      dictionary_freeze(dict);
+    long podpowiedzi = 0;
+    double start = teraz();
+    for (int i = 0; i < probki; i++)
+    {
+      const wchar_t * slowo = slowa[(long) i * ile / probki];
+      wcscpy(zmienione, slowo);
+      zmienione[i % wcslen(slowo)] = litery[i % liczbaLiter];
+      struct word_list lista;
+      dictionary_hints(dict, zmienione, &lista);
+      podpowiedzi += word_list_size(&lista);
+      word_list_done(&lista);
+    }
+    double czas = teraz() - start;
+    printf("  %s: %.1f us/slowo (%ld podpowiedzi)\n", zamrozony ? "zamrozony" : "drzewo",
+      1e6 * czas / probki, podpowiedzi);
+  }
+  dictionary_done(dict);
+}
+
+/** Pomiar pamięci podręcznej podpowiedzi: zamrożony słownik z regułami
+ * i strumień zapytań, w którym, jak w prawdziwym tekście, część błędnych
+ * słów powtarza się wielokrotnie (rozkład zbliżony do prawa Zipfa).
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ */
+static void benchCache(wchar_t ** slowa, int ile)
+{
+  struct dictionary * dict = dictionary_new();
+  for (int i = 0; i < ile; i++)
+    dictionary_insert(dict, slowa[i]);
+  dodajReguly(dict);
+  dictionary_freeze(dict);
+  int liczbaLiter = wcslen(litery);
+  int rozne = ile < 5000 ? ile : 5000, zapytania = 4 * rozne;
+  wchar_t ** bledne = malloc(sizeof(wchar_t *) * rozne);
+  for (int i = 0; i < rozne; i++)
+  {
+    const wchar_t * slowo = slowa[(long) i * ile / rozne];
+    bledne[i] = malloc(sizeof(wchar_t) * (MAX_DLUGOSC + 1));
+    wcscpy(bledne[i], slowo);
+    bledne[i][i % wcslen(slowo)] = litery[i % liczbaLiter];
+  }
+  int * kolejne = malloc(sizeof(int) * zapytania);
+  for (int i = 0; i < zapytania; i++)
+  {
+    /* Słowo numer k pojawia się z prawdopodobieństwem około 1 / (k + 1). */
+    double u = (losuj() % 1000000) / 1e6;
+    kolejne[i] = (int) (exp(u * log(rozne + 1.0))) - 1;
+  }
+
+  printf("cache (%d zapytan, %d roznych slow z jedna zmieniona litera):\n",
+    zapytania, rozne);
+  int pojemnosci[] = { 0, 256, 4096 };
+  for (int tryb = 0; tryb < 3; tryb++)
+  {
+    dictionary_hint_cache(dict, pojemnosci[tryb]);
+    dictionary_reset_stats(dict);
+    long podpowiedzi = 0;
+    double start = teraz();
+    for (int i = 0; i < zapytania; i++)
+    {
+      struct word_list lista;
+      dictionary_hints(dict, bledne[kolejne[i]], &lista);
+      podpowiedzi += word_list_size(&lista);
+      word_list_done(&lista);
+    }
+    double czas = teraz() - start;
+    struct dictionary_stats stats;
+    dictionary_get_stats(dict, &stats);
+    printf("  pojemnosc %d: %.1f us/slowo (%ld podpowiedzi, %llu trafien, %llu chybien)\n",
+      pojemnosci[tryb], 1e6 * czas / zapytania, podpowiedzi,
+      stats.hint_cache_hits, stats.hint_cache_misses);
+  }
+  for (int i = 0; i < rozne; i++)
+    free(bledne[i]);
+  free(bledne);
+  free(kolejne);
+  dictionary_done(dict);
+}
+
+/** Pomiar wyszukiwania podpowiedzi według reguł w wątkach: długie słowa
+ * (dwa słowa słownika sklejone, z jedną zmienioną literą) i maksymalny
+ * koszt 3, dla 1 do 16 wątków. Sprawdza też, czy podpowiedzi są takie
+ * same jak w jednym wątku.
+ * @param[in] slowa Słowa słownika.
+ * @param[in] ile Liczba słów.
+ */
+static void benchThreads(wchar_t ** slowa, int ile)
+{
+  struct dictionary * dict = dictionary_new();
+  for (int i = 0; i < ile; i++)
+    dictionary_insert(dict, slowa[i]);
+  dodajReguly(dict);
+  dictionary_hints_max_cost(dict, 3);
+  dictionary_freeze(dict);
+  int liczbaLiter = wcslen(litery);
+  int probki = ile < 100 ? ile : 100;
+  wchar_t ** dlugie = malloc(sizeof(wchar_t *) * probki);
+  for (int i = 0; i < probki; i++)
+  {
+    dlugie[i] = malloc(sizeof(wchar_t) * (2 * MAX_DLUGOSC + 1));
+    wcscpy(dlugie[i], slowa[(long) i * ile / probki]);
+    wcscat(dlugie[i], slowa[losuj() % ile]);
+    dlugie[i][i % wcslen(dlugie[i])] = litery[i % liczbaLiter];
+  }
+
+  printf("threads (%d slow, maksymalny koszt 3, %ld procesorow):\n", probki,
+    sysconf(_SC_NPROCESSORS_ONLN));
+  double jeden = 0;
+  unsigned long long wzorzec = 0;
+  for (int watki = 1; watki <= 16; watki *= 2)
+  {
+    dictionary_hint_threads(dict, watki);
+    unsigned long long skrot = 0;
+    double start = teraz();
+    for (int i = 0; i < probki; i++)
+    {
+      struct word_list lista;
+      dictionary_hints(dict, dlugie[i], &lista);
+      for (size_t j = 0; j < word_list_size(&lista); j++)
+        for (const wchar_t * c = word_list_get(&lista)[j]; *c; c++)
+          skrot = skrot * 31 + *c;
+      word_list_done(&lista);
+    }
+    double czas = teraz() - start;
+    if (watki == 1)
+    {
+      jeden = czas;
+      wzorzec = skrot;
+    }
+    printf("  %2d watkow: %.0f us/slowo, przyspieszenie %.2f%s\n", watki,
+      1e6 * czas / probki, jeden / czas, skrot == wzorzec ? "" : " (INNE WYNIKI)");
+  }
+  for (int i = 0; i < probki; i++)
+    free(dlugie[i]);
+  free(dlugie);
+  dictionary_done(dict);
+}
+
+/**
+  Funkcja main.
+  @param[in] argc Liczba argumentów.
+  @param[in] argv Opcjonalnie liczba tematów i nazwa pomiaru.
+  @return 0.
+ */
+int main(int argc, char * argv[])
+{
+  if (setlocale(LC_ALL, "pl_PL.UTF-8") == NULL)
+    setlocale(LC_ALL, "C.UTF-8");
+  int tematy = argc > 1 ? atoi(argv[1]) : DOMYSLNA_LICZBA_TEMATOW;
+  const char * pomiar = argc > 2 ? argv[2] : NULL;
+  int ile = 0;
+  wchar_t ** slowa = generujSlowa(tematy, &ile);
+  printf("slownik: %d slow\n", ile);
+
+  if (pomiar == NULL || !strcmp(pomiar, "find"))
+    benchFind(slowa, ile);
+  if (pomiar == NULL || !strcmp(pomiar, "walk"))
+    benchWalk(slowa, ile);
+  if (pomiar == NULL || !strcmp(pomiar, "load"))
+    benchLoad(slowa, ile);
+  if (pomiar == NULL || !strcmp(pomiar, "build"))
+    benchBuild(slowa, ile);
+  if (pomiar == NULL || !strcmp(pomiar, "filter"))
+    benchFilter(slowa, ile);
+  if (pomiar == NULL || !strcmp(pomiar, "hints"))
+    benchHints(slowa, ile);
+  if (pomiar == NULL || !strcmp(pomiar, "rules"))
+    benchRules(slowa, ile);
+  if (pomiar == NULL || !strcmp(pomiar, "cache"))
+    benchCache(slowa, ile);
+  if (pomiar == NULL || !strcmp(pomiar, "threads"))
+    benchThreads(slowa, ile);
+
+  for (int i = 0; i < ile; i++)
+    free(slowa[i]);
+  free(slowa);
+  return 0;
+}
@@ -2,8 +2,12 @@
 #include <stddef.h>
 #include <setjmp.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <cmocka.h>
+#include <string.h>
+#include <unistd.h>
 #include "dictionary.h"
+#include "watki.h"
 
 wchar_t* test   = L"Test string";
 wchar_t* first  = L"First string";
@@ -58,6 +62,791 @@ static void dictionary_delete_non_existing(void ** state){
   assert_int_equal(dictionary_delete(d, test), 0);
 }
 
+static void dictionary_freeze_test(void ** state){
+  struct dictionary * d = * state;
+  dictionary_freeze(d);
+  assert_true(dictionary_find(d, first));
+  assert_true(!dictionary_find(d, test));
+  assert_int_equal(dictionary_insert(d, test), 1);
+  assert_true(dictionary_find(d, test));
+  dictionary_freeze(d);
+  assert_int_equal(dictionary_delete(d, first), 1);
+  assert_true(!dictionary_find(d, first));
+  assert_true(dictionary_find(d, test));
+}
+
+static void dictionary_binary_file_test(void ** state){
+  struct dictionary * d = dictionary_new();
+  dictionary_insert(d, L"kot");
+  dictionary_insert(d, L"kotek");
+  dictionary_insert(d, L"pies");
+  char nazwa[] = "/tmp/dictionary_testXXXXXX";
+  int fd = mkstemp(nazwa);
+  assert_true(fd >= 0);
+  close(fd);
+
+  /* plik tekstowy dalej daje się wczytać */
+  FILE * f = fopen(nazwa, "w");
+  dictionary_save(d, f);
+  fclose(f);
+  struct dictionary * e = dictionary_load_file(nazwa);
+  assert_non_null(e);
+  assert_true(dictionary_find(e, L"kotek"));
+  assert_true(!dictionary_find(e, L"kote"));
+  dictionary_done(e);
+
+  dictionary_insert(d, L"źdźbło");
+  assert_int_equal(dictionary_save_file(d, nazwa), 0);
+  e = dictionary_load_file(nazwa);
+  assert_non_null(e);
+  assert_true(dictionary_find(e, L"kot"));
+  assert_true(dictionary_find(e, L"źdźbło"));
+  assert_true(!dictionary_find(e, L"kote"));
+  /* słownik wczytany z pliku można dalej zmieniać */
+  assert_int_equal(dictionary_insert(e, L"kotka"), 1);
+  assert_int_equal(dictionary_delete(e, L"kot"), 1);
+  assert_true(dictionary_find(e, L"kotka"));
+  assert_true(!dictionary_find(e, L"kot"));
+  dictionary_done(e);
+  dictionary_done(d);
+
+  /* zapis wczytanego słownika do jego własnego pliku, bez zmian */
+  for (int krok = 0; krok < 3; krok++) {
+    e = dictionary_load_file(nazwa);
+    assert_non_null(e);
+    if (krok == 1)
+      assert_int_equal(dictionary_hint_index(e, 1), 0);
+    if (krok == 2)
+      assert_int_equal(dictionary_rule_add(e, L"t", L"s", false, 1, RULE_NORMAL), 1);
+    assert_int_equal(dictionary_save_file(e, nazwa), 0);
+    assert_int_equal(dictionary_save_file(e, nazwa), 0);
+    assert_true(dictionary_find(e, L"kotek"));
+    dictionary_done(e);
+    e = dictionary_load_file(nazwa);
+    assert_non_null(e);
+    assert_true(dictionary_find(e, L"kot"));
+    assert_true(dictionary_find(e, L"źdźbło"));
+    assert_true(!dictionary_find(e, L"kote"));
+    dictionary_done(e);
+  }
+  unlink(nazwa);
+  assert_null(dictionary_load_file(nazwa));
+}
+
+static void dictionary_alphabet_limit_test(void ** state){
+  /* Za duży alfabet: słownik zostaje drzewem i nie zapisuje się binarnie. */
+  struct dictionary_builder * b = dictionary_builder_new();
+  wchar_t word[101];
+  for (int poczatek = 0; poczatek <= 65534; poczatek += 100) {
+    for (int i = 0; i < 100; i++)
+      word[i] = 0x400 + poczatek + i;
+    word[100] = L'\0';
+    assert_int_equal(dictionary_builder_add(b, word), 1);
+  }
+  struct dictionary * d = dictionary_builder_finish(b);
+  dictionary_freeze(d);
+  assert_true(dictionary_find(d, word));
+  word[99] = L'\0';
+  assert_true(!dictionary_find(d, word));
+  char nazwa[] = "/tmp/dictionary_testXXXXXX";
+  int fd = mkstemp(nazwa);
+  assert_true(fd >= 0);
+  close(fd);
+  assert_true(dictionary_save_file(d, nazwa) < 0);
+  unlink(nazwa);
+  dictionary_done(d);
+}
+
+static long dictionary_read_file(const char * nazwa, char * bufor, long rozmiar){
+  FILE * f = fopen(nazwa, "rb");
+  long ile = fread(bufor, 1, rozmiar, f);
+  fclose(f);
+  return ile;
+}
+
+/* Zapisuje zmieniony bajt pliku i sprawdza, że plik nie daje się wczytać. */
+static void dictionary_corrupt_file(const char * nazwa, const char * dane, long ile,
+  long miejsce, const void * wartosc, size_t rozmiar){
+  static char zmienione[4096];
+  memcpy(zmienione, dane, ile);
+  memcpy(zmienione + miejsce, wartosc, rozmiar);
+  FILE * f = fopen(nazwa, "wb");
+  fwrite(zmienione, 1, ile, f);
+  fclose(f);
+  assert_null(dictionary_load_file(nazwa));
+}
+
+static void dictionary_corrupt_file_test(void ** state){
+  struct dictionary * d = dictionary_new();
+  dictionary_insert(d, L"kot");
+  dictionary_insert(d, L"pies");
+  assert_int_equal(dictionary_rule_add(d, L"t", L"s", false, 1, RULE_NORMAL), 1);
+  char nazwa[] = "/tmp/dictionary_testXXXXXX";
+  int fd = mkstemp(nazwa);
+  assert_true(fd >= 0);
+  close(fd);
+  assert_int_equal(dictionary_save_file(d, nazwa), 0);
+  dictionary_done(d);
+  static char dane[4096];
+  long ile = dictionary_read_file(nazwa, dane, sizeof(dane));
+  assert_true(ile > 8 && ile < (long) sizeof(dane));
+  d = dictionary_load_file(nazwa);
+  assert_non_null(d);
+  dictionary_done(d);
+
+  /* ostatnia komórka tablicy: baza poza tablicą, etykieta spoza alfabetu */
+  uint32_t baza = 0xfffffff0;
+  dictionary_corrupt_file(nazwa, dane, ile, ile - 8, &baza, sizeof(baza));
+  uint16_t etykieta = 1000;
+  dictionary_corrupt_file(nazwa, dane, ile, ile - 4, &etykieta, sizeof(etykieta));
+
+  /* reguła bez końca lewej strony i reguła o zerowym koszcie */
+  const wchar_t strony[] = L"t\0s";
+  long regula = 0;
+  while (regula + (long) sizeof(strony) <= ile &&
+    memcmp(dane + regula, strony, sizeof(strony)))
+    regula++;
+  assert_true(regula + (long) sizeof(strony) <= ile);
+  wchar_t litera = L'x';
+  dictionary_corrupt_file(nazwa, dane, ile, regula + sizeof(wchar_t), &litera, sizeof(litera));
+  int32_t koszt = 0;
+  dictionary_corrupt_file(nazwa, dane, ile, regula - 8, &koszt, sizeof(koszt));
+  unlink(nazwa);
+}
+
+static void dictionary_build_sorted_test(void ** state){
+  const wchar_t * words[] = { L"kot", L"kotek", L"kotka", L"pies", L"pies", L"źdźbło" };
+  struct dictionary * d = dictionary_new();
+  for (int i = 0; i < 6; i++)
+    dictionary_insert(d, words[i]);
+  struct dictionary * e = dictionary_build_sorted(words, 6);
+  assert_non_null(e);
+  for (int i = 0; i < 6; i++)
+    assert_true(dictionary_find(e, words[i]));
+  assert_true(!dictionary_find(e, L"kote"));
+
+  /* ten sam słownik co po wstawianiu słów, razem z alfabetem */
+  char nazwa[] = "/tmp/dictionary_testXXXXXX";
+  int fd = mkstemp(nazwa);
+  close(fd);
+  static char zWstawiania[4096], zBudowy[4096];
+  dictionary_save_file(d, nazwa);
+  long ile = dictionary_read_file(nazwa, zWstawiania, sizeof(zWstawiania));
+  dictionary_save_file(e, nazwa);
+  assert_int_equal(dictionary_read_file(nazwa, zBudowy, sizeof(zBudowy)), ile);
+  assert_true(memcmp(zWstawiania, zBudowy, ile) == 0);
+  unlink(nazwa);
+  dictionary_done(d);
+  dictionary_done(e);
+
+  const wchar_t * unsorted[] = { L"kot", L"pies", L"kotek" };
+  assert_null(dictionary_build_sorted(unsorted, 3));
+
+  struct dictionary_builder * b = dictionary_builder_new();
+  assert_int_equal(dictionary_builder_add(b, L"ala"), 1);
+  assert_int_equal(dictionary_builder_add(b, L"ala"), 0);
+  assert_true(dictionary_builder_add(b, L"al") < 0);
+  assert_int_equal(dictionary_builder_add(b, L"alan"), 1);
+  e = dictionary_builder_finish(b);
+  assert_true(dictionary_find(e, L"ala"));
+  assert_true(dictionary_find(e, L"alan"));
+  assert_true(!dictionary_find(e, L"al"));
+  assert_int_equal(dictionary_insert(e, L"al"), 1);
+  assert_true(dictionary_find(e, L"al"));
+  dictionary_done(e);
+}
+
+static void dictionary_filter_test(void ** state){
+  struct dictionary * d = * state;
+  struct dictionary_stats stats;
+  assert_false(dictionary_filter(d, true));
+  assert_true(dictionary_find(d, first));
+  assert_true(!dictionary_find(d, test));
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.lookups, 2);
+  assert_int_equal(stats.misses, 1);
+  assert_int_equal(stats.filter_rejects + stats.filter_false_positives, 1);
+  assert_int_equal(stats.filter_words, 3);
+  assert_true(stats.filter_bytes > 0);
+
+  /* filtr nadąża za wstawianiem i usuwaniem */
+  for (int i = 0; i < 500; i++) {
+    wchar_t slowo[8];
+    swprintf(slowo, 8, L"s%d", i);
+    assert_int_equal(dictionary_insert(d, slowo), 1);
+    assert_int_equal(dictionary_insert(d, slowo), 0);
+  }
+  assert_int_equal(dictionary_delete(d, first), 1);
+  assert_true(!dictionary_find(d, first));
+  dictionary_freeze(d);
+  for (int i = 0; i < 500; i++) {
+    wchar_t slowo[8];
+    swprintf(slowo, 8, L"s%d", i);
+    assert_true(dictionary_find(d, slowo));
+  }
+  assert_true(dictionary_find(d, second));
+
+  /* zamrożony słownik nie pyta filtru */
+  dictionary_reset_stats(d);
+  assert_true(!dictionary_find(d, test));
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.filter_rejects + stats.filter_false_positives, 0);
+
+  dictionary_reset_stats(d);
+  assert_true(dictionary_filter(d, false));
+  assert_true(!dictionary_find(d, test));
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.lookups, 1);
+  assert_int_equal(stats.filter_rejects, 0);
+  assert_int_equal(stats.filter_bytes, 0);
+}
+
+static void dictionary_edit_hints_test(void** state) {
+  const wchar_t * slowa[] = { L"kot", L"kto", L"koty", L"lot", L"pies" };
+  struct dictionary * d = dictionary_new();
+  struct word_list l;
+  for (int i = 0; i < 5; i++)
+    dictionary_insert(d, slowa[i]);
+  for (int zamrozony = 0; zamrozony < 2; zamrozony++) {
+    if (zamrozony)
+      dictionary_freeze(d);
+    dictionary_hints(d, L"kt", &l);
+    assert_int_equal(word_list_size(&l), 2);
+    assert_true(!wcscmp(word_list_get(&l)[0], L"kot"));
+    assert_true(!wcscmp(word_list_get(&l)[1], L"kto"));
+    word_list_done(&l);
+    assert_int_equal(dictionary_edit_hints(d, L"okt", 1, false, &l), 0);
+    assert_int_equal(word_list_size(&l), 0);
+    word_list_done(&l);
+    assert_int_equal(dictionary_edit_hints(d, L"okt", 1, true, &l), 0);
+    assert_int_equal(word_list_size(&l), 1);
+    assert_true(!wcscmp(word_list_get(&l)[0], L"kot"));
+    word_list_done(&l);
+    assert_int_equal(dictionary_edit_hints(d, L"piesy", 2, false, &l), 0);
+    assert_int_equal(word_list_size(&l), 1);
+    word_list_done(&l);
+    assert_true(dictionary_edit_hints(d, L"kot", 3, false, &l) < 0);
+    assert_int_equal(word_list_size(&l), 0);
+    word_list_done(&l);
+  }
+  dictionary_done(d);
+}
+
+static void dictionary_hints_limit_test(void** state) {
+  /* słowo ma więcej sąsiadów niż mieści się w podpowiedziach */
+  struct dictionary * d = dictionary_new();
+  dictionary_insert(d, L"k");
+  for (wchar_t c = L'z'; c >= L'a'; c--) {
+    wchar_t slowo[3] = { L'k', c, L'\0' };
+    dictionary_insert(d, slowo);
+    slowo[0] = c;
+    slowo[1] = L'k';
+    dictionary_insert(d, slowo);
+  }
+  for (int zamrozony = 0; zamrozony < 2; zamrozony++) {
+    if (zamrozony)
+      dictionary_freeze(d);
+    struct word_list l;
+    dictionary_hints(d, L"k", &l);
+    assert_int_equal(word_list_size(&l), DICTIONARY_MAX_HINTS);
+    /* samo słowo i najwcześniejsze w kolejności słownikowej o koszcie 1 */
+    struct word_list wszystkie;
+    assert_int_equal(dictionary_edit_hints(d, L"k", 1, false, &wszystkie), 0);
+    assert_int_equal(word_list_size(&wszystkie), 52);
+    for (int i = 0; i < DICTIONARY_MAX_HINTS; i++)
+      assert_true(!wcscmp(word_list_get(&l)[i], word_list_get(&wszystkie)[i]));
+    word_list_done(&wszystkie);
+    word_list_done(&l);
+    /* z regułami tak samo */
+    dictionary_rule_add(d, L"", L"0", true, 1, RULE_NORMAL);
+    dictionary_hints_max_cost(d, 1);
+    dictionary_hints(d, L"k", &l);
+    assert_int_equal(word_list_size(&l), DICTIONARY_MAX_HINTS);
+    assert_true(!wcscmp(word_list_get(&l)[0], L"ak"));
+    assert_true(!wcscmp(word_list_get(&l)[DICTIONARY_MAX_HINTS - 1], L"ki"));
+    word_list_done(&l);
+    dictionary_rule_clear(d);
+  }
+  dictionary_done(d);
+}
+
+/* Podpowiedzi z wypełnionej listy jako jeden napis, słowa oddzielone
+   spacjami; lista jest niszczona. */
+static void dictionary_hints_text(struct word_list * l, wchar_t * tekst) {
+  tekst[0] = L'\0';
+  for (size_t i = 0; i < word_list_size(l); i++) {
+    wcscat(tekst, word_list_get(l)[i]);
+    wcscat(tekst, L" ");
+  }
+  word_list_done(l);
+}
+
+static void dictionary_hint_index_test(void** state) {
+  const wchar_t * slowa[] = { L"kot", L"kto", L"koty", L"lot", L"pies", L"kotek" };
+  const wchar_t * wzorce[] = { L"kot", L"okt", L"ot", L"kotyk", L"pis", L"" };
+  struct dictionary * d = dictionary_new();
+  for (int i = 0; i < 6; i++)
+    dictionary_insert(d, slowa[i]);
+  wchar_t oczekiwane[6][3][64], tekst[64];
+  struct word_list l;
+  for (int i = 0; i < 6; i++)
+    for (int k = 0; k <= 2; k++) {
+      assert_int_equal(dictionary_edit_hints(d, wzorce[i], k, true, &l), 0);
+      dictionary_hints_text(&l, oczekiwane[i][k]);
+    }
+
+  struct dictionary_stats stats;
+  assert_true(dictionary_hint_index(d, 3) < 0);
+  assert_int_equal(dictionary_hint_index(d, 1), 0);
+  assert_int_equal(dictionary_hint_index(d, 2), 1);
+  dictionary_get_stats(d, &stats);
+  assert_true(stats.hint_index_bytes > 0);
+  for (int i = 0; i < 6; i++)
+    for (int k = 0; k <= 2; k++) {
+      assert_int_equal(dictionary_edit_hints(d, wzorce[i], k, true, &l), 0);
+      dictionary_hints_text(&l, tekst);
+      assert_true(!wcscmp(tekst, oczekiwane[i][k]));
+    }
+
+  /* indeks nadąża za wstawianiem i usuwaniem */
+  assert_int_equal(dictionary_delete(d, L"koty"), 1);
+  assert_int_equal(dictionary_insert(d, L"kota"), 1);
+  assert_int_equal(dictionary_edit_hints(d, L"kot", 1, true, &l), 0);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kot kota kto lot "));
+
+  /* i jest zapisywany razem ze słownikiem */
+  char nazwa[] = "/tmp/dictionary_testXXXXXX";
+  int fd = mkstemp(nazwa);
+  assert_true(fd >= 0);
+  close(fd);
+  assert_int_equal(dictionary_save_file(d, nazwa), 0);
+  struct dictionary * e = dictionary_load_file(nazwa);
+  assert_non_null(e);
+  dictionary_get_stats(e, &stats);
+  assert_true(stats.hint_index_bytes > 0);
+  assert_int_equal(dictionary_edit_hints(e, L"kot", 1, true, &l), 0);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kot kota kto lot "));
+  assert_int_equal(dictionary_insert(e, L"koc"), 1);
+  assert_int_equal(dictionary_delete(e, L"lot"), 1);
+  assert_int_equal(dictionary_edit_hints(e, L"kot", 1, true, &l), 0);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"koc kot kota kto "));
+  assert_int_equal(dictionary_hint_index(e, 0), 2);
+  dictionary_get_stats(e, &stats);
+  assert_int_equal(stats.hint_index_bytes, 0);
+  assert_int_equal(dictionary_edit_hints(e, L"kot", 1, true, &l), 0);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"koc kot kota kto "));
+  dictionary_done(e);
+
+  /* plik bez indeksu */
+  assert_int_equal(dictionary_hint_index(d, 0), 2);
+  assert_int_equal(dictionary_save_file(d, nazwa), 0);
+  e = dictionary_load_file(nazwa);
+  assert_non_null(e);
+  dictionary_get_stats(e, &stats);
+  assert_int_equal(stats.hint_index_bytes, 0);
+  dictionary_done(e);
+  unlink(nazwa);
+  dictionary_done(d);
+}
+
+static void dictionary_hint_cache_test(void** state) {
+  const wchar_t * slowa[] = { L"kot", L"kto", L"koty", L"lot" };
+  struct dictionary * d = dictionary_new();
+  for (int i = 0; i < 4; i++)
+    dictionary_insert(d, slowa[i]);
+  struct dictionary_stats stats;
+  struct word_list l;
+  wchar_t tekst[64];
+  assert_true(dictionary_hint_cache(d, -1) < 0);
+  assert_int_equal(dictionary_hint_cache(d, 2), 0);
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kot koty lot "));
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kot koty lot "));
+  dictionary_hints(d, L"xyz", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L""));
+  dictionary_hints(d, L"xyz", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L""));
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.hint_cache_hits, 2);
+  assert_int_equal(stats.hint_cache_misses, 2);
+  assert_int_equal(stats.hint_cache_entries, 2);
+  /* najdawniej użyte kot wypada */
+  dictionary_hints(d, L"kta", &l);
+  dictionary_hints_text(&l, tekst);
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.hint_cache_misses, 4);
+
+  /* każda zmiana słownika czyści pamięć */
+  assert_int_equal(dictionary_insert(d, L"kos"), 1);
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.hint_cache_entries, 0);
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kos kot koty lot "));
+  assert_int_equal(dictionary_delete(d, L"lot"), 1);
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kos kot koty "));
+  assert_int_equal(dictionary_rule_add(d, L"01", L"10", false, 1, RULE_NORMAL), 1);
+  assert_int_equal(dictionary_hints_max_cost(d, 1), 0);
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kot kto "));
+  dictionary_hints_max_cost(d, 0);
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kot "));
+  /* ten sam koszt niczego nie zmienia */
+  dictionary_hints_max_cost(d, 0);
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.hint_cache_entries, 1);
+  dictionary_rule_clear(d);
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kos kot koty "));
+  dictionary_freeze(d);
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kos kot koty "));
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.hint_cache_hits, 3);
+  assert_int_equal(stats.hint_cache_misses, 9);
+  dictionary_reset_stats(d);
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.hint_cache_hits, 0);
+  assert_int_equal(stats.hint_cache_misses, 0);
+
+  assert_int_equal(dictionary_hint_cache(d, 0), 2);
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.hint_cache_entries, 0);
+  dictionary_hints(d, L"kot", &l);
+  dictionary_hints_text(&l, tekst);
+  assert_true(!wcscmp(tekst, L"kos kot koty "));
+  dictionary_get_stats(d, &stats);
+  assert_int_equal(stats.hint_cache_misses, 0);
+  dictionary_done(d);
+}
+
+static void dictionary_rules_hints_test(void** state) {
+  const wchar_t * slowa[] = { L"ala", L"ma", L"kot", L"kos", L"koty", L"lot" };
+  struct dictionary * d = dictionary_new();
+  struct word_list l;
+  for (int i = 0; i < 6; i++)
+    dictionary_insert(d, slowa[i]);
+  assert_int_equal(dictionary_rule_add(d, L"", L"", false, 1, RULE_NORMAL), 0);
+  assert_int_equal(dictionary_rule_add(d, L"t", L"s", false, 0, RULE_NORMAL), 0);
+  assert_int_equal(dictionary_rule_add(d, L"0", L"12", false, 1, RULE_NORMAL), 0);
+  assert_int_equal(dictionary_rule_add(d, L"t", L"s", true, 1, RULE_NORMAL), 2);
+  assert_int_equal(dictionary_rule_add(d, L"01", L"10", true, 1, RULE_NORMAL), 2);
+  assert_int_equal(dictionary_rule_add(d, L"", L"", false, 2, RULE_SPLIT), 1);
+  assert_int_equal(dictionary_rule_add(d, L"", L"0", false, 3, RULE_END), 1);
+  assert_int_equal(dictionary_hints_max_cost(d, 2), 0);
+  char nazwa[] = "/tmp/dictionary_testXXXXXX";
+  int fd = mkstemp(nazwa);
+  assert_true(fd >= 0);
+  close(fd);
+  for (int krok = 0; krok < 3; krok++) {
+    if (krok == 1)
+      dictionary_freeze(d);
+    if (krok == 2) {
+      assert_int_equal(dictionary_save_file(d, nazwa), 0);
+      dictionary_done(d);
+      d = dictionary_load_file(nazwa);
+      assert_non_null(d);
+      dictionary_hints_max_cost(d, 2);
+    }
+    dictionary_hints(d, L"kto", &l);
+    assert_int_equal(word_list_size(&l), 1);
+    assert_true(!wcscmp(word_list_get(&l)[0], L"kot"));
+    word_list_done(&l);
+    dictionary_hints(d, L"kot", &l);
+    assert_int_equal(word_list_size(&l), 2);
+    assert_true(!wcscmp(word_list_get(&l)[0], L"kos"));
+    assert_true(!wcscmp(word_list_get(&l)[1], L"kot"));
+    word_list_done(&l);
+    dictionary_hints(d, L"alama", &l);
+    assert_int_equal(word_list_size(&l), 1);
+    assert_true(!wcscmp(word_list_get(&l)[0], L"ala ma"));
+    word_list_done(&l);
+    /* reguła dopisująca literę kosztuje więcej niż maksymalny koszt */
+    dictionary_hints(d, L"kot", &l);
+    assert_int_equal(word_list_size(&l), 2);
+    word_list_done(&l);
+    dictionary_hints_max_cost(d, 3);
+    dictionary_hints(d, L"kot", &l);
+    assert_int_equal(word_list_size(&l), 3);
+    assert_true(!wcscmp(word_list_get(&l)[2], L"koty"));
+    word_list_done(&l);
+    dictionary_hints_max_cost(d, 2);
+  }
+  unlink(nazwa);
+  /* bez reguł podpowiedziami są słowa odległe o jedną zmianę */
+  dictionary_rule_clear(d);
+  dictionary_hints(d, L"kot", &l);
+  assert_int_equal(word_list_size(&l), 4);
+  word_list_done(&l);
+  dictionary_done(d);
+}
+
+static void dictionary_hints_max_cost_test(void** state) {
+  struct dictionary * d = dictionary_new();
+  struct word_list l;
+  dictionary_insert(d, L"kot");
+  dictionary_insert(d, L"kos");
+  assert_int_equal(dictionary_rule_add(d, L"01", L"10", false, 1, RULE_NORMAL), 1);
+  assert_int_equal(dictionary_rule_add(d, L"t", L"s", false, 1000, RULE_NORMAL), 1);
+  /* koszty spoza zakresu są odrzucane i nie zmieniają kosztu */
+  assert_true(dictionary_hints_max_cost(d, -1) < 0);
+  assert_true(dictionary_hints_max_cost(d, INT_MAX) < 0);
+  assert_true(dictionary_hints_max_cost(d, MAX_HINTS_COST + 1) < 0);
+  assert_int_equal(dictionary_hints_max_cost(d, MAX_HINTS_COST), 0);
+  /* czas i pamięć nie zależą od maksymalnego kosztu */
+  for (int i = 0; i < 1000; i++) {
+    dictionary_hints(d, L"kot", &l);
+    assert_int_equal(word_list_size(&l), 2);
+    word_list_done(&l);
+  }
+  assert_int_equal(dictionary_hints_max_cost(d, 1), MAX_HINTS_COST);
+  dictionary_hints(d, L"kot", &l);
+  assert_int_equal(word_list_size(&l), 1);
+  word_list_done(&l);
+  dictionary_done(d);
+}
+
+static void dictionary_hints_into_test(void** state) {
+  /* Jedna lista dla wielu słów daje te same podpowiedzi. */
+  const wchar_t * slowa[] = { L"kot", L"kto", L"koty", L"lot", L"kos" };
+  struct dictionary * d = dictionary_new();
+  for (int i = 0; i < 5; i++)
+    dictionary_insert(d, slowa[i]);
+  struct word_list wspolna, l;
+  word_list_init(&wspolna);
+  for (int powtorzenie = 0; powtorzenie < 2; powtorzenie++)
+    for (int i = 0; i < 5; i++) {
+      dictionary_hints_into(d, slowa[i], &wspolna);
+      dictionary_hints(d, slowa[i], &l);
+      assert_int_equal(word_list_size(&wspolna), word_list_size(&l));
+      for (size_t j = 0; j < word_list_size(&l); j++)
+        assert_true(!wcscmp(word_list_get(&wspolna)[j], word_list_get(&l)[j]));
+      word_list_done(&l);
+    }
+  word_list_done(&wspolna);
+  dictionary_done(d);
+}
+
+/* Podpowiedzi zebrane przez dictionary_hints_foreach(). */
+struct zebrane {
+  wchar_t slowa[32][16];
+  int koszty[32];
+  int liczba;
+  int limit;
+};
+
+static bool zbierz(const wchar_t *hint, int cost, void *ctx) {
+  struct zebrane * z = ctx;
+  assert_true(z->liczba < 32);
+  wcscpy(z->slowa[z->liczba], hint);
+  z->koszty[z->liczba++] = cost;
+  return z->liczba != z->limit;
+}
+
+/* Sprawdza kolejność kosztów i zgodność z dictionary_hints(). */
+static void porownajZHints(struct dictionary * d, const wchar_t * slowo) {
+  struct zebrane z = { .liczba = 0, .limit = 0 };
+  struct word_list l;
+  dictionary_hints_foreach(d, slowo, zbierz, &z);
+  for (int i = 1; i < z.liczba; i++)
+    assert_true(z.koszty[i - 1] <= z.koszty[i]);
+  dictionary_hints(d, slowo, &l);
+  assert_int_equal(word_list_size(&l), z.liczba);
+  for (size_t i = 0; i < word_list_size(&l); i++) {
+    int j = 0;
+    while (j < z.liczba && wcscmp(z.slowa[j], word_list_get(&l)[i]))
+      j++;
+    assert_true(j < z.liczba);
+  }
+  word_list_done(&l);
+  /* Przerwanie po pierwszej podpowiedzi. */
+  struct zebrane pierwsza = { .liczba = 0, .limit = 1 };
+  dictionary_hints_foreach(d, slowo, zbierz, &pierwsza);
+  assert_int_equal(pierwsza.liczba, z.liczba > 0);
+  if (z.liczba > 0)
+    assert_int_equal(pierwsza.koszty[0], z.koszty[0]);
+}
+
+static void dictionary_hints_foreach_test(void** state) {
+  const wchar_t * slowa[] = { L"ala", L"ma", L"kot", L"kos", L"koty", L"lot" };
+  const wchar_t * szukane[] = { L"kot", L"kto", L"alama", L"kos", L"xyz" };
+  struct dictionary * d = dictionary_new();
+  for (int i = 0; i < 6; i++)
+    dictionary_insert(d, slowa[i]);
+  /* bez reguł: najpierw samo słowo, potem odległe o jedną zmianę */
+  struct zebrane z = { .liczba = 0, .limit = 0 };
+  dictionary_hints_foreach(d, L"kot", zbierz, &z);
+  assert_int_equal(z.liczba, 4);
+  assert_true(!wcscmp(z.slowa[0], L"kot"));
+  assert_int_equal(z.koszty[0], 0);
+  for (int i = 0; i < 5; i++)
+    porownajZHints(d, szukane[i]);
+  dictionary_freeze(d);
+  for (int i = 0; i < 5; i++)
+    porownajZHints(d, szukane[i]);
+  assert_int_equal(dictionary_hint_index(d, 1), 0);
+  for (int i = 0; i < 5; i++)
+    porownajZHints(d, szukane[i]);
+  assert_int_equal(dictionary_rule_add(d, L"t", L"s", false, 1, RULE_NORMAL), 1);
+  assert_int_equal(dictionary_rule_add(d, L"", L"", false, 2, RULE_SPLIT), 1);
+  assert_int_equal(dictionary_rule_add(d, L"", L"y", false, 3, RULE_END), 1);
+  assert_int_equal(dictionary_hints_max_cost(d, 3), 0);
+  for (int i = 0; i < 5; i++)
+    porownajZHints(d, szukane[i]);
+  /* przerwanie przed droższymi podpowiedziami */
+  z = (struct zebrane) { .liczba = 0, .limit = 2 };
+  dictionary_hints_foreach(d, L"kot", zbierz, &z);
+  assert_int_equal(z.liczba, 2);
+  assert_true(!wcscmp(z.slowa[0], L"kot"));
+  assert_true(!wcscmp(z.slowa[1], L"kos"));
+  assert_int_equal(z.koszty[1], 1);
+  dictionary_done(d);
+}
+
+/* Zadanie sprawdzające czytelnikiem wątku jedno słowo. */
+struct czytanie {
+  struct dictionary_reader * czytelnicy[4];
+  struct word_list listy[4];
+  const wchar_t * slowa[200];
+  bool znalezione[200];
+  int podpowiedzi[200];
+};
+
+static void czytaj(int zadanie, int watek, void * dane) {
+  struct czytanie * c = dane;
+  c->znalezione[zadanie] = dictionary_reader_find(c->czytelnicy[watek],
+    c->slowa[zadanie]);
+  dictionary_reader_hints(c->czytelnicy[watek], c->slowa[zadanie],
+    &c->listy[watek]);
+  c->podpowiedzi[zadanie] = word_list_size(&c->listy[watek]);
+}
+
+static void dictionary_reader_test(void** state) {
+  const wchar_t * slowa[] = { L"ala", L"ma", L"kot", L"kos", L"koty", L"lot" };
+  const wchar_t * szukane[] = { L"kot", L"kto", L"alama", L"kos", L"xyz" };
+  struct dictionary * d = dictionary_new();
+  struct word_list l, r;
+  for (int i = 0; i < 6; i++)
+    dictionary_insert(d, slowa[i]);
+  word_list_init(&r);
+  for (int krok = 0; krok < 3; krok++) {
+    if (krok == 1)
+      dictionary_freeze(d);
+    if (krok == 2) {
+      assert_int_equal(dictionary_rule_add(d, L"t", L"s", false, 1, RULE_NORMAL), 1);
+      assert_int_equal(dictionary_rule_add(d, L"", L"", false, 2, RULE_SPLIT), 1);
+      dictionary_hints_max_cost(d, 2);
+    }
+    /* Czytelnik z pamięcią podręczną i bez daje to samo co słownik. */
+    for (int pojemnosc = 0; pojemnosc <= 2; pojemnosc += 2) {
+      struct dictionary_reader * c = dictionary_reader_new(d, pojemnosc);
+      for (int powtorzenie = 0; powtorzenie < 2; powtorzenie++)
+        for (int i = 0; i < 5; i++) {
+          assert_int_equal(dictionary_reader_find(c, szukane[i]),
+                           dictionary_find(d, szukane[i]));
+          dictionary_reader_hints(c, szukane[i], &r);
+          dictionary_hints(d, szukane[i], &l);
+          assert_int_equal(word_list_size(&r), word_list_size(&l));
+          for (size_t j = 0; j < word_list_size(&l); j++)
+            assert_true(!wcscmp(word_list_get(&r)[j], word_list_get(&l)[j]));
+          word_list_done(&l);
+        }
+      dictionary_reader_done(c);
+    }
+  }
+  word_list_done(&r);
+  /* Czytelnicy pracują współbieżnie, każdy w swoim wątku. */
+  static struct czytanie c;
+  struct watki * pula = watki_nowe(4);
+  assert_non_null(pula);
+  for (int i = 0; i < 4; i++) {
+    c.czytelnicy[i] = dictionary_reader_new(d, 8);
+    word_list_init(&c.listy[i]);
+  }
+  for (int i = 0; i < 200; i++)
+    c.slowa[i] = szukane[i % 5];
+  watki_wykonaj(pula, 200, czytaj, &c);
+  for (int i = 0; i < 200; i++) {
+    assert_int_equal(c.znalezione[i], dictionary_find(d, c.slowa[i]));
+    dictionary_hints(d, c.slowa[i], &l);
+    assert_int_equal(c.podpowiedzi[i], word_list_size(&l));
+    word_list_done(&l);
+  }
+  for (int i = 0; i < 4; i++) {
+    dictionary_reader_done(c.czytelnicy[i]);
+    word_list_done(&c.listy[i]);
+  }
+  watki_done(pula);
+  dictionary_done(d);
+}
+
+static void dictionary_hint_threads_test(void** state) {
+  /* Wyniki w wątkach są takie same jak w jednym wątku. */
+  struct dictionary * d = dictionary_new();
+  unsigned ziarno = 99;
+  for (int i = 0; i < 2000; i++) {
+    wchar_t slowo[8];
+    ziarno = ziarno * 1103515245 + 12345;
+    int dlugosc = 1 + (ziarno >> 16) % 6;
+    for (int j = 0; j < dlugosc; j++) {
+      ziarno = ziarno * 1103515245 + 12345;
+      slowo[j] = L'a' + (ziarno >> 16) % 5;
+    }
+    slowo[dlugosc] = L'\0';
+    dictionary_insert(d, slowo);
+  }
+  dictionary_rule_add(d, L"0", L"1", false, 1, RULE_NORMAL);
+  dictionary_rule_add(d, L"", L"0", false, 1, RULE_NORMAL);
+  dictionary_rule_add(d, L"0", L"", false, 1, RULE_NORMAL);
+  dictionary_rule_add(d, L"", L"", false, 1, RULE_SPLIT);
+  dictionary_hints_max_cost(d, 2);
+  assert_true(dictionary_hint_threads(d, -1) < 0);
+  assert_true(dictionary_hint_threads(d, 65) < 0);
+  assert_int_equal(dictionary_hint_threads(d, 4), 1);
+  assert_int_equal(dictionary_hint_threads(d, 4), 4);
+  assert_int_equal(dictionary_hint_threads(d, 1), 4);
+  const wchar_t * slowa[] = { L"abc", L"eeaab", L"abcdeabcde", L"x", L"" };
+  struct word_list l;
+  for (int zamrozony = 0; zamrozony < 2; zamrozony++) {
+    if (zamrozony)
+      dictionary_freeze(d);
+    for (int i = 0; i < 5; i++) {
+      wchar_t jeden[512], wiele[512];
+      dictionary_hint_threads(d, 0);
+      dictionary_hints(d, slowa[i], &l);
+      dictionary_hints_text(&l, jeden);
+      for (int watki = 2; watki <= 8; watki += 3) {
+        dictionary_hint_threads(d, watki);
+        dictionary_hints(d, slowa[i], &l);
+        dictionary_hints_text(&l, wiele);
+        assert_true(!wcscmp(jeden, wiele));
+      }
+    }
+  }
+  dictionary_hints(d, L"abc", &l);
+  assert_int_equal(word_list_size(&l), DICTIONARY_MAX_HINTS);
+  word_list_done(&l);
+  dictionary_done(d);
+}
+
 static int dictionary_setup(void **state) {
     struct dictionary *d = dictionary_new();
     dictionary_insert(d,first);
@@ -83,6 +872,22 @@ int main(void) {
       cmocka_unit_test_setup_teardown(dictionary_delete_and_find, dictionary_setup, dictionary_teardown),
       cmocka_unit_test_setup_teardown(dictionary_insert_the_same, dictionary_setup, dictionary_teardown),
       cmocka_unit_test_setup_teardown(dictionary_delete_non_existing, dictionary_setup, dictionary_teardown),
+      cmocka_unit_test_setup_teardown(dictionary_freeze_test, dictionary_setup, dictionary_teardown),
+      cmocka_unit_test(dictionary_binary_file_test),
+      cmocka_unit_test(dictionary_alphabet_limit_test),
+      cmocka_unit_test(dictionary_corrupt_file_test),
+      cmocka_unit_test(dictionary_build_sorted_test),
+      cmocka_unit_test_setup_teardown(dictionary_filter_test, dictionary_setup, dictionary_teardown),
+      cmocka_unit_test(dictionary_edit_hints_test),
+      cmocka_unit_test(dictionary_hints_limit_test),
+      cmocka_unit_test(dictionary_hint_index_test),
+      cmocka_unit_test(dictionary_rules_hints_test),
+      cmocka_unit_test(dictionary_hints_max_cost_test),
+      cmocka_unit_test(dictionary_hint_cache_test),
+      cmocka_unit_test(dictionary_hints_into_test),
+      cmocka_unit_test(dictionary_hints_foreach_test),
+      cmocka_unit_test(dictionary_reader_test),
+      cmocka_unit_test(dictionary_hint_threads_test),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
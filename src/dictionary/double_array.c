@@ -0,0 +1,683 @@
+/** @file
+  Podwójna tablica (BASE/CHECK) budowana z drzewa TRIE.
+
+  Drzewo jest najpierw minimalizowane do acyklicznego automatu (DAWG):
+  poddrzewa rozpoznające te same końcówki, np. -ami czy -owie, stają się
+  jednym stanem. Każdy stan dostaje jeden blok komórek, a komórka
+  odpowiada przejściu do stanu, więc wszystkie przejścia do wspólnego
+  stanu wskazują na ten sam blok.
+
+  Komórka 0 jest stanem początkowym. Przejścia stanu zapisanego w komórce s
+  leżą w komórkach komorki[s].baza + kod(litery), a pole etykieta komórki
+  przechowuje kod litery. Każdy blok ma własną, unikalną bazę, więc
+  zgodność etykiety wystarcza do stwierdzenia, że przejście istnieje.
+  Baza 0 nie jest nadawana żadnemu blokowi i oznacza brak przejść.
+
+  @ingroup dictionary
+ */
+#include "double_array.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/** Oznaczenie braku komórki na liście wolnych komórek. */
+#define BRAK UINT32_MAX
+
+/** Stan budowy podwójnej tablicy. */
+struct budowa
+{
+  /** Budowana tablica. */
+  struct double_array * da;
+
+  /** Liczba zaalokowanych komórek. */
+  uint32_t pojemnosc;
+
+  /** Znaczniki komórek zajętych. */
+  char * zajete;
+
+  /** Znaczniki baz nadanych już jakiemuś blokowi. */
+  char * bazaUzyta;
+
+  /** Następna komórka na liście wolnych komórek. */
+  uint32_t * nastepny;
+
+  /** Poprzednia komórka na liście wolnych komórek. */
+  uint32_t * poprzedni;
+
+  /** Liczba nieudanych prób zaczepienia bloku w danej komórce. */
+  unsigned char * proby;
+
+  /** Pierwsza komórka listy wolnych komórek (pojemnosc, jeśli lista jest pusta). */
+  uint32_t pierwszyWolny;
+
+  /** Ostatnia komórka listy wolnych komórek (BRAK, jeśli lista jest pusta). */
+  uint32_t ostatniWolny;
+
+  /** Największy numer zajętej komórki. */
+  uint32_t ostatniZajety;
+};
+
+/** Funkcja zapewniająca, że tablice budowy mają co najmniej podany rozmiar.
+ * @param[in,out] b Stan budowy.
+ * @param[in] potrzebne Wymagana liczba komórek.
+ */
+static void zapewnij(struct budowa * b, uint32_t potrzebne)
+{
+  if (potrzebne <= b->pojemnosc)
+    return;
+  uint32_t nowa = b->pojemnosc ? b->pojemnosc : 1024;
+  while (nowa < potrzebne)
+    nowa *= 2;
+  b->da->komorki = realloc(b->da->komorki, sizeof(struct double_array_komorka) * nowa);
+  b->zajete = realloc(b->zajete, nowa);
+  b->bazaUzyta = realloc(b->bazaUzyta, nowa);
+  b->nastepny = realloc(b->nastepny, sizeof(uint32_t) * nowa);
+  b->poprzedni = realloc(b->poprzedni, sizeof(uint32_t) * nowa);
+  b->proby = realloc(b->proby, nowa);
+  memset(b->da->komorki + b->pojemnosc, 0,
+    sizeof(struct double_array_komorka) * (nowa - b->pojemnosc));
+  memset(b->zajete + b->pojemnosc, 0, nowa - b->pojemnosc);
+  memset(b->bazaUzyta + b->pojemnosc, 0, nowa - b->pojemnosc);
+  memset(b->proby + b->pojemnosc, 0, nowa - b->pojemnosc);
+  /* Nowe komórki dopisujemy na koniec listy wolnych komórek. Ostatni
+     element listy zawsze wskazuje na starą pojemność, czyli na pierwszą
+     z nowych komórek. */
+  for (uint32_t i = b->pojemnosc; i < nowa; i++)
+  {
+    b->nastepny[i] = i + 1;
+    b->poprzedni[i] = i - 1;
+  }
+  b->poprzedni[b->pojemnosc] = b->ostatniWolny;
+  b->ostatniWolny = nowa - 1;
+  b->pojemnosc = nowa;
+}
+
+/** Funkcja usuwająca komórkę z listy wolnych komórek.
+ * @param[in,out] b Stan budowy.
+ * @param[in] poz Usuwana komórka.
+ */
+static void odlacz(struct budowa * b, uint32_t poz)
+{
+  uint32_t nast = b->nastepny[poz];
+  uint32_t poprz = b->poprzedni[poz];
+  bool pierwszy = (poz == b->pierwszyWolny);
+  if (pierwszy)
+    b->pierwszyWolny = nast;
+  else
+    b->nastepny[poprz] = nast;
+  if (nast < b->pojemnosc)
+    b->poprzedni[nast] = pierwszy ? BRAK : poprz;
+  else
+    b->ostatniWolny = pierwszy ? BRAK : poprz;
+}
+
+/** Funkcja zajmująca komórkę.
+ * @param[in,out] b Stan budowy.
+ * @param[in] poz Zajmowana komórka.
+ */
+static void zajmij(struct budowa * b, uint32_t poz)
+{
+  b->zajete[poz] = 1;
+  if (b->proby[poz] < 32)
+    odlacz(b, poz);
+  if (poz > b->ostatniZajety)
+    b->ostatniZajety = poz;
+}
+
+/** Komparator liter używany przy sortowaniu alfabetu.
+ * @param[in] a Pierwsza litera.
+ * @param[in] b Druga litera.
+ * @return Wynik porównania.
+ */
+static int porownajLitery(const void * a, const void * b)
+{
+  wchar_t x = *(const wchar_t *) a;
+  wchar_t y = *(const wchar_t *) b;
+  return (x > y) - (x < y);
+}
+
+/** Funkcja zbierająca alfabet drzewa i nadająca literom kody.
+ * @param[in,out] da Budowana tablica.
+ * @param[in] root Drzewo.
+ */
+static void zbierzAlfabet(struct double_array * da, const struct trie * root)
+{
+  bool male[DOUBLE_ARRAY_MALY_ZAKRES];
+  memset(male, 0, sizeof(male));
+  wchar_t * duze = NULL;
+  int liczbaDuzych = 0, rozmiarDuzych = 0;
+
+  struct trie_kursor kursor;
+  trie_kursor_init(&kursor);
+  trie_kursor_ustaw(&kursor, root);
+  while (trie_kursor_nastepny(&kursor, true))
+  {
+    const struct trie * wezel = trie_kursor_wezel(&kursor);
+    for (int i = 0; i < wezel->krawedz; i++)
+    {
+      wchar_t litera = i == 0 ? wezel->litera : trie_reszta(wezel)[i - 1];
+      if ((unsigned) litera < DOUBLE_ARRAY_MALY_ZAKRES)
+        male[litera] = true;
+      else
+      {
+        if (liczbaDuzych == rozmiarDuzych)
+        {
+          rozmiarDuzych = rozmiarDuzych ? 2 * rozmiarDuzych : 16;
+          duze = realloc(duze, sizeof(wchar_t) * rozmiarDuzych);
+        }
+        duze[liczbaDuzych++] = litera;
+      }
+    }
+  }
+  trie_kursor_done(&kursor);
+
+  if (liczbaDuzych > 1)
+    qsort(duze, liczbaDuzych, sizeof(wchar_t), porownajLitery);
+  int ileMalych = 0;
+  for (int i = 1; i < DOUBLE_ARRAY_MALY_ZAKRES; i++)
+    ileMalych += male[i];
+  da->litery = malloc(sizeof(wchar_t) * (ileMalych + liczbaDuzych + 1));
+  da->liczbaLiter = 0;
+  for (int i = 1; i < DOUBLE_ARRAY_MALY_ZAKRES; i++)
+  {
+    if (male[i])
+    {
+      da->litery[da->liczbaLiter] = i;
+      da->kody[i] = ++da->liczbaLiter;
+    }
+  }
+  for (int i = 0; i < liczbaDuzych; i++)
+  {
+    if (i == 0 || duze[i] != duze[i-1])
+      da->litery[da->liczbaLiter++] = duze[i];
+  }
+  free(duze);
+}
+
+/** Funkcja wyszukująca bazę, pod którą zmieszczą się wszystkie dzieci.
+ * @param[in,out] b Stan budowy.
+ * @param[in] kody Posortowane rosnąco kody dzieci.
+ * @param[in] ile Liczba dzieci.
+ * @return Znaleziona baza (zawsze dodatnia).
+ */
+static uint32_t znajdzBaze(struct budowa * b, const unsigned * kody, int ile)
+{
+  uint32_t poz = b->pierwszyWolny;
+  for (;;)
+  {
+    zapewnij(b, poz + kody[ile-1] + 1);
+    uint32_t nast = b->nastepny[poz];
+    if (poz > kody[0])
+    {
+      uint32_t baza = poz - kody[0];
+      int i = 1;
+      if (!b->bazaUzyta[baza])
+        while (i < ile && !b->zajete[baza + kody[i]])
+          i++;
+      if (!b->bazaUzyta[baza] && i == ile)
+        return baza;
+    }
+    /* Komórki, w których wielokrotnie nie udało się zaczepić bloku,
+       usuwamy z listy, żeby kolejne wyszukiwania ich nie odwiedzały.
+       Wciąż mogą zostać zajęte jako dalsze dziecko jakiegoś bloku. */
+    if (++b->proby[poz] == 32)
+      odlacz(b, poz);
+    poz = nast;
+  }
+}
+
+/** Stan budowy minimalnego automatu (DAWG). Stany numerowane są w kolejności
+    rejestracji, a przejścia stanu s zajmują pozycje
+    [poczatek[s], poczatek[s + 1]) tablic kod i cel. */
+struct minimalizacja
+{
+  /** Liczba zarejestrowanych stanów. */
+  uint32_t liczbaStanow;
+
+  /** Rozmiar tablic stanów. */
+  uint32_t pojemnoscStanow;
+
+  /** Początek przejść każdego stanu (liczbaStanow + 1 pozycji). */
+  uint32_t * poczatek;
+
+  /** Czy stan jest akceptujący. */
+  unsigned char * slowo;
+
+  /** Liczba przejść. */
+  uint32_t liczbaPrzejsc;
+
+  /** Rozmiar tablic przejść. */
+  uint32_t pojemnoscPrzejsc;
+
+  /** Kody liter przejść. */
+  unsigned * kod;
+
+  /** Stany docelowe przejść. */
+  uint32_t * cel;
+
+  /** Tablica haszująca stanów (numer stanu + 1, 0 dla pustego miejsca). */
+  uint32_t * tablica;
+
+  /** Rozmiar tablicy haszującej (potęga dwójki). */
+  uint32_t rozmiarTablicy;
+};
+
+/** Funkcja licząca skrót stanu.
+ * @param[in] slowo Czy stan jest akceptujący.
+ * @param[in] kod Kody liter przejść.
+ * @param[in] cel Stany docelowe przejść.
+ * @param[in] ile Liczba przejść.
+ * @return Skrót.
+ */
+static uint32_t skrot(bool slowo, const unsigned * kod, const uint32_t * cel, uint32_t ile)
+{
+  uint64_t h = slowo ? 0x9e3779b97f4a7c15ULL : 0x632be59bd9b4e019ULL;
+  for (uint32_t i = 0; i < ile; i++)
+  {
+    h ^= ((uint64_t) kod[i] << 32) | cel[i];
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 29;
+  }
+  return (uint32_t) (h ^ (h >> 32));
+}
+
+/** Funkcja powiększająca tablicę haszującą dwukrotnie.
+ * @param[in,out] m Stan minimalizacji.
+ */
+static void powiekszTablice(struct minimalizacja * m)
+{
+  uint32_t rozmiar = m->rozmiarTablicy ? 2 * m->rozmiarTablicy : 1024;
+  uint32_t * tablica = calloc(rozmiar, sizeof(uint32_t));
+  for (uint32_t s = 0; s < m->liczbaStanow; s++)
+  {
+    uint32_t p = m->poczatek[s];
+    uint32_t h = skrot(m->slowo[s], m->kod + p, m->cel + p, m->poczatek[s + 1] - p);
+    while (tablica[h & (rozmiar - 1)] != 0)
+      h++;
+    tablica[h & (rozmiar - 1)] = s + 1;
+  }
+  free(m->tablica);
+  m->tablica = tablica;
+  m->rozmiarTablicy = rozmiar;
+}
+
+/** Funkcja zwracająca numer stanu o danym zestawie przejść, rejestrując
+ * nowy stan, jeśli równoważnego jeszcze nie ma.
+ * @param[in,out] m Stan minimalizacji.
+ * @param[in] slowo Czy stan jest akceptujący.
+ * @param[in] kod Kody liter przejść (rosnąco).
+ * @param[in] cel Stany docelowe przejść.
+ * @param[in] ile Liczba przejść.
+ * @return Numer stanu.
+ */
+static uint32_t zarejestruj(struct minimalizacja * m, bool slowo,
+  const unsigned * kod, const uint32_t * cel, uint32_t ile)
+{
+  if (2 * (m->liczbaStanow + 1) > m->rozmiarTablicy)
+    powiekszTablice(m);
+  uint32_t maska = m->rozmiarTablicy - 1;
+  uint32_t h = skrot(slowo, kod, cel, ile);
+  for (;; h++)
+  {
+    uint32_t s = m->tablica[h & maska];
+    if (s == 0)
+      break;
+    s--;
+    uint32_t p = m->poczatek[s];
+    if (m->slowo[s] == slowo && m->poczatek[s + 1] - p == ile &&
+      (ile == 0 || (!memcmp(m->kod + p, kod, sizeof(unsigned) * ile) &&
+                    !memcmp(m->cel + p, cel, sizeof(uint32_t) * ile))))
+      return s;
+  }
+
+  uint32_t s = m->liczbaStanow++;
+  if (m->liczbaStanow + 1 > m->pojemnoscStanow)
+  {
+    m->pojemnoscStanow = m->pojemnoscStanow ? 2 * m->pojemnoscStanow : 1024;
+    m->poczatek = realloc(m->poczatek, sizeof(uint32_t) * m->pojemnoscStanow);
+    m->slowo = realloc(m->slowo, m->pojemnoscStanow);
+  }
+  if (m->liczbaPrzejsc + ile > m->pojemnoscPrzejsc)
+  {
+    while (m->liczbaPrzejsc + ile > m->pojemnoscPrzejsc)
+      m->pojemnoscPrzejsc = m->pojemnoscPrzejsc ? 2 * m->pojemnoscPrzejsc : 1024;
+    m->kod = realloc(m->kod, sizeof(unsigned) * m->pojemnoscPrzejsc);
+    m->cel = realloc(m->cel, sizeof(uint32_t) * m->pojemnoscPrzejsc);
+  }
+  if (ile > 0)
+  {
+    memcpy(m->kod + m->liczbaPrzejsc, kod, sizeof(unsigned) * ile);
+    memcpy(m->cel + m->liczbaPrzejsc, cel, sizeof(uint32_t) * ile);
+  }
+  m->slowo[s] = slowo;
+  m->poczatek[s] = m->liczbaPrzejsc;
+  m->liczbaPrzejsc += ile;
+  m->poczatek[s + 1] = m->liczbaPrzejsc;
+  m->tablica[h & maska] = s + 1;
+  return s;
+}
+
+/** Element stosu przejścia drzewa w porządku postfiksowym. */
+struct ramka
+{
+  /** Wierzchołek drzewa. */
+  const struct trie * wezel;
+
+  /** Indeks ostatnio odwiedzonego syna (-1 przed pierwszym). */
+  int syn;
+
+  /** Pozycja na stosie przejść, od której leżą przejścia wierzchołka. */
+  uint32_t przejscia;
+};
+
+/** Funkcja budująca minimalny automat rozpoznający słowa drzewa: wierzchołki
+ * o równych poddrzewach (ten sam znacznik słowa i te same przejścia do tych
+ * samych stanów) stają się jednym stanem. Drzewo przechodzone jest raz,
+ * w porządku postfiksowym, więc każdy wierzchołek jest rejestrowany po
+ * wszystkich swoich synach.
+ * @param[out] m Stan minimalizacji.
+ * @param[in] da Tablica z nadanymi kodami liter.
+ * @param[in] root Niepuste drzewo.
+ * @return Numer stanu początkowego.
+ */
+static uint32_t minimalizuj(struct minimalizacja * m, const struct double_array * da,
+  const struct trie * root)
+{
+  memset(m, 0, sizeof(struct minimalizacja));
+  int rozmiarStosu = 64, glebokosc = 0;
+  struct ramka * stos = malloc(sizeof(struct ramka) * rozmiarStosu);
+  uint32_t rozmiarPrzejsc = 64, liczbaPrzejsc = 0;
+  unsigned * kod = malloc(sizeof(unsigned) * rozmiarPrzejsc);
+  uint32_t * cel = malloc(sizeof(uint32_t) * rozmiarPrzejsc);
+  uint32_t poczatkowy = 0;
+
+  stos[0].wezel = root;
+  stos[0].syn = -1;
+  stos[0].przejscia = 0;
+  while (glebokosc >= 0)
+  {
+    struct ramka * r = &stos[glebokosc];
+    r->syn = trie_nastepny_syn(r->wezel, r->syn);
+    if (r->syn != -1)
+    {
+      if (glebokosc + 1 == rozmiarStosu)
+      {
+        rozmiarStosu *= 2;
+        stos = realloc(stos, sizeof(struct ramka) * rozmiarStosu);
+        r = &stos[glebokosc];
+      }
+      glebokosc++;
+      stos[glebokosc].wezel = trie_syn(r->wezel, r->syn);
+      stos[glebokosc].syn = -1;
+      stos[glebokosc].przejscia = liczbaPrzejsc;
+      continue;
+    }
+
+    uint32_t s = zarejestruj(m, r->wezel->czySlowo, kod + r->przejscia,
+      cel + r->przejscia, liczbaPrzejsc - r->przejscia);
+    liczbaPrzejsc = r->przejscia;
+    if (glebokosc == 0)
+      poczatkowy = s;
+    else
+    {
+      if (liczbaPrzejsc == rozmiarPrzejsc)
+      {
+        rozmiarPrzejsc *= 2;
+        kod = realloc(kod, sizeof(unsigned) * rozmiarPrzejsc);
+        cel = realloc(cel, sizeof(uint32_t) * rozmiarPrzejsc);
+      }
+      /* Krawędź o wielu literach to łańcuch stanów z jednym przejściem. */
+      for (int i = r->wezel->krawedz - 1; i > 0; i--)
+      {
+        unsigned k = double_array_kod(da, trie_reszta(r->wezel)[i - 1]);
+        s = zarejestruj(m, false, &k, &s, 1);
+      }
+      kod[liczbaPrzejsc] = double_array_kod(da, r->wezel->litera);
+      cel[liczbaPrzejsc++] = s;
+    }
+    glebokosc--;
+  }
+  free(stos);
+  free(kod);
+  free(cel);
+  free(m->tablica);
+  m->tablica = NULL;
+  return poczatkowy;
+}
+
+struct double_array * double_array_build(const struct trie * root)
+{
+  struct double_array * da = calloc(1, sizeof(struct double_array));
+  zbierzAlfabet(da, root);
+  if (da->liczbaLiter > DOUBLE_ARRAY_MAKS_LITER)
+  {
+    free(da->litery);
+    free(da);
+    return NULL;
+  }
+
+  struct budowa b;
+  b.da = da;
+  b.pojemnosc = 0;
+  b.zajete = NULL;
+  b.bazaUzyta = NULL;
+  b.nastepny = NULL;
+  b.poprzedni = NULL;
+  b.proby = NULL;
+  b.pierwszyWolny = 0;
+  b.ostatniWolny = BRAK;
+  b.ostatniZajety = 0;
+  zapewnij(&b, 2);
+  zajmij(&b, 0);
+
+  if (root != NULL)
+  {
+    struct minimalizacja m;
+    uint32_t poczatkowy = minimalizuj(&m, da, root);
+    da->liczbaStanow = m.liczbaStanow;
+
+    /* Każdy stan dostaje jeden blok, wspólny dla wszystkich prowadzących
+       do niego przejść. Najpierw rozmieszczamy bloki (wszerz, od stanu
+       początkowego), potem wypełniamy komórki. */
+    uint32_t * baza = calloc(m.liczbaStanow, sizeof(uint32_t));
+    uint32_t * kolejka = malloc(sizeof(uint32_t) * m.liczbaStanow);
+    unsigned char * odwiedzony = calloc(m.liczbaStanow, 1);
+    uint32_t poczatek = 0, koniec = 0;
+    kolejka[koniec++] = poczatkowy;
+    odwiedzony[poczatkowy] = 1;
+    while (poczatek < koniec)
+    {
+      uint32_t s = kolejka[poczatek++];
+      uint32_t p = m.poczatek[s], ile = m.poczatek[s + 1] - p;
+      if (ile == 0)
+        continue;
+      baza[s] = znajdzBaze(&b, m.kod + p, ile);
+      b.bazaUzyta[baza[s]] = 1;
+      for (uint32_t i = 0; i < ile; i++)
+      {
+        zajmij(&b, baza[s] + m.kod[p + i]);
+        if (!odwiedzony[m.cel[p + i]])
+        {
+          odwiedzony[m.cel[p + i]] = 1;
+          kolejka[koniec++] = m.cel[p + i];
+        }
+      }
+    }
+
+    da->komorki[0].baza = baza[poczatkowy];
+    da->komorki[0].czySlowo = m.slowo[poczatkowy];
+    for (uint32_t j = 0; j < koniec; j++)
+    {
+      uint32_t s = kolejka[j];
+      for (uint32_t i = m.poczatek[s]; i < m.poczatek[s + 1]; i++)
+      {
+        struct double_array_komorka * k = &da->komorki[baza[s] + m.kod[i]];
+        k->baza = baza[m.cel[i]];
+        k->etykieta = m.kod[i];
+        k->czySlowo = m.slowo[m.cel[i]];
+      }
+    }
+    free(baza);
+    free(kolejka);
+    free(odwiedzony);
+    free(m.poczatek);
+    free(m.slowo);
+    free(m.kod);
+    free(m.cel);
+  }
+
+  /* Zapas na końcu pozwala pominąć sprawdzanie zakresu przy wyszukiwaniu. */
+  uint32_t rozmiar = b.ostatniZajety + da->liczbaLiter + 2;
+  zapewnij(&b, rozmiar);
+  da->komorki = realloc(da->komorki, sizeof(struct double_array_komorka) * rozmiar);
+  da->rozmiar = rozmiar;
+  free(b.zajete);
+  free(b.bazaUzyta);
+  free(b.nastepny);
+  free(b.poprzedni);
+  free(b.proby);
+  return da;
+}
+
+/**
+  Nagłówek binarnego zapisu podwójnej tablicy. Za nagłówkiem leżą litery
+  (wyrównane do 8 bajtów), a za nimi komórki.
+  */
+struct zapis_tablicy
+{
+  /** Liczba liter. */
+  uint32_t liczbaLiter;
+
+  /** Liczba komórek. */
+  uint32_t rozmiar;
+
+  /** Liczba stanów minimalnego automatu. */
+  uint32_t liczbaStanow;
+
+  /** Wyrównanie do 8 bajtów. */
+  uint32_t zapas;
+};
+
+/** Funkcja obliczająca rozmiar liter w zapisie, z wyrównaniem.
+ * @param[in] liczbaLiter Liczba liter.
+ * @return Rozmiar w bajtach, podzielny przez 8.
+ */
+static size_t rozmiarLiter(uint32_t liczbaLiter)
+{
+  return (sizeof(wchar_t) * liczbaLiter + 7) & ~(size_t) 7;
+}
+
+bool double_array_zapisz(const struct double_array * da, FILE * stream)
+{
+  struct zapis_tablicy naglowek = { da->liczbaLiter, da->rozmiar, da->liczbaStanow, 0 };
+  static const char zera[8];
+  size_t litery = sizeof(wchar_t) * da->liczbaLiter;
+  return fwrite(&naglowek, sizeof(naglowek), 1, stream) == 1 &&
+    fwrite(da->litery, 1, litery, stream) == litery &&
+    fwrite(zera, 1, rozmiarLiter(da->liczbaLiter) - litery, stream) ==
+      rozmiarLiter(da->liczbaLiter) - litery &&
+    fwrite(da->komorki, sizeof(struct double_array_komorka), da->rozmiar, stream) ==
+      da->rozmiar;
+}
+
+struct double_array * double_array_widok(const void * dane, size_t rozmiar)
+{
+  const struct zapis_tablicy * naglowek = dane;
+  if (rozmiar < sizeof(struct zapis_tablicy))
+    return NULL;
+  size_t litery = rozmiarLiter(naglowek->liczbaLiter);
+  /* Zapas za ostatnią zajętą komórką (double_array_build) pozwala
+     wyszukiwaniu nie sprawdzać zakresu; bez niego dane są uszkodzone. */
+  if (naglowek->liczbaLiter > DOUBLE_ARRAY_MAKS_LITER ||
+    naglowek->rozmiar < naglowek->liczbaLiter + 2 ||
+    (rozmiar - sizeof(struct zapis_tablicy)) / sizeof(struct double_array_komorka) <
+      naglowek->rozmiar + litery / sizeof(struct double_array_komorka))
+    return NULL;
+
+  /* Wyszukiwanie ufa komórkom: blok dzieci każdej z nich musi mieścić się
+     w tablicy, a etykiety muszą być kodami liter. */
+  const char * poczatek = (const char *) dane + sizeof(struct zapis_tablicy);
+  const struct double_array_komorka * komorki =
+    (const struct double_array_komorka *) (poczatek + litery);
+  for (uint32_t i = 0; i < naglowek->rozmiar; i++)
+    if ((komorki[i].baza != 0 &&
+        (uint64_t) komorki[i].baza + naglowek->liczbaLiter + 1 > naglowek->rozmiar) ||
+      komorki[i].etykieta > naglowek->liczbaLiter)
+      return NULL;
+
+  struct double_array * da = calloc(1, sizeof(struct double_array));
+  da->litery = (wchar_t *) poczatek;
+  da->liczbaLiter = naglowek->liczbaLiter;
+  da->komorki = (struct double_array_komorka *) (poczatek + litery);
+  da->rozmiar = naglowek->rozmiar;
+  da->liczbaStanow = naglowek->liczbaStanow;
+  da->zewnetrzna = true;
+  for (int i = 0; i < da->liczbaLiter; i++)
+    if ((unsigned) da->litery[i] < DOUBLE_ARRAY_MALY_ZAKRES)
+      da->kody[da->litery[i]] = i + 1;
+  return da;
+}
+
+void double_array_done(struct double_array * da)
+{
+  if (da == NULL)
+    return;
+  if (!da->zewnetrzna)
+  {
+    free(da->komorki);
+    free(da->litery);
+  }
+  free(da);
+}
+
+bool double_array_find(const struct double_array * da, const wchar_t * slowo,
+  int dlugosc)
+{
+  uint32_t stan = 0;
+  for (int i = 0; i < dlugosc; i++)
+  {
+    stan = double_array_krok(da, stan, slowo[i]);
+    if (stan == DOUBLE_ARRAY_BRAK)
+      return false;
+  }
+  return double_array_czy_slowo(da, stan);
+}
+
+void double_array_slowa(const struct double_array * da,
+  void (*funkcja)(const wchar_t * slowo, int dlugosc, void * dane), void * dane)
+{
+  int rozmiar = 64, glebokosc = 0;
+  uint32_t * stany = malloc(sizeof(uint32_t) * rozmiar);
+  unsigned * kody = malloc(sizeof(unsigned) * rozmiar);
+  wchar_t * slowo = malloc(sizeof(wchar_t) * (rozmiar + 1));
+  stany[0] = 0;
+  kody[0] = 0;
+  while (glebokosc >= 0)
+  {
+    uint32_t nastepny = double_array_nastepny_syn(da, stany[glebokosc], &kody[glebokosc]);
+    if (nastepny == DOUBLE_ARRAY_BRAK)
+    {
+      glebokosc--;
+      continue;
+    }
+    if (glebokosc + 1 == rozmiar)
+    {
+      rozmiar *= 2;
+      stany = realloc(stany, sizeof(uint32_t) * rozmiar);
+      kody = realloc(kody, sizeof(unsigned) * rozmiar);
+      slowo = realloc(slowo, sizeof(wchar_t) * (rozmiar + 1));
+    }
+    slowo[glebokosc] = da->litery[kody[glebokosc] - 1];
+    glebokosc++;
+    stany[glebokosc] = nastepny;
+    kody[glebokosc] = 0;
+    if (double_array_czy_slowo(da, nastepny))
+    {
+      slowo[glebokosc] = L'\0';
+      funkcja(slowo, glebokosc, dane);
+    }
+  }
+  free(stany);
+  free(kody);
+  free(slowo);
+}
@@ -0,0 +1,203 @@
+/** @file
+    Interfejs skompilowanej, tylko do odczytu, reprezentacji drzewa TRIE
+    w postaci podwójnej tablicy (BASE/CHECK).
+
+    Tablica budowana jest z gotowego drzewa (struct trie), zminimalizowanego
+    do acyklicznego automatu (DAWG), i pozwala przejść o jedną literę
+    w czasie stałym, odwołując się do jednej komórki tablicy.
+
+    @ingroup dictionary
+ */
+
+#ifndef __DOUBLE_ARRAY_H__
+#define __DOUBLE_ARRAY_H__
+
+#include "trie.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <wchar.h>
+
+/** Litery o kodach mniejszych od tej wartości tłumaczone są przez tablicę
+    bezpośrednią. Zakres obejmuje ASCII oraz polskie litery.
+ */
+#define DOUBLE_ARRAY_MALY_ZAKRES 0x180
+
+/** Największa liczba liter alfabetu: kody liter, od 1, zapisywane są
+    w etykietach komórek (uint16_t). */
+#define DOUBLE_ARRAY_MAKS_LITER (UINT16_MAX - 1)
+
+/** Stan oznaczający brak przejścia (komórka 0 jest stanem początkowym,
+    do którego nie prowadzi żadne przejście). */
+#define DOUBLE_ARRAY_BRAK 0
+
+/**
+  Pojedyncza komórka podwójnej tablicy.
+  */
+struct double_array_komorka
+{
+  /** Przesunięcie bloku dzieci (BASE), 0 jeśli wierzchołek nie ma dzieci. */
+  uint32_t baza;
+
+  /** Kod litery prowadzącej do komórki (CHECK), 0 dla komórki wolnej. */
+  uint16_t etykieta;
+
+  /** Czy w tym wierzchołku kończy się słowo. */
+  uint16_t czySlowo;
+};
+
+/**
+  Podwójna tablica reprezentująca zamrożony słownik.
+  */
+struct double_array
+{
+  /** Tablica komórek, komórka 0 jest korzeniem. */
+  struct double_array_komorka * komorki;
+
+  /** Liczba komórek (razem z zapasem na końcu tablicy). */
+  uint32_t rozmiar;
+
+  /** Posortowane litery występujące w drzewie, litera i ma kod i + 1. */
+  wchar_t * litery;
+
+  /** Liczba liter. */
+  int liczbaLiter;
+
+  /** Liczba stanów minimalnego automatu. */
+  uint32_t liczbaStanow;
+
+  /** Czy komórki i litery leżą w cudzej pamięci (np. w zmapowanym pliku),
+      której double_array_done() nie zwalnia. */
+  bool zewnetrzna;
+
+  /** Kody liter z zakresu [0, DOUBLE_ARRAY_MALY_ZAKRES). */
+  uint16_t kody[DOUBLE_ARRAY_MALY_ZAKRES];
+};
+
+/** Funkcja budująca podwójną tablicę z drzewa TRIE.
+ * @param[in] root Drzewo (może być NULL).
+ * @return Nowa podwójna tablica, którą należy zniszczyć double_array_done(),
+ * albo NULL, jeśli drzewo ma więcej niż DOUBLE_ARRAY_MAKS_LITER różnych liter.
+ */
+struct double_array * double_array_build(const struct trie * root);
+
+/** Funkcja zapisująca podwójną tablicę w postaci binarnej, którą można
+ * potem odczytać w miejscu funkcją double_array_widok(). Zapis zaczyna się
+ * i kończy na granicy 8 bajtów względem początku zapisu.
+ * @param[in] da Podwójna tablica.
+ * @param[in] stream Strumień do zapisu (binarny).
+ * @return True jeśli zapis się powiódł, false wpp.
+ */
+bool double_array_zapisz(const struct double_array * da, FILE * stream);
+
+/** Funkcja tworząca podwójną tablicę korzystającą bezpośrednio z danych
+ * zapisanych przez double_array_zapisz(), bez kopiowania komórek.
+ * @param[in] dane Początek zapisu, wyrównany do 8 bajtów. Dane muszą
+ * istnieć dłużej niż zwrócona tablica.
+ * @param[in] rozmiar Liczba bajtów dostępnych od początku zapisu.
+ * @return Nowa podwójna tablica albo NULL, jeśli dane są niepoprawne.
+ */
+struct double_array * double_array_widok(const void * dane, size_t rozmiar);
+
+/** Funkcja niszcząca podwójną tablicę.
+ * @param[in,out] da Niszczona tablica (może być NULL).
+ */
+void double_array_done(struct double_array * da);
+
+/** Funkcja zwracająca kod litery w podwójnej tablicy.
+ * @param[in] da Podwójna tablica.
+ * @param[in] litera Tłumaczona litera.
+ * @return Kod litery lub 0, jeśli litera nie występuje w słowniku.
+ */
+static inline
+unsigned double_array_kod(const struct double_array * da, wchar_t litera)
+{
+  if ((unsigned) litera < DOUBLE_ARRAY_MALY_ZAKRES)
+    return da->kody[litera];
+  int lewy = 0;
+  int prawy = da->liczbaLiter - 1;
+  while (lewy <= prawy)
+  {
+    int srodek = (lewy + prawy) >> 1;
+    if (da->litery[srodek] == litera)
+      return srodek + 1;
+    else if (da->litery[srodek] > litera)
+      prawy = srodek - 1;
+    else
+      lewy = srodek + 1;
+  }
+  return 0;
+}
+
+/** Przejście ze stanu po literze.
+ * @param[in] da Podwójna tablica.
+ * @param[in] stan Stan (komórka), 0 to stan początkowy.
+ * @param[in] litera Litera.
+ * @return Nowy stan albo DOUBLE_ARRAY_BRAK, jeśli przejścia nie ma.
+ */
+static inline
+uint32_t double_array_krok(const struct double_array * da, uint32_t stan,
+  wchar_t litera)
+{
+  unsigned kod = double_array_kod(da, litera);
+  uint32_t baza = da->komorki[stan].baza;
+  if (kod == 0 || baza == 0 || da->komorki[baza + kod].etykieta != kod)
+    return DOUBLE_ARRAY_BRAK;
+  return baza + kod;
+}
+
+/** Funkcja sprawdzająca, czy w danym stanie kończy się słowo.
+ * @param[in] da Podwójna tablica.
+ * @param[in] stan Stan.
+ * @return True jeśli stan jest akceptujący, false wpp.
+ */
+static inline
+bool double_array_czy_slowo(const struct double_array * da, uint32_t stan)
+{
+  return da->komorki[stan].czySlowo;
+}
+
+/** Następne przejście ze stanu, w kolejności liter.
+ * @param[in] da Podwójna tablica.
+ * @param[in] stan Stan.
+ * @param[in,out] kod Kod litery ostatniego przejścia (0, żeby dostać
+ * pierwsze); zmieniany na kod litery znalezionego przejścia, która
+ * jest równa da->litery[*kod - 1].
+ * @return Stan docelowy albo DOUBLE_ARRAY_BRAK, jeśli przejść już nie ma.
+ */
+static inline
+uint32_t double_array_nastepny_syn(const struct double_array * da, uint32_t stan,
+  unsigned * kod)
+{
+  uint32_t baza = da->komorki[stan].baza;
+  if (baza == 0)
+    return DOUBLE_ARRAY_BRAK;
+  for (unsigned k = *kod + 1; k <= (unsigned) da->liczbaLiter; k++)
+  {
+    if (da->komorki[baza + k].etykieta == k)
+    {
+      *kod = k;
+      return baza + k;
+    }
+  }
+  return DOUBLE_ARRAY_BRAK;
+}
+
+/** Funkcja sprawdzająca czy dane słowo występuje w podwójnej tablicy.
+ * @param[in] da Podwójna tablica.
+ * @param[in] slowo Szukane słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @return True jeśli słowo znajduje się w słowniku, false wpp.
+ */
+bool double_array_find(const struct double_array * da, const wchar_t * slowo,
+  int dlugosc);
+
+/** Funkcja wywołująca daną funkcję dla każdego słowa, w kolejności liter.
+ * @param[in] da Podwójna tablica.
+ * @param[in] funkcja Funkcja wywoływana ze słowem (zakończonym znakiem '\0',
+ * ważnym tylko w czasie wywołania), jego długością i wskaźnikiem dane.
+ * @param[in] dane Dodatkowy argument funkcji.
+ */
+void double_array_slowa(const struct double_array * da,
+  void (*funkcja)(const wchar_t * slowo, int dlugosc, void * dane), void * dane);
+
+#endif /* __DOUBLE_ARRAY_H__ */
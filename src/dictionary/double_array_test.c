@@ -0,0 +1,161 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <wchar.h>
+#include "double_array.h"
+
+wchar_t* first  = L"First string";
+wchar_t* second = L"Second string";
+wchar_t* third  = L"Third string";
+wchar_t* prefix = L"First";
+wchar_t* polish = L"źdźbło";
+
+static void double_array_empty_test(void** state) {
+    struct double_array * da = double_array_build(NULL);
+    assert_int_equal(double_array_find(da, first, wcslen(first)), 0);
+    assert_int_equal(double_array_find(da, L"", 0), 0);
+    double_array_done(da);
+}
+
+/* Drzewo ze słowami po sto kolejnych liter, łącznie `liczba` liter. */
+static struct trie * alfabet(int liczba) {
+    struct trie * t = NULL;
+    wchar_t word[101];
+    for (int poczatek = 0; poczatek < liczba; poczatek += 100) {
+        int dlugosc = liczba - poczatek < 100 ? liczba - poczatek : 100;
+        for (int i = 0; i < dlugosc; i++)
+            word[i] = 0x400 + poczatek + i;
+        word[dlugosc] = L'\0';
+        t = insert(word, dlugosc, t, 1);
+    }
+    return t;
+}
+
+static void double_array_alphabet_limit_test(void** state) {
+    /* Kody liter mieszczą się w etykietach komórek. */
+    struct trie * t = alfabet(DOUBLE_ARRAY_MAKS_LITER);
+    struct double_array * da = double_array_build(t);
+    assert_non_null(da);
+    assert_int_equal(da->liczbaLiter, DOUBLE_ARRAY_MAKS_LITER);
+    /* ostatnie słowo zawiera litery o największych kodach */
+    wchar_t word[100];
+    int dlugosc = 0;
+    for (int i = DOUBLE_ARRAY_MAKS_LITER / 100 * 100; i < DOUBLE_ARRAY_MAKS_LITER; i++)
+        word[dlugosc++] = 0x400 + i;
+    assert_int_equal(double_array_find(da, word, dlugosc), 1);
+    assert_int_equal(double_array_find(da, word, dlugosc - 1), 0);
+    double_array_done(da);
+    clean(t);
+    t = alfabet(DOUBLE_ARRAY_MAKS_LITER + 1);
+    assert_null(double_array_build(t));
+    clean(t);
+}
+
+static void double_array_find_test(void** state) {
+    struct trie * t = *state;
+    struct double_array * da = double_array_build(t);
+    assert_int_equal(double_array_find(da, first, wcslen(first)), 1);
+    assert_int_equal(double_array_find(da, second, wcslen(second)), 1);
+    assert_int_equal(double_array_find(da, third, wcslen(third)), 1);
+    assert_int_equal(double_array_find(da, polish, wcslen(polish)), 1);
+    double_array_done(da);
+}
+
+static void double_array_not_found_test(void** state) {
+    struct trie * t = *state;
+    struct double_array * da = double_array_build(t);
+    assert_int_equal(double_array_find(da, prefix, wcslen(prefix)), 0);
+    assert_int_equal(double_array_find(da, L"First strinG", 12), 0);
+    assert_int_equal(double_array_find(da, L"źdźbła", 6), 0);
+    assert_int_equal(double_array_find(da, L"Fifth", 5), 0);
+    double_array_done(da);
+}
+
+static void double_array_agrees_with_trie_test(void** state) {
+    struct trie * t = NULL;
+    wchar_t word[4];
+    word[3] = L'\0';
+    for (wchar_t a = L'a'; a <= L'e'; a++)
+        for (wchar_t b = L'a'; b <= L'e'; b++)
+            for (wchar_t c = L'a'; c <= L'e'; c++)
+            {
+                word[0] = a; word[1] = b; word[2] = c;
+                if ((a + b + c) % 3 == 0)
+                    t = insert(word, 3, t, 1);
+            }
+    struct double_array * da = double_array_build(t);
+    for (wchar_t a = L'a'; a <= L'f'; a++)
+        for (wchar_t b = L'a'; b <= L'f'; b++)
+            for (int c = L'a'; c <= L'f'; c++)
+            {
+                word[0] = a; word[1] = b; word[2] = c;
+                assert_int_equal(double_array_find(da, word, 3), finder(word, 3, 0, t));
+                assert_int_equal(double_array_find(da, word, 2), finder(word, 2, 0, t));
+            }
+    double_array_done(da);
+    clean(t);
+}
+
+static void double_array_shared_suffix_test(void** state) {
+    const wchar_t * words[] = { L"kot", L"kota", L"kotami", L"pies", L"piesa", L"piesami" };
+    struct trie * t = NULL;
+    for (int i = 0; i < 6; i++)
+        t = insert(words[i], wcslen(words[i]), t, 1);
+    struct double_array * da = double_array_build(t);
+    /* Końcówki "", "a", "ami" po "kot" i "pies" są wspólne. */
+    assert_int_equal(da->liczbaStanow, 10);
+    for (int i = 0; i < 6; i++)
+        assert_int_equal(double_array_find(da, words[i], wcslen(words[i])), 1);
+    assert_int_equal(double_array_find(da, L"kotam", 5), 0);
+    assert_int_equal(double_array_find(da, L"piesamia", 8), 0);
+    double_array_done(da);
+    clean(t);
+}
+
+static void collect(const wchar_t * word, int length, void * data) {
+    wchar_t * buffer = data;
+    assert_int_equal(wcslen(word), length);
+    wcscat(buffer, word);
+    wcscat(buffer, L" ");
+}
+
+static void double_array_words_test(void** state) {
+    struct trie * t = *state;
+    struct double_array * da = double_array_build(t);
+    wchar_t buffer[100] = L"";
+    double_array_slowa(da, collect, buffer);
+    assert_true(wcscmp(buffer, L"First string Second string Third string źdźbło ") == 0);
+    double_array_done(da);
+}
+
+static int double_array_setup(void **state) {
+    struct trie *t = NULL;
+    t = insert(first, wcslen(first), t, 1);
+    t = insert(second, wcslen(second), t, 1);
+    t = insert(third, wcslen(third), t, 1);
+    t = insert(polish, wcslen(polish), t, 1);
+    *state = t;
+    return 0;
+}
+
+static int double_array_teardown(void **state) {
+    struct trie * t = *state;
+    clean(t);
+    return 0;
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(double_array_empty_test),
+        cmocka_unit_test(double_array_agrees_with_trie_test),
+        cmocka_unit_test(double_array_shared_suffix_test),
+        cmocka_unit_test(double_array_alphabet_limit_test),
+        cmocka_unit_test_setup_teardown(double_array_words_test, double_array_setup, double_array_teardown),
+        cmocka_unit_test_setup_teardown(double_array_find_test, double_array_setup, double_array_teardown),
+        cmocka_unit_test_setup_teardown(double_array_not_found_test, double_array_setup, double_array_teardown),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,526 @@
+/** @file
+  Implementacja wyszukiwania słów odległych o niewiele edycji od wzorca.
+
+  @ingroup dictionary
+ */
+
+#include "levenshtein.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Szerokość zapamiętanego fragmentu wiersza: pas wokół przekątnej
+    i po jednej komórce z każdej strony. */
+#define SZEROKOSC(maks) (2 * (maks) + 3)
+
+/** Liczba wierszy tablicy (i liter ścieżki), dla których pamięć jest
+    w stanie wyszukiwania, bez przydzielania. */
+#define WIERSZE_W_STANIE 48
+
+/**
+  Stan wyszukiwania: wzorzec, bieżąca ścieżka i wiersze tablicy odległości
+  dla kolejnych jej liter.
+  */
+struct levenshtein
+{
+  /** Wzorzec. */
+  const wchar_t * wzorzec;
+
+  /** Długość wzorca. */
+  int dlugosc;
+
+  /** Dopuszczalna odległość. */
+  int maks;
+
+  /** Odległość, powyżej której ścieżki są odrzucane: początkowo maks,
+      zmniejszana przez funkcję wywoływaną dla znalezionych słów. */
+  int granica;
+
+  /** Czy przestawienie sąsiednich liter jest jedną edycją. */
+  bool przestawienia;
+
+  /** Wiersze tablicy, wiersz i odpowiada pierwszym i literom ścieżki.
+      Z wiersza i pamiętane są komórki od i - maks - 1 do i + maks + 1,
+      wartości większe od maks zapisywane są jako maks + 1. */
+  unsigned char * wiersze;
+
+  /** Litery bieżącej ścieżki. */
+  wchar_t * sciezka;
+
+  /** Pamięć wierszy dla krótkich wzorców. */
+  unsigned char wierszeWStanie[WIERSZE_W_STANIE * SZEROKOSC(LEVENSHTEIN_MAKS_ODLEGLOSC)];
+
+  /** Pamięć ścieżki dla krótkich wzorców. */
+  wchar_t sciezkaWStanie[WIERSZE_W_STANIE];
+
+  /** Funkcja wywoływana dla znalezionych słów. */
+  levenshtein_wynik funkcja;
+
+  /** Dane przekazywane funkcji. */
+  void * dane;
+};
+
+/** Komórka tablicy.
+ * @param[in] l Stan wyszukiwania.
+ * @param[in] i Numer wiersza.
+ * @param[in] j Numer kolumny, od i - maks - 1 do i + maks + 1.
+ * @return Wskaźnik na komórkę.
+ */
+static inline unsigned char * komorka(const struct levenshtein * l, int i, int j)
+{
+  return l->wiersze + (size_t) i * SZEROKOSC(l->maks) + (j - i + l->maks + 1);
+}
+
+/** Przygotowanie stanu wyszukiwania i zerowego wiersza tablicy.
+ * Ścieżki dłuższe niż dlugosc + maks liter nie mogą pasować, więc
+ * wystarcza dlugosc + maks + 1 wierszy.
+ * @param[out] l Stan wyszukiwania.
+ * @param[in] wzorzec Wzorzec.
+ * @param[in] dlugosc Długość wzorca.
+ * @param[in] maks Dopuszczalna odległość.
+ * @param[in] przestawienia Czy przestawienie liter jest jedną edycją.
+ * @param[in] funkcja Funkcja wywoływana dla znalezionych słów.
+ * @param[in] dane Dane przekazywane funkcji.
+ * @return True jeśli się udało, false jeśli zabrakło pamięci lub odległość
+ * jest spoza zakresu.
+ */
+static bool przygotuj(struct levenshtein * l, const wchar_t * wzorzec, int dlugosc,
+  int maks, bool przestawienia, levenshtein_wynik funkcja, void * dane)
+{
+  if (maks < 0 || maks > LEVENSHTEIN_MAKS_ODLEGLOSC || dlugosc < 0)
+    return false;
+  l->wzorzec = wzorzec;
+  l->dlugosc = dlugosc;
+  l->maks = maks;
+  l->granica = maks;
+  l->przestawienia = przestawienia;
+  l->funkcja = funkcja;
+  l->dane = dane;
+  if (dlugosc + maks + 1 <= WIERSZE_W_STANIE)
+  {
+    l->wiersze = l->wierszeWStanie;
+    l->sciezka = l->sciezkaWStanie;
+  }
+  else
+  {
+    l->wiersze = malloc((size_t) (dlugosc + maks + 1) * SZEROKOSC(maks));
+    l->sciezka = malloc(sizeof(wchar_t) * (dlugosc + maks + 1));
+    if (l->wiersze == NULL || l->sciezka == NULL)
+    {
+      free(l->wiersze);
+      free(l->sciezka);
+      return false;
+    }
+  }
+  memset(l->wiersze, maks + 1, SZEROKOSC(maks));
+  for (int j = 0; j <= dlugosc && j <= maks; j++)
+    *komorka(l, 0, j) = j;
+  return true;
+}
+
+/** Zwolnienie pamięci stanu wyszukiwania.
+ * @param[in,out] l Stan wyszukiwania.
+ */
+static void zwolnij(struct levenshtein * l)
+{
+  if (l->wiersze != l->wierszeWStanie)
+  {
+    free(l->wiersze);
+    free(l->sciezka);
+  }
+}
+
+/** Obliczenie wiersza i na podstawie dwóch poprzednich.
+ * @param[in,out] l Stan wyszukiwania, litera i to l->sciezka[i - 1].
+ * @param[in] i Numer wiersza, od 1 do dlugosc + maks.
+ * @return Najmniejsza wartość w wierszu (maks + 1, jeśli żadna ścieżka
+ * przez ten wierzchołek nie pasuje).
+ */
+static int krok(struct levenshtein * l, int i)
+{
+  const int n = l->dlugosc, maks = l->maks, granica = maks + 1;
+  const wchar_t * wzorzec = l->wzorzec;
+  const wchar_t litera = l->sciezka[i - 1];
+  const bool przestawienia = l->przestawienia && i >= 2;
+  int od = i - maks > 0 ? i - maks : 0;
+  int doKonca = i + maks < n ? i + maks : n;
+  int minimum = granica;
+  /* Komórki poza pasem (i poza wzorcem) przekraczają odległość. */
+  memset(komorka(l, i, i - maks - 1), granica, SZEROKOSC(maks));
+  for (int j = od; j <= doKonca; j++)
+  {
+    int d;
+    if (j == 0)
+      d = i;
+    else
+    {
+      d = *komorka(l, i - 1, j - 1) + (litera != wzorzec[j - 1]);
+      if (*komorka(l, i - 1, j) + 1 < d)
+        d = *komorka(l, i - 1, j) + 1;
+      if (*komorka(l, i, j - 1) + 1 < d)
+        d = *komorka(l, i, j - 1) + 1;
+      if (przestawienia && j >= 2 && litera == wzorzec[j - 2] &&
+        l->sciezka[i - 2] == wzorzec[j - 1] && *komorka(l, i - 2, j - 2) + 1 < d)
+        d = *komorka(l, i - 2, j - 2) + 1;
+    }
+    if (d > granica)
+      d = granica;
+    *komorka(l, i, j) = d;
+    if (d < minimum)
+      minimum = d;
+  }
+  return minimum;
+}
+
+/** Odległość całej ścieżki od wzorca.
+ * @param[in] l Stan wyszukiwania.
+ * @param[in] i Długość ścieżki (wiersz i musi być obliczony).
+ * @return Odległość lub maks + 1, jeśli jest większa niż dopuszczalna.
+ */
+static inline int odleglosc(const struct levenshtein * l, int i)
+{
+  if (abs(i - l->dlugosc) > l->maks)
+    return l->maks + 1;
+  return *komorka(l, i, l->dlugosc);
+}
+
+/** Zgłoszenie słowa o danej odległości, jeśli jeszcze jest potrzebne.
+ * @param[in,out] l Stan wyszukiwania.
+ * @param[in] i Długość ścieżki, która jest słowem.
+ * @param[in] d Odległość słowa od wzorca.
+ */
+static void zglosSlowo(struct levenshtein * l, int i, int d)
+{
+  if (d > l->granica)
+    return;
+  l->sciezka[i] = L'\0';
+  int granica = l->funkcja(l->sciezka, i, d, l->dane);
+  if (granica < l->granica)
+    l->granica = granica;
+}
+
+/** Zgłoszenie ścieżki, jeśli jest dość blisko wzorca.
+ * @param[in,out] l Stan wyszukiwania.
+ * @param[in] i Długość ścieżki.
+ */
+static void zglos(struct levenshtein * l, int i)
+{
+  zglosSlowo(l, i, odleglosc(l, i));
+}
+
+/** Litery, od których mogą zaczynać się pasujące przedłużenia ścieżki
+ * długości i, gdy najmniejsza wartość jej wiersza równa się maks. Nie ma
+ * już miejsca na zamianę ani wstawienie, więc litera musi być zgodna
+ * z literą wzorca za komórką o wartości maks (albo kończyć przestawienie),
+ * i zamiast przeglądać wszystkich synów wystarczy zajrzeć do tych kilku.
+ * @param[in] l Stan wyszukiwania.
+ * @param[in] i Długość ścieżki.
+ * @param[out] litery Posortowane litery bez powtórzeń, miejsce na
+ * 2 * SZEROKOSC(maks) liter.
+ * @return Liczba liter.
+ */
+static int literyOkna(const struct levenshtein * l, int i, wchar_t * litery)
+{
+  int od = i + 1 - l->maks > 1 ? i + 1 - l->maks : 1;
+  int doKonca = i + 1 + l->maks < l->dlugosc ? i + 1 + l->maks : l->dlugosc;
+  int ile = 0;
+  for (int j = od; j <= doKonca; j++)
+  {
+    wchar_t kandydaci[2];
+    int ileKandydatow = 0;
+    if (*komorka(l, i, j - 1) <= l->maks)
+      kandydaci[ileKandydatow++] = l->wzorzec[j - 1];
+    if (l->przestawienia && i >= 1 && j >= 2 && l->sciezka[i - 1] == l->wzorzec[j - 1] &&
+      *komorka(l, i - 1, j - 2) < l->maks)
+      kandydaci[ileKandydatow++] = l->wzorzec[j - 2];
+    for (int c = 0; c < ileKandydatow; c++)
+    {
+      wchar_t litera = kandydaci[c];
+      int k = ile;
+      while (k > 0 && litery[k - 1] > litera)
+        k--;
+      if (k > 0 && litery[k - 1] == litera)
+        continue;
+      memmove(litery + k + 1, litery + k, sizeof(wchar_t) * (ile - k));
+      litery[k] = litera;
+      ile++;
+    }
+  }
+  return ile;
+}
+
+/** Sprawdzenie, czy przedłużenie ścieżki może jeszcze dokończyć
+ * przestawienie liter.
+ * @param[in] l Stan wyszukiwania.
+ * @param[in] i Długość ścieżki.
+ * @return True jeśli któraś komórka następnego wiersza może pochodzić
+ * z przestawienia.
+ */
+static bool przestawienieMozliwe(const struct levenshtein * l, int i)
+{
+  if (!l->przestawienia || i < 1)
+    return false;
+  int od = i + 1 - l->maks > 2 ? i + 1 - l->maks : 2;
+  int doKonca = i + 1 + l->maks < l->dlugosc ? i + 1 + l->maks : l->dlugosc;
+  for (int j = od; j <= doKonca; j++)
+    if (l->sciezka[i - 1] == l->wzorzec[j - 1] && *komorka(l, i - 1, j - 2) < l->maks)
+      return true;
+  return false;
+}
+
+/** Porównanie reszt wzorca w kolejności słownikowej.
+ * @param[in] l Stan wyszukiwania.
+ * @param[in] a Kolumna początku pierwszej reszty.
+ * @param[in] b Kolumna początku drugiej reszty.
+ * @return Liczba ujemna, zero lub dodatnia, jak w wcscmp().
+ */
+static int porownajReszty(const struct levenshtein * l, int a, int b)
+{
+  int dlugoscA = l->dlugosc - a, dlugoscB = l->dlugosc - b;
+  int wynik = wmemcmp(l->wzorzec + a, l->wzorzec + b,
+    dlugoscA < dlugoscB ? dlugoscA : dlugoscB);
+  return wynik != 0 ? wynik : dlugoscA - dlugoscB;
+}
+
+/** Kolumny wiersza, od których dokończenie ścieżki musi być dokładnie
+ * resztą wzorca, gdy wykorzystano już wszystkie edycje. Kolumny ułożone
+ * są według reszt wzorca, żeby słowa były zgłaszane w kolejności liter.
+ * @param[in] l Stan wyszukiwania.
+ * @param[in] i Długość ścieżki.
+ * @param[out] kolumny Kolumny, miejsce na SZEROKOSC(maks) kolumn.
+ * @return Liczba kolumn.
+ */
+static int kolumnyReszty(const struct levenshtein * l, int i, int * kolumny)
+{
+  int od = i - l->maks > 0 ? i - l->maks : 0;
+  int doKonca = i + l->maks < l->dlugosc - 1 ? i + l->maks : l->dlugosc - 1;
+  int ile = 0;
+  for (int j = od; j <= doKonca; j++)
+  {
+    if (*komorka(l, i, j) > l->maks)
+      continue;
+    int k = ile;
+    while (k > 0 && porownajReszty(l, kolumny[k - 1], j) > 0)
+      k--;
+    memmove(kolumny + k + 1, kolumny + k, sizeof(int) * (ile - k));
+    kolumny[k] = j;
+    ile++;
+  }
+  return ile;
+}
+
+/** Zejście z wierzchołka ścieżką równą reszcie wzorca od danej kolumny.
+ * @param[in,out] l Stan wyszukiwania.
+ * @param[in] wezel Wierzchołek.
+ * @param[in] dlugosc Długość ścieżki do wierzchołka.
+ * @param[in] j Kolumna, od której zaczyna się reszta wzorca.
+ */
+static void dopasujWezel(struct levenshtein * l, const struct trie * wezel,
+  int dlugosc, int j)
+{
+  const wchar_t * wzorzec = l->wzorzec;
+  while (j < l->dlugosc)
+  {
+    wezel = trie_syn_litery(wezel, wzorzec[j]);
+    if (wezel == NULL || wezel->krawedz > l->dlugosc - j ||
+      wmemcmp(trie_reszta(wezel), wzorzec + j + 1, wezel->krawedz - 1))
+      return;
+    wmemcpy(l->sciezka + dlugosc, wzorzec + j, wezel->krawedz);
+    dlugosc += wezel->krawedz;
+    j += wezel->krawedz;
+  }
+  if (wezel->czySlowo)
+    zglosSlowo(l, dlugosc, l->maks);
+}
+
+/** Zejście ze stanu ścieżką równą reszcie wzorca od danej kolumny.
+ * @param[in,out] l Stan wyszukiwania.
+ * @param[in] da Podwójna tablica.
+ * @param[in] stan Stan.
+ * @param[in] dlugosc Długość ścieżki do stanu.
+ * @param[in] j Kolumna, od której zaczyna się reszta wzorca.
+ */
+static void dopasujStan(struct levenshtein * l, const struct double_array * da,
+  uint32_t stan, int dlugosc, int j)
+{
+  for (; j < l->dlugosc; j++)
+  {
+    stan = double_array_krok(da, stan, l->wzorzec[j]);
+    if (stan == DOUBLE_ARRAY_BRAK)
+      return;
+    l->sciezka[dlugosc++] = l->wzorzec[j];
+  }
+  if (double_array_czy_slowo(da, stan))
+    zglosSlowo(l, dlugosc, l->maks);
+}
+
+/** Przeszukanie poddrzewa.
+ * @param[in,out] l Stan wyszukiwania.
+ * @param[in] wezel Wierzchołek.
+ * @param[in] poczatek Długość ścieżki do ojca (jej wiersz jest obliczony).
+ * @param[in] minimum Najmniejsza wartość tego wiersza.
+ */
+static void odwiedzWezel(struct levenshtein * l, const struct trie * wezel,
+  int poczatek, int minimum)
+{
+  int koniec = poczatek + wezel->krawedz;
+  for (int i = poczatek + 1; i <= koniec; i++)
+  {
+    if (i > l->dlugosc + l->maks)
+      return;
+    l->sciezka[i - 1] = i == poczatek + 1 ? wezel->litera :
+      trie_reszta(wezel)[i - poczatek - 2];
+    minimum = krok(l, i);
+    if (minimum > l->granica)
+      return;
+  }
+  if (wezel->czySlowo)
+    zglos(l, koniec);
+  if (koniec == l->dlugosc + l->maks)
+    return;
+  if (minimum < l->maks)
+  {
+    for (int i = trie_nastepny_syn(wezel, -1); i != -1; i = trie_nastepny_syn(wezel, i))
+      odwiedzWezel(l, trie_syn(wezel, i), koniec, minimum);
+    return;
+  }
+  if (!przestawienieMozliwe(l, koniec))
+  {
+    int kolumny[SZEROKOSC(LEVENSHTEIN_MAKS_ODLEGLOSC)];
+    int ile = kolumnyReszty(l, koniec, kolumny);
+    for (int i = 0; i < ile; i++)
+      dopasujWezel(l, wezel, koniec, kolumny[i]);
+    return;
+  }
+  wchar_t litery[2 * SZEROKOSC(LEVENSHTEIN_MAKS_ODLEGLOSC)];
+  int ile = literyOkna(l, koniec, litery);
+  for (int i = 0; i < ile; i++)
+  {
+    const struct trie * syn = trie_syn_litery(wezel, litery[i]);
+    if (syn != NULL)
+      odwiedzWezel(l, syn, koniec, minimum);
+  }
+}
+
+/** Przeszukanie stanów podwójnej tablicy osiągalnych z danego stanu.
+ * @param[in,out] l Stan wyszukiwania.
+ * @param[in] da Podwójna tablica.
+ * @param[in] stan Stan.
+ * @param[in] glebokosc Długość ścieżki do stanu (jej wiersz jest obliczony).
+ * @param[in] minimum Najmniejsza wartość tego wiersza.
+ */
+static void odwiedzStan(struct levenshtein * l, const struct double_array * da,
+  uint32_t stan, int glebokosc, int minimum)
+{
+  if (double_array_czy_slowo(da, stan))
+    zglos(l, glebokosc);
+  if (glebokosc == l->dlugosc + l->maks)
+    return;
+  if (minimum < l->maks)
+  {
+    unsigned kod = 0;
+    uint32_t syn;
+    while ((syn = double_array_nastepny_syn(da, stan, &kod)) != DOUBLE_ARRAY_BRAK)
+    {
+      l->sciezka[glebokosc] = da->litery[kod - 1];
+      int nowe = krok(l, glebokosc + 1);
+      if (nowe <= l->granica)
+        odwiedzStan(l, da, syn, glebokosc + 1, nowe);
+    }
+    return;
+  }
+  if (!przestawienieMozliwe(l, glebokosc))
+  {
+    int kolumny[SZEROKOSC(LEVENSHTEIN_MAKS_ODLEGLOSC)];
+    int ile = kolumnyReszty(l, glebokosc, kolumny);
+    for (int i = 0; i < ile; i++)
+      dopasujStan(l, da, stan, glebokosc, kolumny[i]);
+    return;
+  }
+  wchar_t litery[2 * SZEROKOSC(LEVENSHTEIN_MAKS_ODLEGLOSC)];
+  int ile = literyOkna(l, glebokosc, litery);
+  for (int i = 0; i < ile; i++)
+  {
+    uint32_t syn = double_array_krok(da, stan, litery[i]);
+    if (syn == DOUBLE_ARRAY_BRAK)
+      continue;
+    l->sciezka[glebokosc] = litery[i];
+    int nowe = krok(l, glebokosc + 1);
+    if (nowe <= l->granica)
+      odwiedzStan(l, da, syn, glebokosc + 1, nowe);
+  }
+}
+
+void levenshtein_trie(const struct trie * root, const wchar_t * wzorzec,
+  int dlugosc, int maksOdleglosc, bool przestawienia, levenshtein_wynik funkcja,
+  void * dane)
+{
+  struct levenshtein l;
+  if (root == NULL || !przygotuj(&l, wzorzec, dlugosc, maksOdleglosc,
+    przestawienia, funkcja, dane))
+    return;
+  odwiedzWezel(&l, root, 0, 0);
+  zwolnij(&l);
+}
+
+void levenshtein_double_array(const struct double_array * da,
+  const wchar_t * wzorzec, int dlugosc, int maksOdleglosc, bool przestawienia,
+  levenshtein_wynik funkcja, void * dane)
+{
+  struct levenshtein l;
+  if (da == NULL || !przygotuj(&l, wzorzec, dlugosc, maksOdleglosc,
+    przestawienia, funkcja, dane))
+    return;
+  odwiedzStan(&l, da, 0, 0, 0);
+  zwolnij(&l);
+}
+
+/** Liczba komórek wiersza, dla których pamięć bierze się ze stosu. */
+#define WIERSZ_NA_STOSIE 64
+
+int levenshtein_odleglosc(const wchar_t * a, int n, const wchar_t * b, int m,
+  int maks, bool przestawienia)
+{
+  if (abs(n - m) > maks)
+    return maks + 1;
+  /* Trzy ostatnie wiersze tablicy: wiersz i odpowiada i literom słowa a. */
+  int naStosie[3 * WIERSZ_NA_STOSIE];
+  int * pamiec = naStosie;
+  if (m + 1 > WIERSZ_NA_STOSIE)
+    pamiec = malloc(sizeof(int) * 3 * (m + 1));
+  int * przedostatni = pamiec, * poprzedni = pamiec + m + 1,
+    * biezacy = pamiec + 2 * (m + 1);
+  for (int j = 0; j <= m; j++)
+    poprzedni[j] = j;
+  int wynik = -1;
+  for (int i = 1; i <= n && wynik < 0; i++)
+  {
+    int minimum = biezacy[0] = i;
+    for (int j = 1; j <= m; j++)
+    {
+      int d = poprzedni[j - 1] + (a[i - 1] != b[j - 1]);
+      if (poprzedni[j] + 1 < d)
+        d = poprzedni[j] + 1;
+      if (biezacy[j - 1] + 1 < d)
+        d = biezacy[j - 1] + 1;
+      if (przestawienia && i >= 2 && j >= 2 && a[i - 1] == b[j - 2] &&
+        a[i - 2] == b[j - 1] && przedostatni[j - 2] + 1 < d)
+        d = przedostatni[j - 2] + 1;
+      biezacy[j] = d;
+      if (d < minimum)
+        minimum = d;
+    }
+    /* Odległość całych słów nie jest mniejsza od najmniejszej wartości
+       w wierszu. */
+    if (minimum > maks)
+      wynik = maks + 1;
+    int * wolny = przedostatni;
+    przedostatni = poprzedni;
+    poprzedni = biezacy;
+    biezacy = wolny;
+  }
+  if (wynik < 0)
+    wynik = poprzedni[m] > maks ? maks + 1 : poprzedni[m];
+  if (pamiec != naStosie)
+    free(pamiec);
+  return wynik;
+}
@@ -0,0 +1,79 @@
+/** @file
+    Interfejs wyszukiwania słów odległych o niewiele edycji od wzorca.
+
+    Drzewo (albo podwójna tablica zamrożonego słownika) przechodzone jest
+    raz, w głąb. Dla każdej litery na ścieżce liczony jest kolejny wiersz
+    tablicy programowania dynamicznego odległości edycyjnej od wzorca,
+    a poddrzewo jest pomijane, gdy wszystkie wartości w wierszu przekraczają
+    dopuszczalną odległość. Liczone są tylko komórki w pasie szerokości
+    2 * odległość + 1 wokół przekątnej, pozostałe i tak ją przekraczają.
+
+    @ingroup dictionary
+ */
+
+#ifndef __LEVENSHTEIN_H__
+#define __LEVENSHTEIN_H__
+
+#include <stdbool.h>
+#include <wchar.h>
+#include "trie.h"
+#include "double_array.h"
+
+/** Największa obsługiwana odległość edycyjna. */
+#define LEVENSHTEIN_MAKS_ODLEGLOSC 2
+
+/** Funkcja otrzymująca znalezione słowo.
+ * @param[in] slowo Słowo zakończone znakiem '\0', ważne tylko w czasie
+ * wywołania.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] odleglosc Odległość słowa od wzorca.
+ * @param[in,out] dane Dane przekazane do wyszukiwania.
+ * @return Największa odległość, przy której kolejne słowa są jeszcze
+ * potrzebne; wyszukiwanie pomija dalej słowa odleglejsze (wartość nie
+ * mniejsza od dopuszczalnej odległości niczego nie zmienia).
+ */
+typedef int (* levenshtein_wynik)(const wchar_t * slowo, int dlugosc,
+  int odleglosc, void * dane);
+
+/** Wyszukiwanie w drzewie słów odległych od wzorca o co najwyżej
+ * maksOdleglosc wstawień, usunięć i zamian liter (oraz, jeśli przestawienia
+ * są włączone, zamian miejscami dwóch sąsiednich liter). Słowa zgłaszane są
+ * w kolejności liter, każde raz.
+ * @param[in] root Drzewo (może być NULL).
+ * @param[in] wzorzec Wzorzec.
+ * @param[in] dlugosc Długość wzorca.
+ * @param[in] maksOdleglosc Odległość z zakresu [0, LEVENSHTEIN_MAKS_ODLEGLOSC].
+ * @param[in] przestawienia Czy przestawienie sąsiednich liter jest jedną edycją.
+ * @param[in] funkcja Funkcja wywoływana dla każdego znalezionego słowa.
+ * @param[in,out] dane Dane przekazywane funkcji.
+ */
+void levenshtein_trie(const struct trie * root, const wchar_t * wzorzec,
+  int dlugosc, int maksOdleglosc, bool przestawienia, levenshtein_wynik funkcja,
+  void * dane);
+
+/** Wyszukiwanie jak w levenshtein_trie(), ale w podwójnej tablicy.
+ * @param[in] da Podwójna tablica.
+ * @param[in] wzorzec Wzorzec.
+ * @param[in] dlugosc Długość wzorca.
+ * @param[in] maksOdleglosc Odległość z zakresu [0, LEVENSHTEIN_MAKS_ODLEGLOSC].
+ * @param[in] przestawienia Czy przestawienie sąsiednich liter jest jedną edycją.
+ * @param[in] funkcja Funkcja wywoływana dla każdego znalezionego słowa.
+ * @param[in,out] dane Dane przekazywane funkcji.
+ */
+void levenshtein_double_array(const struct double_array * da,
+  const wchar_t * wzorzec, int dlugosc, int maksOdleglosc, bool przestawienia,
+  levenshtein_wynik funkcja, void * dane);
+
+/** Odległość edycyjna dwóch słów, liczona tak jak przy wyszukiwaniu.
+ * @param[in] a Pierwsze słowo.
+ * @param[in] n Długość pierwszego słowa.
+ * @param[in] b Drugie słowo.
+ * @param[in] m Długość drugiego słowa.
+ * @param[in] maks Dopuszczalna odległość.
+ * @param[in] przestawienia Czy przestawienie sąsiednich liter jest jedną edycją.
+ * @return Odległość albo maks + 1, jeśli jest większa niż dopuszczalna.
+ */
+int levenshtein_odleglosc(const wchar_t * a, int n, const wchar_t * b, int m,
+  int maks, bool przestawienia);
+
+#endif /* __LEVENSHTEIN_H__ */
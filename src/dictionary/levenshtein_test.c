@@ -0,0 +1,209 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <wchar.h>
+#include "levenshtein.h"
+
+/* Liczba słów w losowym słowniku. */
+#define LICZBA_SLOW 400
+
+/* Zebrane wyniki wyszukiwania. */
+struct wyniki {
+    wchar_t slowa[LICZBA_SLOW][16];
+    int odleglosci[LICZBA_SLOW];
+    int liczba;
+};
+
+static int zbierz(const wchar_t * slowo, int dlugosc, int odleglosc, void * dane) {
+    struct wyniki * w = dane;
+    assert_true(w->liczba < LICZBA_SLOW);
+    assert_int_equal(wcslen(slowo), dlugosc);
+    wcscpy(w->slowa[w->liczba], slowo);
+    w->odleglosci[w->liczba++] = odleglosc;
+    return LEVENSHTEIN_MAKS_ODLEGLOSC;
+}
+
+/* Zapamiętuje tylko odległości, słowa mogą być dłuższe niż w struct wyniki. */
+static int zbierzOdleglosci(const wchar_t * slowo, int dlugosc, int odleglosc, void * dane) {
+    struct wyniki * w = dane;
+    assert_true(w->liczba < LICZBA_SLOW);
+    assert_int_equal(wcslen(slowo), dlugosc);
+    w->odleglosci[w->liczba++] = odleglosc;
+    return LEVENSHTEIN_MAKS_ODLEGLOSC;
+}
+
+/* Po pierwszym słowie potrzebne są już tylko słowa nie dalsze od niego. */
+static int zbierzBliskie(const wchar_t * slowo, int dlugosc, int odleglosc, void * dane) {
+    zbierz(slowo, dlugosc, odleglosc, dane);
+    return odleglosc;
+}
+
+/* Odległość liczona wprost, pełną tablicą. */
+static int odleglosc(const wchar_t * a, const wchar_t * b, int przestawienia) {
+    int n = wcslen(a), m = wcslen(b);
+    int d[16][16];
+    for (int i = 0; i <= n; i++)
+        for (int j = 0; j <= m; j++) {
+            if (i == 0 || j == 0) {
+                d[i][j] = i + j;
+                continue;
+            }
+            int w = d[i - 1][j - 1] + (a[i - 1] != b[j - 1]);
+            if (d[i - 1][j] + 1 < w)
+                w = d[i - 1][j] + 1;
+            if (d[i][j - 1] + 1 < w)
+                w = d[i][j - 1] + 1;
+            if (przestawienia && i > 1 && j > 1 && a[i - 1] == b[j - 2] &&
+                a[i - 2] == b[j - 1] && d[i - 2][j - 2] + 1 < w)
+                w = d[i - 2][j - 2] + 1;
+            d[i][j] = w;
+        }
+    return d[n][m];
+}
+
+static int porownaj(const void * a, const void * b) {
+    return wcscmp(a, b);
+}
+
+static void levenshtein_example_test(void** state) {
+    const wchar_t * slowa[] = { L"kot", L"koty", L"kto", L"lot", L"pies" };
+    struct trie * t = NULL;
+    for (int i = 0; i < 5; i++)
+        t = insert(slowa[i], wcslen(slowa[i]), t, 1);
+    struct wyniki w;
+    w.liczba = 0;
+    levenshtein_trie(t, L"kot", 3, 1, false, zbierz, &w);
+    assert_int_equal(w.liczba, 3);
+    assert_true(wcscmp(w.slowa[0], L"kot") == 0);
+    assert_int_equal(w.odleglosci[0], 0);
+    assert_true(wcscmp(w.slowa[1], L"koty") == 0);
+    assert_true(wcscmp(w.slowa[2], L"lot") == 0);
+    w.liczba = 0;
+    levenshtein_trie(t, L"kot", 3, 1, true, zbierz, &w);
+    assert_int_equal(w.liczba, 4);
+    assert_true(wcscmp(w.slowa[2], L"kto") == 0);
+    w.liczba = 0;
+    levenshtein_trie(t, L"kot", 3, 3, true, zbierz, &w);
+    assert_int_equal(w.liczba, 0);
+    /* po znalezieniu samego wzorca dalsze słowa są pomijane */
+    w.liczba = 0;
+    levenshtein_trie(t, L"kot", 3, 1, true, zbierzBliskie, &w);
+    assert_int_equal(w.liczba, 1);
+    struct double_array * da = double_array_build(t);
+    w.liczba = 0;
+    levenshtein_double_array(da, L"kot", 3, 1, true, zbierzBliskie, &w);
+    assert_int_equal(w.liczba, 1);
+    w.liczba = 0;
+    levenshtein_double_array(da, L"kota", 4, 1, true, zbierzBliskie, &w);
+    assert_int_equal(w.liczba, 2);
+    double_array_done(da);
+    clean(t);
+}
+
+static void levenshtein_random_test(void** state) {
+    static wchar_t slowa[LICZBA_SLOW][16];
+    unsigned ziarno = 12345;
+    struct trie * t = NULL;
+    for (int i = 0; i < LICZBA_SLOW; i++) {
+        ziarno = ziarno * 1103515245 + 12345;
+        int dlugosc = 1 + (ziarno >> 16) % 7;
+        for (int j = 0; j < dlugosc; j++) {
+            ziarno = ziarno * 1103515245 + 12345;
+            slowa[i][j] = L'a' + (ziarno >> 16) % 4;
+        }
+        slowa[i][dlugosc] = L'\0';
+        t = insert(slowa[i], dlugosc, t, 1);
+    }
+    qsort(slowa, LICZBA_SLOW, sizeof(slowa[0]), porownaj);
+    struct double_array * da = double_array_build(t);
+    static struct wyniki drzewo, tablica;
+    for (int p = 0; p < 60; p++) {
+        const wchar_t * wzorzec = slowa[p * 7 % LICZBA_SLOW];
+        wchar_t zmieniony[16];
+        wcscpy(zmieniony, wzorzec);
+        zmieniony[p % wcslen(zmieniony)] = L'a' + p % 5;
+        if (p % 2)
+            wzorzec = zmieniony;
+        for (int k = 0; k <= LEVENSHTEIN_MAKS_ODLEGLOSC; k++)
+            for (int przestawienia = 0; przestawienia < 2; przestawienia++) {
+                drzewo.liczba = tablica.liczba = 0;
+                levenshtein_trie(t, wzorzec, wcslen(wzorzec), k, przestawienia, zbierz, &drzewo);
+                levenshtein_double_array(da, wzorzec, wcslen(wzorzec), k, przestawienia, zbierz, &tablica);
+                int oczekiwane = 0;
+                for (int i = 0; i < LICZBA_SLOW; i++) {
+                    if (i > 0 && wcscmp(slowa[i], slowa[i - 1]) == 0)
+                        continue;
+                    int d = odleglosc(slowa[i], wzorzec, przestawienia);
+                    assert_int_equal(levenshtein_odleglosc(slowa[i], wcslen(slowa[i]),
+                        wzorzec, wcslen(wzorzec), k, przestawienia), d > k ? k + 1 : d);
+                    if (d > k)
+                        continue;
+                    assert_true(oczekiwane < drzewo.liczba);
+                    assert_true(wcscmp(drzewo.slowa[oczekiwane], slowa[i]) == 0);
+                    assert_int_equal(drzewo.odleglosci[oczekiwane], d);
+                    assert_true(wcscmp(tablica.slowa[oczekiwane], slowa[i]) == 0);
+                    assert_int_equal(tablica.odleglosci[oczekiwane], d);
+                    oczekiwane++;
+                }
+                assert_int_equal(drzewo.liczba, oczekiwane);
+                assert_int_equal(tablica.liczba, oczekiwane);
+            }
+    }
+    double_array_done(da);
+    clean(t);
+}
+
+static void levenshtein_long_edge_test(void** state) {
+    /* Długie krawędzie przecinają granicę dopuszczalnej długości ścieżki. */
+    struct trie * t = NULL;
+    t = insert(L"abcdefghijklmnop", 16, t, 1);
+    t = insert(L"abcdefghijklmnoq", 16, t, 1);
+    t = insert(L"ab", 2, t, 1);
+    struct wyniki w;
+    w.liczba = 0;
+    levenshtein_trie(t, L"abcdefghijklmnp", 15, 2, false, zbierz, &w);
+    assert_int_equal(w.liczba, 2);
+    assert_int_equal(w.odleglosci[0], 1);
+    assert_int_equal(w.odleglosci[1], 2);
+    w.liczba = 0;
+    levenshtein_trie(t, L"a", 1, 1, false, zbierz, &w);
+    assert_int_equal(w.liczba, 1);
+    assert_true(wcscmp(w.slowa[0], L"ab") == 0);
+    clean(t);
+}
+
+static void levenshtein_long_word_test(void** state) {
+    /* Wzorzec dłuższy niż pamięć wierszy w stanie wyszukiwania. */
+    wchar_t slowo[81], wzorzec[81];
+    for (int i = 0; i < 80; i++)
+        slowo[i] = L'a' + i % 26;
+    slowo[80] = L'\0';
+    wcscpy(wzorzec, slowo);
+    wzorzec[40] = L'z';
+    struct trie * t = insert(slowo, 80, NULL, 1);
+    struct wyniki w;
+    w.liczba = 0;
+    levenshtein_trie(t, wzorzec, 80, 1, false, zbierzOdleglosci, &w);
+    assert_int_equal(w.liczba, 1);
+    assert_int_equal(w.odleglosci[0], 1);
+    struct double_array * da = double_array_build(t);
+    w.liczba = 0;
+    levenshtein_double_array(da, wzorzec + 1, 79, 2, false, zbierzOdleglosci, &w);
+    assert_int_equal(w.liczba, 1);
+    assert_int_equal(w.odleglosci[0], 2);
+    double_array_done(da);
+    clean(t);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(levenshtein_example_test),
+        cmocka_unit_test(levenshtein_random_test),
+        cmocka_unit_test(levenshtein_long_edge_test),
+        cmocka_unit_test(levenshtein_long_word_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
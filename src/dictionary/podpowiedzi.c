@@ -0,0 +1,830 @@
+/** @file
+  Implementacja wyszukiwania podpowiedzi według reguł słownika.
+
+  @ingroup dictionary
+ */
+
+#include "podpowiedzi.h"
+#include "arena.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Największy koszt, przy którym podpowiedzi szukane są przez podział słowa
+    (koszty podziału reszty słowa są bitami liczby 64-bitowej). */
+#define PODZIAL_MAKS_KOSZT 63
+
+/**
+  Miejsce w słowniku odpowiadające przeczytanemu przedrostkowi słowa.
+  */
+struct miejsce
+{
+  /** Wierzchołek drzewa albo NULL, jeśli słownik jest podwójną tablicą. */
+  const struct trie * wezel;
+
+  /** Liczba przeczytanych liter krawędzi wierzchołka albo stan podwójnej
+      tablicy. */
+  uint32_t stan;
+};
+
+/**
+  Stan przeszukiwania. Stany tworzą drzewo (pole poprzedni), po którym
+  odtwarzane są podpowiedzi; stany pośrednie, powstające przy wypisywaniu
+  prawej strony reguły litera po literze, nie trafiają do kolejki.
+  */
+struct stan
+{
+  /** Stan, do którego dopisano literę (NULL dla stanu początkowego). */
+  const struct stan * poprzedni;
+
+  /** Pierwszy utworzony stan o tej samej podpowiedzi (może to być ten sam
+      stan). Podpowiedź wyznacza miejsce w słowniku, więc stany utożsamiane
+      są przez przedrostek i pozycję; w podwójnej tablicy różne przedrostki
+      mogą prowadzić do wspólnego stanu automatu. */
+  struct stan * przedrostek;
+
+  /** Następny stan w kubełku kolejki. */
+  struct stan * nastepny;
+
+  /** Miejsce w słowniku bieżącego słowa. */
+  struct miejsce miejsce;
+
+  /** Liczba przeczytanych liter słowa wejściowego. */
+  int pozycja;
+
+  /** Koszt dojścia do stanu. */
+  int koszt;
+
+  /** Dopisana litera, spacja dla podziału słowa, '\0' jeśli żadna. */
+  wchar_t litera;
+
+  /** Czy podpowiedź została już zgłoszona (tylko w pierwszym stanie
+      przedrostka). */
+  bool zgloszony;
+};
+
+/**
+  Klucz stanu w zbiorze rozwiniętych stanów.
+  */
+struct klucz
+{
+  /** Przedrostek podpowiedzi, NULL dla pustego miejsca w tablicy. */
+  const struct stan * przedrostek;
+
+  /** Pozycja w słowie. */
+  int pozycja;
+};
+
+/**
+  Przedrostek w zbiorze przedrostków: przedłużenie przedrostka literą.
+  */
+struct wpis
+{
+  /** Przedłużany przedrostek. */
+  const struct stan * rodzic;
+
+  /** Pierwszy stan przedłużonego przedrostka, NULL dla pustego miejsca
+      w tablicy. */
+  struct stan * stan;
+
+  /** Litera. */
+  wchar_t litera;
+};
+
+/**
+  Przeszukiwanie.
+  */
+struct przeszukiwanie
+{
+  /** Drzewo słownika albo NULL. */
+  const struct trie * drzewo;
+
+  /** Podwójna tablica słownika, gdy drzewo jest NULL. */
+  const struct double_array * da;
+
+  /** Zastosowania reguł do bloków słowa. */
+  struct reguly_dopasowania dopasowania;
+
+  /** Słowo wejściowe. */
+  const wchar_t * slowo;
+
+  /** Długość słowa. */
+  int dlugosc;
+
+  /** Maksymalny koszt, zmniejszany przez funkcję wywoływaną dla
+      podpowiedzi. */
+  int maksKoszt;
+
+  /** Wymagana pierwsza litera podpowiedzi, '\0' jeśli dowolna. */
+  wchar_t pierwsza;
+
+  /** Stan początkowy, przedrostek stanów o pustej podpowiedzi. */
+  const struct stan * poczatek;
+
+  /** Pamięć stanów i zgłoszonych podpowiedzi. */
+  struct arena pula;
+
+  /** Kolejka: stany o koszcie k w liście kubelki[k % rozmiarKubelkow].
+      Jeden krok zwiększa koszt najwyżej o koszt najdroższej reguły, więc
+      kolejne koszty w kolejce nie trafiają do wspólnego kubełka. */
+  struct stan ** kubelki;
+
+  /** Liczba kubełków: koszt najdroższej stosowanej reguły plus 1. */
+  int rozmiarKubelkow;
+
+  /** Liczba stanów w kolejce. */
+  size_t liczbaWKolejce;
+
+  /** Rozwinięte stany (adresowanie otwarte). */
+  struct klucz * odwiedzone;
+
+  /** Rozmiar tablicy odwiedzonych, potęga dwójki. */
+  size_t rozmiarOdwiedzonych;
+
+  /** Liczba rozwiniętych stanów. */
+  size_t liczbaOdwiedzonych;
+
+  /** Przedrostki (adresowanie otwarte). */
+  struct wpis * przedrostki;
+
+  /** Rozmiar tablicy przedrostków, potęga dwójki. */
+  size_t rozmiarPrzedrostkow;
+
+  /** Liczba przedrostków. */
+  size_t liczbaPrzedrostkow;
+
+  /** Bufor na odtwarzaną podpowiedź. */
+  wchar_t * bufor;
+
+  /** Rozmiar bufora. */
+  int rozmiarBufora;
+
+  /** Funkcja wywoływana dla podpowiedzi. */
+  podpowiedzi_wynik funkcja;
+
+  /** Dane przekazywane funkcji. */
+  void * dane;
+};
+
+/** Miejsce pustego przedrostka.
+ * @param[in] p Przeszukiwanie.
+ * @return Korzeń słownika.
+ */
+static inline struct miejsce korzen(const struct przeszukiwanie * p)
+{
+  struct miejsce m = { p->drzewo, 0 };
+  return m;
+}
+
+/** Przejście w słowniku po literze.
+ * @param[in] p Przeszukiwanie.
+ * @param[in,out] m Miejsce.
+ * @param[in] litera Litera.
+ * @return True jeśli przedrostek przedłużony literą jest w słowniku
+ * (miejsce jest wtedy zmieniane), false wpp.
+ */
+static bool krok(const struct przeszukiwanie * p, struct miejsce * m, wchar_t litera)
+{
+  if (m->wezel == NULL)
+  {
+    uint32_t stan = double_array_krok(p->da, m->stan, litera);
+    if (stan == DOUBLE_ARRAY_BRAK)
+      return false;
+    m->stan = stan;
+    return true;
+  }
+  if (m->stan < m->wezel->krawedz)
+  {
+    if (trie_reszta(m->wezel)[m->stan - 1] != litera)
+      return false;
+    m->stan++;
+    return true;
+  }
+  const struct trie * syn = trie_syn_litery(m->wezel, litera);
+  if (syn == NULL)
+    return false;
+  m->wezel = syn;
+  m->stan = 1;
+  return true;
+}
+
+/** Sprawdzenie, czy literę można dopisać do podpowiedzi stanu: przy
+ * wymaganej pierwszej literze pusta podpowiedź może zacząć się tylko nią.
+ * @param[in] p Przeszukiwanie.
+ * @param[in] s Stan, do którego dopisywana jest litera.
+ * @param[in] litera Litera.
+ * @return True jeśli można, false wpp.
+ */
+static inline bool dozwolona(const struct przeszukiwanie * p, const struct stan * s,
+  wchar_t litera)
+{
+  return p->pierwsza == L'\0' || s->przedrostek != p->poczatek ||
+    litera == p->pierwsza;
+}
+
+/** Sprawdzenie, czy przedrostek jest słowem słownika.
+ * @param[in] p Przeszukiwanie.
+ * @param[in] m Miejsce.
+ * @return True jeśli jest, false wpp.
+ */
+static bool czySlowo(const struct przeszukiwanie * p, struct miejsce m)
+{
+  if (m.wezel == NULL)
+    return double_array_czy_slowo(p->da, m.stan);
+  return m.stan == m.wezel->krawedz && m.wezel->czySlowo;
+}
+
+/** Kolejne litery, którymi można przedłużyć przedrostek.
+ * @param[in] p Przeszukiwanie.
+ * @param[in] m Miejsce.
+ * @param[in,out] i Stan iteracji, -1 przed pierwszym wywołaniem.
+ * @return Następna litera albo '\0', jeśli już ich nie ma.
+ */
+static wchar_t nastepnaLitera(const struct przeszukiwanie * p, struct miejsce m, int * i)
+{
+  if (m.wezel == NULL)
+  {
+    unsigned kod = *i < 0 ? 0 : *i;
+    if (double_array_nastepny_syn(p->da, m.stan, &kod) == DOUBLE_ARRAY_BRAK)
+      return L'\0';
+    *i = kod;
+    return p->da->litery[kod - 1];
+  }
+  if (m.stan < m.wezel->krawedz)
+  {
+    if (*i >= 0)
+      return L'\0';
+    *i = 0;
+    return trie_reszta(m.wezel)[m.stan - 1];
+  }
+  *i = trie_nastepny_syn(m.wezel, *i);
+  if (*i < 0)
+    return L'\0';
+  return trie_syn(m.wezel, *i)->litera;
+}
+
+/** Mieszanie wskaźnika z liczbą.
+ * @param[in] wskaznik Wskaźnik.
+ * @param[in] liczba Liczba.
+ * @return Skrót.
+ */
+static inline uint64_t skrot(const void * wskaznik, uint32_t liczba)
+{
+  uint64_t h = (uintptr_t) wskaznik * 0x9e3779b97f4a7c15ULL;
+  h ^= liczba * 0xff51afd7ed558ccdULL;
+  return h ^ (h >> 29);
+}
+
+/** Oznaczenie stanu jako rozwiniętego.
+ * @param[in,out] p Przeszukiwanie.
+ * @param[in] s Stan.
+ * @return True jeśli stanu jeszcze nie rozwinięto, false wpp.
+ */
+static bool odwiedz(struct przeszukiwanie * p, const struct stan * s)
+{
+  if (2 * (p->liczbaOdwiedzonych + 1) > p->rozmiarOdwiedzonych)
+  {
+    struct klucz * stare = p->odwiedzone;
+    size_t staryRozmiar = p->rozmiarOdwiedzonych;
+    p->rozmiarOdwiedzonych = staryRozmiar ? 2 * staryRozmiar : 256;
+    p->odwiedzone = calloc(p->rozmiarOdwiedzonych, sizeof(struct klucz));
+    for (size_t i = 0; i < staryRozmiar; i++)
+    {
+      if (stare[i].przedrostek == NULL)
+        continue;
+      size_t j = skrot(stare[i].przedrostek, stare[i].pozycja) &
+        (p->rozmiarOdwiedzonych - 1);
+      while (p->odwiedzone[j].przedrostek != NULL)
+        j = (j + 1) & (p->rozmiarOdwiedzonych - 1);
+      p->odwiedzone[j] = stare[i];
+    }
+    free(stare);
+  }
+  size_t j = skrot(s->przedrostek, s->pozycja) & (p->rozmiarOdwiedzonych - 1);
+  while (p->odwiedzone[j].przedrostek != NULL)
+  {
+    const struct klucz * o = &p->odwiedzone[j];
+    if (o->przedrostek == s->przedrostek && o->pozycja == s->pozycja)
+      return false;
+    j = (j + 1) & (p->rozmiarOdwiedzonych - 1);
+  }
+  p->odwiedzone[j].przedrostek = s->przedrostek;
+  p->odwiedzone[j].pozycja = s->pozycja;
+  p->liczbaOdwiedzonych++;
+  return true;
+}
+
+/** Pierwszy stan przedrostka przedłużonego literą; jeśli takiego jeszcze
+ * nie ma, zostaje nim podany stan.
+ * @param[in,out] p Przeszukiwanie.
+ * @param[in] rodzic Przedłużany przedrostek.
+ * @param[in] litera Litera.
+ * @param[in] s Nowy stan.
+ * @return Pierwszy stan przedłużonego przedrostka.
+ */
+static struct stan * przedrostek(struct przeszukiwanie * p, const struct stan * rodzic,
+  wchar_t litera, struct stan * s)
+{
+  if (2 * (p->liczbaPrzedrostkow + 1) > p->rozmiarPrzedrostkow)
+  {
+    struct wpis * stare = p->przedrostki;
+    size_t staryRozmiar = p->rozmiarPrzedrostkow;
+    p->rozmiarPrzedrostkow = staryRozmiar ? 2 * staryRozmiar : 256;
+    p->przedrostki = calloc(p->rozmiarPrzedrostkow, sizeof(struct wpis));
+    for (size_t i = 0; i < staryRozmiar; i++)
+    {
+      if (stare[i].stan == NULL)
+        continue;
+      size_t j = skrot(stare[i].rodzic, stare[i].litera) &
+        (p->rozmiarPrzedrostkow - 1);
+      while (p->przedrostki[j].stan != NULL)
+        j = (j + 1) & (p->rozmiarPrzedrostkow - 1);
+      p->przedrostki[j] = stare[i];
+    }
+    free(stare);
+  }
+  size_t j = skrot(rodzic, litera) & (p->rozmiarPrzedrostkow - 1);
+  while (p->przedrostki[j].stan != NULL)
+  {
+    const struct wpis * w = &p->przedrostki[j];
+    if (w->rodzic == rodzic && w->litera == litera)
+      return w->stan;
+    j = (j + 1) & (p->rozmiarPrzedrostkow - 1);
+  }
+  p->przedrostki[j].rodzic = rodzic;
+  p->przedrostki[j].litera = litera;
+  p->przedrostki[j].stan = s;
+  p->liczbaPrzedrostkow++;
+  return s;
+}
+
+/** Utworzenie stanu powstałego przez dopisanie litery.
+ * @param[in,out] p Przeszukiwanie.
+ * @param[in] poprzedni Stan, do którego dopisano literę.
+ * @param[in] m Miejsce po dopisaniu litery.
+ * @param[in] litera Litera.
+ * @return Nowy stan (pozycję i koszt ustawia wywołujący).
+ */
+static struct stan * nowyStan(struct przeszukiwanie * p, const struct stan * poprzedni,
+  struct miejsce m, wchar_t litera)
+{
+  struct stan * s = arena_alloc(&p->pula, sizeof(struct stan));
+  s->poprzedni = poprzedni;
+  s->nastepny = NULL;
+  s->miejsce = m;
+  s->pozycja = poprzedni != NULL ? poprzedni->pozycja : 0;
+  s->koszt = poprzedni != NULL ? poprzedni->koszt : 0;
+  s->litera = litera;
+  s->zgloszony = false;
+  if (poprzedni == NULL)
+    s->przedrostek = s;
+  else if (litera == L'\0')
+    s->przedrostek = poprzedni->przedrostek;
+  else
+    s->przedrostek = przedrostek(p, poprzedni->przedrostek, litera, s);
+  return s;
+}
+
+/** Wstawienie stanu do kolejki.
+ * @param[in,out] p Przeszukiwanie.
+ * @param[in] s Stan z ustawioną pozycją i kosztem.
+ */
+static void wstaw(struct przeszukiwanie * p, struct stan * s)
+{
+  int kubelek = s->koszt % p->rozmiarKubelkow;
+  s->nastepny = p->kubelki[kubelek];
+  p->kubelki[kubelek] = s;
+  p->liczbaWKolejce++;
+}
+
+/** Zgłoszenie podpowiedzi kończącej się w danym stanie, jeśli jeszcze jej
+ * nie zgłoszono (wcześniej zgłoszona miała koszt nie większy).
+ * @param[in,out] p Przeszukiwanie.
+ * @param[in] s Stan.
+ */
+static void zglos(struct przeszukiwanie * p, const struct stan * s)
+{
+  /* Granica mogła spaść poniżej kosztu bieżącego kubełka. */
+  if (s->koszt > p->maksKoszt || s->przedrostek->zgloszony)
+    return;
+  s->przedrostek->zgloszony = true;
+  int dlugosc = 0;
+  for (const struct stan * t = s; t != NULL; t = t->poprzedni)
+    dlugosc += t->litera != L'\0';
+  if (dlugosc + 1 > p->rozmiarBufora)
+  {
+    p->rozmiarBufora = 2 * (dlugosc + 1);
+    p->bufor = realloc(p->bufor, sizeof(wchar_t) * p->rozmiarBufora);
+  }
+  p->bufor[dlugosc] = L'\0';
+  int i = dlugosc;
+  for (const struct stan * t = s; t != NULL; t = t->poprzedni)
+    if (t->litera != L'\0')
+      p->bufor[--i] = t->litera;
+
+  int granica = p->funkcja(p->bufor, dlugosc, s->koszt, p->dane);
+  if (granica < p->maksKoszt)
+    p->maksKoszt = granica;
+}
+
+/** Wypisanie prawej strony reguły w słowniku według jej programu, od
+ * danego kroku. Zmienna niewystępująca po lewej stronie przyjmuje kolejno
+ * wartości wszystkich liter, którymi można przedłużyć przedrostek.
+ * @param[in,out] p Przeszukiwanie.
+ * @param[in] r Reguła.
+ * @param[in] k Pierwszy niewypisany krok prawej strony.
+ * @param[in] ostatni Stan po dotychczas wypisanych literach.
+ * @param[in,out] zmienne Wartości zmiennych.
+ * @param[in] pozycja Pozycja w słowie za blokiem.
+ * @param[in] koszt Koszt po zastosowaniu reguły.
+ */
+static void wypisz(struct przeszukiwanie * p, const struct regula * r,
+  const struct regula_krok * k, const struct stan * ostatni, wchar_t * zmienne,
+  int pozycja, int koszt)
+{
+  const struct regula_krok * koniec = r->program + r->krokiLewej + r->krokiPrawej;
+  struct miejsce m = ostatni->miejsce;
+  for (; k < koniec; k++)
+  {
+    if (k->typ == REGULA_LITERY)
+    {
+      for (int i = 0; i < k->wartosc; i++)
+      {
+        if (!dozwolona(p, ostatni, k->litery[i]) || !krok(p, &m, k->litery[i]))
+          return;
+        ostatni = nowyStan(p, ostatni, m, k->litery[i]);
+      }
+      continue;
+    }
+    wchar_t litera;
+    if (k->typ == REGULA_WOLNA)
+    {
+      int i = -1;
+      while ((litera = nastepnaLitera(p, m, &i)) != L'\0')
+      {
+        if (!dozwolona(p, ostatni, litera))
+          continue;
+        struct miejsce nowe = m;
+        krok(p, &nowe, litera);
+        zmienne[k->wartosc] = litera;
+        wypisz(p, r, k + 1, nowyStan(p, ostatni, nowe, litera), zmienne,
+          pozycja, koszt);
+      }
+      return;
+    }
+    litera = zmienne[k->wartosc];
+    if (!dozwolona(p, ostatni, litera) || !krok(p, &m, litera))
+      return;
+    ostatni = nowyStan(p, ostatni, m, litera);
+  }
+  struct stan * s;
+  if (r->flaga == RULE_SPLIT)
+  {
+    if (!czySlowo(p, m))
+      return;
+    s = nowyStan(p, ostatni, korzen(p), L' ');
+  }
+  else
+    s = nowyStan(p, ostatni, m, L'\0');
+  s->pozycja = pozycja;
+  s->koszt = koszt;
+  wstaw(p, s);
+}
+
+/** Rozwinięcie stanu: przepisanie następnej litery słowa i zastosowanie
+ * reguł do bloków zaczynających się na bieżącej pozycji.
+ * @param[in,out] p Przeszukiwanie.
+ * @param[in] s Stan.
+ */
+static void rozwin(struct przeszukiwanie * p, const struct stan * s)
+{
+  if (s->pozycja == p->dlugosc && czySlowo(p, s->miejsce))
+    zglos(p, s);
+  if (s->pozycja < p->dlugosc)
+  {
+    struct miejsce m = s->miejsce;
+    wchar_t litera = p->slowo[s->pozycja];
+    if (dozwolona(p, s, litera) && krok(p, &m, litera))
+    {
+      struct stan * t = nowyStan(p, s, m, litera);
+      t->pozycja++;
+      wstaw(p, t);
+    }
+  }
+  if (p->dopasowania.liczba == 0)
+    return;
+  wchar_t zmienne[REGULY_LICZBA_ZMIENNYCH];
+  const struct reguly_dopasowanie * d = p->dopasowania.tablica;
+  for (int i = p->dopasowania.poczatki[s->pozycja];
+    i < p->dopasowania.poczatki[s->pozycja + 1]; i++)
+  {
+    const struct regula * r = d[i].regula;
+    /* Zastosowania jednego bloku posortowane są po koszcie. */
+    if (r->koszt > p->maksKoszt - s->koszt)
+      break;
+    if (r->koszt <= 0)
+      continue;
+    wmemcpy(zmienne, d[i].zmienne, REGULY_LICZBA_ZMIENNYCH);
+    wypisz(p, r, r->program + r->krokiLewej, s, zmienne,
+      s->pozycja + d[i].dlugosc, s->koszt + r->koszt);
+  }
+}
+
+/** Przeszukiwanie stanów w kolejności niemalejącego kosztu.
+ * @param[in,out] p Przeszukiwanie.
+ */
+static void przeszukaj(struct przeszukiwanie * p)
+{
+  /* Reguły droższe niż maksymalny koszt nigdy nie są stosowane. */
+  int najdrozsza = 0;
+  for (int i = 0; i < p->dopasowania.liczba; i++)
+  {
+    int koszt = p->dopasowania.tablica[i].regula->koszt;
+    if (koszt > najdrozsza && koszt <= p->maksKoszt)
+      najdrozsza = koszt;
+  }
+  p->rozmiarKubelkow = najdrozsza + 1;
+  p->kubelki = calloc(p->rozmiarKubelkow, sizeof(struct stan *));
+  struct stan * poczatek = nowyStan(p, NULL, korzen(p), L'\0');
+  p->poczatek = poczatek;
+  wstaw(p, poczatek);
+  for (int koszt = 0; koszt <= p->maksKoszt && p->liczbaWKolejce > 0; koszt++)
+  {
+    struct stan ** kubelek = &p->kubelki[koszt % p->rozmiarKubelkow];
+    struct stan * s;
+    while ((s = *kubelek) != NULL)
+    {
+      *kubelek = s->nastepny;
+      p->liczbaWKolejce--;
+      if (odwiedz(p, s))
+        rozwin(p, s);
+    }
+  }
+  free(p->kubelki);
+}
+
+/**
+  Podział słowa na słowa słownika. Jeśli jedynymi regułami są reguły
+  podziału bez zmiennych i z pustą prawą stroną, podpowiedź to słowo
+  pocięte na słowa słownika, a między nimi usunięte lewe strony reguł.
+  Zamiast przeszukiwać stany, dla każdej pozycji wyznaczane są raz końce
+  słów słownika zaczynających się na niej i koszty, z jakimi da się
+  podzielić resztę słowa. Wypisywane są wtedy tylko podziały, które
+  prowadzą do podpowiedzi, więc czas jest liniowy względem długości słowa
+  i liczby podpowiedzi, a nie wykładniczy względem liczby miejsc podziału.
+  */
+struct podzial
+{
+  /** Przeszukiwanie (słownik, słowo, zastosowania reguł, funkcja). */
+  struct przeszukiwanie * p;
+
+  /** Końce słów słownika zaczynających się na pozycji i to
+      konce[poczatki[i]], ..., konce[poczatki[i + 1] - 1]. */
+  int * konce;
+
+  /** Początki list końców, dla pozycji od 0 do długości słowa. */
+  int * poczatki;
+
+  /** Bit k maski i jest ustawiony, jeśli resztę słowa od pozycji i można
+      podzielić na słowa słownika kosztem k. */
+  uint64_t * maski;
+
+  /** Zgłoszone podpowiedzi (adresowanie otwarte), NULL dla pustego
+      miejsca. */
+  wchar_t ** zgloszone;
+
+  /** Rozmiar tablicy zgłoszonych, potęga dwójki. */
+  size_t rozmiarZgloszonych;
+
+  /** Liczba zgłoszonych podpowiedzi. */
+  size_t liczbaZgloszonych;
+};
+
+/** Sprawdzenie, czy wszystkie reguły indeksu o dodatnim koszcie są
+ * regułami podziału bez zmiennych i z pustą prawą stroną.
+ * @param[in] reguly Indeks reguł.
+ * @return True jeśli są, false wpp.
+ */
+static bool tylkoPodzialy(const struct reguly * reguly)
+{
+  for (int i = 0; i < reguly->liczba; i++)
+  {
+    const struct regula * r = reguly->reguly[i];
+    if (r->koszt <= 0)
+      continue;
+    if (r->flaga != RULE_SPLIT || r->krokiPrawej != 0 || r->krokiLewej > 1 ||
+        (r->krokiLewej == 1 && r->program[0].typ != REGULA_LITERY))
+      return false;
+  }
+  return true;
+}
+
+/** Skrót napisu.
+ * @param[in] napis Napis.
+ * @param[in] dlugosc Długość napisu.
+ * @return Skrót.
+ */
+static uint64_t skrotNapisu(const wchar_t * napis, int dlugosc)
+{
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (int i = 0; i < dlugosc; i++)
+    h = (h ^ (uint32_t) napis[i]) * 0x100000001b3ULL;
+  return h ^ (h >> 32);
+}
+
+/** Zapamiętanie podpowiedzi z bufora przeszukiwania jako zgłoszonej.
+ * @param[in,out] d Podział.
+ * @param[in] dlugosc Długość podpowiedzi.
+ * @return True jeśli podpowiedzi jeszcze nie zgłoszono, false wpp.
+ */
+static bool zapamietaj(struct podzial * d, int dlugosc)
+{
+  const wchar_t * podpowiedz = d->p->bufor;
+  if (2 * (d->liczbaZgloszonych + 1) > d->rozmiarZgloszonych)
+  {
+    wchar_t ** stare = d->zgloszone;
+    size_t staryRozmiar = d->rozmiarZgloszonych;
+    d->rozmiarZgloszonych = staryRozmiar ? 2 * staryRozmiar : 64;
+    d->zgloszone = calloc(d->rozmiarZgloszonych, sizeof(wchar_t *));
+    for (size_t i = 0; i < staryRozmiar; i++)
+    {
+      if (stare[i] == NULL)
+        continue;
+      size_t j = skrotNapisu(stare[i], wcslen(stare[i])) &
+        (d->rozmiarZgloszonych - 1);
+      while (d->zgloszone[j] != NULL)
+        j = (j + 1) & (d->rozmiarZgloszonych - 1);
+      d->zgloszone[j] = stare[i];
+    }
+    free(stare);
+  }
+  size_t j = skrotNapisu(podpowiedz, dlugosc) & (d->rozmiarZgloszonych - 1);
+  while (d->zgloszone[j] != NULL)
+  {
+    if (!wcscmp(d->zgloszone[j], podpowiedz))
+      return false;
+    j = (j + 1) & (d->rozmiarZgloszonych - 1);
+  }
+  d->zgloszone[j] = arena_alloc(&d->p->pula, sizeof(wchar_t) * (dlugosc + 1));
+  wmemcpy(d->zgloszone[j], podpowiedz, dlugosc + 1);
+  d->liczbaZgloszonych++;
+  return true;
+}
+
+/** Wypisanie podziałów reszty słowa od danej pozycji o danym koszcie.
+ * @param[in,out] d Podział.
+ * @param[in] i Pozycja w słowie, na której zaczyna się słowo podpowiedzi.
+ * @param[in] koszt Koszt całej podpowiedzi.
+ * @param[in] reszta Koszt podziału reszty słowa.
+ * @param[in] dlugosc Długość wypisanej części podpowiedzi.
+ */
+static void podzielOd(struct podzial * d, int i, int koszt, int reszta, int dlugosc)
+{
+  struct przeszukiwanie * p = d->p;
+  const struct reguly_dopasowania * z = &p->dopasowania;
+  for (int k = d->poczatki[i]; k < d->poczatki[i + 1]; k++)
+  {
+    if (koszt > p->maksKoszt)
+      return;
+    int koniec = d->konce[k];
+    int nowaDlugosc = dlugosc + koniec - i;
+    wmemcpy(p->bufor + dlugosc, p->slowo + i, koniec - i);
+    if (koniec == p->dlugosc)
+    {
+      p->bufor[nowaDlugosc] = L'\0';
+      if (reszta == 0 && zapamietaj(d, nowaDlugosc))
+      {
+        int granica = p->funkcja(p->bufor, nowaDlugosc, koszt, p->dane);
+        if (granica < p->maksKoszt)
+          p->maksKoszt = granica;
+      }
+      continue;
+    }
+    if (z->liczba == 0)
+      continue;
+    /* Zastosowania jednego bloku posortowane są po koszcie. */
+    for (int j = z->poczatki[koniec]; j < z->poczatki[koniec + 1]; j++)
+    {
+      int kosztReguly = z->tablica[j].regula->koszt;
+      if (kosztReguly > reszta)
+        break;
+      int dalej = koniec + z->tablica[j].dlugosc;
+      if (kosztReguly <= 0 || !((d->maski[dalej] >> (reszta - kosztReguly)) & 1))
+        continue;
+      p->bufor[nowaDlugosc] = L' ';
+      podzielOd(d, dalej, koszt, reszta - kosztReguly, nowaDlugosc + 1);
+    }
+  }
+}
+
+/** Wyszukiwanie podpowiedzi przez podział słowa (patrz struct podzial).
+ * @param[in,out] p Przeszukiwanie ze słownikiem, w którym są tylko reguły
+ * podziału, i maksymalnym kosztem nie większym niż PODZIAL_MAKS_KOSZT.
+ */
+static void podziel(struct przeszukiwanie * p)
+{
+  struct podzial d;
+  memset(&d, 0, sizeof(d));
+  d.p = p;
+  int n = p->dlugosc;
+  const struct reguly_dopasowania * z = &p->dopasowania;
+
+  /* Końce słów słownika od każdej pozycji: przejście słownika po literach
+     słowa, dopóki przedrostek jest w słowniku. */
+  int rozmiar = n + 1;
+  d.konce = malloc(sizeof(int) * rozmiar);
+  d.poczatki = malloc(sizeof(int) * (n + 2));
+  int liczba = 0;
+  for (int i = 0; i <= n; i++)
+  {
+    d.poczatki[i] = liczba;
+    struct miejsce m = korzen(p);
+    for (int j = i; j < n && krok(p, &m, p->slowo[j]); j++)
+    {
+      if (!czySlowo(p, m))
+        continue;
+      if (liczba == rozmiar)
+      {
+        rozmiar *= 2;
+        d.konce = realloc(d.konce, sizeof(int) * rozmiar);
+      }
+      d.konce[liczba++] = j + 1;
+    }
+  }
+  d.poczatki[n + 1] = liczba;
+
+  /* Koszty podziału reszty słowa, od końca. */
+  uint64_t wszystkie = p->maksKoszt == PODZIAL_MAKS_KOSZT ? ~0ULL : (1ULL << (p->maksKoszt + 1)) - 1;
+  d.maski = calloc(n + 1, sizeof(uint64_t));
+  for (int i = n - 1; i >= 0; i--)
+  {
+    uint64_t maska = 0;
+    for (int k = d.poczatki[i]; k < d.poczatki[i + 1]; k++)
+    {
+      int koniec = d.konce[k];
+      if (koniec == n)
+      {
+        maska |= 1;
+        continue;
+      }
+      if (z->liczba == 0)
+        continue;
+      for (int j = z->poczatki[koniec]; j < z->poczatki[koniec + 1]; j++)
+      {
+        int kosztReguly = z->tablica[j].regula->koszt;
+        if (kosztReguly > p->maksKoszt)
+          break;
+        if (kosztReguly > 0)
+          maska |= d.maski[koniec + z->tablica[j].dlugosc] << kosztReguly;
+      }
+    }
+    d.maski[i] = maska & wszystkie;
+  }
+
+  if (2 * n + 2 > p->rozmiarBufora)
+  {
+    p->rozmiarBufora = 2 * n + 2;
+    p->bufor = realloc(p->bufor, sizeof(wchar_t) * p->rozmiarBufora);
+  }
+  if (p->pierwsza == L'\0' || (n > 0 && p->slowo[0] == p->pierwsza))
+    for (int koszt = 0; koszt <= p->maksKoszt; koszt++)
+      if ((d.maski[0] >> koszt) & 1)
+        podzielOd(&d, 0, koszt, koszt, 0);
+
+  free(d.konce);
+  free(d.poczatki);
+  free(d.maski);
+  free(d.zgloszone);
+}
+
+void podpowiedzi_szukaj(const struct trie * drzewo, const struct double_array * da,
+  const struct reguly * reguly, const wchar_t * slowo,
+  int dlugosc, int maksKoszt, wchar_t pierwsza, podpowiedzi_wynik funkcja,
+  void * dane)
+{
+  if ((drzewo == NULL && da == NULL) || maksKoszt < 0)
+    return;
+  struct przeszukiwanie p;
+  memset(&p, 0, sizeof(p));
+  p.drzewo = drzewo;
+  p.da = da;
+  if (reguly != NULL)
+    reguly_dopasuj(reguly, slowo, dlugosc, &p.dopasowania);
+  p.slowo = slowo;
+  p.dlugosc = dlugosc;
+  p.maksKoszt = maksKoszt;
+  p.pierwsza = pierwsza;
+  p.funkcja = funkcja;
+  p.dane = dane;
+  arena_init(&p.pula);
+  if (reguly != NULL && maksKoszt <= PODZIAL_MAKS_KOSZT && tylkoPodzialy(reguly))
+    podziel(&p);
+  else
+    przeszukaj(&p);
+
+  free(p.odwiedzone);
+  free(p.przedrostki);
+  free(p.bufor);
+  reguly_dopasowania_done(&p.dopasowania);
+  arena_done(&p.pula);
+}
@@ -0,0 +1,64 @@
+/** @file
+    Interfejs wyszukiwania podpowiedzi według reguł słownika.
+
+    Słowo dzielone jest na bloki, z których każdy albo przepisywany jest
+    bez zmian, albo zamieniany regułą (patrz dictionary_rule_add()).
+    Przeszukiwane są stany (pozycja w słowie, dotychczas wypisana część
+    podpowiedzi) w kolejności niemalejącego kosztu, tak jak w algorytmie
+    Dijkstry z kolejką kubełkową. Każdy stan rozwijany jest tylko raz,
+    z najmniejszym kosztem, więc czas jest ograniczony liczbą różnych
+    stanów, a nie liczbą sposobów zastosowania reguł.
+
+    Gdy jedynymi regułami są reguły podziału bez zmiennych i z pustą prawą
+    stroną, podpowiedzi wyznaczane są prościej: przez podział słowa na
+    słowa słownika, programowaniem dynamicznym po pozycjach słowa.
+
+    @ingroup dictionary
+ */
+
+#ifndef __PODPOWIEDZI_H__
+#define __PODPOWIEDZI_H__
+
+#include <stdbool.h>
+#include <wchar.h>
+#include "reguly.h"
+#include "trie.h"
+#include "double_array.h"
+
+/** Funkcja otrzymująca znalezioną podpowiedź.
+ * @param[in] podpowiedz Podpowiedź zakończona znakiem '\0' (słowa rozdzielone
+ * spacjami), ważna tylko w czasie wywołania.
+ * @param[in] dlugosc Długość podpowiedzi.
+ * @param[in] koszt Najmniejszy koszt otrzymania podpowiedzi.
+ * @param[in,out] dane Dane przekazane do wyszukiwania.
+ * @return Największy koszt, przy którym kolejne podpowiedzi są jeszcze
+ * potrzebne (wartość nie mniejsza od maksymalnego kosztu niczego nie
+ * zmienia).
+ */
+typedef int (* podpowiedzi_wynik)(const wchar_t * podpowiedz, int dlugosc,
+  int koszt, void * dane);
+
+/** Wyszukiwanie podpowiedzi o koszcie nie większym niż maksKoszt.
+ * Podpowiedzi zgłaszane są w kolejności niemalejącego kosztu, każda raz.
+ * Koszt zwrócony przez funkcję staje się nowym maksymalnym kosztem, więc
+ * wyszukiwanie kończy się, gdy droższe podpowiedzi nie są już potrzebne,
+ * i nie rozwija droższych stanów. Podpowiedzi o różnych pierwszych literach
+ * można szukać niezależnie, np. w osobnych wątkach.
+ * @param[in] drzewo Słownik w postaci drzewa albo NULL.
+ * @param[in] da Słownik w postaci podwójnej tablicy, używany gdy drzewo
+ * jest NULL (może być NULL).
+ * @param[in] reguly Indeks reguł o dodatnich kosztach albo NULL.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] maksKoszt Maksymalny koszt podpowiedzi.
+ * @param[in] pierwsza Pierwsza litera szukanych podpowiedzi albo '\0',
+ * żeby szukać wszystkich.
+ * @param[in] funkcja Funkcja wywoływana dla każdej podpowiedzi.
+ * @param[in,out] dane Dane przekazywane funkcji.
+ */
+void podpowiedzi_szukaj(const struct trie * drzewo, const struct double_array * da,
+  const struct reguly * reguly, const wchar_t * slowo,
+  int dlugosc, int maksKoszt, wchar_t pierwsza, podpowiedzi_wynik funkcja,
+  void * dane);
+
+#endif /* __PODPOWIEDZI_H__ */
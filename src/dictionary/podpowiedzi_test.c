@@ -0,0 +1,329 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <cmocka.h>
+#include <wchar.h>
+#include "podpowiedzi.h"
+
+/* Słowa testowego słownika. */
+static const wchar_t * slowa[] = {
+    L"ala", L"kos", L"kot", L"koty", L"ma", L"pies", L"kota"
+};
+
+/* Zebrane podpowiedzi. */
+struct wyniki {
+    wchar_t slowa[64][128];
+    int koszty[64];
+    int liczba;
+    /* Liczba podpowiedzi, po której droższe nie są potrzebne (0 bez
+       ograniczenia). */
+    int limit;
+};
+
+static int zbierz(const wchar_t * podpowiedz, int dlugosc, int koszt, void * dane) {
+    struct wyniki * w = dane;
+    assert_true(w->liczba < 64);
+    assert_int_equal(wcslen(podpowiedz), dlugosc);
+    if (w->liczba > 0)
+        assert_true(w->koszty[w->liczba - 1] <= koszt);
+    if (w->limit > 0 && w->liczba >= w->limit)
+        assert_int_equal(w->koszty[w->liczba - 1], koszt);
+    wcscpy(w->slowa[w->liczba], podpowiedz);
+    w->koszty[w->liczba++] = koszt;
+    return w->limit > 0 && w->liczba >= w->limit ? koszt : 1000;
+}
+
+/* Koszt podpowiedzi albo -1, jeśli jej nie ma. */
+static int koszt(const struct wyniki * w, const wchar_t * slowo) {
+    int znaleziony = -1;
+    for (int i = 0; i < w->liczba; i++)
+        if (!wcscmp(w->slowa[i], slowo)) {
+            assert_int_equal(znaleziony, -1);
+            znaleziony = w->koszty[i];
+        }
+    return znaleziony;
+}
+
+static int podpowiedzi_setup(void ** state) {
+    struct trie * t = NULL;
+    for (size_t i = 0; i < sizeof(slowa) / sizeof(slowa[0]); i++)
+        t = insert(slowa[i], wcslen(slowa[i]), t, 1);
+    *state = t;
+    return 0;
+}
+
+static int podpowiedzi_teardown(void ** state) {
+    clean(*state);
+    return 0;
+}
+
+/* Szuka podpowiedzi w drzewie i w podwójnej tablicy, wyniki muszą być te same. */
+static void szukaj(struct trie * t, struct regula * reguly, int liczbaRegul,
+                   const wchar_t * slowo, int maksKoszt, int maksLiczba,
+                   struct wyniki * w) {
+    const struct regula * wskazniki[16];
+    for (int i = 0; i < liczbaRegul; i++) {
+        assert_int_equal(regula_kompiluj(&reguly[i]), 1);
+        wskazniki[i] = &reguly[i];
+    }
+    struct reguly * indeks = reguly_zbuduj(wskazniki, liczbaRegul);
+    static struct wyniki z_tablicy;
+    w->liczba = z_tablicy.liczba = 0;
+    w->limit = z_tablicy.limit = maksLiczba;
+    podpowiedzi_szukaj(t, NULL, indeks, slowo, wcslen(slowo),
+                       maksKoszt, L'\0', zbierz, w);
+    struct double_array * da = double_array_build(t);
+    podpowiedzi_szukaj(NULL, da, indeks, slowo, wcslen(slowo),
+                       maksKoszt, L'\0', zbierz, &z_tablicy);
+    double_array_done(da);
+    reguly_done(indeks);
+    for (int i = 0; i < liczbaRegul; i++)
+        regula_done(&reguly[i]);
+    assert_int_equal(w->liczba, z_tablicy.liczba);
+    for (int i = 0; i < w->liczba; i++)
+        assert_int_equal(koszt(&z_tablicy, w->slowa[i]), w->koszty[i]);
+}
+
+static void podpowiedzi_identity_test(void ** state) {
+    struct wyniki w;
+    szukaj(*state, NULL, 0, L"kot", 5, 0, &w);
+    assert_int_equal(w.liczba, 1);
+    assert_int_equal(koszt(&w, L"kot"), 0);
+    szukaj(*state, NULL, 0, L"kto", 5, 0, &w);
+    assert_int_equal(w.liczba, 0);
+}
+
+static void podpowiedzi_rules_test(void ** state) {
+    struct regula reguly[] = {
+        { L"t", L"s", RULE_NORMAL, 1 },
+        { L"01", L"10", RULE_NORMAL, 1 },
+        { L"", L"0", RULE_NORMAL, 2 },
+        { L"0", L"s", RULE_NORMAL, 3 },
+    };
+    struct wyniki w;
+    szukaj(*state, reguly, 4, L"kot", 5, 0, &w);
+    assert_int_equal(koszt(&w, L"kot"), 0);
+    assert_int_equal(koszt(&w, L"kos"), 1);
+    assert_int_equal(koszt(&w, L"koty"), 2);
+    assert_int_equal(koszt(&w, L"kota"), 2);
+    /* kto -> kot przez przestawienie */
+    szukaj(*state, reguly, 4, L"kto", 5, 0, &w);
+    assert_int_equal(koszt(&w, L"kot"), 1);
+    /* reguły stosowane są do rozłącznych bloków słowa, nie do swoich wyników */
+    assert_int_equal(koszt(&w, L"kos"), -1);
+    /* maksymalny koszt */
+    szukaj(*state, reguly, 4, L"kto", 1, 0, &w);
+    assert_int_equal(w.liczba, 1);
+    szukaj(*state, reguly, 4, L"kto", 0, 0, &w);
+    assert_int_equal(w.liczba, 0);
+    /* kolejka nie zależy od maksymalnego kosztu */
+    szukaj(*state, reguly, 4, L"kot", INT_MAX, 0, &w);
+    assert_int_equal(koszt(&w, L"kot"), 0);
+    assert_int_equal(koszt(&w, L"kos"), 1);
+    assert_int_equal(koszt(&w, L"kota"), 2);
+    /* reguła droższa niż cały zakres int */
+    struct regula droga[] = { { L"t", L"s", RULE_NORMAL, INT_MAX } };
+    szukaj(*state, droga, 1, L"kot", 5, 0, &w);
+    assert_int_equal(w.liczba, 1);
+}
+
+static void podpowiedzi_flags_test(void ** state) {
+    struct regula reguly[] = {
+        { L"x", L"", RULE_BEGIN, 1 },
+        { L"y", L"", RULE_END, 1 },
+        { L"", L"", RULE_SPLIT, 1 },
+        { L"_", L"", RULE_SPLIT, 1 },
+    };
+    struct wyniki w;
+    szukaj(*state, reguly, 4, L"xkot", 5, 0, &w);
+    assert_int_equal(koszt(&w, L"kot"), 1);
+    szukaj(*state, reguly, 4, L"kxot", 5, 0, &w);
+    assert_int_equal(w.liczba, 0);
+    szukaj(*state, reguly, 4, L"koty", 5, 0, &w);
+    assert_int_equal(koszt(&w, L"koty"), 0);
+    assert_int_equal(koszt(&w, L"kot"), 1);
+    szukaj(*state, reguly, 4, L"kyot", 5, 0, &w);
+    assert_int_equal(w.liczba, 0);
+    szukaj(*state, reguly, 4, L"alama", 5, 0, &w);
+    assert_int_equal(w.liczba, 1);
+    assert_int_equal(koszt(&w, L"ala ma"), 1);
+    szukaj(*state, reguly, 4, L"ala_makot", 5, 0, &w);
+    assert_int_equal(koszt(&w, L"ala ma kot"), 2);
+    szukaj(*state, reguly, 4, L"ala_makot", 1, 0, &w);
+    assert_int_equal(w.liczba, 0);
+}
+
+static void podpowiedzi_limit_test(void ** state) {
+    struct regula reguly[] = {
+        { L"0", L"1", RULE_NORMAL, 1 },
+        { L"", L"0", RULE_NORMAL, 1 },
+        { L"0", L"", RULE_NORMAL, 1 },
+    };
+    struct wyniki w;
+    szukaj(*state, reguly, 3, L"kot", 3, 0, &w);
+    int wszystkie = w.liczba;
+    assert_true(wszystkie > 3);
+    /* po koszcie 0 jest już jedna podpowiedź */
+    szukaj(*state, reguly, 3, L"kot", 3, 1, &w);
+    assert_int_equal(w.liczba, 1);
+    szukaj(*state, reguly, 3, L"kot", 3, 2, &w);
+    assert_true(w.liczba >= 2 && w.liczba < wszystkie);
+    assert_int_equal(w.koszty[w.liczba - 1], 1);
+}
+
+static void podpowiedzi_long_word_test(void ** state) {
+    /* Wiele reguł i długie słowo: stany się powtarzają, więc
+       przeszukiwanie kończy się szybko. */
+    struct regula reguly[] = {
+        { L"0", L"1", RULE_NORMAL, 1 },
+        { L"", L"0", RULE_NORMAL, 1 },
+        { L"0", L"", RULE_NORMAL, 1 },
+        { L"01", L"10", RULE_NORMAL, 1 },
+        { L"", L"", RULE_SPLIT, 1 },
+    };
+    struct wyniki w;
+    szukaj(*state, reguly, 5, L"kotkotkotkotkotkotkotkotkotkot", 3, 0, &w);
+    assert_int_equal(w.liczba, 0);
+    szukaj(*state, reguly, 5, L"kotkot", 3, 0, &w);
+    assert_int_equal(koszt(&w, L"kot kot"), 1);
+}
+
+static void podpowiedzi_first_letter_test(void ** state) {
+    /* Podpowiedzi szukane osobno dla każdej pierwszej litery to te same
+       podpowiedzi, z tymi samymi kosztami, co szukane razem. */
+    struct regula reguly[] = {
+        { L"0", L"1", RULE_NORMAL, 1 },
+        { L"", L"0", RULE_NORMAL, 1 },
+        { L"0", L"", RULE_NORMAL, 1 },
+        { L"01", L"10", RULE_NORMAL, 1 },
+        { L"", L"", RULE_SPLIT, 1 },
+    };
+    const wchar_t * slowa[] = { L"kot", L"akot", L"mala", L"kotpies", L"" };
+    const wchar_t litery[] = L"aklmps";
+    struct wyniki w;
+    static struct wyniki czesc;
+    const struct regula * wskazniki[5];
+    for (int i = 0; i < 5; i++) {
+        assert_int_equal(regula_kompiluj(&reguly[i]), 1);
+        wskazniki[i] = &reguly[i];
+    }
+    struct reguly * indeks = reguly_zbuduj(wskazniki, 5);
+    struct double_array * da = double_array_build(*state);
+    for (int i = 0; i < 5; i++) {
+        int dlugosc = wcslen(slowa[i]);
+        w.liczba = 0;
+        w.limit = 0;
+        podpowiedzi_szukaj(*state, NULL, indeks, slowa[i], dlugosc, 3, L'\0',
+                           zbierz, &w);
+        for (int tablica = 0; tablica < 2; tablica++) {
+            int razem = 0;
+            for (int j = 0; litery[j] != L'\0'; j++) {
+                czesc.liczba = 0;
+                czesc.limit = 0;
+                podpowiedzi_szukaj(tablica ? NULL : *state, tablica ? da : NULL,
+                                   indeks, slowa[i], dlugosc, 3, litery[j],
+                                   zbierz, &czesc);
+                for (int k = 0; k < czesc.liczba; k++) {
+                    assert_int_equal(czesc.slowa[k][0], litery[j]);
+                    assert_int_equal(koszt(&w, czesc.slowa[k]), czesc.koszty[k]);
+                }
+                razem += czesc.liczba;
+            }
+            assert_int_equal(razem, w.liczba);
+        }
+    }
+    double_array_done(da);
+    reguly_done(indeks);
+    for (int i = 0; i < 5; i++)
+        regula_done(&reguly[i]);
+}
+
+/* Szuka podpowiedzi w słowniku z danych słów. */
+static void szukajWSlowach(const wchar_t ** slowa, int liczbaSlow,
+                           struct regula * reguly, int liczbaRegul,
+                           const wchar_t * slowo, int maksKoszt, struct wyniki * w) {
+    struct trie * t = NULL;
+    for (int i = 0; i < liczbaSlow; i++)
+        t = insert(slowa[i], wcslen(slowa[i]), t, 1);
+    szukaj(t, reguly, liczbaRegul, slowo, maksKoszt, 0, w);
+    clean(t);
+}
+
+static void podpowiedzi_split_test(void ** state) {
+    /* Same reguły podziału: podział słowa daje te same podpowiedzi co
+       przeszukiwanie stanów, które wymusza reguła nigdy niestosowana. */
+    const wchar_t * slowa[] = { L"a", L"aa", L"ab", L"b", L"ba", L"ala",
+                                L"ma", L"kot", L"a_b" };
+    struct regula reguly[] = {
+        { L"", L"", RULE_SPLIT, 1 },
+        { L"_", L"", RULE_SPLIT, 1 },
+        { L"", L"", RULE_SPLIT, 2 },
+        { L"ab", L"", RULE_SPLIT, 2 },
+        { L"q", L"q", RULE_NORMAL, 100 },
+    };
+    const wchar_t * wejscia[] = { L"alamakot", L"ala_ma_kot", L"aabab",
+                                  L"a_b", L"ababba", L"kotx", L"" };
+    for (int i = 0; i < 7; i++)
+        for (int maksKoszt = 0; maksKoszt <= 4; maksKoszt++) {
+            struct wyniki podzial, stany;
+            szukajWSlowach(slowa, 9, reguly, 4, wejscia[i], maksKoszt, &podzial);
+            szukajWSlowach(slowa, 9, reguly, 5, wejscia[i], maksKoszt, &stany);
+            assert_int_equal(podzial.liczba, stany.liczba);
+            for (int j = 0; j < podzial.liczba; j++)
+                assert_int_equal(koszt(&stany, podzial.slowa[j]), podzial.koszty[j]);
+        }
+    struct wyniki w;
+    szukajWSlowach(slowa, 9, reguly, 4, L"ala_ma_kot", 2, &w);
+    assert_int_equal(koszt(&w, L"ala ma kot"), 2);
+    szukajWSlowach(slowa, 9, reguly, 4, L"a_b", 2, &w);
+    assert_int_equal(koszt(&w, L"a_b"), 0);
+    assert_int_equal(koszt(&w, L"a b"), 1);
+    assert_int_equal(koszt(&w, L"a _b"), -1);
+}
+
+static void podpowiedzi_split_long_word_test(void ** state) {
+    /* Słowa z samych liter a: podziałów jest wykładniczo wiele, ale żaden
+       nie sięga litery b na końcu. */
+    static wchar_t litery[41][41];
+    const wchar_t * slowa[40];
+    for (int i = 0; i < 40; i++) {
+        wmemset(litery[i], L'a', i + 1);
+        litery[i][i + 1] = L'\0';
+        slowa[i] = litery[i];
+    }
+    struct regula reguly[] = { { L"", L"", RULE_SPLIT, 1 } };
+    static wchar_t slowo[302];
+    wmemset(slowo, L'a', 300);
+    slowo[300] = L'b';
+    slowo[301] = L'\0';
+    struct wyniki w;
+    szukajWSlowach(slowa, 40, reguly, 1, slowo, 12, &w);
+    assert_int_equal(w.liczba, 0);
+    /* 70 liter to dwa słowa: pierwsze ma od 30 do 40 liter. */
+    slowo[70] = L'\0';
+    szukajWSlowach(slowa, 40, reguly, 1, slowo, 1, &w);
+    assert_int_equal(w.liczba, 11);
+    wchar_t podpowiedz[72];
+    wmemset(podpowiedz, L'a', 71);
+    podpowiedz[35] = L' ';
+    podpowiedz[71] = L'\0';
+    assert_int_equal(koszt(&w, podpowiedz), 1);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(podpowiedzi_identity_test, podpowiedzi_setup, podpowiedzi_teardown),
+        cmocka_unit_test_setup_teardown(podpowiedzi_rules_test, podpowiedzi_setup, podpowiedzi_teardown),
+        cmocka_unit_test_setup_teardown(podpowiedzi_flags_test, podpowiedzi_setup, podpowiedzi_teardown),
+        cmocka_unit_test_setup_teardown(podpowiedzi_limit_test, podpowiedzi_setup, podpowiedzi_teardown),
+        cmocka_unit_test_setup_teardown(podpowiedzi_long_word_test, podpowiedzi_setup, podpowiedzi_teardown),
+        cmocka_unit_test_setup_teardown(podpowiedzi_first_letter_test, podpowiedzi_setup, podpowiedzi_teardown),
+        cmocka_unit_test(podpowiedzi_split_test),
+        cmocka_unit_test(podpowiedzi_split_long_word_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
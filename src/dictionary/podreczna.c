@@ -0,0 +1,173 @@
+/** @file
+  Implementacja pamięci podręcznej podpowiedzi.
+
+  @ingroup dictionary
+ */
+
+#include "podreczna.h"
+#include "bloom.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Kubełek słowa o danym skrócie.
+ * @param[in] pamiec Pamięć.
+ * @param[in] skrot Skrót słowa.
+ * @return Numer kubełka.
+ */
+static inline size_t kubelek(const struct podreczna * pamiec, uint64_t skrot)
+{
+  return skrot & (pamiec->liczbaKubelkow - 1);
+}
+
+/** Odłączenie wpisu od listy użycia.
+ * @param[in,out] pamiec Pamięć.
+ * @param[in] i Numer wpisu.
+ */
+static void odlacz(struct podreczna * pamiec, int i)
+{
+  struct podreczna_wpis * w = &pamiec->wpisy[i];
+  if (w->starszy >= 0)
+    pamiec->wpisy[w->starszy].nowszy = w->nowszy;
+  else
+    pamiec->najstarszy = w->nowszy;
+  if (w->nowszy >= 0)
+    pamiec->wpisy[w->nowszy].starszy = w->starszy;
+  else
+    pamiec->najnowszy = w->starszy;
+}
+
+/** Dołączenie wpisu na koniec listy użycia, jako ostatnio użytego.
+ * @param[in,out] pamiec Pamięć.
+ * @param[in] i Numer wpisu.
+ */
+static void dolaczNaKoniec(struct podreczna * pamiec, int i)
+{
+  struct podreczna_wpis * w = &pamiec->wpisy[i];
+  w->starszy = pamiec->najnowszy;
+  w->nowszy = -1;
+  if (pamiec->najnowszy >= 0)
+    pamiec->wpisy[pamiec->najnowszy].nowszy = i;
+  else
+    pamiec->najstarszy = i;
+  pamiec->najnowszy = i;
+}
+
+/** Odłączenie wpisu od listy kolizji jego kubełka.
+ * @param[in,out] pamiec Pamięć.
+ * @param[in] i Numer wpisu.
+ */
+static void usunZKubelka(struct podreczna * pamiec, int i)
+{
+  int * poprzedni = &pamiec->kubelki[kubelek(pamiec, pamiec->wpisy[i].skrot)];
+  while (*poprzedni != i)
+    poprzedni = &pamiec->wpisy[*poprzedni].dalej;
+  *poprzedni = pamiec->wpisy[i].dalej;
+}
+
+struct podreczna * podreczna_nowa(int pojemnosc)
+{
+  struct podreczna * pamiec = malloc(sizeof(struct podreczna));
+  pamiec->wpisy = NULL;
+  pamiec->rozmiar = 0;
+  pamiec->liczba = 0;
+  pamiec->pojemnosc = pojemnosc;
+  pamiec->liczbaKubelkow = 1;
+  while (pamiec->liczbaKubelkow < (size_t) pojemnosc)
+    pamiec->liczbaKubelkow *= 2;
+  pamiec->kubelki = malloc(sizeof(int) * pamiec->liczbaKubelkow);
+  memset(pamiec->kubelki, -1, sizeof(int) * pamiec->liczbaKubelkow);
+  pamiec->najstarszy = -1;
+  pamiec->najnowszy = -1;
+  return pamiec;
+}
+
+void podreczna_done(struct podreczna * pamiec)
+{
+  if (pamiec == NULL)
+    return;
+  podreczna_wyczysc(pamiec);
+  free(pamiec->wpisy);
+  free(pamiec->kubelki);
+  free(pamiec);
+}
+
+const struct podreczna_wpis * podreczna_szukaj(struct podreczna * pamiec,
+  const wchar_t * slowo, int dlugosc)
+{
+  uint64_t skrot = bloom_skrot(slowo, dlugosc);
+  for (int i = pamiec->kubelki[kubelek(pamiec, skrot)]; i >= 0;
+       i = pamiec->wpisy[i].dalej)
+  {
+    struct podreczna_wpis * w = &pamiec->wpisy[i];
+    if (w->skrot != skrot || w->dlugosc != dlugosc ||
+        wmemcmp(w->slowo, slowo, dlugosc))
+      continue;
+    if (pamiec->najnowszy != i)
+    {
+      odlacz(pamiec, i);
+      dolaczNaKoniec(pamiec, i);
+    }
+    return w;
+  }
+  return NULL;
+}
+
+void podreczna_dodaj(struct podreczna * pamiec, const wchar_t * slowo,
+  int dlugosc, wchar_t * const * podpowiedzi, int liczba)
+{
+  int i;
+  if (pamiec->liczba == pamiec->pojemnosc)
+  {
+    /* Nowy wpis zajmuje miejsce najdawniej użytego. */
+    i = pamiec->najstarszy;
+    odlacz(pamiec, i);
+    usunZKubelka(pamiec, i);
+    free(pamiec->wpisy[i].slowo);
+  }
+  else
+  {
+    if (pamiec->liczba == pamiec->rozmiar)
+    {
+      pamiec->rozmiar = pamiec->rozmiar ? 2 * pamiec->rozmiar : 16;
+      if (pamiec->rozmiar > pamiec->pojemnosc)
+        pamiec->rozmiar = pamiec->pojemnosc;
+      pamiec->wpisy = realloc(pamiec->wpisy,
+        sizeof(struct podreczna_wpis) * pamiec->rozmiar);
+    }
+    i = pamiec->liczba++;
+  }
+  size_t dlugoscBloku = dlugosc + 1;
+  for (int j = 0; j < liczba; j++)
+    dlugoscBloku += wcslen(podpowiedzi[j]) + 1;
+  struct podreczna_wpis * w = &pamiec->wpisy[i];
+  w->slowo = malloc(sizeof(wchar_t) * dlugoscBloku);
+  wmemcpy(w->slowo, slowo, dlugosc);
+  w->slowo[dlugosc] = L'\0';
+  wchar_t * koniec = w->slowo + dlugosc + 1;
+  w->podpowiedzi = koniec;
+  for (int j = 0; j < liczba; j++)
+  {
+    size_t dl = wcslen(podpowiedzi[j]) + 1;
+    wmemcpy(koniec, podpowiedzi[j], dl);
+    koniec += dl;
+  }
+  w->dlugosc = dlugosc;
+  w->liczba = liczba;
+  w->skrot = bloom_skrot(slowo, dlugosc);
+  size_t k = kubelek(pamiec, w->skrot);
+  w->dalej = pamiec->kubelki[k];
+  pamiec->kubelki[k] = i;
+  dolaczNaKoniec(pamiec, i);
+}
+
+void podreczna_wyczysc(struct podreczna * pamiec)
+{
+  if (pamiec->liczba == 0)
+    return;
+  for (int i = 0; i < pamiec->liczba; i++)
+    free(pamiec->wpisy[i].slowo);
+  pamiec->liczba = 0;
+  memset(pamiec->kubelki, -1, sizeof(int) * pamiec->liczbaKubelkow);
+  pamiec->najstarszy = -1;
+  pamiec->najnowszy = -1;
+}
@@ -0,0 +1,118 @@
+/** @file
+    Interfejs pamięci podręcznej podpowiedzi.
+
+    Pamięć pamięta podpowiedzi dla ograniczonej liczby ostatnio używanych
+    słów. Wpisy są w tablicy skrótów z listami kolizji i jednocześnie na
+    liście od najdawniej do ostatnio użytego; gdy pamięć jest pełna, nowy
+    wpis zajmuje miejsce najdawniej użytego. Podpowiedzi wpisu leżą w tym
+    samym bloku pamięci co słowo.
+
+    @ingroup dictionary
+ */
+
+#ifndef __PODRECZNA_H__
+#define __PODRECZNA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <wchar.h>
+
+/**
+  Wpis pamięci podręcznej.
+  */
+struct podreczna_wpis
+{
+  /** Słowo zakończone znakiem '\0', a za nim kolejne podpowiedzi, każda
+      zakończona znakiem '\0'. */
+  wchar_t * slowo;
+
+  /** Pierwsza podpowiedź, wskazuje do bloku słowa. */
+  const wchar_t * podpowiedzi;
+
+  /** Długość słowa. */
+  int dlugosc;
+
+  /** Liczba podpowiedzi. */
+  int liczba;
+
+  /** Skrót słowa. */
+  uint64_t skrot;
+
+  /** Następny wpis z tego samego kubełka, -1 jeśli to ostatni. */
+  int dalej;
+
+  /** Wpis użyty wcześniej, -1 dla najdawniej użytego. */
+  int starszy;
+
+  /** Wpis użyty później, -1 dla ostatnio użytego. */
+  int nowszy;
+};
+
+/**
+  Pamięć podręczna podpowiedzi.
+  */
+struct podreczna
+{
+  /** Wpisy, zajęte są pierwsze liczba. */
+  struct podreczna_wpis * wpisy;
+
+  /** Liczba wpisów, na które jest miejsce w tablicy wpisy. */
+  int rozmiar;
+
+  /** Liczba zajętych wpisów. */
+  int liczba;
+
+  /** Największa liczba wpisów. */
+  int pojemnosc;
+
+  /** Pierwsze wpisy list kolizji, -1 dla pustego kubełka. */
+  int * kubelki;
+
+  /** Liczba kubełków, potęga dwójki nie mniejsza od pojemności. */
+  size_t liczbaKubelkow;
+
+  /** Najdawniej użyty wpis, -1 jeśli pamięć jest pusta. */
+  int najstarszy;
+
+  /** Ostatnio użyty wpis, -1 jeśli pamięć jest pusta. */
+  int najnowszy;
+};
+
+/** Utworzenie pustej pamięci.
+ * @param[in] pojemnosc Największa liczba wpisów, dodatnia.
+ * @return Pamięć do zwolnienia przez podreczna_done().
+ */
+struct podreczna * podreczna_nowa(int pojemnosc);
+
+/** Zwolnienie pamięci.
+ * @param[in] pamiec Pamięć albo NULL.
+ */
+void podreczna_done(struct podreczna * pamiec);
+
+/** Wyszukanie wpisu słowa; znaleziony wpis staje się ostatnio użytym.
+ * @param[in,out] pamiec Pamięć.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @return Wpis ważny do następnej zmiany pamięci albo NULL, jeśli słowa
+ * nie ma w pamięci.
+ */
+const struct podreczna_wpis * podreczna_szukaj(struct podreczna * pamiec,
+  const wchar_t * slowo, int dlugosc);
+
+/** Dodanie wpisu słowa, którego nie ma jeszcze w pamięci. W pełnej pamięci
+ * usuwany jest najdawniej użyty wpis.
+ * @param[in,out] pamiec Pamięć.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] podpowiedzi Podpowiedzi, kopiowane do wpisu.
+ * @param[in] liczba Liczba podpowiedzi.
+ */
+void podreczna_dodaj(struct podreczna * pamiec, const wchar_t * slowo,
+  int dlugosc, wchar_t * const * podpowiedzi, int liczba);
+
+/** Usunięcie wszystkich wpisów.
+ * @param[in,out] pamiec Pamięć.
+ */
+void podreczna_wyczysc(struct podreczna * pamiec);
+
+#endif /* __PODRECZNA_H__ */
@@ -0,0 +1,115 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+#include <wchar.h>
+#include "podreczna.h"
+
+/* Dodaje słowo z podpowiedziami podanymi jako jeden napis, oddzielonymi
+   spacjami. */
+static void dodaj(struct podreczna * p, const wchar_t * slowo,
+                  const wchar_t * podpowiedzi) {
+    wchar_t kopia[64], * stan;
+    wchar_t * tablica[8];
+    int liczba = 0;
+    wcscpy(kopia, podpowiedzi);
+    for (wchar_t * s = wcstok(kopia, L" ", &stan); s != NULL;
+         s = wcstok(NULL, L" ", &stan))
+        tablica[liczba++] = s;
+    podreczna_dodaj(p, slowo, wcslen(slowo), tablica, liczba);
+}
+
+/* Podpowiedzi słowa jako jeden napis albo NULL, jeśli słowa nie ma. */
+static const wchar_t * szukaj(struct podreczna * p, const wchar_t * slowo) {
+    static wchar_t wynik[64];
+    const struct podreczna_wpis * w = podreczna_szukaj(p, slowo, wcslen(slowo));
+    if (w == NULL)
+        return NULL;
+    assert_true(!wcscmp(w->slowo, slowo));
+    wynik[0] = L'\0';
+    const wchar_t * s = w->podpowiedzi;
+    for (int i = 0; i < w->liczba; i++) {
+        if (i > 0)
+            wcscat(wynik, L" ");
+        wcscat(wynik, s);
+        s += wcslen(s) + 1;
+    }
+    return wynik;
+}
+
+static void podreczna_example_test(void** state) {
+    struct podreczna * p = podreczna_nowa(3);
+    assert_null(szukaj(p, L"kto"));
+    dodaj(p, L"kto", L"kot kto");
+    dodaj(p, L"", L"");
+    dodaj(p, L"pjes", L"pies");
+    assert_int_equal(p->liczba, 3);
+    assert_true(!wcscmp(szukaj(p, L"kto"), L"kot kto"));
+    assert_true(!wcscmp(szukaj(p, L""), L""));
+    assert_null(szukaj(p, L"kt"));
+    /* najdawniej użyte jest teraz pjes */
+    dodaj(p, L"ala", L"ala ma");
+    assert_int_equal(p->liczba, 3);
+    assert_null(szukaj(p, L"pjes"));
+    assert_true(!wcscmp(szukaj(p, L"kto"), L"kot kto"));
+    dodaj(p, L"mma", L"ma");
+    assert_null(szukaj(p, L""));
+    assert_true(!wcscmp(szukaj(p, L"ala"), L"ala ma"));
+    assert_true(!wcscmp(szukaj(p, L"mma"), L"ma"));
+    podreczna_wyczysc(p);
+    assert_int_equal(p->liczba, 0);
+    assert_null(szukaj(p, L"ala"));
+    dodaj(p, L"ala", L"ala");
+    assert_true(!wcscmp(szukaj(p, L"ala"), L"ala"));
+    podreczna_done(p);
+}
+
+static void podreczna_random_test(void** state) {
+    /* Porównanie z prostą listą słów w kolejności użycia. */
+    enum { POJEMNOSC = 37, SLOWA = 100 };
+    struct podreczna * p = podreczna_nowa(POJEMNOSC);
+    int kolejnosc[POJEMNOSC], liczba = 0;
+    unsigned ziarno = 2024;
+    for (int krok = 0; krok < 20000; krok++) {
+        ziarno = ziarno * 1103515245 + 12345;
+        int numer = (ziarno >> 16) % SLOWA;
+        wchar_t slowo[8], podpowiedz[8];
+        swprintf(slowo, 8, L"s%d", numer);
+        swprintf(podpowiedz, 8, L"p%d", numer);
+        int miejsce = -1;
+        for (int i = 0; i < liczba; i++)
+            if (kolejnosc[i] == numer)
+                miejsce = i;
+        const wchar_t * wynik = szukaj(p, slowo);
+        if (miejsce < 0) {
+            assert_null(wynik);
+            dodaj(p, slowo, podpowiedz);
+            if (liczba == POJEMNOSC)
+                memmove(kolejnosc, kolejnosc + 1, sizeof(int) * --liczba);
+            kolejnosc[liczba++] = numer;
+        } else {
+            assert_non_null(wynik);
+            assert_true(!wcscmp(wynik, podpowiedz));
+            memmove(kolejnosc + miejsce, kolejnosc + miejsce + 1,
+                    sizeof(int) * (liczba - miejsce - 1));
+            kolejnosc[liczba - 1] = numer;
+        }
+        assert_int_equal(p->liczba, liczba);
+        if (krok % 5000 == 4999) {
+            podreczna_wyczysc(p);
+            liczba = 0;
+        }
+    }
+    podreczna_done(p);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(podreczna_example_test),
+        cmocka_unit_test(podreczna_random_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,460 @@
+/** @file
+  Implementacja indeksu reguł podpowiedzi.
+
+  @ingroup dictionary
+ */
+
+#include "reguly.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Czy znak jest zmienną reguły.
+ * @param[in] znak Znak.
+ * @return True dla cyfr.
+ */
+static inline bool czyZmienna(wchar_t znak)
+{
+  return znak >= L'0' && znak <= L'9';
+}
+
+/**
+  Reguła z numerem na wejściu, do sortowania.
+  */
+struct numerowana
+{
+  /** Reguła. */
+  const struct regula * regula;
+
+  /** Numer na wejściu. */
+  int numer;
+};
+
+/** Porównanie reguł po koszcie, a przy równym po numerze na wejściu.
+ * @param[in] a Pierwsza reguła.
+ * @param[in] b Druga reguła.
+ * @return Wynik porównania.
+ */
+static int porownajKoszty(const void * a, const void * b)
+{
+  const struct numerowana * x = a, * y = b;
+  if (x->regula->koszt != y->regula->koszt)
+    return x->regula->koszt < y->regula->koszt ? -1 : 1;
+  return x->numer - y->numer;
+}
+
+/** Porównanie krawędzi po literze.
+ * @param[in] a Pierwsza krawędź.
+ * @param[in] b Druga krawędź.
+ * @return Wynik porównania.
+ */
+static int porownajKrawedzie(const void * a, const void * b)
+{
+  const struct reguly_krawedz * x = a, * y = b;
+  return (x->litera > y->litera) - (x->litera < y->litera);
+}
+
+/** Przejście automatu po literze bez korzystania z porażek.
+ * @param[in] indeks Indeks.
+ * @param[in] wezel Wierzchołek.
+ * @param[in] litera Litera.
+ * @return Wierzchołek docelowy albo -1, jeśli nie ma krawędzi.
+ */
+static int przejscie(const struct reguly * indeks, int wezel, wchar_t litera)
+{
+  const struct reguly_krawedz * k = indeks->krawedzie + indeks->wezly[wezel].krawedzie;
+  int lewy = 0, prawy = indeks->wezly[wezel].liczbaKrawedzi;
+  while (lewy < prawy)
+  {
+    int srodek = (lewy + prawy) / 2;
+    if (k[srodek].litera < litera)
+      lewy = srodek + 1;
+    else
+      prawy = srodek;
+  }
+  if (lewy < indeks->wezly[wezel].liczbaKrawedzi && k[lewy].litera == litera)
+    return k[lewy].cel;
+  return -1;
+}
+
+/** Wybór najdłuższego ciągu liter lewej strony.
+ * @param[in] r Skompilowana reguła.
+ * @param[out] dlugosc Długość ciągu, 0 jeśli lewa strona składa się
+ * z samych zmiennych.
+ * @return Położenie ciągu w lewej stronie.
+ */
+static int fragment(const struct regula * r, int * dlugosc)
+{
+  int najlepszy = 0, polozenie = 0;
+  *dlugosc = 0;
+  for (const struct regula_krok * k = r->program; k < r->program + r->krokiLewej; k++)
+  {
+    if (k->typ != REGULA_LITERY)
+    {
+      polozenie++;
+      continue;
+    }
+    if (k->wartosc > *dlugosc)
+    {
+      najlepszy = polozenie;
+      *dlugosc = k->wartosc;
+    }
+    polozenie += k->wartosc;
+  }
+  return najlepszy;
+}
+
+/** Dopisanie kroków jednej strony reguły.
+ * @param[in] strona Strona reguły.
+ * @param[in,out] kroki Program, do którego dopisywane są kroki.
+ * @param[in,out] znane Czy zmienna ma już wartość.
+ * @param[in] lewa Czy to lewa strona.
+ * @param[out] wolne Liczba zmiennych prawej strony, których nie ma po lewej.
+ * @return Liczba dopisanych kroków.
+ */
+static int kompilujStrone(const wchar_t * strona, struct regula_krok * kroki,
+  bool * znane, bool lewa, int * wolne)
+{
+  int liczba = 0;
+  for (int i = 0; strona[i] != L'\0';)
+  {
+    struct regula_krok * k = &kroki[liczba++];
+    if (!czyZmienna(strona[i]))
+    {
+      int j = i;
+      while (strona[j] != L'\0' && !czyZmienna(strona[j]))
+        j++;
+      k->typ = REGULA_LITERY;
+      k->wartosc = j - i;
+      k->litery = strona + i;
+      i = j;
+      continue;
+    }
+    k->wartosc = strona[i++] - L'0';
+    k->litery = NULL;
+    if (znane[k->wartosc])
+      k->typ = lewa ? REGULA_POWTORZENIE : REGULA_ZMIENNA;
+    else
+    {
+      k->typ = lewa ? REGULA_ZMIENNA : REGULA_WOLNA;
+      znane[k->wartosc] = true;
+      *wolne += !lewa;
+    }
+  }
+  return liczba;
+}
+
+int regula_kompiluj(struct regula * r)
+{
+  size_t dlugosc = wcslen(r->lewaStrona) + wcslen(r->prawaStrona);
+  struct regula_krok * program = malloc(sizeof(struct regula_krok) * (dlugosc + 1));
+  if (program == NULL)
+    return -1;
+  bool znane[REGULY_LICZBA_ZMIENNYCH] = { false };
+  int wolne = 0;
+  r->krokiLewej = kompilujStrone(r->lewaStrona, program, znane, true, &wolne);
+  r->krokiPrawej = kompilujStrone(r->prawaStrona, program + r->krokiLewej, znane,
+    false, &wolne);
+  if (wolne > 1)
+  {
+    free(program);
+    return 0;
+  }
+  r->dlugoscLewej = wcslen(r->lewaStrona);
+  r->program = program;
+  return 1;
+}
+
+void regula_done(struct regula * r)
+{
+  free(r->program);
+  r->program = NULL;
+}
+
+struct reguly * reguly_zbuduj(const struct regula * const * reguly, int liczba)
+{
+  struct reguly * indeks = calloc(1, sizeof(struct reguly));
+  indeks->liczba = liczba;
+  indeks->reguly = malloc(sizeof(struct regula *) * (liczba + 1));
+  indeks->przesuniecia = malloc(sizeof(int) * (liczba + 1));
+  indeks->bezLiter = malloc(sizeof(int) * (liczba + 1));
+  struct numerowana * numerowane = malloc(sizeof(struct numerowana) * (liczba + 1));
+  for (int i = 0; i < liczba; i++)
+  {
+    numerowane[i].regula = reguly[i];
+    numerowane[i].numer = i;
+  }
+  qsort(numerowane, liczba, sizeof(struct numerowana), porownajKoszty);
+  for (int i = 0; i < liczba; i++)
+    indeks->reguly[i] = numerowane[i].regula;
+  free(numerowane);
+
+  /* Drzewo fragmentów; dzieci wierzchołka tworzą listę (dziecko, brat). */
+  int liczbaLiter = 0;
+  for (int i = 0; i < liczba; i++)
+    liczbaLiter += wcslen(indeks->reguly[i]->lewaStrona);
+  int * dziecko = malloc(sizeof(int) * (liczbaLiter + 1));
+  int * brat = malloc(sizeof(int) * (liczbaLiter + 1));
+  wchar_t * litery = malloc(sizeof(wchar_t) * (liczbaLiter + 1));
+  int * konce = malloc(sizeof(int) * (liczba + 1));
+  int liczbaWezlow = 1;
+  dziecko[0] = -1;
+  for (int i = 0; i < liczba; i++)
+  {
+    int dlugosc;
+    const wchar_t * lewa = indeks->reguly[i]->lewaStrona;
+    indeks->przesuniecia[i] = fragment(indeks->reguly[i], &dlugosc);
+    if (dlugosc == 0)
+    {
+      indeks->bezLiter[indeks->liczbaBezLiter++] = i;
+      konce[i] = -1;
+      continue;
+    }
+    int wezel = 0;
+    for (const wchar_t * l = lewa + indeks->przesuniecia[i]; l < lewa + indeks->przesuniecia[i] + dlugosc; l++)
+    {
+      int syn = dziecko[wezel];
+      while (syn >= 0 && litery[syn] != *l)
+        syn = brat[syn];
+      if (syn < 0)
+      {
+        syn = liczbaWezlow++;
+        litery[syn] = *l;
+        dziecko[syn] = -1;
+        brat[syn] = dziecko[wezel];
+        dziecko[wezel] = syn;
+      }
+      wezel = syn;
+    }
+    konce[i] = wezel;
+  }
+
+  indeks->liczbaWezlow = liczbaWezlow;
+  indeks->wezly = calloc(liczbaWezlow, sizeof(struct reguly_wezel));
+  indeks->krawedzie = malloc(sizeof(struct reguly_krawedz) * liczbaWezlow);
+  indeks->wyjscia = malloc(sizeof(int) * (liczba + 1));
+  int liczbaKrawedzi = 0;
+  for (int w = 0; w < liczbaWezlow; w++)
+  {
+    indeks->wezly[w].krawedzie = liczbaKrawedzi;
+    for (int syn = dziecko[w]; syn >= 0; syn = brat[syn])
+    {
+      indeks->krawedzie[liczbaKrawedzi].litera = litery[syn];
+      indeks->krawedzie[liczbaKrawedzi++].cel = syn;
+    }
+    indeks->wezly[w].liczbaKrawedzi = liczbaKrawedzi - indeks->wezly[w].krawedzie;
+    qsort(indeks->krawedzie + indeks->wezly[w].krawedzie, indeks->wezly[w].liczbaKrawedzi,
+      sizeof(struct reguly_krawedz), porownajKrawedzie);
+  }
+  /* Reguły kończące się w jednym wierzchołku leżą obok siebie,
+     w kolejności kosztów. */
+  for (int i = 0; i < liczba; i++)
+    if (konce[i] >= 0)
+      indeks->wezly[konce[i]].liczbaRegul++;
+  int suma = 0;
+  for (int w = 0; w < liczbaWezlow; w++)
+  {
+    indeks->wezly[w].reguly = suma;
+    suma += indeks->wezly[w].liczbaRegul;
+    indeks->wezly[w].liczbaRegul = 0;
+  }
+  for (int i = 0; i < liczba; i++)
+    if (konce[i] >= 0)
+    {
+      struct reguly_wezel * w = &indeks->wezly[konce[i]];
+      indeks->wyjscia[w->reguly + w->liczbaRegul++] = i;
+    }
+
+  /* Porażki wyznaczane wszerz, od płytszych wierzchołków. */
+  int * kolejka = dziecko;
+  int poczatek = 0, koniec = 0;
+  indeks->wezly[0].wyjscie = -1;
+  kolejka[koniec++] = 0;
+  while (poczatek < koniec)
+  {
+    int w = kolejka[poczatek++];
+    const struct reguly_wezel * wezel = &indeks->wezly[w];
+    for (int k = wezel->krawedzie; k < wezel->krawedzie + wezel->liczbaKrawedzi; k++)
+    {
+      wchar_t litera = indeks->krawedzie[k].litera;
+      struct reguly_wezel * syn = &indeks->wezly[indeks->krawedzie[k].cel];
+      syn->glebokosc = wezel->glebokosc + 1;
+      syn->porazka = 0;
+      if (w != 0)
+        for (int p = wezel->porazka;; p = indeks->wezly[p].porazka)
+        {
+          int cel = przejscie(indeks, p, litera);
+          if (cel >= 0)
+          {
+            syn->porazka = cel;
+            break;
+          }
+          if (p == 0)
+            break;
+        }
+      const struct reguly_wezel * porazka = &indeks->wezly[syn->porazka];
+      syn->wyjscie = porazka->liczbaRegul > 0 ? syn->porazka : porazka->wyjscie;
+      kolejka[koniec++] = indeks->krawedzie[k].cel;
+    }
+  }
+  free(dziecko);
+  free(brat);
+  free(litery);
+  free(konce);
+  return indeks;
+}
+
+void reguly_done(struct reguly * indeks)
+{
+  if (indeks == NULL)
+    return;
+  free(indeks->reguly);
+  free(indeks->przesuniecia);
+  free(indeks->wezly);
+  free(indeks->krawedzie);
+  free(indeks->wyjscia);
+  free(indeks->bezLiter);
+  free(indeks);
+}
+
+int regula_pasuje(const struct regula * r, const wchar_t * blok, int zostalo,
+  wchar_t * zmienne)
+{
+  if (r->dlugoscLewej > zostalo)
+    return -1;
+  for (int z = 0; z < REGULY_LICZBA_ZMIENNYCH; z++)
+    zmienne[z] = L'\0';
+  for (const struct regula_krok * k = r->program; k < r->program + r->krokiLewej; k++)
+    switch (k->typ)
+    {
+      case REGULA_LITERY:
+        if (wmemcmp(blok, k->litery, k->wartosc))
+          return -1;
+        blok += k->wartosc;
+        break;
+      case REGULA_ZMIENNA:
+        zmienne[k->wartosc] = *blok++;
+        break;
+      default:
+        if (zmienne[k->wartosc] != *blok++)
+          return -1;
+    }
+  return r->dlugoscLewej;
+}
+
+/**
+  Zastosowanie reguły przed posortowaniem.
+  */
+struct znalezione
+{
+  /** Początek bloku. */
+  int poczatek;
+
+  /** Numer reguły w indeksie. */
+  int numer;
+};
+
+/** Porównanie zastosowań po początku bloku, a potem po numerze reguły.
+ * @param[in] a Pierwsze zastosowanie.
+ * @param[in] b Drugie zastosowanie.
+ * @return Wynik porównania.
+ */
+static int porownajZnalezione(const void * a, const void * b)
+{
+  const struct znalezione * x = a, * y = b;
+  if (x->poczatek != y->poczatek)
+    return x->poczatek - y->poczatek;
+  return x->numer - y->numer;
+}
+
+/** Sprawdzenie reguły na początku bloku i zapamiętanie jej zastosowania.
+ * @param[in] indeks Indeks.
+ * @param[in] numer Numer reguły.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] poczatek Początek bloku.
+ * @param[in,out] znalezione Tablica zastosowań.
+ * @param[in,out] liczba Liczba zastosowań.
+ * @param[in,out] rozmiar Rozmiar tablicy zastosowań.
+ */
+static void sprawdz(const struct reguly * indeks, int numer, const wchar_t * slowo,
+  int dlugosc, int poczatek, struct znalezione ** znalezione, int * liczba,
+  int * rozmiar)
+{
+  const struct regula * r = indeks->reguly[numer];
+  if (r->flaga == RULE_BEGIN && poczatek != 0)
+    return;
+  wchar_t zmienne[REGULY_LICZBA_ZMIENNYCH];
+  int dlugoscBloku = regula_pasuje(r, slowo + poczatek, dlugosc - poczatek,
+    zmienne);
+  if (dlugoscBloku < 0)
+    return;
+  if (r->flaga == RULE_END && poczatek + dlugoscBloku != dlugosc)
+    return;
+  if (*liczba == *rozmiar)
+  {
+    *rozmiar = *rozmiar ? 2 * *rozmiar : 64;
+    *znalezione = realloc(*znalezione, sizeof(struct znalezione) * *rozmiar);
+  }
+  (*znalezione)[*liczba].poczatek = poczatek;
+  (*znalezione)[(*liczba)++].numer = numer;
+}
+
+void reguly_dopasuj(const struct reguly * indeks, const wchar_t * slowo,
+  int dlugosc, struct reguly_dopasowania * wynik)
+{
+  struct znalezione * znalezione = NULL;
+  int liczba = 0, rozmiar = 0;
+  for (int poczatek = 0; poczatek <= dlugosc; poczatek++)
+    for (int i = 0; i < indeks->liczbaBezLiter; i++)
+      sprawdz(indeks, indeks->bezLiter[i], slowo, dlugosc, poczatek,
+        &znalezione, &liczba, &rozmiar);
+  int wezel = 0;
+  for (int j = 0; j < dlugosc; j++)
+  {
+    int cel;
+    while ((cel = przejscie(indeks, wezel, slowo[j])) < 0 && wezel != 0)
+      wezel = indeks->wezly[wezel].porazka;
+    wezel = cel >= 0 ? cel : 0;
+    int w = indeks->wezly[wezel].liczbaRegul > 0 ? wezel : indeks->wezly[wezel].wyjscie;
+    for (; w >= 0; w = indeks->wezly[w].wyjscie)
+    {
+      const struct reguly_wezel * o = &indeks->wezly[w];
+      for (int k = o->reguly; k < o->reguly + o->liczbaRegul; k++)
+      {
+        int numer = indeks->wyjscia[k];
+        int poczatek = j + 1 - o->glebokosc - indeks->przesuniecia[numer];
+        if (poczatek >= 0)
+          sprawdz(indeks, numer, slowo, dlugosc, poczatek, &znalezione,
+            &liczba, &rozmiar);
+      }
+    }
+  }
+  if (liczba > 0)
+    qsort(znalezione, liczba, sizeof(struct znalezione), porownajZnalezione);
+
+  wynik->liczba = liczba;
+  wynik->tablica = malloc(sizeof(struct reguly_dopasowanie) * (liczba + 1));
+  wynik->poczatki = malloc(sizeof(int) * (dlugosc + 2));
+  int poczatek = 0;
+  for (int i = 0; i < liczba; i++)
+  {
+    while (poczatek <= znalezione[i].poczatek)
+      wynik->poczatki[poczatek++] = i;
+    struct reguly_dopasowanie * d = &wynik->tablica[i];
+    d->regula = indeks->reguly[znalezione[i].numer];
+    d->dlugosc = regula_pasuje(d->regula, slowo + znalezione[i].poczatek,
+      dlugosc - znalezione[i].poczatek, d->zmienne);
+  }
+  while (poczatek <= dlugosc + 1)
+    wynik->poczatki[poczatek++] = liczba;
+  free(znalezione);
+}
+
+void reguly_dopasowania_done(struct reguly_dopasowania * dopasowania)
+{
+  free(dopasowania->tablica);
+  free(dopasowania->poczatki);
+  dopasowania->tablica = NULL;
+  dopasowania->poczatki = NULL;
+  dopasowania->liczba = 0;
+}
@@ -0,0 +1,241 @@
+/** @file
+    Interfejs indeksu reguł podpowiedzi.
+
+    Z lewej strony każdej reguły wybierany jest najdłuższy fragment bez
+    zmiennych. Fragmenty wszystkich reguł tworzą automat Aho-Corasick,
+    więc jedno przejście po słowie znajduje każde wystąpienie każdego
+    fragmentu; wystąpienie wyznacza początek bloku, do którego sprawdzana
+    jest reszta lewej strony razem z wartościami zmiennych. Reguły, których
+    lewa strona składa się z samych zmiennych, sprawdzane są na każdej
+    pozycji.
+
+    @ingroup dictionary
+ */
+
+#ifndef __REGULY_H__
+#define __REGULY_H__
+
+#include <stdbool.h>
+#include <wchar.h>
+#include "dictionary.h"
+
+/** Liczba zmiennych reguł (cyfry 0-9). */
+#define REGULY_LICZBA_ZMIENNYCH 10
+
+/**
+  Rodzaj kroku programu reguły.
+  */
+enum regula_typ
+{
+  REGULA_LITERY,   ///< Ciąg liter bez zmiennych.
+  REGULA_ZMIENNA,  ///< Zmienna: po lewej pierwsze wystąpienie (przypisanie),
+                   ///< po prawej wystąpienie zmiennej o znanej wartości.
+  REGULA_POWTORZENIE, ///< Kolejne wystąpienie zmiennej po lewej stronie.
+  REGULA_WOLNA     ///< Pierwsze wystąpienie po prawej stronie zmiennej,
+                   ///< której nie ma po lewej.
+};
+
+/**
+  Krok programu reguły.
+  */
+struct regula_krok
+{
+  /** Rodzaj kroku. */
+  enum regula_typ typ;
+
+  /** Numer zmiennej albo liczba liter ciągu. */
+  int wartosc;
+
+  /** Litery ciągu, wskazują do strony reguły. */
+  const wchar_t * litery;
+};
+
+/** Struktura przechowująca regułę. */
+struct regula
+{
+  /** Lewa strona reguły. */
+  const wchar_t * lewaStrona;
+
+  /** Prawa strona reguły. */
+  const wchar_t * prawaStrona;
+
+  /** Reprezentuje flagę przypisaną regule. */
+  enum rule_flag flaga;
+
+  /** Koszt podpowiedzi. */
+  int koszt;
+
+  /** Program reguły (patrz regula_kompiluj()): kroki lewej strony, a po nich
+      kroki prawej, NULL jeśli reguły nie skompilowano. */
+  struct regula_krok * program;
+
+  /** Liczba kroków lewej strony. */
+  int krokiLewej;
+
+  /** Liczba kroków prawej strony. */
+  int krokiPrawej;
+
+  /** Długość bloku, do którego pasuje lewa strona. */
+  int dlugoscLewej;
+};
+
+/**
+  Wierzchołek automatu Aho-Corasick.
+  */
+struct reguly_wezel
+{
+  /** Wierzchołek najdłuższego właściwego sufiksu, który jest w automacie. */
+  int porazka;
+
+  /** Najbliższy wierzchołek na ścieżce porażek, w którym kończą się
+      fragmenty reguł, -1 jeśli takiego nie ma. */
+  int wyjscie;
+
+  /** Indeks pierwszej krawędzi wychodzącej. */
+  int krawedzie;
+
+  /** Liczba krawędzi wychodzących. */
+  int liczbaKrawedzi;
+
+  /** Indeks pierwszej reguły kończącej się tu fragmentem. */
+  int reguly;
+
+  /** Liczba reguł kończących się tu fragmentem. */
+  int liczbaRegul;
+
+  /** Długość fragmentu odpowiadającego wierzchołkowi. */
+  int glebokosc;
+};
+
+/**
+  Krawędź automatu.
+  */
+struct reguly_krawedz
+{
+  /** Litera krawędzi. */
+  wchar_t litera;
+
+  /** Wierzchołek docelowy. */
+  int cel;
+};
+
+/**
+  Indeks reguł.
+  */
+struct reguly
+{
+  /** Reguły, w kolejności niemalejącego kosztu. */
+  const struct regula ** reguly;
+
+  /** Liczba reguł. */
+  int liczba;
+
+  /** Położenie fragmentu w lewej stronie każdej reguły. */
+  int * przesuniecia;
+
+  /** Wierzchołki automatu, korzeniem jest wierzchołek 0. */
+  struct reguly_wezel * wezly;
+
+  /** Liczba wierzchołków. */
+  int liczbaWezlow;
+
+  /** Krawędzie automatu, dla każdego wierzchołka posortowane po literach. */
+  struct reguly_krawedz * krawedzie;
+
+  /** Numery reguł kończących się fragmentem w kolejnych wierzchołkach. */
+  int * wyjscia;
+
+  /** Numery reguł, których lewa strona składa się z samych zmiennych. */
+  int * bezLiter;
+
+  /** Liczba takich reguł. */
+  int liczbaBezLiter;
+};
+
+/**
+  Zastosowanie reguły do bloku słowa.
+  */
+struct reguly_dopasowanie
+{
+  /** Reguła. */
+  const struct regula * regula;
+
+  /** Długość bloku. */
+  int dlugosc;
+
+  /** Wartości zmiennych, '\0' dla niewystępujących w lewej stronie. */
+  wchar_t zmienne[REGULY_LICZBA_ZMIENNYCH];
+};
+
+/**
+  Wszystkie zastosowania reguł do bloków jednego słowa.
+  */
+struct reguly_dopasowania
+{
+  /** Zastosowania posortowane po początku bloku, a dla jednego początku
+      po koszcie reguły. */
+  struct reguly_dopasowanie * tablica;
+
+  /** Zastosowania do bloków zaczynających się na pozycji i to
+      tablica[poczatki[i]], ..., tablica[poczatki[i + 1] - 1]. */
+  int * poczatki;
+
+  /** Liczba zastosowań. */
+  int liczba;
+};
+
+/** Budowa indeksu reguł.
+ * @param[in] reguly Skompilowane reguły; indeks pamięta wskaźniki do nich.
+ * @param[in] liczba Liczba reguł.
+ * @return Indeks do zwolnienia przez reguly_done().
+ */
+struct reguly * reguly_zbuduj(const struct regula * const * reguly, int liczba);
+
+/** Zwolnienie indeksu.
+ * @param[in] indeks Indeks albo NULL.
+ */
+void reguly_done(struct reguly * indeks);
+
+/** Kompilacja reguły do programu: lewa strona staje się ciągiem kroków
+ * porównujących litery, przypisujących zmienne i sprawdzających ich
+ * powtórzenia, a prawa wzorcem podstawienia. Kroki wskazują do stron
+ * reguły, więc muszą one żyć co najmniej tak długo jak program.
+ * @param[in,out] r Reguła.
+ * @return 1 jeśli regułę skompilowano, 0 jeśli prawa strona ma więcej niż
+ * jedną zmienną, której nie ma po lewej, -1 jeśli zabrakło pamięci.
+ */
+int regula_kompiluj(struct regula * r);
+
+/** Zwolnienie programu reguły.
+ * @param[in,out] r Reguła.
+ */
+void regula_done(struct regula * r);
+
+/** Sprawdzenie skompilowanej reguły na początku bloku.
+ * @param[in] r Reguła.
+ * @param[in] blok Początek bloku.
+ * @param[in] zostalo Liczba liter słowa od początku bloku.
+ * @param[out] zmienne Wartości zmiennych, '\0' dla niewystępujących
+ * w lewej stronie.
+ * @return Długość bloku albo -1, jeśli reguła do niego nie pasuje.
+ */
+int regula_pasuje(const struct regula * r, const wchar_t * blok, int zostalo,
+  wchar_t * zmienne);
+
+/** Znalezienie wszystkich zastosowań reguł do bloków słowa, z uwzględnieniem
+ * flag RULE_BEGIN i RULE_END.
+ * @param[in] indeks Indeks.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[out] wynik Zastosowania, do zwolnienia przez
+ * reguly_dopasowania_done().
+ */
+void reguly_dopasuj(const struct reguly * indeks, const wchar_t * slowo,
+  int dlugosc, struct reguly_dopasowania * wynik);
+
+/** Zwolnienie zastosowań.
+ * @param[in,out] dopasowania Zastosowania.
+ */
+void reguly_dopasowania_done(struct reguly_dopasowania * dopasowania);
+
+#endif /* __REGULY_H__ */
@@ -0,0 +1,204 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <cmocka.h>
+#include <wchar.h>
+#include "reguly.h"
+
+/* Liczba losowych reguł. */
+#define LICZBA_REGUL 200
+
+/* Dopasowanie lewej strony wprost, bez programu reguły. */
+static int pasuje(const wchar_t * lewa, const wchar_t * blok, int zostalo,
+                  wchar_t * zmienne) {
+    for (int z = 0; z < REGULY_LICZBA_ZMIENNYCH; z++)
+        zmienne[z] = L'\0';
+    int i = 0;
+    for (; lewa[i] != L'\0'; i++) {
+        if (i == zostalo)
+            return -1;
+        if (lewa[i] < L'0' || lewa[i] > L'9') {
+            if (lewa[i] != blok[i])
+                return -1;
+            continue;
+        }
+        wchar_t * zmienna = &zmienne[lewa[i] - L'0'];
+        if (*zmienna == L'\0')
+            *zmienna = blok[i];
+        else if (*zmienna != blok[i])
+            return -1;
+    }
+    return i;
+}
+
+/* Sprawdza, czy zastosowania z indeksu to dokładnie te, które daje
+   sprawdzenie każdej reguły na każdej pozycji. */
+static void porownaj(const struct regula * const * reguly, int liczba,
+                     const struct reguly * indeks, const wchar_t * slowo) {
+    int dlugosc = wcslen(slowo);
+    struct reguly_dopasowania d;
+    reguly_dopasuj(indeks, slowo, dlugosc, &d);
+    int oczekiwane = 0;
+    for (int poczatek = 0; poczatek <= dlugosc; poczatek++) {
+        int ostatniKoszt = 0;
+        for (int i = d.poczatki[poczatek]; i < d.poczatki[poczatek + 1]; i++) {
+            assert_true(d.tablica[i].regula->koszt >= ostatniKoszt);
+            ostatniKoszt = d.tablica[i].regula->koszt;
+        }
+        for (int r = 0; r < liczba; r++) {
+            wchar_t zmienne[REGULY_LICZBA_ZMIENNYCH];
+            int dlugoscBloku = pasuje(reguly[r]->lewaStrona, slowo + poczatek,
+                                      dlugosc - poczatek, zmienne);
+            if (dlugoscBloku < 0)
+                continue;
+            if (reguly[r]->flaga == RULE_BEGIN && poczatek != 0)
+                continue;
+            if (reguly[r]->flaga == RULE_END && poczatek + dlugoscBloku != dlugosc)
+                continue;
+            int znalezione = 0;
+            for (int i = d.poczatki[poczatek]; i < d.poczatki[poczatek + 1]; i++)
+                if (d.tablica[i].regula == reguly[r]) {
+                    znalezione++;
+                    assert_int_equal(d.tablica[i].dlugosc, dlugoscBloku);
+                    assert_true(!wmemcmp(d.tablica[i].zmienne, zmienne,
+                                         REGULY_LICZBA_ZMIENNYCH));
+                }
+            assert_int_equal(znalezione, 1);
+            oczekiwane++;
+        }
+    }
+    assert_int_equal(d.liczba, oczekiwane);
+    assert_int_equal(d.poczatki[dlugosc + 1], d.liczba);
+    reguly_dopasowania_done(&d);
+}
+
+static void reguly_example_test(void** state) {
+    struct regula r[] = {
+        { L"he", L"", RULE_NORMAL, 2 },
+        { L"she", L"", RULE_NORMAL, 1 },
+        { L"his", L"", RULE_NORMAL, 1 },
+        { L"hers", L"", RULE_NORMAL, 1 },
+        { L"h0", L"", RULE_NORMAL, 3 },
+        { L"00", L"0", RULE_NORMAL, 1 },
+        { L"", L"x", RULE_NORMAL, 1 },
+        { L"s", L"", RULE_BEGIN, 1 },
+        { L"s", L"", RULE_END, 1 },
+    };
+    const struct regula * wskazniki[9];
+    for (int i = 0; i < 9; i++) {
+        assert_int_equal(regula_kompiluj(&r[i]), 1);
+        wskazniki[i] = &r[i];
+    }
+    struct reguly * indeks = reguly_zbuduj(wskazniki, 9);
+    struct reguly_dopasowania d;
+    reguly_dopasuj(indeks, L"ushers", 6, &d);
+    /* na pozycji 1: she i ""; na 2: hers i "" (1), he (2), h0 (3) */
+    assert_int_equal(d.poczatki[2] - d.poczatki[1], 2);
+    assert_ptr_equal(d.tablica[d.poczatki[2]].regula, &r[3]);
+    assert_ptr_equal(d.tablica[d.poczatki[2] + 1].regula, &r[6]);
+    assert_ptr_equal(d.tablica[d.poczatki[2] + 2].regula, &r[0]);
+    assert_ptr_equal(d.tablica[d.poczatki[2] + 3].regula, &r[4]);
+    assert_int_equal(d.tablica[d.poczatki[2] + 3].zmienne[0], L'e');
+    assert_int_equal(d.poczatki[3], d.poczatki[2] + 4);
+    /* s na końcu, ale nie na początku */
+    assert_int_equal(d.poczatki[6] - d.poczatki[5], 2);
+    assert_int_equal(d.poczatki[7] - d.poczatki[6], 1);
+    reguly_dopasowania_done(&d);
+    porownaj(wskazniki, 9, indeks, L"ushers");
+    porownaj(wskazniki, 9, indeks, L"shhhis");
+    porownaj(wskazniki, 9, indeks, L"");
+    reguly_done(indeks);
+    for (int i = 0; i < 9; i++)
+        regula_done(&r[i]);
+
+    indeks = reguly_zbuduj(NULL, 0);
+    reguly_dopasuj(indeks, L"kot", 3, &d);
+    assert_int_equal(d.liczba, 0);
+    reguly_dopasowania_done(&d);
+    reguly_done(indeks);
+}
+
+static void reguly_compile_test(void** state) {
+    struct regula r = { L"ab01c0", L"x12", RULE_NORMAL, 1 };
+    assert_int_equal(regula_kompiluj(&r), 1);
+    assert_int_equal(r.dlugoscLewej, 6);
+    assert_int_equal(r.krokiLewej, 5);
+    assert_int_equal(r.program[0].typ, REGULA_LITERY);
+    assert_int_equal(r.program[0].wartosc, 2);
+    assert_int_equal(r.program[1].typ, REGULA_ZMIENNA);
+    assert_int_equal(r.program[2].typ, REGULA_ZMIENNA);
+    assert_int_equal(r.program[2].wartosc, 1);
+    assert_int_equal(r.program[4].typ, REGULA_POWTORZENIE);
+    assert_int_equal(r.krokiPrawej, 3);
+    assert_int_equal(r.program[5].typ, REGULA_LITERY);
+    assert_int_equal(r.program[6].typ, REGULA_ZMIENNA);
+    assert_int_equal(r.program[7].typ, REGULA_WOLNA);
+    assert_int_equal(r.program[7].wartosc, 2);
+    wchar_t zmienne[REGULY_LICZBA_ZMIENNYCH];
+    assert_int_equal(regula_pasuje(&r, L"abkocky", 7, zmienne), 6);
+    assert_int_equal(zmienne[0], L'k');
+    assert_int_equal(zmienne[1], L'o');
+    assert_int_equal(zmienne[2], L'\0');
+    assert_int_equal(regula_pasuje(&r, L"abkocoy", 7, zmienne), -1);
+    assert_int_equal(regula_pasuje(&r, L"abkock", 5, zmienne), -1);
+    regula_done(&r);
+
+    /* prawa strona może mieć tylko jedną zmienną spoza lewej */
+    struct regula z = { L"0", L"1221", RULE_NORMAL, 1 };
+    assert_int_equal(regula_kompiluj(&z), 0);
+    struct regula p = { L"", L"11", RULE_NORMAL, 1 };
+    assert_int_equal(regula_kompiluj(&p), 1);
+    assert_int_equal(p.program[0].typ, REGULA_WOLNA);
+    assert_int_equal(p.program[1].typ, REGULA_ZMIENNA);
+    regula_done(&p);
+}
+
+static void reguly_random_test(void** state) {
+    static wchar_t strony[LICZBA_REGUL][8];
+    static struct regula r[LICZBA_REGUL];
+    static const struct regula * wskazniki[LICZBA_REGUL];
+    unsigned ziarno = 4321;
+    for (int i = 0; i < LICZBA_REGUL; i++) {
+        ziarno = ziarno * 1103515245 + 12345;
+        int dlugosc = (ziarno >> 16) % 5;
+        for (int j = 0; j < dlugosc; j++) {
+            ziarno = ziarno * 1103515245 + 12345;
+            int znak = (ziarno >> 16) % 6;
+            strony[i][j] = znak < 3 ? L'a' + znak : L'0' + znak - 3;
+        }
+        strony[i][dlugosc] = L'\0';
+        ziarno = ziarno * 1103515245 + 12345;
+        r[i].lewaStrona = strony[i];
+        r[i].prawaStrona = L"";
+        r[i].flaga = (ziarno >> 16) % 4;
+        r[i].koszt = 1 + (ziarno >> 20) % 3;
+        assert_int_equal(regula_kompiluj(&r[i]), 1);
+        wskazniki[i] = &r[i];
+    }
+    struct reguly * indeks = reguly_zbuduj(wskazniki, LICZBA_REGUL);
+    for (int p = 0; p < 100; p++) {
+        wchar_t slowo[16];
+        ziarno = ziarno * 1103515245 + 12345;
+        int dlugosc = (ziarno >> 16) % 15;
+        for (int j = 0; j < dlugosc; j++) {
+            ziarno = ziarno * 1103515245 + 12345;
+            slowo[j] = L'a' + (ziarno >> 16) % 3;
+        }
+        slowo[dlugosc] = L'\0';
+        porownaj(wskazniki, LICZBA_REGUL, indeks, slowo);
+    }
+    reguly_done(indeks);
+    for (int i = 0; i < LICZBA_REGUL; i++)
+        regula_done(&r[i]);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(reguly_compile_test),
+        cmocka_unit_test(reguly_example_test),
+        cmocka_unit_test(reguly_random_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -3,74 +3,522 @@
   @ingroup dictionary
  */
 #include "trie.h"
+#include "arena.h"
 #include <assert.h>
 #include <string.h>
+#include <limits.h>
 #include <time.h>
 
+/** Czy etykiety synów są przeszukiwane instrukcjami wektorowymi (SSE2,
+    a przy kompilacji z -mavx2 także AVX2). */
+#if defined(__SSE2__) && __SIZEOF_WCHAR_T__ == 4
+#define TRIE_SIMD 1
+#else
+#define TRIE_SIMD 0
+#endif
+
+#if TRIE_SIMD
+#include <immintrin.h>
+#endif
+
 /** Maksymalna długość słowa.* */
 #define MAX_WORD_LENGTH 63
 
 /** Pomocnicza zmienna do rozpoznawania "pustych" słów. */
 static wchar_t * puste = L"";
 
+/**
+ * Korzeń drzewa razem z pulą pamięci, z której przydzielane są wszystkie
+ * wierzchołki i tablice synów drzewa. Korzeń jest pierwszym polem, więc
+ * wskaźnik na korzeń jest jednocześnie wskaźnikiem na całą strukturę.
+ */
+struct drzewo
+{
+  /** Korzeń drzewa. */
+  struct trie korzen;
+
+  /** Pula pamięci drzewa. */
+  struct arena pula;
+};
+
+/** Funkcja zwracająca pulę pamięci drzewa.
+ * @param[in] root Korzeń drzewa.
+ * @return Pula pamięci.
+ */
+static struct arena * pulaDrzewa(struct trie * root)
+{
+  return &((struct drzewo *) root)->pula;
+}
+
+/** Najdłuższa krawędź jednego wierzchołka; dłuższe końcówki słów
+    dzielone są na kilka wierzchołków. */
+#define MAKS_KRAWEDZ USHRT_MAX
+
+/** Funkcja obliczająca rozmiar wierzchołka razem z literami krawędzi.
+ * @param[in] krawedz Liczba liter krawędzi (co najmniej 1).
+ * @return Rozmiar w bajtach.
+ */
+static size_t rozmiarWezla(int krawedz)
+{
+  return sizeof(struct trie) + sizeof(wchar_t) * (krawedz - 1);
+}
+
 /** Alokowanie pamięci dla nowego wierzchołka.
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in] krawedz Liczba liter krawędzi wierzchołka.
  * @return Zaalokowana pamięć.
  */
-static struct trie * newNode()
+static struct trie * newNode(struct arena * pula, int krawedz)
 {
-  return malloc(sizeof(struct trie));
+  return arena_alloc(pula, rozmiarWezla(krawedz));
 }
 
-/** Pomocnicza funkcja powiekszajaca tablice synów wierzchołka.
- * 
- * @param[in] doPowiekszenia Wierzchołek, którego tablica synów jest powiększana.
- * @param[in] doWlozenia Etykieta dodwawanego wierzchołka.
- * @return Zmodyfikowany wierzchołek.
+/** Funkcja zwracająca do puli pamięć wierzchołka (bez bloku synów).
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in] node Wierzchołek.
+ */
+static void zwolnijWezel(struct arena * pula, struct trie * node)
+{
+  arena_free(pula, node, rozmiarWezla(node->krawedz));
+}
+
+/** Funkcja zwracająca modyfikowalne litery krawędzi za pierwszą.
+ * @param[in] node Wierzchołek.
+ * @return Tablica node->krawedz - 1 liter.
+ */
+static inline wchar_t * resztaKrawedzi(struct trie * node)
+{
+  return (wchar_t *) (node + 1);
+}
+
+/** Największa liczba synów wierzchołka TRIE_MALY. */
+#define MAKS_MALY 16
+
+/** Największa liczba synów wierzchołka TRIE_INDEKSOWANY. */
+#define MAKS_INDEKSOWANY 48
+
+/** Liczba synów, poniżej której wierzchołek TRIE_INDEKSOWANY wraca do
+    TRIE_MALY. Odstęp od MAKS_MALY chroni przed ciągłą zmianą rodzaju
+    przy naprzemiennym wstawianiu i usuwaniu. */
+#define MIN_INDEKSOWANY 12
+
+/** Liczba synów, poniżej której wierzchołek TRIE_PELNY wraca do
+    TRIE_INDEKSOWANY. */
+#define MIN_PELNY 40
+
+/** Największa rozpiętość etykiet synów obsługiwana przez gęstą tablicę. */
+#define MAX_ZAKRES_GESTEJ 512
+
+/** Największa rozpiętość etykiet synów wierzchołka TRIE_PELNY. */
+#define MAX_ZAKRES_PELNEGO 1024
+
+/** Liczba wskaźników bufora na stosie używanego przy przebudowie
+    wierzchołka. */
+#define BUFOR_SYNOW 64
+
+/**
+ * Gęsta tablica indeksów synów, trzymana w bloku synów za etykietami
+ * wierzchołków TRIE_INDEKSOWANY: indeks[c - od] to numer syna
+ * o etykiecie c powiększony o 1 albo 0, jeśli takiego syna nie ma.
+ */
+struct gesta
+{
+  /** Najmniejsza etykieta syna. */
+  wchar_t od;
+
+  /** Rozmiar tablicy indeksów. */
+  int rozmiar;
+
+  /** Tablica indeksów. */
+  unsigned char indeks[];
+};
+
+/** Funkcja zwracająca etykiety synów wierzchołka TRIE_MALY
+ * lub TRIE_INDEKSOWANY.
+ * @param[in] node Wierzchołek.
+ * @return Tablica node->iluSynow etykiet, w tej samej kolejności co synowie.
+ */
+static inline wchar_t * literySynow(const struct trie * node)
+{
+  if (node->dlugosc == 1)
+    return node->dzieci.jedyny != NULL ? &node->dzieci.jedyny->litera : NULL;
+  return (wchar_t *) (node->dzieci.synowie + node->dlugosc);
+}
+
+/** Funkcja zwracająca najmniejszą etykietę, od której zaczyna się tablica
+ * wierzchołka TRIE_PELNY. Etykieta trzymana jest tuż przed tablicą.
+ * @param[in] node Wierzchołek TRIE_PELNY.
+ * @return Etykieta odpowiadająca miejscu 0.
+ */
+static inline wchar_t poczatekPelnego(const struct trie * node)
+{
+  return *(const wchar_t *) (node->dzieci.synowie - 1);
+}
+
+/** Funkcja dobierająca rodzaj wierzchołka do jego synów.
+ * @param[in] typ Obecny rodzaj wierzchołka.
+ * @param[in] iluSynow Liczba synów.
+ * @param[in] pierwsza Najmniejsza etykieta syna.
+ * @param[in] ostatnia Największa etykieta syna.
+ * @return Nowy rodzaj wierzchołka.
+ */
+static int dobierzTyp(int typ, int iluSynow, wchar_t pierwsza, wchar_t ostatnia)
+{
+  bool miesciSie = iluSynow > 0 && ostatnia - pierwsza < MAX_ZAKRES_PELNEGO;
+  if (miesciSie && (iluSynow > MAKS_INDEKSOWANY ||
+    (typ == TRIE_PELNY && iluSynow >= MIN_PELNY)))
+    return TRIE_PELNY;
+  if (iluSynow > MAKS_MALY || (typ != TRIE_MALY && iluSynow >= MIN_INDEKSOWANY))
+    return TRIE_INDEKSOWANY;
+  return TRIE_MALY;
+}
+
+/** Funkcja obliczająca rozmiar gęstej tablicy wierzchołka.
+ * @param[in] typ Rodzaj wierzchołka.
+ * @param[in] iluSynow Liczba synów.
+ * @param[in] pierwsza Najmniejsza etykieta syna.
+ * @param[in] ostatnia Największa etykieta syna.
+ * @return Rozmiar gęstej tablicy albo 0, jeśli wierzchołek jej nie ma.
+ */
+static int zakresGestej(int typ, int iluSynow, wchar_t pierwsza, wchar_t ostatnia)
+{
+  if (typ != TRIE_INDEKSOWANY || iluSynow > UCHAR_MAX ||
+    ostatnia - pierwsza >= MAX_ZAKRES_GESTEJ)
+    return 0;
+  return ostatnia - pierwsza + 1;
+}
+
+/** Funkcja obliczająca rozmiar gęstej tablicy wierzchołka.
+ * @param[in] node Wierzchołek.
+ * @return Rozmiar gęstej tablicy albo 0, jeśli wierzchołek jej nie ma.
+ */
+static int zakresWezla(const struct trie * node)
+{
+  if (node->typ != TRIE_INDEKSOWANY)
+    return 0;
+  const wchar_t * litery = literySynow(node);
+  return zakresGestej(node->typ, node->iluSynow, litery[0], litery[node->iluSynow - 1]);
+}
+
+/** Funkcja zwracająca gęstą tablicę wierzchołka.
+ * @param[in] node Wierzchołek z gęstą tablicą.
+ * @return Gęsta tablica.
+ */
+static struct gesta * gestaTablica(const struct trie * node)
+{
+  /* Wyrównanie do 8 bajtów za etykietami. */
+  return (struct gesta *) (literySynow(node) + ((node->dlugosc + 1) & ~1));
+}
+
+/** Funkcja obliczająca rozmiar bloku synów.
+ * @param[in] typ Rodzaj wierzchołka.
+ * @param[in] dlugosc Pojemność bloku.
+ * @param[in] zakres Rozmiar gęstej tablicy (0 jeśli jej nie ma).
+ * @return Rozmiar bloku w bajtach (0 jeśli wierzchołek nie ma bloku).
+ */
+static size_t rozmiarBloku(int typ, int dlugosc, int zakres)
+{
+  if (dlugosc == 1)
+    return 0;
+  if (typ == TRIE_PELNY)
+    return sizeof(struct trie *) * (dlugosc + 1);
+  size_t rozmiar = dlugosc * sizeof(struct trie *) +
+    ((dlugosc + 1) & ~1) * sizeof(wchar_t);
+  if (zakres > 0)
+    rozmiar += sizeof(struct gesta) + zakres;
+  return rozmiar;
+}
+
+/** Funkcja zwracająca blok synów wierzchołka do puli.
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in] node Wierzchołek.
+ */
+static void zwolnijBlok(struct arena * pula, const struct trie * node)
+{
+  size_t rozmiar = rozmiarBloku(node->typ, node->dlugosc, zakresWezla(node));
+  if (rozmiar == 0)
+    return;
+  if (node->typ == TRIE_PELNY)
+    arena_free(pula, node->dzieci.synowie - 1, rozmiar);
+  else
+    arena_free(pula, node->dzieci.synowie, rozmiar);
+}
+
+/** Funkcja wypełniająca gęstą tablicę wierzchołka, jeśli ją ma.
+ * @param[in,out] node Wierzchołek.
+ */
+static void wypelnijGesta(struct trie * node)
+{
+  int zakres = zakresWezla(node);
+  if (zakres == 0)
+    return;
+  const wchar_t * litery = literySynow(node);
+  struct gesta * gesta = gestaTablica(node);
+  gesta->od = litery[0];
+  gesta->rozmiar = zakres;
+  memset(gesta->indeks, 0, zakres);
+  for (int i = 0; i < node->iluSynow; i++)
+    gesta->indeks[litery[i] - gesta->od] = i + 1;
+}
+
+/** Funkcja obliczająca pojemność bloku dla danej liczby synów.
+ * @param[in] iluSynow Liczba synów.
+ * @return Najmniejsza potęga dwójki nie mniejsza niż iluSynow (co najmniej 1).
+ */
+static int pojemnosc(int iluSynow)
+{
+  int dlugosc = 1;
+  while (dlugosc < iluSynow)
+    dlugosc *= 2;
+  return dlugosc;
+}
+
+/** Funkcja budująca od nowa blok synów wierzchołka, w rodzaju dobranym
+ * do nowego zestawu synów. Stary blok wraca do puli.
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in,out] node Wierzchołek.
+ * @param[in] synowie Nowi synowie, posortowani według etykiet.
+ * @param[in] iluSynow Liczba nowych synów.
+ * @param[in] dokladnie Czy blok ma mieć dokładnie iluSynow miejsc zamiast
+ * zapasu na kolejnych synów.
+ */
+static void przebuduj(struct arena * pula, struct trie * node,
+  struct trie * const * synowie, int iluSynow, bool dokladnie)
+{
+  wchar_t pierwsza = iluSynow ? synowie[0]->litera : 0;
+  wchar_t ostatnia = iluSynow ? synowie[iluSynow - 1]->litera : 0;
+  int typ = dobierzTyp(node->typ, iluSynow, pierwsza, ostatnia);
+  zwolnijBlok(pula, node);
+  node->typ = typ;
+  node->iluSynow = iluSynow;
+
+  if (typ == TRIE_PELNY)
+  {
+    int zakres = ostatnia - pierwsza + 1;
+    struct trie ** blok = arena_alloc(pula, rozmiarBloku(typ, zakres, 0));
+    *(wchar_t *) blok = pierwsza;
+    memset(blok + 1, 0, sizeof(struct trie *) * zakres);
+    for (int i = 0; i < iluSynow; i++)
+      blok[1 + synowie[i]->litera - pierwsza] = synowie[i];
+    node->dlugosc = zakres;
+    node->dzieci.synowie = blok + 1;
+    return;
+  }
+
+  node->dlugosc = dokladnie && iluSynow > 1 ? iluSynow : pojemnosc(iluSynow);
+  if (node->dlugosc == 1)
+  {
+    node->dzieci.jedyny = iluSynow ? synowie[0] : NULL;
+    return;
+  }
+  node->dzieci.synowie = arena_alloc(pula, rozmiarBloku(typ, node->dlugosc,
+    zakresGestej(typ, iluSynow, pierwsza, ostatnia)));
+  wchar_t * litery = literySynow(node);
+  for (int i = 0; i < iluSynow; i++)
+  {
+    node->dzieci.synowie[i] = synowie[i];
+    litery[i] = synowie[i]->litera;
+  }
+  wypelnijGesta(node);
+}
+
+/** Funkcja przebudowująca wierzchołek po wstawieniu lub usunięciu syna.
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in,out] node Wierzchołek.
+ * @param[in] nowy Wstawiany syn albo NULL.
+ * @param[in] usuwany Indeks usuwanego syna albo -1.
+ */
+static void przebudujZmieniony(struct arena * pula, struct trie * node,
+  struct trie * nowy, int usuwany)
+{
+  struct trie * bufor[BUFOR_SYNOW];
+  struct trie ** synowie = bufor;
+  if (node->iluSynow + 1 > BUFOR_SYNOW)
+    synowie = malloc(sizeof(struct trie *) * (node->iluSynow + 1));
+  int ile = 0;
+  for (int i = trie_nastepny_syn(node, -1); i != -1; i = trie_nastepny_syn(node, i))
+  {
+    struct trie * syn = trie_syn(node, i);
+    if (nowy != NULL && nowy->litera < syn->litera)
+    {
+      synowie[ile++] = nowy;
+      nowy = NULL;
+    }
+    if (i != usuwany)
+      synowie[ile++] = syn;
+  }
+  if (nowy != NULL)
+    synowie[ile++] = nowy;
+  przebuduj(pula, node, synowie, ile, false);
+  if (synowie != bufor)
+    free(synowie);
+}
+
+/** Pomocnicza funkcja wstawiająca syna do wierzchołka. Jeśli w bloku jest
+ * miejsce, a rodzaj wierzchołka i rozmiar gęstej tablicy się nie
+ * zmieniają, syn wstawiany jest w miejscu. W przeciwnym razie blok jest
+ * budowany od nowa (z podwojoną pojemnością albo w innym rodzaju).
+ *
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in,out] node Wierzchołek, do którego wstawiany jest syn.
+ * @param[in] syn Wstawiany syn.
+ */
+static void wstawSyna(struct arena * pula, struct trie * node, struct trie * syn)
+{
+  int iluSynow = node->iluSynow;
+  wchar_t doWlozenia = syn->litera;
+  if (node->typ == TRIE_PELNY)
+  {
+    unsigned miejsce = (unsigned) (doWlozenia - poczatekPelnego(node));
+    if (miejsce < (unsigned) node->dlugosc)
+    {
+      node->dzieci.synowie[miejsce] = syn;
+      node->iluSynow++;
+      return;
+    }
+    przebudujZmieniony(pula, node, syn, -1);
+    return;
+  }
+
+  wchar_t * litery = literySynow(node);
+  int i = iluSynow;
+  while (i > 0 && litery[i-1] > doWlozenia)
+    i--;
+  wchar_t pierwsza = i == 0 ? doWlozenia : litery[0];
+  wchar_t ostatnia = i == iluSynow ? doWlozenia : litery[iluSynow - 1];
+  int typ = dobierzTyp(node->typ, iluSynow + 1, pierwsza, ostatnia);
+  if (iluSynow < node->dlugosc && node->dlugosc > 1 && typ == node->typ &&
+    zakresWezla(node) == zakresGestej(typ, iluSynow + 1, pierwsza, ostatnia))
+  {
+    memmove(node->dzieci.synowie + i + 1, node->dzieci.synowie + i,
+      sizeof(struct trie *) * (iluSynow - i));
+    memmove(litery + i + 1, litery + i, sizeof(wchar_t) * (iluSynow - i));
+    node->dzieci.synowie[i] = syn;
+    litery[i] = doWlozenia;
+    node->iluSynow++;
+    wypelnijGesta(node);
+  }
+  else if (iluSynow == 0)
+  {
+    node->dzieci.jedyny = syn;
+    node->iluSynow = 1;
+  }
+  else
+    przebudujZmieniony(pula, node, syn, -1);
+}
+
+/** Pomocnicza funkcja usuwająca syna z wierzchołka.
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in,out] node Wierzchołek.
+ * @param[in] i Indeks usuwanego syna.
  */
-static struct trie * powiekszacz(struct trie * doPowiekszenia, wchar_t doWlozenia)
+static void usunSyna(struct arena * pula, struct trie * node, int i)
 {
-  struct trie ** synowie = doPowiekszenia->synowie;
-  int nowaDlugosc = doPowiekszenia->dlugosc;
-  if (doPowiekszenia->iluSynow == doPowiekszenia->dlugosc)
+  int iluSynow = node->iluSynow;
+  if (node->typ == TRIE_PELNY)
+  {
+    node->dzieci.synowie[i] = NULL;
+    node->iluSynow--;
+    if (iluSynow - 1 < MIN_PELNY)
+      przebudujZmieniony(pula, node, NULL, -1);
+    return;
+  }
+
+  if (iluSynow <= 2)
+  {
+    /* Zostaje co najwyżej jeden syn, trzymany w samym wierzchołku. */
+    przebudujZmieniony(pula, node, NULL, i);
+    return;
+  }
+  wchar_t * litery = literySynow(node);
+  wchar_t pierwsza = litery[i == 0];
+  wchar_t ostatnia = litery[iluSynow - 1 - (i == iluSynow - 1)];
+  int typ = dobierzTyp(node->typ, iluSynow - 1, pierwsza, ostatnia);
+  /* Blok zajęty w mniej niż ćwierci jest zmniejszany. */
+  if (typ == node->typ && 4 * (iluSynow - 1) > node->dlugosc &&
+    zakresWezla(node) == zakresGestej(typ, iluSynow - 1, pierwsza, ostatnia))
   {
-    nowaDlugosc += 2;
+    memmove(node->dzieci.synowie + i, node->dzieci.synowie + i + 1,
+      sizeof(struct trie *) * (iluSynow - i - 1));
+    memmove(litery + i, litery + i + 1, sizeof(wchar_t) * (iluSynow - i - 1));
+    node->iluSynow--;
+    wypelnijGesta(node);
   }
-  int iluSynow = doPowiekszenia->iluSynow;
-  struct trie ** nowiSynowie = NULL;
-  nowiSynowie = realloc(nowiSynowie, (sizeof(struct trie *) * nowaDlugosc));
+  else
+    przebudujZmieniony(pula, node, NULL, i);
+}
+
+/** Pomocnicza funkcja przeszukująca liniowo etykiety synów. Porównuje
+ * naraz 8 (AVX2) lub 4 (SSE2) etykiety, resztę sprawdza pojedynczo.
+ * @param[in] litery Etykiety synów.
+ * @param[in] iluSynow Liczba synów.
+ * @param[in] szukana Szukana etykieta.
+ * @return Indeks syna lub -1, jeśli go nie ma.
+ */
+static inline int szukajLiniowo(const wchar_t * litery, int iluSynow, wchar_t szukana)
+{
   int i = 0;
-  while (i < iluSynow && synowie[i]->litera < doWlozenia)
+#if TRIE_SIMD
+#ifdef __AVX2__
+  __m256i klucz8 = _mm256_set1_epi32(szukana);
+  for (; i + 8 <= iluSynow; i += 8)
   {
-    nowiSynowie[i] = synowie[i];
-    i++;
+    __m256i etykiety = _mm256_loadu_si256((const __m256i *) (litery + i));
+    int maska = _mm256_movemask_ps(_mm256_castsi256_ps(
+      _mm256_cmpeq_epi32(etykiety, klucz8)));
+    if (maska)
+      return i + __builtin_ctz(maska);
   }
-  nowiSynowie[i++] = NULL;
-  while (i <= iluSynow) {
-    nowiSynowie[i] = synowie[i-1];
-    i++;
+#endif
+  __m128i klucz = _mm_set1_epi32(szukana);
+  for (; i + 4 <= iluSynow; i += 4)
+  {
+    __m128i etykiety = _mm_loadu_si128((const __m128i *) (litery + i));
+    int maska = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(etykiety, klucz)));
+    if (maska)
+      return i + __builtin_ctz(maska);
   }
-  while (i < nowaDlugosc)
-    nowiSynowie[i++] = NULL;
-  free(synowie);
-  doPowiekszenia->dlugosc = nowaDlugosc;
-  doPowiekszenia->synowie = nowiSynowie;
-  return doPowiekszenia;
+#endif
+  for (; i < iluSynow; i++)
+    if (litery[i] == szukana)
+      return i;
+  return -1;
 }
 
-/** Pomocnicza funkcja wyszukująca indeks w tablicy synów, który odpowiada etykiecie,
-    za pomocą wyszukiwania binarnego.
+/** Pomocnicza funkcja wyszukująca indeks w tablicy synów, który odpowiada
+ * etykiecie. Sposób wyszukiwania zależy od rodzaju wierzchołka.
  * @param[in] node Wierzchołek, którego tablica synów jest przeszukiwana.
  * @param[in] doWlozenia Etykieta szukanego syna.
- * @return Numer indeksu jeśli taki istnieje. NULL w przeciwnym wypadku.
+ * @return Numer indeksu jeśli taki istnieje, -1 w przeciwnym wypadku.
  */
 static int indeksDoWlozenia (const struct trie * node, wchar_t doWlozenia)
 {
-  struct trie ** tablica = node->synowie;
+  if (node->typ == TRIE_PELNY)
+  {
+    unsigned miejsce = (unsigned) (doWlozenia - poczatekPelnego(node));
+    if (miejsce >= (unsigned) node->dlugosc || node->dzieci.synowie[miejsce] == NULL)
+      return -1;
+    return miejsce;
+  }
+  if (node->dlugosc == 1)
+    return node->iluSynow && node->dzieci.jedyny->litera == doWlozenia ? 0 : -1;
+  const wchar_t * tablica = literySynow(node);
+  int iluSynow = node->iluSynow;
+  if (node->typ == TRIE_MALY)
+    return szukajLiniowo(tablica, iluSynow, doWlozenia);
+  if (zakresWezla(node) > 0)
+  {
+    const struct gesta * gesta = gestaTablica(node);
+    unsigned przesuniecie = (unsigned) (doWlozenia - gesta->od);
+    if (przesuniecie >= (unsigned) gesta->rozmiar)
+      return -1;
+    return gesta->indeks[przesuniecie] - 1;
+  }
   int lewy = 0;
-  int prawy = node->iluSynow - 1;
+  int prawy = iluSynow - 1;
   while (lewy <= prawy){
     int srodek = (lewy + prawy) >> 1;
-    wchar_t obecnaLitera = tablica[srodek]->litera;
+    wchar_t obecnaLitera = tablica[srodek];
     if (obecnaLitera == doWlozenia)
       return srodek;
     else if (obecnaLitera > doWlozenia)
@@ -81,87 +529,227 @@ static int indeksDoWlozenia (const struct trie * node, wchar_t doWlozenia)
   return -1;
 }
 
+/** Pomocnicza funkcja porównująca litery krawędzi ze słowem. Porównuje
+ * naraz 8 (AVX2) lub 4 (SSE2) litery, resztę sprawdza pojedynczo.
+ * @param[in] a Pierwszy ciąg liter.
+ * @param[in] b Drugi ciąg liter.
+ * @param[in] n Liczba porównywanych liter.
+ * @return Indeks pierwszej różnej litery albo n, jeśli ciągi są równe.
+ */
+static inline int wspolnaDlugosc(const wchar_t * a, const wchar_t * b, int n)
+{
+  int i = 0;
+#if TRIE_SIMD
+#ifdef __AVX2__
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256i rowne = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (a + i)),
+      _mm256_loadu_si256((const __m256i *) (b + i)));
+    int maska = _mm256_movemask_ps(_mm256_castsi256_ps(rowne));
+    if (maska != 0xff)
+      return i + __builtin_ctz(~maska);
+  }
+#endif
+  for (; i + 4 <= n; i += 4)
+  {
+    __m128i rowne = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (a + i)),
+      _mm_loadu_si128((const __m128i *) (b + i)));
+    int maska = _mm_movemask_ps(_mm_castsi128_ps(rowne));
+    if (maska != 0xf)
+      return i + __builtin_ctz(~maska);
+  }
+#endif
+  for (; i < n; i++)
+    if (a[i] != b[i])
+      return i;
+  return n;
+}
+
+/** Funkcja obliczająca, ile liter krawędzi wierzchołka zgadza się ze
+ * słowem, którego pierwsza litera jest równa node->litera.
+ * @param[in] node Wierzchołek.
+ * @param[in] slowo Początek słowa.
+ * @param[in] dlugosc Liczba liter słowa.
+ * @return Liczba zgodnych liter (od 1 do node->krawedz).
+ */
+static inline int zgodneLitery(const struct trie * node, const wchar_t * slowo, int dlugosc)
+{
+  int krawedz = node->krawedz < dlugosc ? node->krawedz : dlugosc;
+  return 1 + wspolnaDlugosc(trie_reszta(node), slowo + 1, krawedz - 1);
+}
+
 bool finder (const wchar_t * slowoDoWlozenia, int rozmiarSlowa, int index, struct trie * root)
 {
   if (root == NULL)
     return false;
-  if (index == rozmiarSlowa)
+  while (index < rozmiarSlowa)
   {
-    return root->czySlowo;
+    int indeksPomocniczy = indeksDoWlozenia(root, slowoDoWlozenia[index]);
+    if (indeksPomocniczy == -1)
+      return false;
+    root = trie_syn(root, indeksPomocniczy);
+    if (root->krawedz > 1 && (root->krawedz > rozmiarSlowa - index ||
+      zgodneLitery(root, slowoDoWlozenia + index, rozmiarSlowa - index) < root->krawedz))
+      return false;
+    index += root->krawedz;
   }
-  int indeksPomocniczy = indeksDoWlozenia(root, slowoDoWlozenia[index]);
-  if (indeksPomocniczy == -1)
-    return false;
-  return finder(slowoDoWlozenia, rozmiarSlowa, index + 1, root->synowie[indeksPomocniczy]);
+  return root->czySlowo;
+}
+
+/** Funkcja ustawiająca pola nowego wierzchołka bez synów.
+ * @param[out] node Wierzchołek.
+ * @param[in] litera Etykieta wierzchołka.
+ * @param[in] ojciec Ojciec wierzchołka.
+ */
+static void zerujWezel(struct trie * node, wchar_t litera, struct trie * ojciec)
+{
+  node->litera = litera;
+  node->czySlowo = 0;
+  node->typ = TRIE_MALY;
+  node->krawedz = 1;
+  node->iluSynow = 0;
+  node->dlugosc = 1;
+  node->dzieci.jedyny = NULL;
+  node->ojciec = ojciec;
+}
+
+/** Funkcja tworząca wierzchołek bez synów o danej krawędzi.
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in] etykieta Litery krawędzi.
+ * @param[in] krawedz Liczba liter krawędzi (od 1 do MAKS_KRAWEDZ).
+ * @param[in] ojciec Ojciec wierzchołka.
+ * @return Nowy wierzchołek.
+ */
+static struct trie * nowyWezel(struct arena * pula, const wchar_t * etykieta,
+  int krawedz, struct trie * ojciec)
+{
+  struct trie * node = newNode(pula, krawedz);
+  zerujWezel(node, etykieta[0], ojciec);
+  node->krawedz = krawedz;
+  wmemcpy(resztaKrawedzi(node), etykieta + 1, krawedz - 1);
+  return node;
+}
+
+/** Funkcja przenosząca synów i znacznik słowa do innego wierzchołka.
+ * @param[in,out] node Wierzchołek przejmujący synów.
+ * @param[in] zrodlo Wierzchołek, którego synowie są przenoszeni.
+ */
+static void przejmijSynow(struct trie * node, const struct trie * zrodlo)
+{
+  node->czySlowo = zrodlo->czySlowo;
+  node->typ = zrodlo->typ;
+  node->iluSynow = zrodlo->iluSynow;
+  node->dlugosc = zrodlo->dlugosc;
+  node->dzieci = zrodlo->dzieci;
+  for (int i = trie_nastepny_syn(node, -1); i != -1; i = trie_nastepny_syn(node, i))
+    trie_syn(node, i)->ojciec = node;
 }
 
-/** Pomocnicza funkcja insert, operująca na wierzchołkach które nie są korzeniami.
+/** Funkcja podmieniająca syna o danym indeksie na wierzchołek o tej samej
+ * pierwszej literze.
+ * @param[in,out] node Ojciec.
+ * @param[in] i Indeks syna.
+ * @param[in] syn Nowy syn.
+ */
+static void podmienSyna(struct trie * node, int i, struct trie * syn)
+{
+  if (node->dlugosc == 1)
+    node->dzieci.jedyny = syn;
+  else
+    node->dzieci.synowie[i] = syn;
+}
+
+/** Funkcja dzieląca krawędź syna: powstaje wierzchołek z początkiem
+ * krawędzi, którego jedynym synem jest wierzchołek z jej resztą.
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in,out] node Ojciec dzielonego syna.
+ * @param[in] i Indeks syna.
+ * @param[in] ile Liczba liter zostających w górnym wierzchołku (mniejsza
+ * od długości krawędzi syna).
+ * @return Górny wierzchołek.
+ */
+static struct trie * podzielKrawedz(struct arena * pula, struct trie * node, int i, int ile)
+{
+  struct trie * syn = trie_syn(node, i);
+  struct trie * gorny = newNode(pula, ile);
+  zerujWezel(gorny, syn->litera, node);
+  gorny->krawedz = ile;
+  wmemcpy(resztaKrawedzi(gorny), trie_reszta(syn), ile - 1);
+  struct trie * dolny = nowyWezel(pula, trie_reszta(syn) + ile - 1,
+    syn->krawedz - ile, gorny);
+  przejmijSynow(dolny, syn);
+  gorny->dzieci.jedyny = dolny;
+  gorny->iluSynow = 1;
+  podmienSyna(node, i, gorny);
+  zwolnijWezel(pula, syn);
+  return gorny;
+}
+
+/** Funkcja scalająca wierzchołek, który nie kończy słowa i ma jednego syna,
+ * z tym synem w jeden wierzchołek o połączonej krawędzi.
+ * @param[in,out] pula Pula pamięci drzewa.
+ * @param[in,out] node Scalany wierzchołek (nie korzeń).
+ */
+static void scalZSynem(struct arena * pula, struct trie * node)
+{
+  struct trie * syn = trie_syn(node, trie_nastepny_syn(node, -1));
+  int krawedz = node->krawedz + syn->krawedz;
+  if (krawedz > MAKS_KRAWEDZ)
+    return;
+  struct trie * ojciec = node->ojciec;
+  struct trie * nowy = newNode(pula, krawedz);
+  zerujWezel(nowy, node->litera, ojciec);
+  nowy->krawedz = krawedz;
+  wchar_t * reszta = resztaKrawedzi(nowy);
+  wmemcpy(reszta, trie_reszta(node), node->krawedz - 1);
+  reszta[node->krawedz - 1] = syn->litera;
+  wmemcpy(reszta + node->krawedz, trie_reszta(syn), syn->krawedz - 1);
+  przejmijSynow(nowy, syn);
+  podmienSyna(ojciec, indeksDoWlozenia(ojciec, node->litera), nowy);
+  zwolnijWezel(pula, node);
+  zwolnijWezel(pula, syn);
+}
+
+/** Pomocnicza funkcja insert, wstawiająca końcówkę słowa pod dany wierzchołek.
  * 
+ * @param[in,out] pula Pula pamięci drzewa.
  * @param[in] slowoDoWlozenia Wkładane słowo.
  * @param[in] rozmiarSlowa Długość słowa.
- * @param[in] index Indeks wskazujący która litera słowa jest aktualnie przetwarzana.
- * @param[in] node Modyfikowane drzewo.
+ * @param[in] index Indeks pierwszej litery słowa wstawianej pod node.
+ * @param[in] node Wierzchołek, od którego zaczyna się wstawianie.
  * @param[in] forreal Zmienna decydująca czy słowo nie jest tylko częścią słowa,
  * które może być wrzucane za pomocą funkcji load.
- * @return Zmodyfikowane drzewo.
+ * @return Wierzchołek, w którym kończy się wstawione słowo.
  */
-static struct trie * insertPom (const wchar_t * slowoDoWlozenia,
+static struct trie * insertPom (struct arena * pula, const wchar_t * slowoDoWlozenia,
   int rozmiarSlowa, int index, struct trie * node, bool forreal)
 {
-  if (node == NULL && index < rozmiarSlowa)
+  while (index < rozmiarSlowa)
   {
-    node = newNode();
-    node->litera = slowoDoWlozenia[index++];
-    node->iluSynow = 0;
-    node->dlugosc = 0;
-    node->synowie = NULL;
-    node->czySlowo = 0;
-  }
-
-  if (index < rozmiarSlowa){
-    if(node->synowie == NULL)
+    int indeks = indeksDoWlozenia(node, slowoDoWlozenia[index]);
+    if (indeks == -1)
     {
-      node->synowie = malloc(sizeof(struct trie *));
-      node->iluSynow = 1;
-      node->dlugosc = 1;
-      node->synowie[0] = NULL;
-      node->synowie[0] = insertPom(slowoDoWlozenia, rozmiarSlowa, index, node->synowie[0], forreal);
-      node->synowie[0]->ojciec = node;
+      /* Reszta słowa staje się krawędzią nowego liścia. */
+      int ile = rozmiarSlowa - index < MAKS_KRAWEDZ ? rozmiarSlowa - index : MAKS_KRAWEDZ;
+      struct trie * syn = nowyWezel(pula, slowoDoWlozenia + index, ile, node);
+      wstawSyna(pula, node, syn);
+      node = syn;
+      index += ile;
+      continue;
     }
-    else
-    {
-      int indexPomocniczy = indeksDoWlozenia(node, slowoDoWlozenia[index]);
-      if (indexPomocniczy != -1)
-      {
-        node->synowie[indexPomocniczy] = insertPom (slowoDoWlozenia, rozmiarSlowa, \
-          index + 1, node->synowie[indexPomocniczy],forreal);
-        node->synowie[indexPomocniczy]->ojciec = node;
-      }
-      else
-      {
-        node = powiekszacz(node, slowoDoWlozenia[index]);
-        for (int i = 0; i <= node->iluSynow; i++)
-        {
-          if (node->synowie[i] == NULL)
-          {
-            node->synowie[i] = insertPom(slowoDoWlozenia, rozmiarSlowa, index, \
-              node->synowie[i],forreal);
-            node->synowie[i]->ojciec = node;
-            node->iluSynow++;
-            break;
-          }
-        }
-      }
-      }
-  }
-  if (index == rozmiarSlowa)
-  {
-    node->czySlowo = forreal;
+    struct trie * syn = trie_syn(node, indeks);
+    int zgodne = syn->krawedz == 1 ? 1 :
+      zgodneLitery(syn, slowoDoWlozenia + index, rozmiarSlowa - index);
+    if (zgodne < syn->krawedz)
+      syn = podzielKrawedz(pula, node, indeks, zgodne);
+    node = syn;
+    index += zgodne;
   }
+  node->czySlowo = forreal;
   return node;
 }
 
-/** Funkcja inicjalizująca korzeń drzewa.
+/** Funkcja inicjalizująca korzeń drzewa wraz z pulą pamięci drzewa.
  * 
  * @param[in] root Korzeń drzewa.
  * @return Zmodyfikowany korzeń.
@@ -170,45 +758,20 @@ static struct trie * rootInitalize(struct trie * root)
 {
   if (root == NULL)
   {
-    root = newNode();
-    root->litera = '\0';
-    root->czySlowo = 0;
-    root->iluSynow = 0;
-    root->dlugosc = 1;
-    root->synowie = malloc(sizeof(struct trie *));
-    root->synowie[0] = NULL;
-    root->ojciec = root;
+    struct drzewo * drzewo = malloc(sizeof(struct drzewo));
+    arena_init(&drzewo->pula);
+    root = &drzewo->korzen;
+    zerujWezel(root, '\0', root);
+    root->krawedz = 0;
   }
   return root;
 }
 
 struct trie * insert (const wchar_t * slowoDoWlozenia, int dlugoscSlowa, struct trie * root, bool forreal){
 
-  if (root == NULL);
-    root = rootInitalize(root);
-  int index = indeksDoWlozenia(root, slowoDoWlozenia[0]);
-
-  if (index != -1)
-  {
-    root->synowie[index] = insertPom(slowoDoWlozenia, dlugoscSlowa, 1,
-      root->synowie[index],forreal);
-    root->synowie[index]->ojciec = root;
-  }
-  else
-  {
-    root = powiekszacz(root, slowoDoWlozenia[0]);
-    for (int i = 0; i <= root->dlugosc; i++)
-    {
-      if (root->synowie[i] == NULL)
-      {
-        root->synowie[i] = insertPom(slowoDoWlozenia, dlugoscSlowa, 0,
-          root->synowie[i],forreal);
-        root->synowie[i]->ojciec = root;
-        root->iluSynow++;
-        break;
-      }
-    }
-  }
+  root = rootInitalize(root);
+  if (dlugoscSlowa > 0)
+    insertPom(pulaDrzewa(root), slowoDoWlozenia, dlugoscSlowa, 0, root, forreal);
   return root;
 }
 
@@ -216,161 +779,253 @@ void clean(struct trie * node)
 {
   if (node == NULL)
     return;
-  for (int i = 0; i < node->iluSynow; i++)
-  {
-    clean(node->synowie[i]);
-    node->synowie[i] = NULL;
-  }
-  if (node->synowie != NULL){
-    free(node->synowie);
-    node->synowie = NULL;
-  }
-  free(node);
-  node = NULL;
-}
-
-/** Funkcja porządkująca tablicę synów, wyrzuca NULL na koniec tablicy.
- * @param[in,out] root Modyfikowane drzewo.
- */
-static void skurcz(struct trie * root){
-  int i = 0;
-  while (i < root->iluSynow && root->synowie[i] !=NULL)
-  {
-    i++;
-  }
-  while (i < root->iluSynow)                                                
-  {
-    root->synowie[i] = root->synowie[i+1];
-    i++;
-  }
-  root->iluSynow--;
+  assert(node->litera == '\0');
+  struct drzewo * drzewo = (struct drzewo *) node;
+  arena_done(&drzewo->pula);
+  free(drzewo);
 }
 
 struct trie * delete (const wchar_t * slowoDoUsuniecia, int rozmiarSlowa,
   int index, struct trie * root2)
 {
   struct trie * root = root2;
+  struct arena * pula = pulaDrzewa(root2);
   while (index < rozmiarSlowa)
   {
     int indeksPomocniczy = indeksDoWlozenia(root, slowoDoUsuniecia[index]);
-    root = root->synowie[indeksPomocniczy];
-    index++;
+    root = trie_syn(root, indeksPomocniczy);
+    index += root->krawedz;
   }
-  
+
   root->czySlowo = 0;
-  if (!(root->iluSynow))
+  /* Usuwamy wierzchołki, które nie są już potrzebne żadnemu słowu. */
+  while (root->iluSynow == 0 && root != root2 && !(root->czySlowo))
   {
-    while (root->iluSynow < 2 && root->litera != '\0' && !(root->czySlowo))
-    {
-      struct trie * temp = root->ojciec;
-      if (root->synowie != NULL)
-      {
-        free(root->synowie);
-        root->synowie = NULL;
-      }
-      int hehe = indeksDoWlozenia(root->ojciec, root->litera);
-      root->ojciec->synowie[hehe] = NULL;
-      free(root);
-      root = temp;
-    }
-    if (root->litera == '\0' && root->iluSynow == 1)
-    {
-      clean(root);
-      return NULL;
-    }
-    else
-    {
-      skurcz(root);
-    }
+    struct trie * ojciec = root->ojciec;
+    usunSyna(pula, ojciec, indeksDoWlozenia(ojciec, root->litera));
+    zwolnijWezel(pula, root);
+    root = ojciec;
+  }
+  /* Wierzchołek, który został z jednym synem, łączy się z nim w jedną
+     krawędź. */
+  if (root != root2 && root->iluSynow == 1 && !(root->czySlowo))
+    scalZSynem(pula, root);
+  if (root2->iluSynow == 0)
+  {
+    clean(root2);
+    return NULL;
   }
   return root2;
 }
 
-void zapis(const struct trie *node, FILE * stream, int glebokosc)
+/** Funkcja zapewniająca w budowie miejsce na słowo danej długości.
+ * @param[in,out] budowa Budowa.
+ * @param[in] dlugosc Długość słowa.
+ */
+static void budowaZapewnij(struct trie_budowa * budowa, int dlugosc)
 {
-  if (node == NULL){
+  if (dlugosc < budowa->rozmiar)
     return;
+  int rozmiar = 2 * (dlugosc + 1);
+  budowa->slowo = realloc(budowa->slowo, sizeof(wchar_t) * rozmiar);
+  budowa->poziomy = realloc(budowa->poziomy, sizeof(struct trie_poziom) * rozmiar);
+  for (int i = budowa->rozmiar; i < rozmiar; i++)
+  {
+    budowa->poziomy[i].synowie = NULL;
+    budowa->poziomy[i].iluSynow = 0;
+    budowa->poziomy[i].rozmiar = 0;
+    budowa->poziomy[i].czySlowo = false;
   }
-  wchar_t literka = node->litera;
-  if (literka != '\0')
+  budowa->rozmiar = rozmiar;
+}
+
+/** Funkcja tworząca wierzchołek zamykanego poziomu i dopisująca go do
+ * synów poziomu, na którym zaczyna się jego krawędź. Krawędź dłuższa niż
+ * MAKS_KRAWEDZ dzielona jest tak samo jak w insertPom().
+ * @param[in,out] budowa Budowa.
+ * @param[in] od Poziom ojca, krawędź zaczyna się od litery slowo[od].
+ * @param[in] glebokosc Zamykany poziom.
+ */
+static void budowaUtworz(struct trie_budowa * budowa, int od, int glebokosc)
+{
+  struct arena * pula = pulaDrzewa(budowa->root);
+  struct trie_poziom * poziom = &budowa->poziomy[glebokosc];
+  int poczatek = od + (glebokosc - od - 1) / MAKS_KRAWEDZ * MAKS_KRAWEDZ;
+  struct trie * node = nowyWezel(pula, budowa->slowo + poczatek,
+    glebokosc - poczatek, NULL);
+  node->czySlowo = poziom->czySlowo;
+  przebuduj(pula, node, poziom->synowie, poziom->iluSynow, true);
+  for (int i = 0; i < poziom->iluSynow; i++)
+    poziom->synowie[i]->ojciec = node;
+  poziom->iluSynow = 0;
+  poziom->czySlowo = false;
+  while (poczatek > od)
   {
-    if (node->ojciec->iluSynow > 1)
-      fwprintf(stream, L"%d", glebokosc);
+    poczatek -= MAKS_KRAWEDZ;
+    struct trie * gorny = nowyWezel(pula, budowa->slowo + poczatek,
+      MAKS_KRAWEDZ, NULL);
+    przebuduj(pula, gorny, &node, 1, true);
+    node->ojciec = gorny;
+    node = gorny;
+  }
 
-    if (node->czySlowo)
+  poziom = &budowa->poziomy[od];
+  if (poziom->iluSynow == poziom->rozmiar)
+  {
+    poziom->rozmiar = poziom->rozmiar ? 2 * poziom->rozmiar : 4;
+    poziom->synowie = realloc(poziom->synowie,
+      sizeof(struct trie *) * poziom->rozmiar);
+  }
+  poziom->synowie[poziom->iluSynow++] = node;
+}
+
+/** Funkcja zamykająca poziomy poprzedniego słowa głębsze niż wspólny
+ * prefiks. Poziom, który nie jest słowem i ma tylko jednego syna, nie
+ * staje się wierzchołkiem, tylko przedłuża krawędź syna.
+ * @param[in,out] budowa Budowa.
+ * @param[in] wspolne Długość wspólnego prefiksu (mniejsza niż długość
+ * poprzedniego słowa).
+ */
+static void budowaZamknij(struct trie_budowa * budowa, int wspolne)
+{
+  int dolny = budowa->dlugosc;
+  for (int d = budowa->dlugosc - 1; d > wspolne; d--)
+  {
+    if (budowa->poziomy[d].czySlowo || budowa->poziomy[d].iluSynow > 0)
     {
-      fwprintf(stream, L"%lc", towupper(node->litera));
+      budowaUtworz(budowa, d, dolny);
+      dolny = d;
     }
-    else
-      fwprintf(stream, L"%lc", node->litera);
   }
-  for (int i = 0; i < node->iluSynow; i++){
-    zapis(node->synowie[i], stream, glebokosc+1);
+  budowaUtworz(budowa, wspolne, dolny);
+}
+
+void trie_budowa_init(struct trie_budowa * budowa)
+{
+  budowa->root = rootInitalize(NULL);
+  budowa->slowo = NULL;
+  budowa->dlugosc = 0;
+  budowa->rozmiar = 0;
+  budowa->poziomy = NULL;
+  budowaZapewnij(budowa, 0);
+}
+
+int trie_budowa_dodaj(struct trie_budowa * budowa, const wchar_t * slowo, int dlugosc)
+{
+  if (dlugosc == 0)
+    return 0;
+  int wspolne = wspolnaDlugosc(slowo, budowa->slowo,
+    dlugosc < budowa->dlugosc ? dlugosc : budowa->dlugosc);
+  if (wspolne == dlugosc)
+    return wspolne == budowa->dlugosc ? 0 : -1;
+  if (wspolne < budowa->dlugosc)
+  {
+    if (slowo[wspolne] < budowa->slowo[wspolne])
+      return -1;
+    budowaZamknij(budowa, wspolne);
   }
+  budowaZapewnij(budowa, dlugosc);
+  wmemcpy(budowa->slowo + wspolne, slowo + wspolne, dlugosc - wspolne);
+  budowa->poziomy[dlugosc].czySlowo = true;
+  budowa->dlugosc = dlugosc;
+  return 1;
 }
 
-/** Funkcja pobierająca słowo ze strumienia.
- * @param[in] stream Strumień wejściowy.
- * @return Wczytane słowo.
- */
-static wchar_t * wezSlowo(FILE * stream)
+struct trie * trie_budowa_koniec(struct trie_budowa * budowa)
 {
-  int rozmiar = 0;
-  wchar_t word[MAX_WORD_LENGTH];
-  wchar_t buff;
-  while ((buff = fgetwc(stream)) != EOF)
+  struct trie * root = budowa->root;
+  if (budowa->dlugosc > 0)
   {
-    if (!(iswalpha(buff))){
-      ungetwc(buff, stream);
-      break;
-    }
-    word[rozmiar] = buff;
-    rozmiar++;
-    if (iswupper(buff))
-      break;
+    budowaZamknij(budowa, 0);
+    struct trie_poziom * poziom = &budowa->poziomy[0];
+    przebuduj(pulaDrzewa(root), root, poziom->synowie, poziom->iluSynow, true);
+    for (int i = 0; i < poziom->iluSynow; i++)
+      poziom->synowie[i]->ojciec = root;
   }
-  wchar_t * prawdziwy = malloc(sizeof(wchar_t) * (rozmiar + 1));
-  for (int i = 0; i < rozmiar; i++)
+  else
   {
-    prawdziwy[i] = word[i];
+    clean(root);
+    root = NULL;
   }
-  prawdziwy[rozmiar] = L'\0';
-  return prawdziwy;
+  for (int i = 0; i < budowa->rozmiar; i++)
+    free(budowa->poziomy[i].synowie);
+  free(budowa->poziomy);
+  free(budowa->slowo);
+  budowa->root = NULL;
+  budowa->poziomy = NULL;
+  budowa->slowo = NULL;
+  budowa->dlugosc = budowa->rozmiar = 0;
+  return root;
 }
 
-/** Funkcja sprawdzająca czy dane słowo należy uznać za prawdziwe
-    i wstawić je do słownika.  
- * @param[in] slowo Sprawdzane słowo.
- * @return True, jeśli słowo zawiera dużą literę i przy wstawianiu do słownika
- * należy zaznaczyć, iż słowo jest słowem. False wpp.
+/** Funkcja zapisująca litery krawędzi wierzchołka. Jeśli wierzchołek
+ * kończy słowo, ostatnia litera zapisywana jest jako wielka.
+ * @param[in] node Wierzchołek.
+ * @param[in] stream Strumień do zapisu.
  */
-static bool isForreal(wchar_t * slowo)
+static void zapiszKrawedz(const struct trie * node, FILE * stream)
 {
-  int i = 0;
-  while (slowo[i] != '\0')
+  const wchar_t * reszta = trie_reszta(node);
+  for (int i = 0; i < node->krawedz; i++)
   {
-    if (iswupper(slowo[i]))
-      return true;
-    i++;
+    wchar_t litera = i == 0 ? node->litera : reszta[i - 1];
+    if (i == node->krawedz - 1 && node->czySlowo)
+      litera = towupper(litera);
+    fwprintf(stream, L"%lc", litera);
   }
-  return false;
 }
 
-/** Funkcja pomocnicza, wyszukuje gdzie w drzewie kończy się dane słowo.
- * @param[in] slowo Szukane słowo.
- * @param[in] rozmiarSlowa Długość słowa.
- * @param[in] index Aktualnie przetwarzana litera w słowie.
- * @param[in] root Słownik.
- * @return Wskaźnik do miejsca gdzie kończy się słowo w słowniku.
- */
-static struct trie * wskaznikoDo (wchar_t * slowo, int rozmiarSlowa, int index, struct trie * root)
+void zapis(const struct trie *node, FILE * stream, int glebokosc)
 {
-  if (index == rozmiarSlowa )
+  if (node == NULL){
+    return;
+  }
+  /* Format pliku opisuje drzewo litera po literze, niezależnie od podziału
+     na krawędzie: liczba przed literą to głębokość jej ojca w literach,
+     wypisywana tylko wtedy, gdy ojciec ma więcej niż jednego syna. */
+  if (node->litera != '\0')
+  {
+    if (node->ojciec->iluSynow > 1)
+      fwprintf(stream, L"%d", glebokosc);
+    zapiszKrawedz(node, stream);
+    glebokosc += node->krawedz - 1;
+  }
+  struct trie_kursor kursor;
+  trie_kursor_init(&kursor);
+  trie_kursor_ustaw(&kursor, node);
+  while (trie_kursor_nastepny(&kursor, true))
   {
-    return root;
+    const struct trie * wezel = trie_kursor_wezel(&kursor);
+    if (trie_kursor_ojciec(&kursor)->iluSynow > 1)
+      fwprintf(stream, L"%d",
+        glebokosc + 1 + trie_kursor_dlugosc(&kursor) - wezel->krawedz);
+    zapiszKrawedz(wezel, stream);
   }
-  int indeksPomocniczy = indeksDoWlozenia(root, slowo[index]);
-  return wskaznikoDo(slowo, rozmiarSlowa, index+1, root->synowie[indeksPomocniczy]);
+  trie_kursor_done(&kursor);
+}
+
+/** Sprawdza, czy znak jest literą, bez odwoływania się do lokalizacji
+ * dla znaków ASCII.
+ * @param[in] znak Sprawdzany znak.
+ * @return Czy znak jest literą.
+ */
+static inline bool czyLitera(wint_t znak)
+{
+  if (znak < 0x80)
+    return (znak | 0x20) >= L'a' && (znak | 0x20) <= L'z';
+  return znak != WEOF && iswalpha(znak);
+}
+
+/** Sprawdza, czy znak jest wielką literą, bez odwoływania się do
+ * lokalizacji dla znaków ASCII.
+ * @param[in] znak Sprawdzana litera.
+ * @return Czy litera jest wielka.
+ */
+static inline bool czyWielka(wint_t znak)
+{
+  if (znak < 0x80)
+    return znak >= L'A' && znak <= L'Z';
+  return iswupper(znak);
 }
 
 bool czyJest(int liczbaLiterPom, wchar_t * tablica, wchar_t doWlozenia)
@@ -433,282 +1088,197 @@ wchar_t * poprawAlfabet(int * rozmiar, int * liczbaLiter, wchar_t * tablica, wch
   return nowiSynowie;
 }
 
-struct trie * wczyt(FILE * stream, int * rozmiarAlfabetu, int * liczbaLiter, wchar_t ** alfabet)
+struct trie * wczyt(struct utf8_czytnik * czytnik, int * rozmiarAlfabetu,
+  int * liczbaLiter, wchar_t ** alfabet)
 {
   wchar_t * alfabetPom = *(alfabet);
   int liczbaLiterPom = *(liczbaLiter);
   struct trie * nowy = NULL;
   nowy = rootInitalize(nowy);
+  /* Plik opisuje drzewo litera po literze, więc odtwarzamy z niego
+     kolejne słowa i wstawiamy je do skompresowanego drzewa, zaczynając
+     od wierzchołka ostatnio wstawionego słowa albo jego przodka.
+     Fragment liter kończy się wielką literą (koniec słowa) albo liczbą
+     (głębokość, do której cofamy słowo). */
+  wchar_t * slowo = NULL;
+  int glebokosc = 0, rozmiarSlowa = 0;
   struct trie * pomocniczy = nowy;
-  int glebokosc = 0;
-  wchar_t buff = NULL;
-  while ((buff = fgetwc(stream)) != EOF)
+  int glebokoscPomocniczego = 0;
+  wint_t buff;
+  while ((buff = utf8_podejrzyj(czytnik)) != WEOF)
   {
-    if(!(iswdigit(buff)))
+    if (buff >= L'0' && buff <= L'9')
     {
-      ungetwc(buff,stream);
-      wchar_t * pom = wezSlowo(stream);
-      int dlugosc = wcslen(pom);
-      bool czySlowo = isForreal(pom);
-      pom[dlugosc-1] = towlower(pom[dlugosc-1]);
-      for (int i = 0; i < dlugosc; i++)
+      int pom = 0;
+      utf8_liczba(czytnik, &pom);
+      if (glebokosc > pom)
+        glebokosc = pom;
+      while (glebokoscPomocniczego > glebokosc)
       {
-        if (alfabetPom == NULL)
-        {
-          alfabetPom = malloc(sizeof(wchar_t));
-        }
-
-        if (!czyJest(liczbaLiterPom, alfabetPom, pom[i]))
-        {
-          alfabetPom = poprawAlfabet(rozmiarAlfabetu, liczbaLiter, alfabetPom, pom[i]);
-          liczbaLiterPom = *(liczbaLiter);
-        }
+        glebokoscPomocniczego -= pomocniczy->krawedz;
+        pomocniczy = pomocniczy->ojciec;
       }
-      if (pomocniczy->litera == '\0')
-        pomocniczy = insert(pom, dlugosc, pomocniczy, czySlowo);
-      else
-        pomocniczy = insertPom(pom, dlugosc, 0, pomocniczy, czySlowo);
-      pomocniczy = wskaznikoDo(pom, dlugosc, 0, pomocniczy);
-      glebokosc += dlugosc;
-      free(pom);
+      continue;
     }
-    else
+    if (!czyLitera(buff))
+      break;
+    bool czySlowo = false;
+    do
     {
-      ungetwc(buff, stream);
-      int pom = 0;
-      fwscanf(stream, L"%d", &pom);
-      while (glebokosc > pom)
+      utf8_wez(czytnik);
+      if (glebokosc == rozmiarSlowa)
       {
-        pomocniczy = pomocniczy->ojciec;
-        glebokosc--;
+        rozmiarSlowa = 2 * rozmiarSlowa + MAX_WORD_LENGTH;
+        slowo = realloc(slowo, sizeof(wchar_t) * rozmiarSlowa);
+      }
+      czySlowo = czyWielka(buff);
+      if (czySlowo)
+        buff = towlower(buff);
+      slowo[glebokosc++] = buff;
+      if (!czyJest(liczbaLiterPom, alfabetPom, buff))
+      {
+        if (alfabetPom == NULL)
+          alfabetPom = malloc(sizeof(wchar_t));
+        alfabetPom = poprawAlfabet(rozmiarAlfabetu, liczbaLiter, alfabetPom, buff);
+        liczbaLiterPom = *(liczbaLiter);
       }
+    } while (!czySlowo && czyLitera(buff = utf8_podejrzyj(czytnik)));
+    if (czySlowo)
+    {
+      pomocniczy = insertPom(pulaDrzewa(nowy), slowo, glebokosc,
+        glebokoscPomocniczego, pomocniczy, true);
+      glebokoscPomocniczego = glebokosc;
     }
   }
+  free(slowo);
   *(alfabet) = alfabetPom;
   return nowy;
 }
 
-/** Funkcja wstawiająca dane słowo do tablicy. 
- * @param[in,out] ileSlow Ilość słów w tablicy.
- * @param[in,out] tablica Tablica słów.
- * @param[in,out] rozmiar Rozmiar tablicy.
- * @param[in] slowo Wkładane słowo.
- * @param[in] dlugosc Długość słowa.
- * @return Zmodyfikowana tablica.
+/** Funkcja zapewniająca miejsce na stosie kursora na kolejny poziom.
+ * @param[in,out] kursor Kursor.
  */
-static wchar_t ** poprawTablice(int ileSlow, wchar_t ** tablica, int * rozmiar, wchar_t * slowo, int dlugosc)
+static void kursorZapewnij(struct trie_kursor * kursor)
 {
-  int nowaDlugosc = *(rozmiar);
-  wchar_t ** nowaTablica = tablica;
-  wchar_t * doWlozenia = malloc(sizeof(wchar_t) * (dlugosc + 2));
-  wcscpy(doWlozenia, slowo);
-  doWlozenia[dlugosc + 1] = '\0';
-  if (ileSlow < nowaDlugosc)
-  {
-    nowaTablica[ileSlow] = doWlozenia;
-    ileSlow++;
-  }
-  else
-  {
-    if (!nowaDlugosc)
-      nowaDlugosc++;    
-    nowaDlugosc *= 2;
-    nowaTablica = NULL;
-    nowaTablica = realloc(tablica, sizeof(wchar_t *) * nowaDlugosc);
-    nowaTablica[ileSlow] = doWlozenia;
-    ileSlow++;
-  }
-  *(rozmiar) = nowaDlugosc;
-  tablica = nowaTablica;
-  return tablica;
+  if (kursor->glebokosc + 2 <= kursor->rozmiar)
+    return;
+  kursor->rozmiar = kursor->rozmiar ? 2 * kursor->rozmiar : 32;
+  kursor->sciezka = realloc(kursor->sciezka, sizeof(struct trie_krok) * kursor->rozmiar);
 }
 
-/** Funkcja generująca podpowiedzi poprzez zamienienie jednej z liter na inną z alfabetu. 
- * @param[in] node Drzewo słownikowe.
- * @param[in] alfabet Alfabet liter.
- * @param[in] slowo Słowo do którego generowane są podpowiedzi.
- * @param[in] dlugoscAlfabetu Ilość liter w alfabecie.
- * @param[in,out] liczbaHintow Liczba podpowiedzi.
- * @param[in] dlugosc Rozmiar słowa.
- * @return Lista podpowiedzi.
+/** Funkcja zapewniająca miejsce w buforze słowa kursora.
+ * @param[in,out] kursor Kursor.
+ * @param[in] dlugosc Potrzebna liczba liter (razem ze znakiem '\0').
  */
-static wchar_t ** generowaniePrzezZamiane(struct trie * node, wchar_t * alfabet, wchar_t * slowo,
- int dlugoscAlfabetu, int * liczbaHintow, int dlugosc)
+static void kursorZapewnijSlowo(struct trie_kursor * kursor, int dlugosc)
 {
-
-  int ileSlow = 0;
-  int rozmiar = 0;
-  wchar_t ** wynik = NULL; //malloc(sizeof(wchar_t *));
-  for (int i = 0; i < dlugosc; i++)
-  {
-    wchar_t zmieniane = slowo[i];
-    for (int j = 0; j < dlugoscAlfabetu; j++)
-    {
-      // fwprintf(stderr, L"tu %lc %lc %d %d\n", slowo[i], alfabet[j], i, j);
-      slowo[i] = alfabet[j];
-      // fwprintf(stderr, L"tu\n");
-      if (finder(slowo, dlugosc, 0, node))
-      {
-        wynik = poprawTablice(ileSlow, wynik, &rozmiar, slowo, dlugosc);
-        ileSlow++;
-      }
-      slowo[i] = zmieniane;
-    }
-  }
-  for (int i = ileSlow; i < rozmiar; i++)
-    wynik[i] = NULL;
-  *(liczbaHintow) = ileSlow;  
-  return wynik;
-}
-
-/** Funkcja generująca podpowiedzi poprzez usniecie jednej z liter.
- * @param[in] node Drzewo słownikowe.
- * @param[in] slowo Słowo do którego generowane są podpowiedzi.
- * @param[in,out] liczbaHintow Liczba podpowiedzi.
- * @param[in] dlugosc Rozmiar słowa.
- * @return Lista podpowiedzi.
-*/
-static wchar_t ** generowaniePrzezUsuniecie(struct trie * node, wchar_t * slowo, int * liczbaHintow, int dlugosc)
-{
-  wchar_t ** wynik = NULL; //malloc(sizeof(wchar_t *));
-  int rozmiar = 0;
-  int ileSlow = 0;
-  wchar_t * pom = malloc(sizeof(wchar_t) * (dlugosc + 2));
-  for (int i = 0; i < dlugosc; i++)
-  {
-    int index = 0;
-    for (int j = 0; j < dlugosc; j++)
-    {
-      if (i == j)
-        continue;
-      pom[index++] = slowo[j];
-    }
-    pom[index] = '\0';
-    if (finder(pom, dlugosc - 1, 0, node))
-    {
-      //fwprintf(stderr, L"u slowo %ls\n", pom);
-      wynik = poprawTablice(ileSlow, wynik, &rozmiar, pom, dlugosc);
-      ileSlow++;
-    }
-  }
-
-  for (int i = ileSlow; i < rozmiar; i++)
-    wynik[i] = NULL;
-  *(liczbaHintow) = ileSlow;
-  free(pom);
-  return wynik;
-}
-/** Funkcja generująca podpowiedzi poprzez wstawienie jednej z liter z alfabetu. 
- * @param[in] node Drzewo słownikowe.
- * @param[in] alfabet Alfabet liter.
- * @param[in] slowo Słowo do którego generowane są podpowiedzi.
- * @param[in] dlugoscAlfabetu Ilość liter w alfabecie.
- * @param[in,out] liczbaHintow Liczba podpowiedzi.
- * @param[in] dlugosc Rozmiar słowa.
- * @return Lista podpowiedzi.
-*/
-static wchar_t ** generowaniePrzezWstawienie(struct trie * node, wchar_t * alfabet, wchar_t * slowo,
- int dlugoscAlfabetu, int * liczbaHintow, int dlugosc)
-{
-  int ileSlow = 0;
-  int rozmiar = 0;
-  wchar_t ** wynik = NULL; //malloc(sizeof(wchar_t *) );
-  wchar_t * pom = malloc(sizeof(wchar_t) * (dlugosc + 3));
-  for (int i = 1; i < dlugosc + 1; i++)
-  {
-    pom[i] = slowo[i-1];
-  }
-  pom[dlugosc+1] ='\0';
-  for (int i = 0; i < dlugosc + 1; i++)
-  {
-    for (int j = 0; j < dlugoscAlfabetu; j++)
-    {
-      pom[i] = alfabet[j];
-      // fwprintf(stderr, L"w slowo %ls\n", pom);
-      if (finder(pom, dlugosc + 1, 0, node))
-      {
-        // fwprintf(stderr, L"\tw slowo %ls\n", pom);
-        wynik = poprawTablice(ileSlow, wynik, &rozmiar, pom, dlugosc);
-        ileSlow++;
-      }
-    }
-    if (i < dlugosc)
-      pom[i] = pom [i+1];
-  }
-  for (int i = ileSlow; i < rozmiar; i++)
-    wynik[i] = NULL;
-
-
-  *(liczbaHintow) = ileSlow;
-  free(pom);
-  return wynik;
+  if (dlugosc <= kursor->rozmiarSlowa)
+    return;
+  while (kursor->rozmiarSlowa < dlugosc)
+    kursor->rozmiarSlowa = kursor->rozmiarSlowa ? 2 * kursor->rozmiarSlowa : 64;
+  kursor->slowo = realloc(kursor->slowo, sizeof(wchar_t) * kursor->rozmiarSlowa);
 }
 
-/** Funkcja łącząca trzy tablicę słów w jedną.
- * @param[in] list1 Pierwsza tablica
- * @param[in] list2 Druga tablica.
- * @param[in] list3 Trzecia tablica.
- * @param[in] rozmiar1 Rozmiar pierwszej tablicy.
- * @param[in] rozmiar2 Rozmiar drugiej tablicy.
- * @param[in] rozmiar3 Rozmiar trzeciej tablicy.
- * @return [description]
+/** Funkcja wstawiająca wierzchołek na wierzch stosu kursora.
+ * @param[in,out] kursor Kursor.
+ * @param[in] wezel Wierzchołek.
+ * @param[in] indeks Indeks wierzchołka w tablicy synów ojca.
+ * @param[in] glebokosc Głębokość, na której ma się znaleźć wierzchołek.
  */
-static wchar_t ** mergeLists (wchar_t ** list1, wchar_t ** list2, wchar_t ** list3, int rozmiar1, int rozmiar2, int rozmiar3)
+static void kursorUstawKrok(struct trie_kursor * kursor, const struct trie * wezel,
+  int indeks, int glebokosc)
 {
-  wchar_t ** result = malloc(sizeof(wchar_t *) * (rozmiar1 + rozmiar2 + rozmiar3 + 2));
-  for (int i = 0; i < rozmiar1; i++)
-  {
-    result[i] = list1[i];
-    // fwprintf(stderr, L"przepisuje zam %ls\n", list1[i]);
-  }
-  for (int i = 0; i < rozmiar2; i++)
-  {
-    result[rozmiar1 + i] = list2[i];
-    // fwprintf(stderr, L"przepisuje usu %ls\n", list2[i]);
-  }
-  for (int i = 0; i < rozmiar3; i++)
+  int dlugosc = glebokosc > 0 ? kursor->sciezka[glebokosc - 1].dlugosc : 0;
+  kursor->glebokosc = glebokosc;
+  kursor->sciezka[glebokosc].wezel = wezel;
+  kursor->sciezka[glebokosc].indeks = indeks;
+  if (glebokosc > 0)
   {
-    result[rozmiar1 + rozmiar2 + i] = list3[i];
-    // fwprintf(stderr, L"przepisuje wsr %ls\n", list3[i]);
+    kursorZapewnijSlowo(kursor, dlugosc + wezel->krawedz + 1);
+    kursor->slowo[dlugosc] = wezel->litera;
+    wmemcpy(kursor->slowo + dlugosc + 1, trie_reszta(wezel), wezel->krawedz - 1);
+    dlugosc += wezel->krawedz;
   }
-  return result;
+  else
+    kursorZapewnijSlowo(kursor, 1);
+  kursor->sciezka[glebokosc].dlugosc = dlugosc;
+  kursor->slowo[dlugosc] = L'\0';
 }
 
-wchar_t ** hints(struct trie * node, const wchar_t * slowo, wchar_t * alfabet, int liczbaLiter, int * liczbaHintow)
+struct trie * trie_syn_litery(const struct trie * node, wchar_t litera)
 {
-  wchar_t * pom = (wchar_t *) slowo;
-  wchar_t ** wynik;
-  wchar_t ** wynik1;
-  wchar_t ** wynik2;
-  wchar_t ** wynik3;
-  int dlugoscSlowa = wcslen(pom);
-  int ilosc1 = 0, ilosc2 = 0, ilosc3 = 0;
+  int indeks = indeksDoWlozenia(node, litera);
+  return indeks == -1 ? NULL : trie_syn(node, indeks);
+}
 
-  wynik1 = generowaniePrzezZamiane(node, alfabet, pom, liczbaLiter, liczbaHintow, dlugoscSlowa);
-  ilosc1 = *liczbaHintow;
+void trie_kursor_init(struct trie_kursor * kursor)
+{
+  kursor->sciezka = NULL;
+  kursor->slowo = NULL;
+  kursor->glebokosc = -1;
+  kursor->rozmiar = 0;
+  kursor->rozmiarSlowa = 0;
+}
 
-  wynik2 = generowaniePrzezUsuniecie(node, pom, liczbaHintow, dlugoscSlowa);
-  ilosc2 = *liczbaHintow;
+void trie_kursor_done(struct trie_kursor * kursor)
+{
+  free(kursor->sciezka);
+  free(kursor->slowo);
+  trie_kursor_init(kursor);
+}
 
-  wynik3 = generowaniePrzezWstawienie(node, alfabet, pom, liczbaLiter, liczbaHintow, dlugoscSlowa);
-  ilosc3 = *liczbaHintow;
+void trie_kursor_ustaw(struct trie_kursor * kursor, const struct trie * root)
+{
+  kursor->glebokosc = -1;
+  if (root == NULL)
+    return;
+  kursorZapewnij(kursor);
+  kursorUstawKrok(kursor, root, -1, 0);
+}
 
-  *liczbaHintow = ilosc1 + ilosc2 + ilosc3;
+bool trie_kursor_w_dol(struct trie_kursor * kursor, wchar_t litera)
+{
+  const struct trie * wezel = trie_kursor_wezel(kursor);
+  int indeks = indeksDoWlozenia(wezel, litera);
+  if (indeks == -1)
+    return false;
+  kursorZapewnij(kursor);
+  kursorUstawKrok(kursor, trie_syn(wezel, indeks), indeks, kursor->glebokosc + 1);
+  return true;
+}
+
+void trie_kursor_w_gore(struct trie_kursor * kursor)
+{
+  assert(kursor->glebokosc > 0);
+  kursor->glebokosc--;
+  kursor->slowo[trie_kursor_dlugosc(kursor)] = L'\0';
+}
 
-  if (*liczbaHintow == 0)
+bool trie_kursor_nastepny(struct trie_kursor * kursor, bool wejdz)
+{
+  if (kursor->glebokosc < 0)
+    return false;
+  const struct trie * wezel = trie_kursor_wezel(kursor);
+  if (wejdz && wezel->iluSynow > 0)
   {
-    return NULL;
+    kursorZapewnij(kursor);
+    int indeks = trie_nastepny_syn(wezel, -1);
+    kursorUstawKrok(kursor, trie_syn(wezel, indeks), indeks, kursor->glebokosc + 1);
+    return true;
   }
-
-  wynik = mergeLists(wynik1, wynik2, wynik3, ilosc1, ilosc2, ilosc3);
-
-  if (wynik1 != NULL)  
-    free(wynik1);
-  if (wynik2 != NULL)  
-    free(wynik2);
-  if (wynik3 != NULL)  
-    free(wynik3);
-  return wynik;
+  while (kursor->glebokosc > 0)
+  {
+    const struct trie * ojciec = kursor->sciezka[kursor->glebokosc - 1].wezel;
+    int indeks = trie_nastepny_syn(ojciec, kursor->sciezka[kursor->glebokosc].indeks);
+    if (indeks != -1)
+    {
+      kursorUstawKrok(kursor, trie_syn(ojciec, indeks), indeks, kursor->glebokosc);
+      return true;
+    }
+    kursor->glebokosc--;
+  }
+  kursor->glebokosc = -1;
+  return false;
 }
 
 static wchar_t * nextSuf(wchar_t * slowo)
@@ -734,8 +1304,9 @@ void pokazStany(wchar_t * suf, struct trie * node)
     int indeks = indeksDoWlozenia(node, suf[0]);
     if (indeks == -1)
       return;
-    node = node->synowie[indeks];
-    suf = nextSuf(suf);
+    node = trie_syn(node, indeks);
+    for (int i = 0; i < node->krawedz && wcscoll(suf, puste); i++)
+      suf = nextSuf(suf);
   }
   fwprintf(stderr, L"%lc literka\n", node->litera);
 }
\ No newline at end of file
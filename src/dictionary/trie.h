@@ -9,6 +9,7 @@
 #ifndef __TRIE_H__
 #define __TRIE_H__
 
+#include "utf8.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <wchar.h>
@@ -18,12 +19,33 @@
 
 
 /**
- * Drzewo używan do trzymania słów w słowniku.
+ * Rodzaje wierzchołków drzewa, dobierane do liczby synów. Wierzchołek
+ * zmienia rodzaj sam przy wstawianiu i usuwaniu synów.
+ */
+enum trie_typ
+{
+	/** Do 16 synów: posortowane etykiety przeszukiwane liniowo. Jedyny
+	    syn trzymany jest bezpośrednio w wierzchołku, bez osobnego bloku. */
+	TRIE_MALY,
+
+	/** Do 48 synów: posortowane etykiety i gęsta tablica indeksów. */
+	TRIE_INDEKSOWANY,
+
+	/** Więcej synów: tablica wskaźników indeksowana bezpośrednio etykietą. */
+	TRIE_PELNY
+};
+
+/**
+ * Drzewo używan do trzymania słów w słowniku. Drzewo jest skompresowane:
+ * krawędź prowadząca do wierzchołka może mieć etykietę złożoną z wielu
+ * liter, więc każdy wierzchołek poza korzeniem albo kończy słowo, albo ma
+ * co najmniej dwóch synów. Pierwsza litera krawędzi trzymana jest w polu
+ * litera, pozostałe tuż za strukturą wierzchołka (trie_reszta()).
  */
 struct trie
 {
 	/**
-		Etykieta wierzchołka, zawiera literę.
+		Etykieta wierzchołka, zawiera pierwszą literę krawędzi.
 	 */
  	wchar_t litera;
 
@@ -33,13 +55,25 @@ struct trie
  	 */
 	bool czySlowo;
 
+	/**
+	 * Rodzaj wierzchołka (enum trie_typ).
+	 */
+	unsigned char typ;
+
+	/**
+	 * Liczba liter na krawędzi prowadzącej do wierzchołka (0 dla korzenia).
+	 */
+	unsigned short krawedz;
+
 	/**
 	 * Zmienna opisująca liczbę dzieci wierzchołka.
 	 */
 	int iluSynow;
 
 	/**
-	 * Zmienna opisująca rozmiar tablicy dzieci wierzchołka.
+	 * Zmienna opisująca pojemność bloku dzieci wierzchołka (1, gdy jedyny
+	 * syn trzymany jest w wierzchołku, a dla TRIE_PELNY liczba miejsc
+	 * w tablicy).
 	 */
 	int dlugosc;
 
@@ -49,11 +83,198 @@ struct trie
 	struct trie * ojciec;
 
 	/**
-	 * Tablica dzieci wierzchołka.
+	 * Dzieci wierzchołka.
 	 */
-	struct trie ** synowie;
+	union trie_dzieci
+	{
+		/**
+		 * Blok dzieci: tablica wskaźników na dzieci posortowanych według
+		 * etykiet, a za nią tablica samych etykiet, żeby wyszukiwanie syna
+		 * nie musiało odwiedzać wierzchołków dzieci. Dla TRIE_PELNY
+		 * tablica wskaźników indeksowana etykietą (NULL tam, gdzie syna
+		 * nie ma).
+		 */
+		struct trie ** synowie;
+
+		/**
+		 * Jedyny syn (lub NULL), gdy dlugosc wynosi 1.
+		 */
+		struct trie * jedyny;
+	} dzieci;
+};
+
+/** Litery krawędzi wierzchołka następujące po node->litera.
+ * @param[in] node Wierzchołek.
+ * @return Tablica node->krawedz - 1 liter.
+ */
+static inline
+const wchar_t * trie_reszta(const struct trie * node)
+{
+	return (const wchar_t *) (node + 1);
+}
+
+/** Syn wierzchołka o danym indeksie.
+ * @param[in] node Wierzchołek.
+ * @param[in] i Indeks syna (dla TRIE_PELNY miejsce w tablicy).
+ * @return Syn (dla TRIE_PELNY może być NULL).
+ */
+static inline
+struct trie * trie_syn(const struct trie * node, int i)
+{
+	if (node->dlugosc == 1)
+		return node->dzieci.jedyny;
+	return node->dzieci.synowie[i];
+}
+
+/** Indeks następnego syna wierzchołka, w kolejności etykiet.
+ * @param[in] node Wierzchołek.
+ * @param[in] i Indeks bieżącego syna albo -1, żeby dostać pierwszego.
+ * @return Indeks następnego syna albo -1, jeśli go nie ma.
+ */
+static inline
+int trie_nastepny_syn(const struct trie * node, int i)
+{
+	if (node->typ != TRIE_PELNY)
+		return i + 1 < node->iluSynow ? i + 1 : -1;
+	for (i++; i < node->dlugosc; i++)
+		if (node->dzieci.synowie[i] != NULL)
+			return i;
+	return -1;
+}
+
+/** Syn wierzchołka, którego krawędź zaczyna się daną literą.
+ * @param[in] node Wierzchołek.
+ * @param[in] litera Pierwsza litera krawędzi.
+ * @return Syn albo NULL, jeśli go nie ma.
+ */
+struct trie * trie_syn_litery(const struct trie * node, wchar_t litera);
+
+/**
+ * Krok na ścieżce kursora.
+ */
+struct trie_krok
+{
+	/** Wierzchołek na ścieżce. */
+	const struct trie * wezel;
+
+	/** Indeks wierzchołka w tablicy synów ojca (-1 dla początku ścieżki). */
+	int indeks;
+
+	/** Liczba liter na ścieżce, razem z krawędzią wierzchołka. */
+	int dlugosc;
 };
 
+/**
+ * Kursor po drzewie TRIE: ścieżka od wierzchołka początkowego do bieżącego,
+ * trzymana na jawnym stosie zamiast na stosie wywołań. Stos i bufor słowa
+ * są zachowywane między kolejnymi użyciami kursora (trie_kursor_ustaw()),
+ * więc jeden kursor może obsłużyć wiele przejść bez ponownych alokacji.
+ */
+struct trie_kursor
+{
+	/** Stos kroków, sciezka[0] to wierzchołek początkowy. */
+	struct trie_krok * sciezka;
+
+	/** Litery na ścieżce zakończone znakiem '\0'. */
+	wchar_t * slowo;
+
+	/** Głębokość bieżącego wierzchołka, -1 jeśli kursor jest pusty. */
+	int glebokosc;
+
+	/** Rozmiar stosu. */
+	int rozmiar;
+
+	/** Rozmiar bufora słowa. */
+	int rozmiarSlowa;
+};
+
+/** Inicjalizacja pustego kursora.
+ * @param[out] kursor Kursor.
+ */
+void trie_kursor_init(struct trie_kursor * kursor);
+
+/** Zwolnienie pamięci kursora.
+ * @param[in,out] kursor Kursor.
+ */
+void trie_kursor_done(struct trie_kursor * kursor);
+
+/** Ustawienie kursora na danym wierzchołku (ścieżka zaczyna się od niego).
+ * @param[in,out] kursor Kursor.
+ * @param[in] root Wierzchołek początkowy (dla NULL kursor jest pusty).
+ */
+void trie_kursor_ustaw(struct trie_kursor * kursor, const struct trie * root);
+
+/** Przejście do syna, którego krawędź zaczyna się daną literą (kursor
+ * przechodzi całą krawędź).
+ * @param[in,out] kursor Kursor.
+ * @param[in] litera Pierwsza litera krawędzi syna.
+ * @return True jeśli syn istnieje, false wpp. (kursor się nie zmienia).
+ */
+bool trie_kursor_w_dol(struct trie_kursor * kursor, wchar_t litera);
+
+/** Powrót do ojca bieżącego wierzchołka.
+ * @param[in,out] kursor Kursor (głębokość musi być dodatnia).
+ */
+void trie_kursor_w_gore(struct trie_kursor * kursor);
+
+/** Przejście do następnego wierzchołka w porządku prefiksowym.
+ * @param[in,out] kursor Kursor.
+ * @param[in] wejdz Czy odwiedzać poddrzewo bieżącego wierzchołka;
+ * false pomija całe poddrzewo.
+ * @return True jeśli jest kolejny wierzchołek, false po zakończeniu przejścia.
+ */
+bool trie_kursor_nastepny(struct trie_kursor * kursor, bool wejdz);
+
+/** Bieżący wierzchołek kursora.
+ * @param[in] kursor Niepusty kursor.
+ * @return Bieżący wierzchołek.
+ */
+static inline
+const struct trie * trie_kursor_wezel(const struct trie_kursor * kursor)
+{
+	return kursor->sciezka[kursor->glebokosc].wezel;
+}
+
+/** Ojciec bieżącego wierzchołka kursora.
+ * @param[in] kursor Kursor o dodatniej głębokości.
+ * @return Ojciec bieżącego wierzchołka.
+ */
+static inline
+const struct trie * trie_kursor_ojciec(const struct trie_kursor * kursor)
+{
+	return kursor->sciezka[kursor->glebokosc - 1].wezel;
+}
+
+/** Głębokość bieżącego wierzchołka względem wierzchołka początkowego.
+ * @param[in] kursor Kursor.
+ * @return Głębokość.
+ */
+static inline
+int trie_kursor_glebokosc(const struct trie_kursor * kursor)
+{
+	return kursor->glebokosc;
+}
+
+/** Liczba liter na ścieżce od wierzchołka początkowego do bieżącego.
+ * @param[in] kursor Niepusty kursor.
+ * @return Długość słowa trie_kursor_slowo().
+ */
+static inline
+int trie_kursor_dlugosc(const struct trie_kursor * kursor)
+{
+	return kursor->sciezka[kursor->glebokosc].dlugosc;
+}
+
+/** Litery na ścieżce od wierzchołka początkowego do bieżącego.
+ * @param[in] kursor Niepusty kursor.
+ * @return Słowo zakończone znakiem '\0'.
+ */
+static inline
+const wchar_t * trie_kursor_slowo(const struct trie_kursor * kursor)
+{
+	return kursor->slowo;
+}
+
 
 /** Funkcja sprawdzajaca czy dane slowo wystepuje w słowniku.
  * 
@@ -93,6 +314,71 @@ void clean(struct trie * node);
 struct trie * delete (const wchar_t * slowoDoUsuniecia, int rozmiarSlowa,
   int index, struct trie * root2);
 
+/**
+ * Poziom otwartej ścieżki budowy drzewa: wierzchołek odpowiadający
+ * prefiksowi poprzedniego słowa o danej długości.
+ */
+struct trie_poziom
+{
+	/** Gotowi synowie, posortowani według etykiet. */
+	struct trie ** synowie;
+
+	/** Liczba gotowych synów. */
+	int iluSynow;
+
+	/** Rozmiar tablicy synów. */
+	int rozmiar;
+
+	/** Czy prefiks jest słowem. */
+	bool czySlowo;
+};
+
+/**
+ * Budowa drzewa z posortowanych słów w jednym przejściu. Dla kolejnego
+ * słowa zamykane są wierzchołki poprzedniego słowa głębsze niż ich wspólny
+ * prefiks: od razu dostają ostateczną krawędź i blok synów dokładnie
+ * takiej wielkości, ilu mają synów, więc drzewo nie jest później
+ * przebudowywane.
+ */
+struct trie_budowa
+{
+	/** Korzeń budowanego drzewa. */
+	struct trie * root;
+
+	/** Poprzednie słowo. */
+	wchar_t * slowo;
+
+	/** Długość poprzedniego słowa. */
+	int dlugosc;
+
+	/** Rozmiar bufora słowa i tablicy poziomów. */
+	int rozmiar;
+
+	/** Poziomy otwartej ścieżki, poziomy[d] odpowiada prefiksowi długości d. */
+	struct trie_poziom * poziomy;
+};
+
+/** Rozpoczęcie budowy pustego drzewa.
+ * @param[out] budowa Budowa.
+ */
+void trie_budowa_init(struct trie_budowa * budowa);
+
+/** Dodanie kolejnego słowa. Słowa muszą przychodzić rosnąco w porządku
+ * wcscmp().
+ * @param[in,out] budowa Budowa.
+ * @param[in] slowo Dodawane słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @return 1 jeśli słowo dodano, 0 jeśli jest równe poprzedniemu lub puste,
+ * -1 jeśli jest mniejsze od poprzedniego (słowo nie jest dodawane).
+ */
+int trie_budowa_dodaj(struct trie_budowa * budowa, const wchar_t * slowo, int dlugosc);
+
+/** Zakończenie budowy. Zwalnia pamięć pomocniczą budowy.
+ * @param[in,out] budowa Budowa.
+ * @return Zbudowane drzewo (NULL jeśli nie dodano żadnego słowa).
+ */
+struct trie * trie_budowa_koniec(struct trie_budowa * budowa);
+
 /** Funkcja zapisująca drzewo do pliku.
  * @param[in] node Zapisywane drzewo.
  * @param[in] stream Strumień do zapisu.
@@ -102,13 +388,14 @@ void zapis(const struct trie *node, FILE * stream, int glebokosc);
 
 /** Funkcja wczytująca drzewo z pliku.
  * 
- * @param[in] stream Strumień do wczytywania.
+ * @param[in,out] czytnik Czytnik strumienia, z którego wczytywane jest drzewo.
  * @param[in,out] rozmiarAlfabetu Rozmiar alfabetu aktualnie użytych liter.
  * @param[in,out] liczbaLiter Liczba liter w alfabecie.
  * @param[in,out] alfabet Zbiór liter do tej pory wczytanych.
  * @return Wczytane drzewo.
  */
-struct trie * wczyt(FILE * stream, int * rozmiarAlfabetu, int * liczbaLiter, wchar_t ** alfabet);
+struct trie * wczyt(struct utf8_czytnik * czytnik, int * rozmiarAlfabetu,
+  int * liczbaLiter, wchar_t ** alfabet);
 
 /** Funkcja sprawdzająca czy dana litera jest w alfabecie. 
  * @param[in] liczbaLiterPom Liczba liter w alfabecie.
@@ -127,16 +414,6 @@ bool czyJest(int liczbaLiterPom, wchar_t * tablica, wchar_t doWlozenia);
  */
 wchar_t * poprawAlfabet(int * rozmiarAlfabetu, int * liczbaLiter, wchar_t * tablica, wchar_t doWlozenia);
 
-/** Funkcja zwracająca listę podpowiedzi.
- * @param[in] node Drzewo słownikowe.
- * @param[in] slowo Sprawdzane słowo.
- * @param[in] alfabet Alfabet pomocniczy.
- * @param[in] liczbaLiter Liczba liter w alfabecie.
- * @param[in,out] liczbaHintow Liczba podpowiedzi.
- * @return Lista podpowiedzi.
- */
-wchar_t ** hints(struct trie * node, const wchar_t * slowo, wchar_t * alfabet, int liczbaLiter, int * liczbaHintow);
-
 /**
  * @brief sad
  * @details adsfaf
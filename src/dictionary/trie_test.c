@@ -61,6 +61,209 @@ static void trie_delete_all_test(void ** state){
   assert_true(t == NULL);
 }
 
+static void trie_cursor_walk_test(void** state) {
+    struct trie * t = * state;
+    struct trie_kursor k;
+    trie_kursor_init(&k);
+    trie_kursor_ustaw(&k, t);
+    int words = 0;
+    const wchar_t * expected[] = { first, second, third };
+    while (trie_kursor_nastepny(&k, true))
+    {
+        if (trie_kursor_wezel(&k)->czySlowo)
+        {
+            assert_true(wcscmp(trie_kursor_slowo(&k), expected[words]) == 0);
+            words++;
+        }
+    }
+    assert_int_equal(words, 3);
+    trie_kursor_done(&k);
+}
+
+static void trie_cursor_descend_test(void** state) {
+    struct trie * t = * state;
+    struct trie_kursor k;
+    trie_kursor_init(&k);
+    trie_kursor_ustaw(&k, t);
+    /* krawędź "Second string" przechodzona jest w całości */
+    assert_true(trie_kursor_w_dol(&k, L'S'));
+    assert_false(trie_kursor_w_dol(&k, L'x'));
+    assert_int_equal(trie_kursor_glebokosc(&k), 1);
+    assert_true(wcscmp(trie_kursor_slowo(&k), second) == 0);
+    trie_kursor_w_gore(&k);
+    assert_true(wcscmp(trie_kursor_slowo(&k), L"") == 0);
+    assert_true(trie_kursor_w_dol(&k, L'S'));
+    /* pominięcie poddrzewa "S" przechodzi do "T" */
+    assert_true(trie_kursor_nastepny(&k, false));
+    assert_true(wcscmp(trie_kursor_slowo(&k), third) == 0);
+    trie_kursor_done(&k);
+}
+
+static int trie_count_nodes(struct trie * t) {
+    struct trie_kursor k;
+    int nodes = 0;
+    trie_kursor_init(&k);
+    trie_kursor_ustaw(&k, t);
+    while (trie_kursor_nastepny(&k, true))
+        nodes++;
+    trie_kursor_done(&k);
+    return nodes;
+}
+
+static void trie_path_compression_test(void** state) {
+    const wchar_t * words[] = { L"kotami", L"kot", L"kota", L"koty", L"pies" };
+    struct trie * t = NULL;
+    for (int i = 0; i < 5; i++)
+        t = insert(words[i], wcslen(words[i]), t, 1);
+    /* kot, a, mi, y, pies */
+    assert_int_equal(trie_count_nodes(t), 5);
+    assert_false(finder(L"ko", 2, 0, t));
+    assert_false(finder(L"kotam", 5, 0, t));
+    assert_false(finder(L"kotamix", 7, 0, t));
+    assert_false(finder(L"piesek", 6, 0, t));
+    for (int i = 0; i < 5; i++)
+        assert_true(finder(words[i], wcslen(words[i]), 0, t));
+
+    /* "kota" przestaje być słowem: krawędzie "a" i "mi" się łączą */
+    t = delete(L"kota", 4, 0, t);
+    assert_int_equal(trie_count_nodes(t), 4);
+    assert_false(finder(L"kota", 4, 0, t));
+    assert_true(finder(L"kotami", 6, 0, t));
+    t = delete(L"koty", 4, 0, t);
+    t = delete(L"kot", 3, 0, t);
+    assert_int_equal(trie_count_nodes(t), 2);
+    assert_true(finder(L"kotami", 6, 0, t));
+    assert_true(finder(L"pies", 4, 0, t));
+    clean(t);
+}
+
+static void trie_node_types_test(void** state) {
+	wchar_t slowo[3] = L"x";
+	/* "x" jest słowem, więc zostaje osobnym wierzchołkiem */
+	struct trie * t = insert(slowo, 1, NULL, 1);
+	for (int i = 0; i < 60; i++) {
+		slowo[1] = L'a' + i;
+		t = insert(slowo, 2, t, 1);
+		const struct trie * x = trie_syn(t, 0);
+		assert_int_equal(x->iluSynow, i + 1);
+		assert_int_equal(x->typ, i < 16 ? TRIE_MALY : i < 48 ? TRIE_INDEKSOWANY : TRIE_PELNY);
+	}
+	for (int i = 59; i > 0; i--) {
+		slowo[1] = L'a' + i;
+		t = delete(slowo, 2, 0, t);
+		const struct trie * x = trie_syn(t, 0);
+		assert_int_equal(x->iluSynow, i);
+		assert_int_equal(x->typ, i >= 40 ? TRIE_PELNY : i >= 12 ? TRIE_INDEKSOWANY : TRIE_MALY);
+	}
+	slowo[1] = L'a';
+	assert_true(finder(slowo, 2, 0, t));
+	clean(t);
+}
+
+static void trie_wide_node_test(void** state) {
+	/* Dużo synów jednego wierzchołka: najpierw blisko siebie (gęsta
+	   tablica), potem daleko (wyszukiwanie binarne). */
+	wchar_t slowo[3] = L"x";
+	struct trie * t = NULL;
+	for (int i = 0; i < 300; i++) {
+		slowo[1] = i < 100 ? L'a' + i : 0x1000 + 7 * i;
+		t = insert(slowo, 2, t, 1);
+	}
+	for (int i = 0; i < 300; i += 2) {
+		slowo[1] = i < 100 ? L'a' + i : 0x1000 + 7 * i;
+		t = delete(slowo, 2, 0, t);
+	}
+	for (int i = 0; i < 300; i++) {
+		slowo[1] = i < 100 ? L'a' + i : 0x1000 + 7 * i;
+		assert_int_equal(finder(slowo, 2, 0, t), i % 2);
+	}
+	slowo[1] = L'a' + 200;
+	assert_false(finder(slowo, 2, 0, t));
+	for (int i = 1; i < 300; i += 2) {
+		slowo[1] = i < 100 ? L'a' + i : 0x1000 + 7 * i;
+		t = delete(slowo, 2, 0, t);
+	}
+	assert_null(t);
+}
+
+static void trie_assert_same(const struct trie * a, const struct trie * b) {
+    struct trie_kursor ka, kb;
+    trie_kursor_init(&ka);
+    trie_kursor_init(&kb);
+    trie_kursor_ustaw(&ka, a);
+    trie_kursor_ustaw(&kb, b);
+    bool dalej;
+    while ((dalej = trie_kursor_nastepny(&ka, true))) {
+        assert_true(trie_kursor_nastepny(&kb, true));
+        const struct trie * x = trie_kursor_wezel(&ka);
+        const struct trie * y = trie_kursor_wezel(&kb);
+        assert_true(wcscmp(trie_kursor_slowo(&ka), trie_kursor_slowo(&kb)) == 0);
+        assert_int_equal(x->krawedz, y->krawedz);
+        assert_int_equal(x->czySlowo, y->czySlowo);
+        assert_int_equal(x->iluSynow, y->iluSynow);
+        assert_int_equal(x->typ, y->typ);
+        assert_ptr_equal(y->ojciec, trie_kursor_ojciec(&kb));
+        /* bloki synów zbudowanego drzewa nie mają zapasu */
+        if (y->typ != TRIE_PELNY && y->iluSynow > 1)
+            assert_int_equal(y->dlugosc, y->iluSynow);
+    }
+    assert_false(trie_kursor_nastepny(&kb, true));
+    trie_kursor_done(&ka);
+    trie_kursor_done(&kb);
+}
+
+static int trie_compare_words(const void * a, const void * b) {
+    return wcscmp(*(wchar_t * const *) a, *(wchar_t * const *) b);
+}
+
+static void trie_build_sorted_test(void** state) {
+    /* słowa o wspólnych prefiksach, jeden wierzchołek z wieloma synami
+       i słowa będące prefiksami innych */
+    enum { ILE = 700 };
+    wchar_t * words[ILE];
+    for (int i = 0; i < ILE; i++) {
+        words[i] = malloc(sizeof(wchar_t) * 8);
+        if (i < 200)
+            swprintf(words[i], 8, L"x%lc", (wchar_t) (L'a' + i));
+        else
+            swprintf(words[i], 8, L"%lc%lc%lc", (wchar_t) (L'a' + i % 5),
+                (wchar_t) (L'a' + i / 5 % 7), (wchar_t) (L'a' + i % 11));
+    }
+    qsort(words, ILE, sizeof(wchar_t *), trie_compare_words);
+
+    struct trie * t = NULL;
+    struct trie_budowa budowa;
+    trie_budowa_init(&budowa);
+    for (int i = 0; i < ILE; i++) {
+        int duplikat = i > 0 && wcscmp(words[i], words[i - 1]) == 0;
+        t = insert(words[i], wcslen(words[i]), t, 1);
+        assert_int_equal(trie_budowa_dodaj(&budowa, words[i], wcslen(words[i])),
+            !duplikat);
+    }
+    assert_int_equal(trie_budowa_dodaj(&budowa, L"a", 1), -1);
+    assert_int_equal(trie_budowa_dodaj(&budowa, L"", 0), 0);
+    struct trie * z = trie_budowa_koniec(&budowa);
+    trie_assert_same(t, z);
+    for (int i = 0; i < ILE; i++)
+        assert_true(finder(words[i], wcslen(words[i]), 0, z));
+    assert_false(finder(L"x", 1, 0, z));
+
+    /* zbudowane drzewo można dalej zmieniać */
+    z = insert(L"xaa", 3, z, 1);
+    z = delete(L"xb", 2, 0, z);
+    assert_true(finder(L"xaa", 3, 0, z));
+    assert_false(finder(L"xb", 2, 0, z));
+    assert_true(finder(L"xa", 2, 0, z));
+
+    clean(t);
+    clean(z);
+    for (int i = 0; i < ILE; i++)
+        free(words[i]);
+
+    trie_budowa_init(&budowa);
+    assert_null(trie_budowa_koniec(&budowa));
+}
+
 static int trie_setup(void **state) {
     struct trie *t = NULL;
     t = insert(first, wcslen(first), t, 1);
@@ -84,7 +287,13 @@ int main(void) {
         cmocka_unit_test(trie_delete_test),
         cmocka_unit_test(trie_clean_test),
         cmocka_unit_test(trie_delete_all_test),
+        cmocka_unit_test(trie_wide_node_test),
+        cmocka_unit_test(trie_node_types_test),
         cmocka_unit_test_setup_teardown(trie_add_many_test, trie_setup, trie_teardown),             
+        cmocka_unit_test_setup_teardown(trie_cursor_walk_test, trie_setup, trie_teardown),
+        cmocka_unit_test_setup_teardown(trie_cursor_descend_test, trie_setup, trie_teardown),
+        cmocka_unit_test(trie_path_compression_test),
+        cmocka_unit_test(trie_build_sorted_test),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,495 @@
+/** @file
+  Implementacja indeksu usunięć.
+
+  @ingroup dictionary
+ */
+
+#include "usuniecia.h"
+#include "bloom.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Najmniejszy rozmiar tablicy skrótów. */
+#define MINIMALNY_ROZMIAR 64
+
+/**
+  Nagłówek zapisu indeksu (usuniecia_zapisz()). Za nim leżą kolejno: tekst,
+  położenia, długości słów i tablica skrótów, każda część wyrównana
+  do 8 bajtów.
+  */
+struct zapis_usuniec
+{
+  /** Największa liczba usuwanych liter. */
+  uint32_t odleglosc;
+
+  /** Liczba numerów słów. */
+  uint32_t liczbaSlow;
+
+  /** Liczba liter tekstu. */
+  uint64_t dlugoscTekstu;
+
+  /** Rozmiar tablicy skrótów. */
+  uint64_t rozmiarTablicy;
+
+  /** Liczba zajętych wpisów. */
+  uint64_t liczbaWpisow;
+};
+
+/**
+  Rosnąca tablica liczb.
+  */
+struct liczby
+{
+  /** Liczby. */
+  uint32_t * tablica;
+
+  /** Liczba liczb. */
+  size_t liczba;
+
+  /** Liczba liczb, na które jest miejsce. */
+  size_t rozmiar;
+};
+
+/** Dopisanie liczby na koniec tablicy.
+ * @param[in,out] l Tablica.
+ * @param[in] x Liczba.
+ */
+static void dopisz(struct liczby * l, uint32_t x)
+{
+  if (l->liczba == l->rozmiar)
+  {
+    l->rozmiar = l->rozmiar ? 2 * l->rozmiar : 64;
+    l->tablica = realloc(l->tablica, sizeof(uint32_t) * l->rozmiar);
+  }
+  l->tablica[l->liczba++] = x;
+}
+
+/** Komparator liczb.
+ * @param[in] a Pierwsza liczba.
+ * @param[in] b Druga liczba.
+ * @return Liczba ujemna, zero lub dodatnia.
+ */
+static int cmpLiczb(const void * a, const void * b)
+{
+  uint32_t x = *(const uint32_t *) a, y = *(const uint32_t *) b;
+  return x < y ? -1 : x > y;
+}
+
+/** Posortowanie tablicy i usunięcie powtórzeń.
+ * @param[in,out] l Tablica.
+ */
+static void bezPowtorzen(struct liczby * l)
+{
+  if (l->liczba == 0)
+    return;
+  qsort(l->tablica, l->liczba, sizeof(uint32_t), cmpLiczb);
+  size_t ile = 1;
+  for (size_t i = 1; i < l->liczba; i++)
+    if (l->tablica[i] != l->tablica[ile - 1])
+      l->tablica[ile++] = l->tablica[i];
+  l->liczba = ile;
+}
+
+/** Maska bitów wpisu z liczbą usuniętych liter. */
+#define MASKA_LICZBY ((1u << USUNIECIA_BITY_LICZBY) - 1)
+
+/** Skrót wariantu słowa razem z liczbą usuniętych liter.
+ * @param[in] slowo Wariant.
+ * @param[in] dlugosc Długość wariantu.
+ * @param[in] usuniete Liczba liter usuniętych ze słowa.
+ * @return Skrót.
+ */
+static inline uint32_t skrot(const wchar_t * slowo, int dlugosc, int usuniete)
+{
+  return ((uint32_t) (bloom_skrot(slowo, dlugosc) >> 32) & ~MASKA_LICZBY) | usuniete;
+}
+
+/** Miejsce tablicy skrótów, od którego szukany jest wpis. Wszystkie wpisy
+ * jednego wariantu mają to samo miejsce, niezależnie od liczby usuniętych
+ * liter.
+ * @param[in] skrot Skrót wpisu.
+ * @param[in] maska Rozmiar tablicy pomniejszony o 1.
+ * @return Miejsce.
+ */
+static inline uint64_t miejsce(uint32_t skrot, uint64_t maska)
+{
+  return (skrot >> USUNIECIA_BITY_LICZBY) & maska;
+}
+
+/** Dopisanie skrótów słowa i wszystkich słów powstających z niego przez
+ * usunięcie co najwyżej zostalo liter z pozycji od dalszych. Słowo jest
+ * zmieniane w trakcie i odtwarzane na końcu.
+ * @param[in,out] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] od Pierwsza pozycja, z której można usunąć literę.
+ * @param[in] usuniete Liczba liter usuniętych już z pierwotnego słowa.
+ * @param[in] zostalo Liczba liter, które można jeszcze usunąć.
+ * @param[in,out] skroty Skróty.
+ */
+static void warianty(wchar_t * slowo, int dlugosc, int od, int usuniete,
+  int zostalo, struct liczby * skroty)
+{
+  dopisz(skroty, skrot(slowo, dlugosc, usuniete));
+  if (zostalo == 0)
+    return;
+  for (int i = od; i < dlugosc; i++)
+  {
+    /* Usunięcie drugiej z dwóch takich samych liter daje to samo słowo. */
+    if (i > od && slowo[i] == slowo[i - 1])
+      continue;
+    wchar_t litera = slowo[i];
+    wmemmove(slowo + i, slowo + i + 1, dlugosc - i - 1);
+    warianty(slowo, dlugosc - 1, i, usuniete + 1, zostalo - 1, skroty);
+    wmemmove(slowo + i + 1, slowo + i, dlugosc - i - 1);
+    slowo[i] = litera;
+  }
+}
+
+/** Różne skróty wariantów słowa.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @param[in] odleglosc Największa liczba usuwanych liter.
+ * @param[out] skroty Skróty bez powtórzeń, do zwolnienia.
+ */
+static void skrotyWariantow(const wchar_t * slowo, int dlugosc, int odleglosc,
+  struct liczby * skroty)
+{
+  wchar_t * kopia = malloc(sizeof(wchar_t) * (dlugosc + 1));
+  wmemcpy(kopia, slowo, dlugosc);
+  skroty->tablica = NULL;
+  skroty->liczba = skroty->rozmiar = 0;
+  warianty(kopia, dlugosc, 0, 0, odleglosc, skroty);
+  free(kopia);
+  bezPowtorzen(skroty);
+}
+
+/** Wstawienie wpisu do tablicy skrótów, w której jest wolne miejsce.
+ * @param[in,out] indeks Indeks.
+ * @param[in] wpis Wpis.
+ */
+static void wstawWpis(struct usuniecia * indeks, struct usuniecia_wpis wpis)
+{
+  uint64_t maska = indeks->rozmiarTablicy - 1;
+  uint64_t i = miejsce(wpis.skrot, maska);
+  while (indeks->wpisy[i].slowo != USUNIECIA_PUSTY)
+    i = (i + 1) & maska;
+  indeks->wpisy[i] = wpis;
+  indeks->liczbaWpisow++;
+}
+
+/** Powiększenie tablicy skrótów tak, żeby po dopisaniu kolejnych wpisów
+ * była zajęta najwyżej w trzech czwartych.
+ * @param[in,out] indeks Indeks.
+ * @param[in] dodawane Liczba dopisywanych wpisów.
+ */
+static void zapewnijMiejsce(struct usuniecia * indeks, uint64_t dodawane)
+{
+  uint64_t rozmiar = indeks->rozmiarTablicy;
+  while ((indeks->liczbaWpisow + dodawane) * 4 > rozmiar * 3)
+    rozmiar *= 2;
+  if (rozmiar == indeks->rozmiarTablicy)
+    return;
+  struct usuniecia_wpis * stare = indeks->wpisy;
+  uint64_t staryRozmiar = indeks->rozmiarTablicy;
+  indeks->wpisy = malloc(sizeof(struct usuniecia_wpis) * rozmiar);
+  memset(indeks->wpisy, 0xff, sizeof(struct usuniecia_wpis) * rozmiar);
+  indeks->rozmiarTablicy = rozmiar;
+  indeks->liczbaWpisow = 0;
+  for (uint64_t i = 0; i < staryRozmiar; i++)
+    if (stare[i].slowo != USUNIECIA_PUSTY)
+      wstawWpis(indeks, stare[i]);
+  free(stare);
+}
+
+/** Usunięcie wpisu z tablicy skrótów. Wpisy za nim przesuwane są wstecz,
+ * żeby żaden nie został oddzielony od swojego miejsca wolnym miejscem.
+ * @param[in,out] indeks Indeks.
+ * @param[in] wpis Wpis, który jest w tablicy.
+ */
+static void usunWpis(struct usuniecia * indeks, struct usuniecia_wpis wpis)
+{
+  struct usuniecia_wpis * wpisy = indeks->wpisy;
+  uint64_t maska = indeks->rozmiarTablicy - 1;
+  uint64_t i = miejsce(wpis.skrot, maska);
+  while (wpisy[i].skrot != wpis.skrot || wpisy[i].slowo != wpis.slowo)
+    i = (i + 1) & maska;
+  for (uint64_t j = (i + 1) & maska; wpisy[j].slowo != USUNIECIA_PUSTY;
+    j = (j + 1) & maska)
+  {
+    /* Wpis z j zostaje, jeśli jego miejsce leży cyklicznie w (i, j]. */
+    if (((j - miejsce(wpisy[j].skrot, maska)) & maska) < ((j - i) & maska))
+      continue;
+    wpisy[i] = wpisy[j];
+    i = j;
+  }
+  wpisy[i].slowo = USUNIECIA_PUSTY;
+  indeks->liczbaWpisow--;
+}
+
+/** Skopiowanie do własnej pamięci indeksu leżącego w cudzej, przed jego
+ * zmianą.
+ * @param[in,out] indeks Indeks.
+ */
+static void wlasnaPamiec(struct usuniecia * indeks)
+{
+  if (!indeks->zewnetrzna)
+    return;
+  wchar_t * tekst = malloc(sizeof(wchar_t) * (indeks->dlugoscTekstu + 1));
+  wmemcpy(tekst, indeks->tekst, indeks->dlugoscTekstu);
+  uint64_t * polozenia = malloc(sizeof(uint64_t) * (indeks->liczbaSlow + 1));
+  memcpy(polozenia, indeks->polozenia, sizeof(uint64_t) * indeks->liczbaSlow);
+  int32_t * dlugosci = malloc(sizeof(int32_t) * (indeks->liczbaSlow + 1));
+  memcpy(dlugosci, indeks->dlugosci, sizeof(int32_t) * indeks->liczbaSlow);
+  struct usuniecia_wpis * wpisy = malloc(sizeof(struct usuniecia_wpis) *
+    indeks->rozmiarTablicy);
+  memcpy(wpisy, indeks->wpisy, sizeof(struct usuniecia_wpis) * indeks->rozmiarTablicy);
+  indeks->tekst = tekst;
+  indeks->rozmiarTekstu = indeks->dlugoscTekstu + 1;
+  indeks->polozenia = polozenia;
+  indeks->dlugosci = dlugosci;
+  indeks->rozmiarSlow = indeks->liczbaSlow + 1;
+  indeks->wpisy = wpisy;
+  indeks->zewnetrzna = false;
+}
+
+/** Numer słowa w indeksie.
+ * @param[in] indeks Indeks.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @return Numer słowa albo USUNIECIA_PUSTY, jeśli go nie ma.
+ */
+static uint32_t numerSlowa(const struct usuniecia * indeks, const wchar_t * slowo,
+  int dlugosc)
+{
+  uint32_t s = skrot(slowo, dlugosc, 0);
+  uint64_t maska = indeks->rozmiarTablicy - 1;
+  for (uint64_t i = miejsce(s, maska); indeks->wpisy[i].slowo != USUNIECIA_PUSTY;
+    i = (i + 1) & maska)
+  {
+    uint32_t numer = indeks->wpisy[i].slowo;
+    if (indeks->wpisy[i].skrot == s && indeks->dlugosci[numer] == dlugosc &&
+      !wmemcmp(indeks->tekst + indeks->polozenia[numer], slowo, dlugosc))
+      return numer;
+  }
+  return USUNIECIA_PUSTY;
+}
+
+struct usuniecia * usuniecia_nowe(int odleglosc)
+{
+  struct usuniecia * indeks = calloc(1, sizeof(struct usuniecia));
+  indeks->odleglosc = odleglosc;
+  indeks->rozmiarTablicy = MINIMALNY_ROZMIAR;
+  indeks->wpisy = malloc(sizeof(struct usuniecia_wpis) * MINIMALNY_ROZMIAR);
+  memset(indeks->wpisy, 0xff, sizeof(struct usuniecia_wpis) * MINIMALNY_ROZMIAR);
+  return indeks;
+}
+
+void usuniecia_done(struct usuniecia * indeks)
+{
+  if (indeks == NULL)
+    return;
+  if (!indeks->zewnetrzna)
+  {
+    free(indeks->tekst);
+    free(indeks->polozenia);
+    free(indeks->dlugosci);
+    free(indeks->wpisy);
+  }
+  free(indeks);
+}
+
+void usuniecia_dodaj(struct usuniecia * indeks, const wchar_t * slowo, int dlugosc)
+{
+  wlasnaPamiec(indeks);
+  if (indeks->liczbaSlow == indeks->rozmiarSlow)
+  {
+    indeks->rozmiarSlow = indeks->rozmiarSlow ? 2 * indeks->rozmiarSlow : 64;
+    indeks->polozenia = realloc(indeks->polozenia, sizeof(uint64_t) * indeks->rozmiarSlow);
+    indeks->dlugosci = realloc(indeks->dlugosci, sizeof(int32_t) * indeks->rozmiarSlow);
+  }
+  if (indeks->dlugoscTekstu + dlugosc + 1 > indeks->rozmiarTekstu)
+  {
+    while (indeks->dlugoscTekstu + dlugosc + 1 > indeks->rozmiarTekstu)
+      indeks->rozmiarTekstu = indeks->rozmiarTekstu ? 2 * indeks->rozmiarTekstu : 1024;
+    indeks->tekst = realloc(indeks->tekst, sizeof(wchar_t) * indeks->rozmiarTekstu);
+  }
+  uint32_t numer = indeks->liczbaSlow++;
+  indeks->polozenia[numer] = indeks->dlugoscTekstu;
+  indeks->dlugosci[numer] = dlugosc;
+  wmemcpy(indeks->tekst + indeks->dlugoscTekstu, slowo, dlugosc);
+  indeks->tekst[indeks->dlugoscTekstu + dlugosc] = L'\0';
+  indeks->dlugoscTekstu += dlugosc + 1;
+
+  struct liczby skroty;
+  skrotyWariantow(slowo, dlugosc, indeks->odleglosc, &skroty);
+  zapewnijMiejsce(indeks, skroty.liczba);
+  for (size_t i = 0; i < skroty.liczba; i++)
+    wstawWpis(indeks, (struct usuniecia_wpis) { skroty.tablica[i], numer });
+  free(skroty.tablica);
+}
+
+bool usuniecia_usun(struct usuniecia * indeks, const wchar_t * slowo, int dlugosc)
+{
+  uint32_t numer = numerSlowa(indeks, slowo, dlugosc);
+  if (numer == USUNIECIA_PUSTY)
+    return false;
+  wlasnaPamiec(indeks);
+  struct liczby skroty;
+  skrotyWariantow(slowo, dlugosc, indeks->odleglosc, &skroty);
+  for (size_t i = 0; i < skroty.liczba; i++)
+    usunWpis(indeks, (struct usuniecia_wpis) { skroty.tablica[i], numer });
+  free(skroty.tablica);
+  /* Litery słowa zostają w tekście, numer nie jest używany ponownie. */
+  indeks->dlugosci[numer] = -1;
+  return true;
+}
+
+void usuniecia_szukaj(const struct usuniecia * indeks, const wchar_t * wzorzec,
+  int dlugosc, int maksOdleglosc, bool przestawienia, levenshtein_wynik funkcja,
+  void * dane)
+{
+  if (maksOdleglosc < 0 || maksOdleglosc > indeks->odleglosc || dlugosc < 0)
+    return;
+  struct liczby skroty, kandydaci = { NULL, 0, 0 };
+  skrotyWariantow(wzorzec, dlugosc, maksOdleglosc, &skroty);
+  uint64_t maska = indeks->rozmiarTablicy - 1;
+  for (size_t k = 0; k < skroty.liczba; k++)
+  {
+    /* Słowo, z którego usunięto więcej niż maksOdleglosc liter, nie może
+       pasować, niezależnie od liczby liter usuniętych z wzorca. */
+    uint32_t s = skroty.tablica[k] & ~MASKA_LICZBY;
+    for (uint64_t i = miejsce(s, maska); indeks->wpisy[i].slowo != USUNIECIA_PUSTY;
+      i = (i + 1) & maska)
+      if ((indeks->wpisy[i].skrot & ~MASKA_LICZBY) == s &&
+        (int) (indeks->wpisy[i].skrot & MASKA_LICZBY) <= maksOdleglosc)
+        dopisz(&kandydaci, indeks->wpisy[i].slowo);
+  }
+  free(skroty.tablica);
+  /* Słowo pasuje zwykle przez wiele wariantów naraz. */
+  bezPowtorzen(&kandydaci);
+  for (size_t k = 0; k < kandydaci.liczba; k++)
+  {
+    uint32_t numer = kandydaci.tablica[k];
+    int dlugoscSlowa = indeks->dlugosci[numer];
+    const wchar_t * slowo = indeks->tekst + indeks->polozenia[numer];
+    int d = levenshtein_odleglosc(wzorzec, dlugosc, slowo, dlugoscSlowa,
+      maksOdleglosc, przestawienia);
+    if (d > maksOdleglosc)
+      continue;
+    int granica = funkcja(slowo, dlugoscSlowa, d, dane);
+    if (granica < maksOdleglosc)
+      maksOdleglosc = granica;
+  }
+  free(kandydaci.tablica);
+}
+
+size_t usuniecia_rozmiar(const struct usuniecia * indeks)
+{
+  return sizeof(struct usuniecia) + sizeof(wchar_t) * indeks->rozmiarTekstu +
+    (sizeof(uint64_t) + sizeof(int32_t)) * indeks->rozmiarSlow +
+    sizeof(struct usuniecia_wpis) * indeks->rozmiarTablicy;
+}
+
+/** Rozmiar części zapisu wyrównany do 8 bajtów.
+ * @param[in] rozmiar Rozmiar w bajtach.
+ * @return Rozmiar wyrównany w górę do wielokrotności 8.
+ */
+static inline uint64_t wyrownany(uint64_t rozmiar)
+{
+  return (rozmiar + 7) & ~(uint64_t) 7;
+}
+
+/** Zapis części indeksu z dopełnieniem do 8 bajtów.
+ * @param[in] dane Dane.
+ * @param[in] rozmiar Rozmiar danych w bajtach.
+ * @param[in] stream Strumień.
+ * @return True jeśli zapis się powiódł, false wpp.
+ */
+static bool zapiszCzesc(const void * dane, uint64_t rozmiar, FILE * stream)
+{
+  static const char zera[8];
+  uint64_t uzupelnienie = wyrownany(rozmiar) - rozmiar;
+  return fwrite(dane, 1, rozmiar, stream) == rozmiar &&
+    fwrite(zera, 1, uzupelnienie, stream) == uzupelnienie;
+}
+
+uint64_t usuniecia_rozmiar_zapisu(const struct usuniecia * indeks)
+{
+  return sizeof(struct zapis_usuniec) +
+    wyrownany(sizeof(wchar_t) * indeks->dlugoscTekstu) +
+    sizeof(uint64_t) * indeks->liczbaSlow +
+    wyrownany(sizeof(int32_t) * indeks->liczbaSlow) +
+    sizeof(struct usuniecia_wpis) * indeks->rozmiarTablicy;
+}
+
+bool usuniecia_zapisz(const struct usuniecia * indeks, FILE * stream)
+{
+  struct zapis_usuniec naglowek = { indeks->odleglosc, indeks->liczbaSlow,
+    indeks->dlugoscTekstu, indeks->rozmiarTablicy, indeks->liczbaWpisow };
+  return fwrite(&naglowek, sizeof(naglowek), 1, stream) == 1 &&
+    zapiszCzesc(indeks->tekst, sizeof(wchar_t) * indeks->dlugoscTekstu, stream) &&
+    zapiszCzesc(indeks->polozenia, sizeof(uint64_t) * indeks->liczbaSlow, stream) &&
+    zapiszCzesc(indeks->dlugosci, sizeof(int32_t) * indeks->liczbaSlow, stream) &&
+    zapiszCzesc(indeks->wpisy, sizeof(struct usuniecia_wpis) * indeks->rozmiarTablicy,
+      stream);
+}
+
+struct usuniecia * usuniecia_widok(const void * dane, size_t rozmiar)
+{
+  const struct zapis_usuniec * naglowek = dane;
+  if (rozmiar < sizeof(struct zapis_usuniec))
+    return NULL;
+  uint64_t tablica = naglowek->rozmiarTablicy;
+  /* Ograniczenia wykluczają przepełnienie przy liczeniu rozmiarów części. */
+  if (naglowek->odleglosc < 1 || naglowek->odleglosc > LEVENSHTEIN_MAKS_ODLEGLOSC ||
+    tablica < MINIMALNY_ROZMIAR || (tablica & (tablica - 1)) != 0 ||
+    tablica > rozmiar || naglowek->liczbaWpisow >= tablica ||
+    naglowek->dlugoscTekstu > rozmiar)
+    return NULL;
+  uint64_t tekst = wyrownany(sizeof(wchar_t) * naglowek->dlugoscTekstu);
+  uint64_t polozenia = sizeof(uint64_t) * naglowek->liczbaSlow;
+  uint64_t dlugosci = wyrownany(sizeof(int32_t) * naglowek->liczbaSlow);
+  if (rozmiar - sizeof(struct zapis_usuniec) < tekst + polozenia + dlugosci +
+    sizeof(struct usuniecia_wpis) * tablica)
+    return NULL;
+
+  /* Wyszukiwanie ufa zawartości: słowa muszą leżeć w tekście, wpisy
+     wskazywać istniejące słowa, a liczba wpisów musi się zgadzać, żeby
+     w tablicy zostało wolne miejsce kończące każde szukanie. */
+  const char * poczatek = (const char *) dane + sizeof(struct zapis_usuniec);
+  const uint64_t * zapisanePolozenia = (const uint64_t *) (poczatek + tekst);
+  const int32_t * zapisaneDlugosci = (const int32_t *) (poczatek + tekst + polozenia);
+  const struct usuniecia_wpis * zapisaneWpisy =
+    (const struct usuniecia_wpis *) (poczatek + tekst + polozenia + dlugosci);
+  for (uint32_t i = 0; i < naglowek->liczbaSlow; i++)
+    if (zapisaneDlugosci[i] < -1 || zapisanePolozenia[i] > naglowek->dlugoscTekstu ||
+      (zapisaneDlugosci[i] >= 0 &&
+        (uint64_t) zapisaneDlugosci[i] > naglowek->dlugoscTekstu - zapisanePolozenia[i]))
+      return NULL;
+  uint64_t zajete = 0;
+  for (uint64_t i = 0; i < tablica; i++)
+  {
+    uint32_t slowo = zapisaneWpisy[i].slowo;
+    if (slowo == USUNIECIA_PUSTY)
+      continue;
+    /* Usunięte słowo (długość -1) nie ma już wpisów. */
+    if (slowo >= naglowek->liczbaSlow || zapisaneDlugosci[slowo] < 0)
+      return NULL;
+    zajete++;
+  }
+  if (zajete != naglowek->liczbaWpisow || zajete == tablica)
+    return NULL;
+
+  struct usuniecia * indeks = calloc(1, sizeof(struct usuniecia));
+  indeks->odleglosc = naglowek->odleglosc;
+  indeks->tekst = (wchar_t *) poczatek;
+  indeks->dlugoscTekstu = indeks->rozmiarTekstu = naglowek->dlugoscTekstu;
+  indeks->polozenia = (uint64_t *) (poczatek + tekst);
+  indeks->dlugosci = (int32_t *) (poczatek + tekst + polozenia);
+  indeks->liczbaSlow = indeks->rozmiarSlow = naglowek->liczbaSlow;
+  indeks->wpisy = (struct usuniecia_wpis *) (poczatek + tekst + polozenia + dlugosci);
+  indeks->rozmiarTablicy = tablica;
+  indeks->liczbaWpisow = naglowek->liczbaWpisow;
+  indeks->zewnetrzna = true;
+  return indeks;
+}
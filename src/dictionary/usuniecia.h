@@ -0,0 +1,164 @@
+/** @file
+    Interfejs indeksu usunięć (symetrycznego wyszukiwania przez usuwanie
+    liter) dla podpowiedzi odległych o kilka edycji.
+
+    Dla każdego słowa słownika zapamiętywane są skróty wszystkich słów
+    powstających z niego przez usunięcie co najwyżej odleglosc liter. Jeśli
+    słowo jest odległe od wzorca o d edycji (wstawień, usunięć, zamian
+    i przestawień liter), to usunięcie co najwyżej d liter z każdego z nich
+    daje to samo słowo. Wyszukiwanie sprowadza się więc do sprawdzenia
+    w tablicy skrótów wszystkich wariantów wzorca i policzenia odległości
+    tylko dla znalezionych tak kandydatów.
+
+    Indeks jest zmieniany przy wstawianiu i usuwaniu słów i może być
+    zapisany razem ze słownikiem, a potem używany w miejscu w zmapowanym
+    pliku (kopiowany jest dopiero przy pierwszej zmianie).
+
+    @ingroup dictionary
+ */
+
+#ifndef __USUNIECIA_H__
+#define __USUNIECIA_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <wchar.h>
+#include "levenshtein.h"
+
+/**
+  Wpis tablicy skrótów: wariant słowa i numer słowa, z którego powstał.
+  */
+struct usuniecia_wpis
+{
+  /** Skrót wariantu na bitach od USUNIECIA_BITY_LICZBY wzwyż i liczba
+      liter usuniętych ze słowa na bitach niższych. */
+  uint32_t skrot;
+
+  /** Numer słowa, USUNIECIA_PUSTY w wolnym miejscu tablicy. */
+  uint32_t slowo;
+};
+
+/** Liczba bitów wpisu na liczbę usuniętych liter. */
+#define USUNIECIA_BITY_LICZBY 2
+
+/** Numer słowa oznaczający wolne miejsce tablicy skrótów. */
+#define USUNIECIA_PUSTY UINT32_MAX
+
+/**
+  Indeks usunięć.
+  */
+struct usuniecia
+{
+  /** Największa liczba usuwanych liter. */
+  int odleglosc;
+
+  /** Litery słów, każde zakończone znakiem '\0'. */
+  wchar_t * tekst;
+
+  /** Liczba zajętych liter tekstu. */
+  uint64_t dlugoscTekstu;
+
+  /** Liczba liter, na które jest miejsce. */
+  uint64_t rozmiarTekstu;
+
+  /** Położenie w tekście kolejnych słów. */
+  uint64_t * polozenia;
+
+  /** Długości kolejnych słów, -1 dla słów usuniętych z indeksu. */
+  int32_t * dlugosci;
+
+  /** Liczba numerów słów, łącznie z usuniętymi. */
+  uint32_t liczbaSlow;
+
+  /** Liczba numerów, na które jest miejsce. */
+  uint32_t rozmiarSlow;
+
+  /** Tablica skrótów z adresowaniem otwartym, wiele wpisów może mieć ten
+      sam skrót. */
+  struct usuniecia_wpis * wpisy;
+
+  /** Rozmiar tablicy skrótów, potęga dwójki. */
+  uint64_t rozmiarTablicy;
+
+  /** Liczba zajętych wpisów. */
+  uint64_t liczbaWpisow;
+
+  /** Czy tablice leżą w cudzej pamięci (np. w zmapowanym pliku), której
+      usuniecia_done() nie zwalnia. */
+  bool zewnetrzna;
+};
+
+/** Utworzenie pustego indeksu.
+ * @param[in] odleglosc Największa liczba usuwanych liter, z zakresu
+ * [1, LEVENSHTEIN_MAKS_ODLEGLOSC].
+ * @return Indeks do zwolnienia przez usuniecia_done().
+ */
+struct usuniecia * usuniecia_nowe(int odleglosc);
+
+/** Zwolnienie indeksu.
+ * @param[in] indeks Indeks albo NULL.
+ */
+void usuniecia_done(struct usuniecia * indeks);
+
+/** Dodanie słowa, którego nie ma jeszcze w indeksie.
+ * @param[in,out] indeks Indeks.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ */
+void usuniecia_dodaj(struct usuniecia * indeks, const wchar_t * slowo, int dlugosc);
+
+/** Usunięcie słowa z indeksu.
+ * @param[in,out] indeks Indeks.
+ * @param[in] slowo Słowo.
+ * @param[in] dlugosc Długość słowa.
+ * @return True jeśli słowo było w indeksie, false wpp.
+ */
+bool usuniecia_usun(struct usuniecia * indeks, const wchar_t * slowo, int dlugosc);
+
+/** Wyszukiwanie słów odległych od wzorca o co najwyżej maksOdleglosc edycji,
+ * tak jak w levenshtein_trie(), ale w dowolnej kolejności.
+ * @param[in] indeks Indeks, indeks->odleglosc nie mniejsza od maksOdleglosc.
+ * @param[in] wzorzec Wzorzec.
+ * @param[in] dlugosc Długość wzorca.
+ * @param[in] maksOdleglosc Odległość.
+ * @param[in] przestawienia Czy przestawienie sąsiednich liter jest jedną edycją.
+ * @param[in] funkcja Funkcja wywoływana dla każdego znalezionego słowa.
+ * @param[in,out] dane Dane przekazywane funkcji.
+ */
+void usuniecia_szukaj(const struct usuniecia * indeks, const wchar_t * wzorzec,
+  int dlugosc, int maksOdleglosc, bool przestawienia, levenshtein_wynik funkcja,
+  void * dane);
+
+/** Liczba bajtów zajmowanych przez indeks.
+ * @param[in] indeks Indeks.
+ * @return Rozmiar w bajtach.
+ */
+size_t usuniecia_rozmiar(const struct usuniecia * indeks);
+
+/** Zapis indeksu w postaci binarnej, którą można potem odczytać w miejscu
+ * funkcją usuniecia_widok(). Zapis zaczyna się i kończy na granicy 8 bajtów
+ * względem początku zapisu.
+ * @param[in] indeks Indeks.
+ * @param[in] stream Strumień do zapisu (binarny).
+ * @return True jeśli zapis się powiódł, false wpp.
+ */
+bool usuniecia_zapisz(const struct usuniecia * indeks, FILE * stream);
+
+/** Liczba bajtów zapisu indeksu przez usuniecia_zapisz().
+ * @param[in] indeks Indeks.
+ * @return Rozmiar zapisu, wielokrotność 8.
+ */
+uint64_t usuniecia_rozmiar_zapisu(const struct usuniecia * indeks);
+
+/** Utworzenie indeksu korzystającego bezpośrednio z danych zapisanych przez
+ * usuniecia_zapisz(), bez kopiowania.
+ * @param[in] dane Początek zapisu, wyrównany do 8 bajtów. Dane muszą
+ * istnieć dłużej niż zwrócony indeks.
+ * @param[in] rozmiar Liczba bajtów dostępnych od początku zapisu.
+ * @return Nowy indeks albo NULL, jeśli dane są niepoprawne.
+ */
+struct usuniecia * usuniecia_widok(const void * dane, size_t rozmiar);
+
+#endif /* __USUNIECIA_H__ */
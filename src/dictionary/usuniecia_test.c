@@ -0,0 +1,233 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+#include <wchar.h>
+#include "usuniecia.h"
+
+/* Liczba słów w losowym słowniku. */
+#define LICZBA_SLOW 400
+
+/* Zebrane wyniki wyszukiwania. */
+struct wyniki {
+    wchar_t slowa[LICZBA_SLOW][16];
+    int odleglosci[LICZBA_SLOW];
+    int liczba;
+};
+
+static int zbierz(const wchar_t * slowo, int dlugosc, int odleglosc, void * dane) {
+    struct wyniki * w = dane;
+    assert_true(w->liczba < LICZBA_SLOW);
+    assert_int_equal(wcslen(slowo), dlugosc);
+    wcscpy(w->slowa[w->liczba], slowo);
+    w->odleglosci[w->liczba++] = odleglosc;
+    return LEVENSHTEIN_MAKS_ODLEGLOSC;
+}
+
+/* Porządek wyników po słowach. */
+static int porownajWyniki(const void * a, const void * b) {
+    return wcscmp(a, b);
+}
+
+/* Sprawdza, czy indeks znajduje te same słowa, w tych samych odległościach,
+   co przejście drzewa. */
+static void porownaj(const struct usuniecia * indeks, const struct trie * t,
+                     const wchar_t * wzorzec) {
+    static struct wyniki drzewo, z_indeksu;
+    for (int k = 0; k <= indeks->odleglosc; k++)
+        for (int przestawienia = 0; przestawienia < 2; przestawienia++) {
+            drzewo.liczba = z_indeksu.liczba = 0;
+            levenshtein_trie(t, wzorzec, wcslen(wzorzec), k, przestawienia, zbierz, &drzewo);
+            usuniecia_szukaj(indeks, wzorzec, wcslen(wzorzec), k, przestawienia,
+                             zbierz, &z_indeksu);
+            assert_int_equal(z_indeksu.liczba, drzewo.liczba);
+            /* Odległość idzie za słowem, więc sortowane są całe wiersze. */
+            struct { wchar_t slowo[16]; int odleglosc; } wiersze[LICZBA_SLOW];
+            for (int i = 0; i < z_indeksu.liczba; i++) {
+                wcscpy(wiersze[i].slowo, z_indeksu.slowa[i]);
+                wiersze[i].odleglosc = z_indeksu.odleglosci[i];
+            }
+            qsort(wiersze, z_indeksu.liczba, sizeof(wiersze[0]), porownajWyniki);
+            for (int i = 0; i < drzewo.liczba; i++) {
+                assert_true(wcscmp(wiersze[i].slowo, drzewo.slowa[i]) == 0);
+                assert_int_equal(wiersze[i].odleglosc, drzewo.odleglosci[i]);
+            }
+        }
+}
+
+/* Losowe słowa nad czteroliterowym alfabetem, mogą się powtarzać. */
+static void losujSlowa(wchar_t slowa[][16], int liczba, unsigned ziarno) {
+    for (int i = 0; i < liczba; i++) {
+        ziarno = ziarno * 1103515245 + 12345;
+        int dlugosc = 1 + (ziarno >> 16) % 7;
+        for (int j = 0; j < dlugosc; j++) {
+            ziarno = ziarno * 1103515245 + 12345;
+            slowa[i][j] = L'a' + (ziarno >> 16) % 4;
+        }
+        slowa[i][dlugosc] = L'\0';
+    }
+}
+
+/* Wzorzec numer p: słowo słownika, co drugie ze zmienioną literą. */
+static const wchar_t * wzorzec(wchar_t slowa[][16], int p, wchar_t * zmieniony) {
+    wcscpy(zmieniony, slowa[p * 7 % LICZBA_SLOW]);
+    if (p % 2)
+        zmieniony[p % wcslen(zmieniony)] = L'a' + p % 5;
+    return zmieniony;
+}
+
+static void usuniecia_example_test(void** state) {
+    struct usuniecia * indeks = usuniecia_nowe(1);
+    const wchar_t * slowa[] = { L"kot", L"koty", L"kto", L"lot", L"pies", L"" };
+    for (int i = 0; i < 6; i++)
+        usuniecia_dodaj(indeks, slowa[i], wcslen(slowa[i]));
+    struct wyniki w;
+    w.liczba = 0;
+    usuniecia_szukaj(indeks, L"kot", 3, 1, false, zbierz, &w);
+    assert_int_equal(w.liczba, 3);
+    w.liczba = 0;
+    usuniecia_szukaj(indeks, L"kot", 3, 1, true, zbierz, &w);
+    assert_int_equal(w.liczba, 4);
+    w.liczba = 0;
+    usuniecia_szukaj(indeks, L"a", 1, 1, false, zbierz, &w);
+    assert_int_equal(w.liczba, 1);
+    assert_int_equal(w.slowa[0][0], L'\0');
+    /* odległość większa niż w indeksie */
+    w.liczba = 0;
+    usuniecia_szukaj(indeks, L"kot", 3, 2, false, zbierz, &w);
+    assert_int_equal(w.liczba, 0);
+
+    assert_true(usuniecia_usun(indeks, L"koty", 4));
+    assert_false(usuniecia_usun(indeks, L"koty", 4));
+    assert_false(usuniecia_usun(indeks, L"ko", 2));
+    w.liczba = 0;
+    usuniecia_szukaj(indeks, L"kot", 3, 1, false, zbierz, &w);
+    assert_int_equal(w.liczba, 2);
+    usuniecia_dodaj(indeks, L"koty", 4);
+    w.liczba = 0;
+    usuniecia_szukaj(indeks, L"kot", 3, 1, false, zbierz, &w);
+    assert_int_equal(w.liczba, 3);
+    usuniecia_done(indeks);
+}
+
+static void usuniecia_random_test(void** state) {
+    static wchar_t slowa[LICZBA_SLOW][16];
+    losujSlowa(slowa, LICZBA_SLOW, 12345);
+    struct trie * t = NULL;
+    struct usuniecia * indeks = usuniecia_nowe(LEVENSHTEIN_MAKS_ODLEGLOSC);
+    for (int i = 0; i < LICZBA_SLOW; i++) {
+        int dlugosc = wcslen(slowa[i]);
+        if (finder(slowa[i], dlugosc, 0, t))
+            continue;
+        t = insert(slowa[i], dlugosc, t, 1);
+        usuniecia_dodaj(indeks, slowa[i], dlugosc);
+    }
+    wchar_t zmieniony[16];
+    for (int p = 0; p < 60; p++)
+        porownaj(indeks, t, wzorzec(slowa, p, zmieniony));
+
+    /* Po usunięciu połowy słów i ponownym dodaniu części z nich. */
+    for (int i = 0; i < LICZBA_SLOW; i += 2) {
+        int dlugosc = wcslen(slowa[i]);
+        bool byl = finder(slowa[i], dlugosc, 0, t);
+        assert_int_equal(usuniecia_usun(indeks, slowa[i], dlugosc), byl);
+        if (byl)
+            t = delete(slowa[i], dlugosc, 0, t);
+    }
+    for (int i = 0; i < LICZBA_SLOW; i += 6) {
+        int dlugosc = wcslen(slowa[i]);
+        if (finder(slowa[i], dlugosc, 0, t))
+            continue;
+        t = insert(slowa[i], dlugosc, t, 1);
+        usuniecia_dodaj(indeks, slowa[i], dlugosc);
+    }
+    for (int p = 0; p < 60; p++)
+        porownaj(indeks, t, wzorzec(slowa, p, zmieniony));
+    usuniecia_done(indeks);
+    clean(t);
+}
+
+static void usuniecia_save_test(void** state) {
+    static wchar_t slowa[LICZBA_SLOW][16];
+    losujSlowa(slowa, LICZBA_SLOW, 777);
+    struct trie * t = NULL;
+    struct usuniecia * indeks = usuniecia_nowe(1);
+    for (int i = 0; i < LICZBA_SLOW; i++) {
+        int dlugosc = wcslen(slowa[i]);
+        if (finder(slowa[i], dlugosc, 0, t))
+            continue;
+        t = insert(slowa[i], dlugosc, t, 1);
+        usuniecia_dodaj(indeks, slowa[i], dlugosc);
+    }
+    assert_true(usuniecia_usun(indeks, slowa[0], wcslen(slowa[0])));
+    t = delete(slowa[0], wcslen(slowa[0]), 0, t);
+
+    FILE * f = tmpfile();
+    assert_true(usuniecia_zapisz(indeks, f));
+    long rozmiar = ftell(f);
+    assert_int_equal(rozmiar, usuniecia_rozmiar_zapisu(indeks));
+    assert_int_equal(rozmiar % 8, 0);
+    uint64_t * dane = malloc(rozmiar);
+    rewind(f);
+    assert_int_equal(fread(dane, 1, rozmiar, f), rozmiar);
+    fclose(f);
+    usuniecia_done(indeks);
+
+    assert_null(usuniecia_widok(dane, rozmiar - 8));
+    /* Uszkodzona zawartość: słowo poza tekstem, wpis spoza słów, wpis
+       usuniętego słowa (numer 0) i zła liczba wpisów. */
+    uint32_t liczbaSlow = ((uint32_t *) dane)[1];
+    uint64_t dlugoscTekstu = dane[1], tablica = dane[2];
+    uint64_t * polozenia = dane + 4 + (sizeof(wchar_t) * dlugoscTekstu + 7) / 8;
+    struct usuniecia_wpis * wpisy = (struct usuniecia_wpis *)
+        (polozenia + liczbaSlow + (sizeof(int32_t) * liczbaSlow + 7) / 8);
+    uint64_t zajety = 0;
+    while (wpisy[zajety].slowo == USUNIECIA_PUSTY)
+        zajety++;
+    assert_true(zajety < tablica);
+    uint64_t stare = polozenia[liczbaSlow - 1];
+    polozenia[liczbaSlow - 1] = dlugoscTekstu;
+    assert_null(usuniecia_widok(dane, rozmiar));
+    polozenia[liczbaSlow - 1] = stare;
+    uint32_t slowo = wpisy[zajety].slowo;
+    wpisy[zajety].slowo = liczbaSlow;
+    assert_null(usuniecia_widok(dane, rozmiar));
+    wpisy[zajety].slowo = 0;
+    assert_null(usuniecia_widok(dane, rozmiar));
+    wpisy[zajety].slowo = slowo;
+    dane[3]--;
+    assert_null(usuniecia_widok(dane, rozmiar));
+    dane[3]++;
+
+    struct usuniecia * widok = usuniecia_widok(dane, rozmiar);
+    assert_non_null(widok);
+    assert_true(widok->zewnetrzna);
+    wchar_t zmieniony[16];
+    for (int p = 0; p < 30; p++)
+        porownaj(widok, t, wzorzec(slowa, p, zmieniony));
+    /* Zmiana przenosi indeks do własnej pamięci, dane zostają nietknięte. */
+    uint64_t * kopia = malloc(rozmiar);
+    memcpy(kopia, dane, rozmiar);
+    usuniecia_dodaj(widok, slowa[0], wcslen(slowa[0]));
+    t = insert(slowa[0], wcslen(slowa[0]), t, 1);
+    assert_false(widok->zewnetrzna);
+    assert_true(memcmp(kopia, dane, rozmiar) == 0);
+    for (int p = 0; p < 30; p++)
+        porownaj(widok, t, wzorzec(slowa, p, zmieniony));
+    usuniecia_done(widok);
+    free(kopia);
+    free(dane);
+    clean(t);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(usuniecia_example_test),
+        cmocka_unit_test(usuniecia_random_test),
+        cmocka_unit_test(usuniecia_save_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
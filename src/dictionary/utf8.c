@@ -0,0 +1,176 @@
+/** @file
+  Implementacja czytnika tekstu w UTF-8.
+
+  @ingroup dictionary
+ */
+
+#include "utf8.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Koduje znak w UTF-8.
+ * @param[in] znak Kodowany znak.
+ * @param[out] wynik Miejsce na co najmniej UTF8_MAX_ZNAK bajtów.
+ * @return Liczba zapisanych bajtów.
+ */
+static int zakoduj(wint_t znak, unsigned char * wynik)
+{
+  if (znak < 0x80)
+  {
+    wynik[0] = znak;
+    return 1;
+  }
+  if (znak < 0x800)
+  {
+    wynik[0] = 0xC0 | (znak >> 6);
+    wynik[1] = 0x80 | (znak & 0x3F);
+    return 2;
+  }
+  if (znak < 0x10000)
+  {
+    wynik[0] = 0xE0 | (znak >> 12);
+    wynik[1] = 0x80 | ((znak >> 6) & 0x3F);
+    wynik[2] = 0x80 | (znak & 0x3F);
+    return 3;
+  }
+  wynik[0] = 0xF0 | (znak >> 18);
+  wynik[1] = 0x80 | ((znak >> 12) & 0x3F);
+  wynik[2] = 0x80 | ((znak >> 6) & 0x3F);
+  wynik[3] = 0x80 | (znak & 0x3F);
+  return 4;
+}
+
+/** Przenosi nieprzeczytane bajty na początek bufora i dopełnia go
+ * kolejnym blokiem ze strumienia.
+ * @param[in,out] czytnik Czytnik.
+ */
+static void doladuj(struct utf8_czytnik * czytnik)
+{
+  size_t zostalo = czytnik->koniec - czytnik->pozycja;
+  memmove(czytnik->bufor, czytnik->bufor + czytnik->pozycja, zostalo);
+  czytnik->pozycja = 0;
+  czytnik->koniec = zostalo;
+  if (czytnik->szeroki)
+  {
+    while (czytnik->koniec + UTF8_MAX_ZNAK <= UTF8_BLOK)
+    {
+      wint_t znak = fgetwc(czytnik->stream);
+      if (znak == WEOF)
+      {
+        czytnik->koniecStrumienia = true;
+        break;
+      }
+      czytnik->koniec += zakoduj(znak, czytnik->bufor + czytnik->koniec);
+    }
+    return;
+  }
+  size_t chciane = UTF8_BLOK - czytnik->koniec;
+  size_t pobrane = fread(czytnik->bufor + czytnik->koniec, 1, chciane,
+    czytnik->stream);
+  czytnik->koniec += pobrane;
+  if (pobrane < chciane)
+    czytnik->koniecStrumienia = true;
+}
+
+void utf8_czytnik_init(struct utf8_czytnik * czytnik, FILE * stream)
+{
+  czytnik->stream = stream;
+  czytnik->bufor = malloc(UTF8_BLOK);
+  czytnik->pozycja = 0;
+  czytnik->koniec = 0;
+  czytnik->szeroki = fwide(stream, 0) > 0;
+  czytnik->koniecStrumienia = false;
+}
+
+void utf8_czytnik_done(struct utf8_czytnik * czytnik)
+{
+  /* Pobrane z wyprzedzeniem bajty oddajemy strumieniowi, o ile da się
+     go przewinąć; dla strumienia szerokich znaków nie znamy ich
+     liczby w kodowaniu lokalizacji. */
+  if (!czytnik->szeroki && czytnik->pozycja < czytnik->koniec)
+    fseek(czytnik->stream, -(long)(czytnik->koniec - czytnik->pozycja), SEEK_CUR);
+  free(czytnik->bufor);
+  czytnik->bufor = NULL;
+  czytnik->pozycja = czytnik->koniec = 0;
+}
+
+wint_t utf8_dekoduj(struct utf8_czytnik * czytnik, int * dlugosc)
+{
+  *dlugosc = 0;
+  if (czytnik->koniec - czytnik->pozycja < UTF8_MAX_ZNAK
+    && !czytnik->koniecStrumienia)
+    doladuj(czytnik);
+  size_t zostalo = czytnik->koniec - czytnik->pozycja;
+  if (zostalo == 0)
+    return WEOF;
+  const unsigned char * p = czytnik->bufor + czytnik->pozycja;
+  wint_t znak, najmniejszy;
+  int ile;
+  if (p[0] < 0x80)
+  {
+    *dlugosc = 1;
+    return p[0];
+  }
+  else if ((p[0] & 0xE0) == 0xC0)
+  {
+    ile = 2;
+    znak = p[0] & 0x1F;
+    najmniejszy = 0x80;
+  }
+  else if ((p[0] & 0xF0) == 0xE0)
+  {
+    ile = 3;
+    znak = p[0] & 0x0F;
+    najmniejszy = 0x800;
+  }
+  else if ((p[0] & 0xF8) == 0xF0)
+  {
+    ile = 4;
+    znak = p[0] & 0x07;
+    najmniejszy = 0x10000;
+  }
+  else
+    return WEOF;
+  if (zostalo < (size_t)ile)
+    return WEOF;
+  for (int i = 1; i < ile; i++)
+  {
+    if ((p[i] & 0xC0) != 0x80)
+      return WEOF;
+    znak = (znak << 6) | (p[i] & 0x3F);
+  }
+  /* Tak jak dekoder biblioteki standardowej odrzucamy kodowania
+     nadmiarowe, surogaty i znaki spoza zakresu Unicode. */
+  if (znak < najmniejszy || znak > 0x10FFFF || (znak >= 0xD800 && znak <= 0xDFFF))
+    return WEOF;
+  *dlugosc = ile;
+  return znak;
+}
+
+bool utf8_liczba(struct utf8_czytnik * czytnik, int * wynik)
+{
+  wint_t znak = utf8_podejrzyj(czytnik);
+  while (znak == L' ' || (znak >= L'\t' && znak <= L'\r'))
+  {
+    utf8_wez(czytnik);
+    znak = utf8_podejrzyj(czytnik);
+  }
+  bool ujemna = false;
+  if (znak == L'-' || znak == L'+')
+  {
+    ujemna = znak == L'-';
+    utf8_wez(czytnik);
+    znak = utf8_podejrzyj(czytnik);
+  }
+  if (znak < L'0' || znak > L'9')
+    return false;
+  int liczba = 0;
+  do
+  {
+    liczba = 10 * liczba + (znak - L'0');
+    utf8_wez(czytnik);
+    znak = utf8_podejrzyj(czytnik);
+  } while (znak >= L'0' && znak <= L'9');
+  *wynik = ujemna ? -liczba : liczba;
+  return true;
+}
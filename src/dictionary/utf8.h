@@ -0,0 +1,107 @@
+/** @file
+    Interfejs czytnika tekstu w UTF-8 dla wczytywania słownika.
+
+    Czytnik pobiera ze strumienia duże bloki bajtów (fread()) i sam
+    dekoduje z nich znaki, zamiast pobierać je pojedynczo przez warstwę
+    szerokich znaków biblioteki standardowej, zależną od lokalizacji.
+    Znaki ASCII obsługiwane są bez dekodowania, bezpośrednio z bufora.
+    Strumień zorientowany już na szerokie znaki (np. zapisany przed chwilą
+    przez fwprintf()) czytany jest przez fgetwc(), a znaki trafiają do
+    bufora zakodowane z powrotem w UTF-8.
+
+    @ingroup dictionary
+ */
+
+#ifndef __UTF8_H__
+#define __UTF8_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <wchar.h>
+
+/** Rozmiar bloku pobieranego ze strumienia w bajtach. */
+#define UTF8_BLOK (64 * 1024)
+
+/** Najdłuższe kodowanie jednego znaku w bajtach. */
+#define UTF8_MAX_ZNAK 4
+
+/**
+  Czytnik strumienia w UTF-8.
+  */
+struct utf8_czytnik
+{
+  /** Czytany strumień. */
+  FILE * stream;
+
+  /** Bufor z pobranymi bajtami. */
+  unsigned char * bufor;
+
+  /** Pozycja następnego nieprzeczytanego bajtu w buforze. */
+  size_t pozycja;
+
+  /** Liczba bajtów w buforze. */
+  size_t koniec;
+
+  /** Czy strumień zorientowany jest na szerokie znaki. */
+  bool szeroki;
+
+  /** Czy strumień się skończył. */
+  bool koniecStrumienia;
+};
+
+/** Inicjalizacja czytnika.
+ * @param[out] czytnik Czytnik.
+ * @param[in,out] stream Czytany strumień.
+ */
+void utf8_czytnik_init(struct utf8_czytnik * czytnik, FILE * stream);
+
+/** Zakończenie pracy czytnika. Jeśli to możliwe, strumień cofany jest
+ * za ostatni przeczytany znak.
+ * @param[in,out] czytnik Czytnik.
+ */
+void utf8_czytnik_done(struct utf8_czytnik * czytnik);
+
+/** Dekoduje znak spoza ASCII (lub pobiera kolejny blok), nie przesuwając
+ * czytnika. Używana przez utf8_podejrzyj() i utf8_wez().
+ * @param[in,out] czytnik Czytnik.
+ * @param[out] dlugosc Długość kodowania znaku w bajtach.
+ * @return Znak lub WEOF na końcu strumienia i przy błędnym kodowaniu.
+ */
+wint_t utf8_dekoduj(struct utf8_czytnik * czytnik, int * dlugosc);
+
+/** Zwraca następny znak, nie przesuwając czytnika.
+ * @param[in,out] czytnik Czytnik.
+ * @return Znak lub WEOF.
+ */
+static inline wint_t utf8_podejrzyj(struct utf8_czytnik * czytnik)
+{
+  if (czytnik->pozycja < czytnik->koniec && czytnik->bufor[czytnik->pozycja] < 0x80)
+    return czytnik->bufor[czytnik->pozycja];
+  int dlugosc;
+  return utf8_dekoduj(czytnik, &dlugosc);
+}
+
+/** Zwraca następny znak i przesuwa za niego czytnik.
+ * @param[in,out] czytnik Czytnik.
+ * @return Znak lub WEOF.
+ */
+static inline wint_t utf8_wez(struct utf8_czytnik * czytnik)
+{
+  if (czytnik->pozycja < czytnik->koniec && czytnik->bufor[czytnik->pozycja] < 0x80)
+    return czytnik->bufor[czytnik->pozycja++];
+  int dlugosc;
+  wint_t znak = utf8_dekoduj(czytnik, &dlugosc);
+  czytnik->pozycja += dlugosc;
+  return znak;
+}
+
+/** Wczytuje liczbę całkowitą zapisaną dziesiętnie, pomijając poprzedzające
+ * ją białe znaki (tak jak `%d` w fwscanf()).
+ * @param[in,out] czytnik Czytnik.
+ * @param[out] wynik Wczytana liczba.
+ * @return Czy udało się wczytać liczbę.
+ */
+bool utf8_liczba(struct utf8_czytnik * czytnik, int * wynik);
+
+#endif /* __UTF8_H__ */
@@ -0,0 +1,107 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+#include "utf8.h"
+
+/* "żółw1" zapisane w UTF-8 bajt po bajcie. */
+static const char zolw[] = "\xc5\xbc\xc3\xb3\xc5\x82w1";
+
+static void utf8_decode_test(void** state) {
+    FILE * f = fmemopen((void *) zolw, strlen(zolw), "r");
+    struct utf8_czytnik c;
+    utf8_czytnik_init(&c, f);
+    assert_int_equal(utf8_podejrzyj(&c), 0x17C);
+    assert_int_equal(utf8_wez(&c), 0x17C);
+    assert_int_equal(utf8_wez(&c), 0xF3);
+    assert_int_equal(utf8_wez(&c), 0x142);
+    assert_int_equal(utf8_wez(&c), L'w');
+    assert_int_equal(utf8_wez(&c), L'1');
+    assert_int_equal(utf8_wez(&c), WEOF);
+    assert_int_equal(utf8_podejrzyj(&c), WEOF);
+    utf8_czytnik_done(&c);
+    fclose(f);
+}
+
+static void utf8_invalid_test(void** state) {
+    const char * zle[] = { "\xc5", "\xc5x", "\xc0\x80", "\xed\xa0\x80", "\xff" };
+    for (int i = 0; i < 5; i++) {
+        FILE * f = fmemopen((void *) zle[i], strlen(zle[i]), "r");
+        struct utf8_czytnik c;
+        utf8_czytnik_init(&c, f);
+        assert_int_equal(utf8_wez(&c), WEOF);
+        utf8_czytnik_done(&c);
+        fclose(f);
+    }
+}
+
+static void utf8_number_test(void** state) {
+    const char tekst[] = " 12\n-7|x";
+    FILE * f = fmemopen((void *) tekst, strlen(tekst), "r");
+    struct utf8_czytnik c;
+    int liczba = 0;
+    utf8_czytnik_init(&c, f);
+    assert_true(utf8_liczba(&c, &liczba));
+    assert_int_equal(liczba, 12);
+    assert_true(utf8_liczba(&c, &liczba));
+    assert_int_equal(liczba, -7);
+    assert_false(utf8_liczba(&c, &liczba));
+    assert_int_equal(utf8_wez(&c), L'|');
+    utf8_czytnik_done(&c);
+    /* nieprzeczytana reszta wraca do strumienia */
+    assert_int_equal(fgetc(f), 'x');
+    fclose(f);
+}
+
+static void utf8_block_boundary_test(void** state) {
+    /* Dwubajtowe znaki przesunięte o jeden bajt przecinają granice bloków. */
+    size_t ile = 3 * UTF8_BLOK / 2;
+    char * tekst = malloc(2 * ile + 1);
+    tekst[0] = 'a';
+    for (size_t i = 0; i < ile; i++)
+        memcpy(tekst + 1 + 2 * i, "\xc5\xbc", 2);
+    FILE * f = fmemopen(tekst, 2 * ile + 1, "r");
+    struct utf8_czytnik c;
+    utf8_czytnik_init(&c, f);
+    assert_int_equal(utf8_wez(&c), L'a');
+    size_t przeczytane = 0;
+    while (utf8_wez(&c) == 0x17C)
+        przeczytane++;
+    assert_int_equal(przeczytane, ile);
+    utf8_czytnik_done(&c);
+    fclose(f);
+    free(tekst);
+}
+
+static void utf8_wide_stream_test(void** state) {
+    FILE * f = tmpfile();
+    fwprintf(f, L"%d|abc", 42);
+    rewind(f);
+    struct utf8_czytnik c;
+    int liczba = 0;
+    utf8_czytnik_init(&c, f);
+    assert_true(c.szeroki);
+    assert_true(utf8_liczba(&c, &liczba));
+    assert_int_equal(liczba, 42);
+    assert_int_equal(utf8_wez(&c), L'|');
+    assert_int_equal(utf8_wez(&c), L'a');
+    assert_int_equal(utf8_wez(&c), L'b');
+    assert_int_equal(utf8_wez(&c), L'c');
+    assert_int_equal(utf8_wez(&c), WEOF);
+    utf8_czytnik_done(&c);
+    fclose(f);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(utf8_decode_test),
+        cmocka_unit_test(utf8_invalid_test),
+        cmocka_unit_test(utf8_number_test),
+        cmocka_unit_test(utf8_block_boundary_test),
+        cmocka_unit_test(utf8_wide_stream_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,130 @@
+/** @file
+  Implementacja puli wątków.
+
+  @ingroup dictionary
+ */
+
+#include "watki.h"
+#include <stdlib.h>
+
+/**
+  Wątek roboczy puli.
+  */
+struct watki_pracownik
+{
+  /** Pula. */
+  struct watki * pula;
+
+  /** Numer wątku w puli, od 1. */
+  int numer;
+
+  /** Wątek. */
+  pthread_t watek;
+};
+
+/** Wykonywanie zadań bieżącego zlecenia, dopóki są niepobrane.
+ * @param[in,out] pula Pula.
+ * @param[in] numer Numer wątku.
+ */
+static void wykonujZadania(struct watki * pula, int numer)
+{
+  int zadanie;
+  while ((zadanie = __atomic_fetch_add(&pula->nastepne, 1, __ATOMIC_RELAXED)) <
+         pula->liczbaZadan)
+    pula->funkcja(zadanie, numer, pula->dane);
+}
+
+/** Pętla wątku roboczego: czekanie na zlecenie i praca nad nim.
+ * @param[in] argument Pracownik (struct watki_pracownik).
+ * @return NULL.
+ */
+static void * pracuj(void * argument)
+{
+  struct watki_pracownik * pracownik = argument;
+  struct watki * pula = pracownik->pula;
+  unsigned long wykonane = 0;
+  pthread_mutex_lock(&pula->blokada);
+  for (;;)
+  {
+    while (!pula->koniec && pula->zlecenie == wykonane)
+      pthread_cond_wait(&pula->praca, &pula->blokada);
+    if (pula->koniec)
+      break;
+    wykonane = pula->zlecenie;
+    pthread_mutex_unlock(&pula->blokada);
+    wykonujZadania(pula, pracownik->numer);
+    pthread_mutex_lock(&pula->blokada);
+    if (--pula->pracujace == 0)
+      pthread_cond_signal(&pula->gotowe);
+  }
+  pthread_mutex_unlock(&pula->blokada);
+  return NULL;
+}
+
+struct watki * watki_nowe(int liczba)
+{
+  struct watki * pula = malloc(sizeof(struct watki));
+  pula->liczba = 1;
+  pula->pracownicy = malloc(sizeof(struct watki_pracownik) * liczba);
+  pthread_mutex_init(&pula->blokada, NULL);
+  pthread_cond_init(&pula->praca, NULL);
+  pthread_cond_init(&pula->gotowe, NULL);
+  pula->zlecenie = 0;
+  pula->pracujace = 0;
+  pula->koniec = false;
+  pula->funkcja = NULL;
+  pula->dane = NULL;
+  pula->liczbaZadan = 0;
+  pula->nastepne = 0;
+  for (int i = 1; i < liczba; i++)
+  {
+    struct watki_pracownik * pracownik = &pula->pracownicy[i - 1];
+    pracownik->pula = pula;
+    pracownik->numer = i;
+    if (pthread_create(&pracownik->watek, NULL, pracuj, pracownik) != 0)
+    {
+      watki_done(pula);
+      return NULL;
+    }
+    pula->liczba++;
+  }
+  return pula;
+}
+
+void watki_done(struct watki * pula)
+{
+  if (pula == NULL)
+    return;
+  pthread_mutex_lock(&pula->blokada);
+  pula->koniec = true;
+  pthread_cond_broadcast(&pula->praca);
+  pthread_mutex_unlock(&pula->blokada);
+  for (int i = 0; i < pula->liczba - 1; i++)
+    pthread_join(pula->pracownicy[i].watek, NULL);
+  pthread_cond_destroy(&pula->gotowe);
+  pthread_cond_destroy(&pula->praca);
+  pthread_mutex_destroy(&pula->blokada);
+  free(pula->pracownicy);
+  free(pula);
+}
+
+void watki_wykonaj(struct watki * pula, int liczbaZadan, watki_zadanie funkcja,
+  void * dane)
+{
+  pthread_mutex_lock(&pula->blokada);
+  pula->funkcja = funkcja;
+  pula->dane = dane;
+  pula->liczbaZadan = liczbaZadan;
+  pula->nastepne = 0;
+  pula->pracujace = pula->liczba - 1;
+  pula->zlecenie++;
+  pthread_cond_broadcast(&pula->praca);
+  pthread_mutex_unlock(&pula->blokada);
+
+  wykonujZadania(pula, 0);
+
+  pthread_mutex_lock(&pula->blokada);
+  while (pula->pracujace > 0)
+    pthread_cond_wait(&pula->gotowe, &pula->blokada);
+  pthread_mutex_unlock(&pula->blokada);
+}
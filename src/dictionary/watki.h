@@ -0,0 +1,96 @@
+/** @file
+    Interfejs puli wątków.
+
+    Pula wykonuje zlecenia złożone z ponumerowanych, niezależnych zadań.
+    Wątki pobierają kolejne zadania ze wspólnego licznika, więc wątek,
+    który skończył swoje zadania wcześniej, zabiera zadania pozostałym
+    i krótkie zadania nie czekają na długie. Wywołujący zlecenie pracuje
+    jako jeden z wątków puli i czeka na wykonanie wszystkich zadań.
+
+    @ingroup dictionary
+ */
+
+#ifndef __WATKI_H__
+#define __WATKI_H__
+
+#include <pthread.h>
+#include <stdbool.h>
+
+/** Zadanie zlecenia.
+ * @param[in] zadanie Numer zadania, od 0.
+ * @param[in] watek Numer wykonującego wątku, od 0 (wywołujący zlecenie)
+ * do liczby wątków puli - 1.
+ * @param[in,out] dane Dane zlecenia.
+ */
+typedef void (* watki_zadanie)(int zadanie, int watek, void * dane);
+
+/** Wątek roboczy puli. */
+struct watki_pracownik;
+
+/**
+  Pula wątków.
+  */
+struct watki
+{
+  /** Liczba wątków, łącznie z wywołującym zlecenia. */
+  int liczba;
+
+  /** Wątki robocze (liczba - 1). */
+  struct watki_pracownik * pracownicy;
+
+  /** Blokada pól poniżej. */
+  pthread_mutex_t blokada;
+
+  /** Sygnał nowego zlecenia lub zamknięcia puli. */
+  pthread_cond_t praca;
+
+  /** Sygnał zakończenia pracy ostatniego wątku roboczego. */
+  pthread_cond_t gotowe;
+
+  /** Numer bieżącego zlecenia. */
+  unsigned long zlecenie;
+
+  /** Liczba wątków roboczych pracujących nad bieżącym zleceniem. */
+  int pracujace;
+
+  /** Czy pula jest zamykana. */
+  bool koniec;
+
+  /** Zadanie bieżącego zlecenia. */
+  watki_zadanie funkcja;
+
+  /** Dane bieżącego zlecenia. */
+  void * dane;
+
+  /** Liczba zadań bieżącego zlecenia. */
+  int liczbaZadan;
+
+  /** Numer następnego niepobranego zadania, zmieniany atomowo. */
+  int nastepne;
+};
+
+/** Utworzenie puli.
+ * @param[in] liczba Liczba wątków, łącznie z wywołującym zlecenia,
+ * dodatnia.
+ * @return Pula do zwolnienia przez watki_done() albo NULL, jeśli nie udało
+ * się uruchomić wątków.
+ */
+struct watki * watki_nowe(int liczba);
+
+/** Zamknięcie puli i zwolnienie jej pamięci.
+ * @param[in] pula Pula albo NULL.
+ */
+void watki_done(struct watki * pula);
+
+/** Wykonanie zlecenia. Każde zadanie wykonywane jest dokładnie raz,
+ * w dowolnym wątku i w dowolnej kolejności; zlecenia nie mogą być
+ * wydawane współbieżnie.
+ * @param[in,out] pula Pula.
+ * @param[in] liczbaZadan Liczba zadań.
+ * @param[in] funkcja Zadanie.
+ * @param[in,out] dane Dane zlecenia.
+ */
+void watki_wykonaj(struct watki * pula, int liczbaZadan, watki_zadanie funkcja,
+  void * dane);
+
+#endif /* __WATKI_H__ */
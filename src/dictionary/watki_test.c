@@ -0,0 +1,60 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmocka.h>
+#include "watki.h"
+
+/* Dane zlecenia: ile razy i w którym wątku wykonano każde zadanie. */
+struct licznik {
+    int wykonania[1000];
+    int watki[1000];
+    int liczbaWatkow;
+};
+
+static void zadanie(int numer, int watek, void * dane) {
+    struct licznik * l = dane;
+    assert_true(watek >= 0 && watek < l->liczbaWatkow);
+    l->wykonania[numer]++;
+    l->watki[numer] = watek;
+}
+
+static void watki_all_tasks_test(void** state) {
+    static struct licznik l;
+    for (int liczba = 1; liczba <= 8; liczba *= 2) {
+        struct watki * pula = watki_nowe(liczba);
+        assert_non_null(pula);
+        assert_int_equal(pula->liczba, liczba);
+        l.liczbaWatkow = liczba;
+        /* Kolejne zlecenia tej samej puli, także puste. */
+        for (int zadan = 0; zadan <= 1000; zadan += 125) {
+            memset(l.wykonania, 0, sizeof(l.wykonania));
+            watki_wykonaj(pula, zadan, zadanie, &l);
+            for (int i = 0; i < 1000; i++)
+                assert_int_equal(l.wykonania[i], i < zadan);
+        }
+        watki_done(pula);
+    }
+}
+
+static void watki_single_test(void** state) {
+    /* Pula z jednym wątkiem wykonuje wszystko w wywołującym. */
+    static struct licznik l;
+    struct watki * pula = watki_nowe(1);
+    l.liczbaWatkow = 1;
+    watki_wykonaj(pula, 10, zadanie, &l);
+    for (int i = 0; i < 10; i++)
+        assert_int_equal(l.watki[i], 0);
+    watki_done(pula);
+    watki_done(NULL);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(watki_all_tasks_test),
+        cmocka_unit_test(watki_single_test),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
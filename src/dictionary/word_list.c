@@ -10,6 +10,7 @@
 #include "word_list.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <wchar.h>
 
 /** @name Elementy interfejsu
@@ -20,37 +21,85 @@ void word_list_init(struct word_list *list)
 {
     list->size = 0;
     list->buffer_size = 0;
-    list->array = NULL; //malloc(sizeof(wchar_t *));
+    list->chars_size = WORD_LIST_SUM;
+    list->chars = list->buffer;
+    list->array_size = WORD_LIST_MAX_WORDS;
+    list->array = list->words;
 }
 
 void word_list_done(struct word_list *list)
 {
-  wchar_t ** pom = list->array;  
-  for (int i = 0; i < list->size;i++)
+  if (list->chars != list->buffer)
+    free(list->chars);
+  if (list->array != list->words)
+    free(list->array);
+}
+
+void word_list_clear(struct word_list *list)
+{
+  list->size = 0;
+  list->buffer_size = 0;
+}
+
+/** Podwaja tablicę słów.
+ * @param[in,out] list Lista słów.
+ * @return 1 jeśli się udało, 0 w p.p.
+ */
+static int resize(struct word_list *list)
+{
+  size_t size = 2 * list->array_size;
+  wchar_t ** newArray;
+  if (list->array == list->words)
   {
-      free(pom[i]);
+    newArray = malloc(sizeof(wchar_t *) * size);
+    if (newArray != NULL)
+      memcpy(newArray, list->words, sizeof(list->words));
   }
-  free(pom);
+  else
+    newArray = realloc(list->array, sizeof(wchar_t *) * size);
+  if (newArray == NULL)
+    return 0;
+  list->array = newArray;
+  list->array_size = size;
+  return 1;
 }
 
-static struct word_list * resize (struct word_list *list2)
+/** Powiększa obszar słów, przenosząc do niego dotychczasowe słowa.
+ * @param[in,out] list Lista słów.
+ * @param[in] needed Liczba znaków, na które musi być miejsce.
+ * @return 1 jeśli się udało, 0 w p.p.
+ */
+static int grow(struct word_list *list, size_t needed)
 {
-  struct word_list * list = list2;
-  if (!list->buffer_size)
-    list-> buffer_size++;
-  wchar_t ** current = list->array;
-  wchar_t ** newArray = realloc(current, sizeof(wchar_t *) * (list->buffer_size * 2));
-  current = newArray;
-  list->buffer_size *= 2;
-  list->array = current;
-  return list;
+  size_t size = 2 * list->chars_size;
+  if (size < needed)
+    size = needed;
+  wchar_t * chars = malloc(sizeof(wchar_t) * size);
+  if (chars == NULL)
+    return 0;
+  wmemcpy(chars, list->chars, list->buffer_size);
+  /* Słowa leżą w tym samym miejscu względem początku obszaru. */
+  for (size_t i = 0; i < list->size; i++)
+    list->array[i] = chars + (list->array[i] - list->chars);
+  if (list->chars != list->buffer)
+    free(list->chars);
+  list->chars = chars;
+  list->chars_size = size;
+  return 1;
 }
 
-int word_list_add(struct word_list *list, wchar_t *word)
+int word_list_add(struct word_list *list, const wchar_t *word)
 {
-    if (list->size >= list->buffer_size)
-      list = resize(list);
-    list->array[list->size++] = word;
+    if (list->size >= list->array_size && !resize(list))
+      return 0;
+    size_t length = wcslen(word) + 1;
+    if (list->buffer_size + length > list->chars_size &&
+        !grow(list, list->buffer_size + length))
+      return 0;
+    wchar_t * copy = list->chars + list->buffer_size;
+    list->buffer_size += length;
+    wmemcpy(copy, word, length);
+    list->array[list->size++] = copy;
     return 1;
 }
 
@@ -5,8 +5,6 @@
     @author Jakub Pawlewicz <pan@mimuw.edu.pl>
     @copyright Uniwerstet Warszawski
     @date 2015-05-10
-    @todo Poszerzyć implementację, aby można było trzymać dowolną
-      liczbę słów.
  */
 
 #ifndef __WORD_LIST_H__
@@ -30,16 +28,30 @@
   Struktura przechowująca listę słów.
   Należy używać funkcji operujących na strukturze,
   gdyż jej implementacja może się zmienić.
+  Lista przechowuje kopie słów, jedno za drugim, w jednym obszarze pamięci:
+  najpierw w buforze, a gdy się zapełni, w powiększanym dwukrotnie obszarze
+  na stercie, do którego przenoszone są wszystkie słowa. Tablica słów
+  wskazuje do tego obszaru. Lista wskazuje do własnego wnętrza, więc nie
+  należy jej kopiować. Wyczyszczona lista (word_list_clear()) zachowuje
+  pamięć, więc używana ponownie nie przydziela jej od nowa.
   */
 struct word_list
 {
     /// Liczba słów.
     size_t size;
-    /// Łączna liczba znaków.
+    /// Łączna liczba znaków słów w obszarze.
     size_t buffer_size;
+    /// Liczba znaków, na które jest miejsce w obszarze.
+    size_t chars_size;
+    /// Obszar ze słowami: bufor albo pamięć na stercie.
+    wchar_t * chars;
+    /// Liczba słów, na które jest miejsce w tablicy słów.
+    size_t array_size;
     /// Tablica słów.
     wchar_t ** array;
-    /// Bufor, w którym pamiętane są słowa.
+    /// Początkowa tablica słów.
+    wchar_t * words[WORD_LIST_MAX_WORDS];
+    /// Początkowy obszar słów.
     wchar_t buffer[WORD_LIST_SUM];
 };
 
@@ -56,12 +68,18 @@ void word_list_init(struct word_list *list);
 void word_list_done(struct word_list *list);
 
 /**
-  Dodaje słowo do listy.
+  Usuwa wszystkie słowa z listy, zachowując jej pamięć.
+  @param[in,out] list Lista słów.
+  */
+void word_list_clear(struct word_list *list);
+
+/**
+  Dodaje kopię słowa do listy.
   @param[in,out] list Lista słów.
   @param[in] word Dodawane słowo.
   @return 1 jeśli się udało, 0 w p.p.
   */
-int word_list_add(struct word_list *list, wchar_t *word);
+int word_list_add(struct word_list *list, const wchar_t *word);
 
 /**
   Zwraca liczę słów w liście.
@@ -14,7 +14,7 @@ static void word_list_init_test(void** state) {
     struct word_list l;
     word_list_init(&l);
     assert_int_equal(word_list_size(&l), 0);
-   // word_list_done(&l);
+    word_list_done(&l);
 }
 
 static void word_list_add_test(void** state) {
@@ -23,7 +23,9 @@ static void word_list_add_test(void** state) {
     word_list_add(&l, test);
     assert_int_equal(word_list_size(&l), 1);
     assert_true(wcscmp(test, word_list_get(&l)[0]) == 0);
-    //word_list_done(&l);
+    /* lista trzyma własną kopię */
+    assert_true(word_list_get(&l)[0] != test);
+    word_list_done(&l);
 }
 
 static int word_list_setup(void **state) {
@@ -40,6 +42,7 @@ static int word_list_setup(void **state) {
 
 static int word_list_teardown(void **state) {
     struct word_list *l = *state;
+    word_list_done(l);
     free(l);
     return 0;
 }
@@ -58,11 +61,77 @@ static void word_list_repeat_test(void** state) {
     assert_true(wcscmp(third, word_list_get(l)[3]) == 0);
 }
 
+static void word_list_many_test(void** state) {
+    /* Więcej słów i liter niż mieści się w buforze listy. */
+    struct word_list l;
+    word_list_init(&l);
+    wchar_t word[64];
+    for (int i = 0; i < 3 * WORD_LIST_MAX_WORDS; i++) {
+        swprintf(word, 64, L"%0*d", 1 + i % 60, i);
+        assert_int_equal(word_list_add(&l, word), 1);
+    }
+    assert_int_equal(word_list_size(&l), 3 * WORD_LIST_MAX_WORDS);
+    for (int i = 0; i < 3 * WORD_LIST_MAX_WORDS; i++) {
+        swprintf(word, 64, L"%0*d", 1 + i % 60, i);
+        assert_true(wcscmp(word, word_list_get(&l)[i]) == 0);
+    }
+    word_list_done(&l);
+}
+
+static void word_list_clear_test(void** state) {
+    /* Słowa leżą jedno za drugim; wyczyszczona lista używa tej samej
+       pamięci. */
+    struct word_list l;
+    word_list_init(&l);
+    wchar_t word[64];
+    for (int i = 0; i < 4 * WORD_LIST_MAX_WORDS; i++) {
+        swprintf(word, 64, L"%0*d", 1 + i % 60, i);
+        word_list_add(&l, word);
+    }
+    for (size_t i = 0; i + 1 < word_list_size(&l); i++)
+        assert_true(word_list_get(&l)[i + 1] ==
+                    word_list_get(&l)[i] + wcslen(word_list_get(&l)[i]) + 1);
+    wchar_t * const * array = word_list_get(&l);
+    const wchar_t * chars = array[0];
+    word_list_clear(&l);
+    assert_int_equal(word_list_size(&l), 0);
+    for (int i = 0; i < 4 * WORD_LIST_MAX_WORDS; i++) {
+        swprintf(word, 64, L"%0*d", 1 + i % 60, i);
+        word_list_add(&l, word);
+    }
+    assert_true(word_list_get(&l) == array);
+    assert_true(word_list_get(&l)[0] == chars);
+    word_list_done(&l);
+}
+
+static void word_list_grow_test(void** state) {
+    /* Przeniesienie słów nie zmienia kolejności w tablicy, także
+       przestawionej przez użytkownika listy. */
+    struct word_list l;
+    word_list_init(&l);
+    word_list_add(&l, first);
+    word_list_add(&l, second);
+    wchar_t ** array = word_list_get(&l);
+    wchar_t * pom = array[0];
+    array[0] = array[1];
+    array[1] = pom;
+    wchar_t word[WORD_LIST_SUM];
+    wmemset(word, L'x', WORD_LIST_SUM - 1);
+    word[WORD_LIST_SUM - 1] = L'\0';
+    assert_int_equal(word_list_add(&l, word), 1);
+    assert_true(wcscmp(second, word_list_get(&l)[0]) == 0);
+    assert_true(wcscmp(first, word_list_get(&l)[1]) == 0);
+    assert_true(wcscmp(word, word_list_get(&l)[2]) == 0);
+    word_list_done(&l);
+}
 
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(word_list_init_test),
         cmocka_unit_test(word_list_add_test),
+        cmocka_unit_test(word_list_many_test),
+        cmocka_unit_test(word_list_clear_test),
+        cmocka_unit_test(word_list_grow_test),
         cmocka_unit_test_setup_teardown(word_list_get_test, word_list_setup, word_list_teardown),
         cmocka_unit_test_setup_teardown(word_list_repeat_test, word_list_setup, word_list_teardown),
     };
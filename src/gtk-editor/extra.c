@@ -19,6 +19,22 @@ static int make_lowercase(wchar_t *word)
     return 1;
 }
 
+// Podpowiedzi dla listy wyboru
+struct combo_hints {
+  GtkWidget *combo;
+  int count;
+};
+
+static bool append_hint(const wchar_t *hint, int cost, void *ctx)
+{
+  struct combo_hints *h = ctx;
+  char *uword = g_ucs4_to_utf8((gunichar *)hint, -1, NULL, NULL, NULL);
+  gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(h->combo), uword);
+  g_free(uword);
+  // Podpowiedzi przychodzą od najtańszej, dalsze nie są potrzebne
+  return ++h->count < DICTIONARY_MAX_HINTS;
+}
+
 void show_about () {
   GtkWidget *dialog = gtk_about_dialog_new();
 
@@ -106,13 +122,8 @@ static void WhatCheck (GtkMenuItem *item, gpointer data) {
   {
     // Czas korekty
     GtkWidget *vbox, *label, *combo;
+    struct combo_hints hints;
 
-    struct word_list hints;
-    int i;
-    wchar_t **words;
-
-    dictionary_hints(dict, (wchar_t *)wword, &hints);
-    words = word_list_get(&hints);
     dialog = gtk_dialog_new_with_buttons("Korekta", NULL, 0, 
                                          GTK_STOCK_OK,
                                          GTK_RESPONSE_ACCEPT,
@@ -127,11 +138,9 @@ static void WhatCheck (GtkMenuItem *item, gpointer data) {
     gtk_box_pack_start(GTK_BOX(vbox), label, FALSE, FALSE, 1);
     
     combo = gtk_combo_box_text_new();    
-    for (i = 0; i < word_list_size(&hints); i++) {
-      char *uword = g_ucs4_to_utf8((gunichar *)words[i], -1, NULL, NULL, NULL);
-      gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo), uword);
-      g_free(uword);
-    }
+    hints.combo = combo;
+    hints.count = 0;
+    dictionary_hints_foreach(dict, (wchar_t *)wword, append_hint, &hints);
     gtk_combo_box_set_active(GTK_COMBO_BOX(combo), 0);
     gtk_box_pack_start(GTK_BOX(vbox), combo, FALSE, FALSE, 1);
     gtk_widget_show(combo);